@@ -0,0 +1,87 @@
+/**
+* Benchmarks of the JSON and XML loggers
+*
+* Benchmarks cover:
+* > JSONLogger output of a RunLog with many step frames
+* > XMLLogger output of a RunLog with many step frames
+*/
+#include <array>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/io/JSONLogger.h"
+#include "flamegpu/io/XMLLogger.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_logger {
+const unsigned int AGENTS = 4;
+const unsigned int VARIABLES = 4;
+const char *JSON_FILE_NAME = "bench_logger.json";
+const char *XML_FILE_NAME = "bench_logger.xml";
+/**
+ * Builds a log frame equivalent to one produced by CUDASimulation, logging several environment properties,
+ * and the count and every reduction of several variables for each agent
+ */
+LogFrame buildFrame(const unsigned int step) {
+    std::map<std::string, util::Any> env;
+    env.emplace("float", util::Any(static_cast<float>(step)));
+    env.emplace("int", util::Any(static_cast<int>(step)));
+    const std::array<double, 4> array = {0.0, 1.0, 2.0, static_cast<double>(step)};
+    env.emplace("array", util::Any(array.data(), sizeof(double) * array.size(), std::type_index(typeid(double)), static_cast<unsigned int>(array.size())));
+    std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents;
+    const LoggingConfig::Reduction reductions[] = {
+        LoggingConfig::Mean, LoggingConfig::StandardDev, LoggingConfig::Min, LoggingConfig::Max, LoggingConfig::Sum };
+    for (unsigned int a = 0; a < AGENTS; ++a) {
+        std::map<LoggingConfig::NameReductionFn, util::Any> vars;
+        for (unsigned int v = 0; v < VARIABLES; ++v) {
+            for (const auto &reduction : reductions) {
+                // The reduction function pointers are not used by the loggers
+                vars.emplace(LoggingConfig::NameReductionFn{"v" + std::to_string(v), reduction, nullptr, nullptr}, util::Any(static_cast<double>(step + v)));
+            }
+        }
+        agents.emplace(util::StringPair{"agent" + std::to_string(a), ModelData::DEFAULT_STATE}, std::make_pair(std::move(vars), step * 10));
+    }
+    return LogFrame(std::move(env), std::move(agents), step);
+}
+RunLog buildRunLog(const unsigned int steps) {
+    std::list<LogFrame> step_log;
+    for (unsigned int i = 0; i < steps; ++i) {
+        step_log.push_back(buildFrame(i));
+    }
+    return RunLog(buildFrame(steps), step_log);
+}
+template<typename LoggerT>
+void logRun(benchmark::State &state, const char *path, const bool prettyPrint) {
+    const unsigned int steps = static_cast<unsigned int>(state.range(0));
+    const RunLog log = buildRunLog(steps);
+    for (auto _ : state) {
+        LoggerT logger(path, prettyPrint, true);
+        logger.log(log, true, true, true);
+    }
+    state.SetItemsProcessed(state.iterations() * steps);
+    std::remove(path);
+}
+
+void BM_JSONLogger(benchmark::State &state) {
+    logRun<io::JSONLogger>(state, JSON_FILE_NAME, false);
+}
+BENCHMARK(BM_JSONLogger)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+void BM_JSONLogger_PrettyPrint(benchmark::State &state) {
+    logRun<io::JSONLogger>(state, JSON_FILE_NAME, true);
+}
+BENCHMARK(BM_JSONLogger_PrettyPrint)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+void BM_XMLLogger(benchmark::State &state) {
+    logRun<io::XMLLogger>(state, XML_FILE_NAME, false);
+}
+BENCHMARK(BM_XMLLogger)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+}  // namespace bench_logger
+}  // namespace flamegpu
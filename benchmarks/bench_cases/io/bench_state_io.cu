@@ -0,0 +1,155 @@
+/**
+* Benchmarks of the JSON and XML state readers and writers
+*
+* Benchmarks cover:
+* > JSONStateReader and XMLStateReader parsing of synthetic populations
+* > JSONStateWriter and XMLStateWriter output via Simulation::exportData()
+*
+* @note The state writers read environment properties from EnvironmentManager, which requires a CUDA device,
+* so the writer benchmarks are skipped if a device is not available.
+*/
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/io/StateReaderFactory.h"
+#include "helpers/synthetic_model.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_state_io {
+const unsigned int VARIABLES = 6;
+const char *JSON_FILE_NAME = "bench_state_io.json";
+const char *XML_FILE_NAME = "bench_state_io.xml";
+/**
+ * Formats the value of variable j of agent i, matching benchmarks::fillSyntheticPopulation()
+ * @param separator Separator between array elements
+ */
+std::string syntheticValue(const unsigned int i, const unsigned int j, const char *separator) {
+    switch (j % 3) {
+    case 0:
+        return std::to_string(static_cast<float>(i) * 0.5f);
+    case 1:
+        return std::to_string(i);
+    default:
+        return std::to_string(static_cast<float>(i)) + separator + std::to_string(static_cast<float>(j)) + separator + "0.25";
+    }
+}
+/**
+ * Writes a JSON state file, in the format output by JSONStateWriter, holding count agents
+ * This is written directly, so that the reader benchmarks do not require a device
+ */
+void writeSyntheticJSON(const std::string &path, const unsigned int count) {
+    std::ofstream out(path, std::ofstream::trunc);
+    out << "{\"config\":{},\"stats\":{\"step_count\":0},\"environment\":{\"scalar\":1.0,\"array\":[1,2,3,4,5,6,7,8]},";
+    out << "\"agents\":{\"agent\":{\"default\":[";
+    for (unsigned int i = 0; i < count; ++i) {
+        out << (i ? ",{" : "{");
+        for (unsigned int j = 0; j < VARIABLES; ++j) {
+            out << (j ? ",\"v" : "\"v") << j << "\":";
+            if (j % 3 == 2) {
+                out << "[" << syntheticValue(i, j, ",") << "]";
+            } else {
+                out << syntheticValue(i, j, ",");
+            }
+        }
+        out << "}";
+    }
+    out << "]}}}\n";
+}
+/**
+ * Writes an XML state file, in the format output by XMLStateWriter, holding count agents
+ * This is written directly, so that the reader benchmarks do not require a device
+ */
+void writeSyntheticXML(const std::string &path, const unsigned int count) {
+    std::ofstream out(path, std::ofstream::trunc);
+    out << "<states>\n<itno>0</itno>\n<environment>\n<scalar>1.0</scalar>\n<array>1,2,3,4,5,6,7,8</array>\n</environment>\n";
+    for (unsigned int i = 0; i < count; ++i) {
+        out << "<xagent>\n<name>agent</name>\n<state>default</state>\n";
+        for (unsigned int j = 0; j < VARIABLES; ++j) {
+            out << "<v" << j << ">" << syntheticValue(i, j, ",") << "</v" << j << ">\n";
+        }
+        out << "</xagent>\n";
+    }
+    out << "</states>\n";
+}
+/**
+ * Parses the input file via the StateReader selected by StateReaderFactory, in the same manner as Simulation::applyConfig()
+ */
+void readStates(benchmark::State &state, const std::string &path, void(*writeInput)(const std::string &, unsigned int)) {
+    ModelDescription model("model");
+    EnvironmentDescription &env = model.Environment();
+    env.newProperty<float>("scalar", 0.0f);
+    env.newProperty<int, 8>("array", {});
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    writeInput(path, count);
+    const auto env_desc = env.getPropertiesMap();
+    for (auto _ : state) {
+        util::StringUint32PairUnorderedMap<util::Any> env_init;
+        util::StringPairUnorderedMap<std::shared_ptr<AgentVector>> pops;
+        pops.emplace(util::StringPair{ "agent", ModelData::DEFAULT_STATE }, std::make_shared<AgentVector>(agent));
+        std::unique_ptr<io::StateReader> reader(io::StateReaderFactory::createReader(model.getName(), env_desc, env_init, pops, path, nullptr));
+        reader->parse();
+        benchmark::DoNotOptimize(pops.begin()->second->size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::remove(path.c_str());
+}
+/**
+ * Exports a simulation's state via the StateWriter selected by StateWriterFactory
+ */
+void writeStates(benchmark::State &state, const std::string &path, const bool prettyPrint) {
+    if (!benchmarks::hasDevice()) {
+        state.SkipWithError("A CUDA device is required to export state files");
+        return;
+    }
+    ModelDescription model("model");
+    EnvironmentDescription &env = model.Environment();
+    env.newProperty<float>("scalar", 1.0f);
+    env.newProperty<int, 8>("array", {1, 2, 3, 4, 5, 6, 7, 8});
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    AgentVector pop(agent, count);
+    benchmarks::fillSyntheticPopulation(pop, VARIABLES);
+    CUDASimulation sim(model);
+    sim.setPopulationData(pop);
+    // Warm up, so that the population is already available on the host
+    sim.exportData(path, prettyPrint);
+    for (auto _ : state) {
+        sim.exportData(path, prettyPrint);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::remove(path.c_str());
+}
+
+void BM_JSONStateReader(benchmark::State &state) {
+    readStates(state, JSON_FILE_NAME, writeSyntheticJSON);
+}
+BENCHMARK(BM_JSONStateReader)->RangeMultiplier(16)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMillisecond);
+void BM_XMLStateReader(benchmark::State &state) {
+    readStates(state, XML_FILE_NAME, writeSyntheticXML);
+}
+BENCHMARK(BM_XMLStateReader)->RangeMultiplier(16)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMillisecond);
+void BM_JSONStateWriter(benchmark::State &state) {
+    writeStates(state, JSON_FILE_NAME, false);
+}
+BENCHMARK(BM_JSONStateWriter)->RangeMultiplier(16)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMillisecond);
+void BM_JSONStateWriter_PrettyPrint(benchmark::State &state) {
+    writeStates(state, JSON_FILE_NAME, true);
+}
+BENCHMARK(BM_JSONStateWriter_PrettyPrint)->RangeMultiplier(16)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMillisecond);
+void BM_XMLStateWriter(benchmark::State &state) {
+    writeStates(state, XML_FILE_NAME, false);
+}
+BENCHMARK(BM_XMLStateWriter)->RangeMultiplier(16)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMillisecond);
+}  // namespace bench_state_io
+}  // namespace flamegpu
@@ -0,0 +1,52 @@
+/**
+* Benchmarks of DependencyGraph
+*
+* Benchmarks cover:
+* > generateLayers() for large synthetic models, with many agents and long chains of dependent agent functions
+* > validation of large dependency graphs
+*/
+#include "flamegpu/flamegpu.h"
+#include "helpers/synthetic_model.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_dependency_graph {
+
+void BM_DependencyGraph_GenerateLayers(benchmark::State &state) {
+    const unsigned int agents = static_cast<unsigned int>(state.range(0));
+    const unsigned int functions = static_cast<unsigned int>(state.range(1));
+    for (auto _ : state) {
+        // Layers can only be generated once per model, so a new model is required each iteration
+        state.PauseTiming();
+        ModelDescription model("model");
+        benchmarks::defineSyntheticModel(model, agents, functions);
+        state.ResumeTiming();
+        model.generateLayers();
+        benchmark::DoNotOptimize(model.getLayersCount());
+    }
+    state.SetItemsProcessed(state.iterations() * agents * functions);
+}
+BENCHMARK(BM_DependencyGraph_GenerateLayers)
+    ->ArgNames({"agents", "functions"})
+    ->Args({4, 16})->Args({16, 16})->Args({64, 16})->Args({16, 64})->Args({64, 64})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_DependencyGraph_Validate(benchmark::State &state) {
+    const unsigned int agents = static_cast<unsigned int>(state.range(0));
+    const unsigned int functions = static_cast<unsigned int>(state.range(1));
+    ModelDescription model("model");
+    benchmarks::defineSyntheticModel(model, agents, functions);
+    DependencyGraph &graph = model.getDependencyGraph();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(graph.validateDependencyGraph());
+    }
+    state.SetItemsProcessed(state.iterations() * agents * functions);
+}
+BENCHMARK(BM_DependencyGraph_Validate)
+    ->ArgNames({"agents", "functions"})
+    ->Args({4, 16})->Args({16, 16})->Args({64, 16})->Args({16, 64})->Args({64, 64});
+}  // namespace bench_dependency_graph
+}  // namespace flamegpu
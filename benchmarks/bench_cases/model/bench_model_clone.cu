@@ -0,0 +1,64 @@
+/**
+* Benchmarks of ModelData::clone()
+*
+* Benchmarks cover:
+* > cloning of large synthetic model hierarchies, as performed when a model is passed to a simulation or ensemble
+* > cloning of models containing a submodel
+*
+* @note ModelData is not accessible from ModelDescription, so the clone is performed by constructing a CUDAEnsemble,
+* which does not require a device and otherwise only parses it's (empty) arguments.
+*/
+#include "flamegpu/flamegpu.h"
+#include "helpers/synthetic_model.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_model_clone {
+FLAMEGPU_EXIT_CONDITION(exit_always) {
+    return EXIT;
+}
+
+void BM_ModelData_Clone(benchmark::State &state) {
+    const unsigned int agents = static_cast<unsigned int>(state.range(0));
+    const unsigned int functions = static_cast<unsigned int>(state.range(1));
+    ModelDescription model("model");
+    benchmarks::defineSyntheticModel(model, agents, functions);
+    model.generateLayers();
+    for (auto _ : state) {
+        CUDAEnsemble ensemble(model);
+        benchmark::DoNotOptimize(&ensemble);
+    }
+    state.SetItemsProcessed(state.iterations() * agents * functions);
+}
+BENCHMARK(BM_ModelData_Clone)
+    ->ArgNames({"agents", "functions"})
+    ->Args({4, 16})->Args({16, 16})->Args({64, 16})->Args({64, 64})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_ModelData_CloneSubModel(benchmark::State &state) {
+    const unsigned int agents = static_cast<unsigned int>(state.range(0));
+    const unsigned int functions = static_cast<unsigned int>(state.range(1));
+    ModelDescription sub_model("sub_model");
+    benchmarks::defineSyntheticModel(sub_model, agents, functions);
+    sub_model.generateLayers();
+    sub_model.addExitCondition(exit_always);
+    ModelDescription model("model");
+    benchmarks::defineSyntheticModel(model, agents, functions);
+    SubModelDescription &sub = model.newSubModel("sub", sub_model);
+    sub.bindAgent("agent0", "agent0", true, true);
+    model.generateLayers();
+    for (auto _ : state) {
+        CUDAEnsemble ensemble(model);
+        benchmark::DoNotOptimize(&ensemble);
+    }
+    state.SetItemsProcessed(state.iterations() * agents * functions * 2);
+}
+BENCHMARK(BM_ModelData_CloneSubModel)
+    ->ArgNames({"agents", "functions"})
+    ->Args({4, 16})->Args({16, 16})->Args({64, 16})
+    ->Unit(benchmark::kMicrosecond);
+}  // namespace bench_model_clone
+}  // namespace flamegpu
@@ -0,0 +1,122 @@
+/**
+* Benchmarks of AgentVector
+*
+* Benchmarks cover:
+* > construction of populations with many variables
+* > variable access via AgentVector::Agent (setVariable() and getVariable())
+* > variable access via AgentVector::data()
+* > push_back() growth
+* > copy construction
+*/
+#include <array>
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "helpers/synthetic_model.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_agent_vector {
+const unsigned int VARIABLES = 12;
+
+void BM_AgentVector_Construct(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    for (auto _ : state) {
+        AgentVector pop(agent, count);
+        benchmark::DoNotOptimize(pop.data<float>("v0"));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_Construct)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+void BM_AgentVector_SetGetVariable(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    AgentVector pop(agent, count);
+    for (auto _ : state) {
+        int sum = 0;
+        for (AgentVector::Agent ai : pop) {
+            ai.setVariable<int>("v1", ai.getVariable<int>("v1") + 1);
+            sum += ai.getVariable<int>("v4");
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_SetGetVariable)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+void BM_AgentVector_SetGetArrayVariable(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    AgentVector pop(agent, count);
+    for (auto _ : state) {
+        for (AgentVector::Agent ai : pop) {
+            std::array<float, 3> v = ai.getVariable<float, 3>("v2");
+            v[0] += 1.0f;
+            ai.setVariable<float, 3>("v2", v);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_SetGetArrayVariable)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+void BM_AgentVector_DataAccess(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    AgentVector pop(agent, count);
+    for (auto _ : state) {
+        int *data = pop.data<int>("v1");
+        for (unsigned int i = 0; i < count; ++i) {
+            data[i] += 1;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_DataAccess)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+void BM_AgentVector_PushBack(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    for (auto _ : state) {
+        AgentVector pop(agent);
+        for (unsigned int i = 0; i < count; ++i) {
+            pop.push_back();
+        }
+        benchmark::DoNotOptimize(pop.size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_PushBack)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+void BM_AgentVector_Copy(benchmark::State &state) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    benchmarks::addSyntheticVariables(agent, VARIABLES);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    AgentVector pop(agent, count);
+    benchmarks::fillSyntheticPopulation(pop, VARIABLES);
+    for (auto _ : state) {
+        AgentVector copy(pop);
+        benchmark::DoNotOptimize(copy.data<float>("v0"));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AgentVector_Copy)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+}  // namespace bench_agent_vector
+}  // namespace flamegpu
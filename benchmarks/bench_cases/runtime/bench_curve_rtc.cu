@@ -0,0 +1,62 @@
+/**
+* Benchmarks of CurveRTCHost
+*
+* Benchmarks cover:
+* > dynamic header generation for agent functions accessing many variables, messages and environment properties
+*/
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/runtime/detail/curve/curve_rtc.cuh"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_curve_rtc {
+/**
+ * Registers count of each type of variable with curve, in the same manner as CUDAAgent::addInstantitateRTCFunction()
+ */
+void registerVariables(detail::curve::CurveRTCHost &curve, const std::vector<std::string> &names) {
+    ptrdiff_t offset = 0;
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        const char *name = names[i].c_str();
+        if (i % 2) {
+            curve.registerAgentVariable(name, "float", sizeof(float));
+            curve.registerMessageInVariable(name, "float", sizeof(float), 1, true, false);
+            curve.registerMessageOutVariable(name, "float", sizeof(float), 1, false, true);
+            curve.registerNewAgentVariable(name, "float", sizeof(float), 1, false, true);
+            curve.registerEnvVariable(name, offset, "float", sizeof(float));
+            offset += sizeof(float);
+        } else {
+            curve.registerAgentVariable(name, "int", sizeof(int), 3);
+            curve.registerMessageInVariable(name, "int", sizeof(int), 3, true, false);
+            curve.registerMessageOutVariable(name, "int", sizeof(int), 3, false, true);
+            curve.registerNewAgentVariable(name, "int", sizeof(int), 3, false, true);
+            curve.registerEnvVariable(name, offset, "int", sizeof(int), 3);
+            offset += 3 * sizeof(int);
+        }
+    }
+}
+
+void BM_CurveRTCHost_GetDynamicHeader(benchmark::State &state) {
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        names.push_back("variable" + std::to_string(i));
+    }
+    size_t header_length = 0;
+    for (auto _ : state) {
+        // The header can only be generated once per instance, so registration is also timed
+        detail::curve::CurveRTCHost curve;
+        registerVariables(curve, names);
+        header_length = curve.getDynamicHeader().size();
+        benchmark::DoNotOptimize(header_length);
+    }
+    state.counters["header_bytes"] = static_cast<double>(header_length);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CurveRTCHost_GetDynamicHeader)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
+}  // namespace bench_curve_rtc
+}  // namespace flamegpu
@@ -0,0 +1,77 @@
+/**
+* Benchmarks of RunPlanVector
+*
+* Benchmarks cover:
+* > construction of large plan vectors
+* > generation of per run seeds and properties (uniform distribution, uniform random and normal random)
+*/
+#include <string>
+
+#include "flamegpu/flamegpu.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_run_plan_vector {
+const unsigned int PROPERTIES = 8;
+
+void defineEnvironment(ModelDescription &model) {
+    EnvironmentDescription &env = model.Environment();
+    for (unsigned int i = 0; i < PROPERTIES; ++i) {
+        env.newProperty<float>("f" + std::to_string(i), 0.0f);
+        env.newProperty<int>("i" + std::to_string(i), 0);
+    }
+    env.newProperty<double, 16>("array", {});
+}
+
+void BM_RunPlanVector_Construct(benchmark::State &state) {
+    ModelDescription model("model");
+    defineEnvironment(model);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    for (auto _ : state) {
+        RunPlanVector plans(model, count);
+        benchmark::DoNotOptimize(plans.size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RunPlanVector_Construct)->RangeMultiplier(16)->Range(1 << 4, 1 << 16);
+
+void BM_RunPlanVector_Generate(benchmark::State &state) {
+    ModelDescription model("model");
+    defineEnvironment(model);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    RunPlanVector plans(model, count);
+    for (auto _ : state) {
+        plans.setRandomSimulationSeed(12, 1);
+        plans.setSteps(100);
+        for (unsigned int i = 0; i < PROPERTIES; ++i) {
+            plans.setPropertyUniformDistribution<float>("f" + std::to_string(i), 0.0f, 1.0f);
+            plans.setPropertyUniformRandom<int>("i" + std::to_string(i), 0, 100);
+        }
+        for (EnvironmentManager::size_type i = 0; i < 16; ++i) {
+            plans.setPropertyNormalRandom<double>("array", i, 0.0, 1.0);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RunPlanVector_Generate)->RangeMultiplier(16)->Range(1 << 4, 1 << 16);
+
+void BM_RunPlanVector_Copy(benchmark::State &state) {
+    ModelDescription model("model");
+    defineEnvironment(model);
+    const unsigned int count = static_cast<unsigned int>(state.range(0));
+    RunPlanVector plans(model, count);
+    for (unsigned int i = 0; i < PROPERTIES; ++i) {
+        plans.setPropertyUniformRandom<float>("f" + std::to_string(i), 0.0f, 1.0f);
+    }
+    for (auto _ : state) {
+        RunPlanVector copy(plans);
+        benchmark::DoNotOptimize(copy.size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RunPlanVector_Copy)->RangeMultiplier(16)->Range(1 << 4, 1 << 16);
+}  // namespace bench_run_plan_vector
+}  // namespace flamegpu
@@ -0,0 +1,75 @@
+/**
+* Benchmarks of JitifyCache
+*
+* Benchmarks cover:
+* > generation of the cache key from large kernel sources and dynamic headers
+* > lookup of kernels which are not in the in-memory or on-disk cache
+*
+* @note Loading a cached kernel requires a compiled kernel, which requires a device and NVRTC, so cache hits are not benchmarked here.
+*/
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/runtime/detail/curve/curve_rtc.cuh"
+#include "flamegpu/util/detail/JitifyCache.h"
+
+#include "benchmark/benchmark.h"
+
+namespace flamegpu {
+
+
+namespace bench_jitify_cache {
+const char *KERNEL_SRC = R"###(
+#include "flamegpu/runtime/DeviceAPI.cuh"
+#include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceDevice.cuh"
+FLAMEGPU_AGENT_FUNCTION(rtc_function, flamegpu::MessageBruteForce, flamegpu::MessageNone) {
+    float sum = 0;
+    for (const auto &message : FLAMEGPU->message_in) {
+        sum += message.getVariable<float>("variable1");
+    }
+    FLAMEGPU->setVariable<float>("variable1", sum);
+    return flamegpu::ALIVE;
+}
+)###";
+/**
+ * Generates a dynamic header of a realistic size, via CurveRTCHost
+ */
+std::string buildDynamicHeader(const unsigned int variables) {
+    detail::curve::CurveRTCHost curve;
+    for (unsigned int i = 0; i < variables; ++i) {
+        const std::string name = "variable" + std::to_string(i);
+        curve.registerAgentVariable(name.c_str(), "float", sizeof(float));
+        curve.registerMessageInVariable(name.c_str(), "float", sizeof(float), 1, true, false);
+    }
+    return curve.getDynamicHeader();
+}
+
+void BM_JitifyCache_GetCacheKey(benchmark::State &state) {
+    const std::string header = buildDynamicHeader(static_cast<unsigned int>(state.range(0)));
+    const std::string kernel_src = KERNEL_SRC;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::detail::JitifyCache::getCacheKey(kernel_src, header));
+    }
+    state.SetBytesProcessed(state.iterations() * (kernel_src.size() + header.size()));
+}
+BENCHMARK(BM_JitifyCache_GetCacheKey)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_JitifyCache_LookupMiss(benchmark::State &state) {
+    const std::string header = buildDynamicHeader(static_cast<unsigned int>(state.range(0)));
+    const std::string kernel_src = KERNEL_SRC;
+    util::detail::JitifyCache &cache = util::detail::JitifyCache::getInstance();
+    const bool use_disk_cache = cache.useDiskCache();
+    cache.useDiskCache(state.range(1) != 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.isCached(kernel_src, header));
+    }
+    cache.useDiskCache(use_disk_cache);
+    state.SetBytesProcessed(state.iterations() * (kernel_src.size() + header.size()));
+}
+BENCHMARK(BM_JitifyCache_LookupMiss)
+    ->ArgNames({"variables", "disk_cache"})
+    ->Args({4, 0})->Args({64, 0})->Args({256, 0})
+    ->Args({4, 1})->Args({64, 1})->Args({256, 1});
+}  // namespace bench_jitify_cache
+}  // namespace flamegpu
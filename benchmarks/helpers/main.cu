@@ -0,0 +1,39 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "flamegpu/gpu/CUDASimulation.h"
+#include "flamegpu/version.h"
+#include "benchmark/benchmark.h"
+
+
+int main(int argc, char **argv) {
+    // Disable auto reset, as benchmarks which require a device create many simulations
+    flamegpu::CUDASimulation::AUTO_CUDA_DEVICE_RESET = false;
+    // Results are always written as JSON, so they can be compared between releases (e.g. with benchmark's tools/compare.py)
+    // Unless the user has specified their own output file
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--benchmark_out=", strlen("--benchmark_out=")) == 0) {
+            has_out = true;
+        }
+    }
+    std::string out_arg = std::string("--benchmark_out=benchmarks_") + flamegpu::VERSION_FULL + ".json";
+    std::string out_format_arg = "--benchmark_out_format=json";
+    if (!has_out) {
+        args.push_back(&out_arg[0]);
+        args.push_back(&out_format_arg[0]);
+    }
+    int args_count = static_cast<int>(args.size());
+    benchmark::AddCustomContext("flamegpu_version", flamegpu::VERSION_FULL);
+    benchmark::AddCustomContext("flamegpu_build_metadata", flamegpu::VERSION_BUILDMETADATA);
+    benchmark::AddCustomContext("flamegpu_seatbelts", std::to_string(SEATBELTS));
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
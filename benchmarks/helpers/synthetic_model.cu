@@ -0,0 +1,93 @@
+#include "helpers/synthetic_model.h"
+
+#include <cuda_runtime.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace flamegpu {
+namespace benchmarks {
+
+FLAMEGPU_AGENT_FUNCTION(synthetic_output, MessageNone, MessageBruteForce) {
+    FLAMEGPU->message_out.setVariable<float>("x", FLAMEGPU->getVariable<float>("v0"));
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(synthetic_function, MessageNone, MessageNone) {
+    return ALIVE;
+}
+
+void addSyntheticVariables(AgentDescription &agent, const unsigned int variables) {
+    for (unsigned int i = 0; i < variables; ++i) {
+        const std::string name = "v" + std::to_string(i);
+        switch (i % 3) {
+        case 0:
+            agent.newVariable<float>(name, 1.0f);
+            break;
+        case 1:
+            agent.newVariable<int>(name, 2);
+            break;
+        default:
+            agent.newVariable<float, 3>(name, {3.0f, 4.0f, 5.0f});
+            break;
+        }
+    }
+}
+void fillSyntheticPopulation(AgentVector &pop, const unsigned int variables) {
+    for (unsigned int i = 0; i < pop.size(); ++i) {
+        AgentVector::Agent ai = pop[i];
+        for (unsigned int j = 0; j < variables; ++j) {
+            const std::string name = "v" + std::to_string(j);
+            switch (j % 3) {
+            case 0:
+                ai.setVariable<float>(name, static_cast<float>(i) * 0.5f);
+                break;
+            case 1:
+                ai.setVariable<int>(name, static_cast<int>(i));
+                break;
+            default:
+                ai.setVariable<float, 3>(name, {static_cast<float>(i), static_cast<float>(j), 0.25f});
+                break;
+            }
+        }
+    }
+}
+void defineSyntheticModel(ModelDescription &model, const unsigned int agents, const unsigned int functions) {
+    EnvironmentDescription &env = model.Environment();
+    env.newProperty<float>("scalar", 1.0f);
+    env.newProperty<int, 8>("array", {1, 2, 3, 4, 5, 6, 7, 8});
+    std::vector<std::vector<AgentFunctionDescription*>> fns(agents);
+    for (unsigned int a = 0; a < agents; ++a) {
+        const std::string agent_name = "agent" + std::to_string(a);
+        AgentDescription &agent = model.newAgent(agent_name);
+        addSyntheticVariables(agent, 6);
+        MessageBruteForce::Description &message = model.newMessage(agent_name + "_message");
+        message.newVariable<float>("x");
+        for (unsigned int f = 0; f < functions; ++f) {
+            if (f == 0) {
+                AgentFunctionDescription &fn = agent.newFunction("fn0", synthetic_output);
+                fn.setMessageOutput(message);
+                fns[a].push_back(&fn);
+            } else {
+                fns[a].push_back(&agent.newFunction("fn" + std::to_string(f), synthetic_function));
+            }
+        }
+    }
+    DependencyGraph &graph = model.getDependencyGraph();
+    for (unsigned int a = 0; a < agents; ++a) {
+        graph.addRoot(*fns[a][0]);
+        for (unsigned int f = 1; f < functions; ++f) {
+            fns[a][f]->dependsOn(*fns[a][f - 1]);
+            if (agents > 1) {
+                fns[a][f]->dependsOn(*fns[(a + 1) % agents][f - 1]);
+            }
+        }
+    }
+}
+bool hasDevice() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+}  // namespace benchmarks
+}  // namespace flamegpu
@@ -0,0 +1,40 @@
+#ifndef BENCHMARKS_HELPERS_SYNTHETIC_MODEL_H_
+#define BENCHMARKS_HELPERS_SYNTHETIC_MODEL_H_
+
+#include "flamegpu/flamegpu.h"
+
+namespace flamegpu {
+namespace benchmarks {
+/**
+ * Adds variables to the agent, cycling between scalar float, scalar int and array float[3] variables
+ * Variables are named "v0", "v1", ... "v<variables-1>"
+ * @param agent The agent to add variables to
+ * @param variables The number of variables to add
+ */
+void addSyntheticVariables(AgentDescription &agent, unsigned int variables);
+/**
+ * Sets every variable of every agent within the population to a value derived from the agent's index
+ * @param pop A population of an agent defined by addSyntheticVariables()
+ * @param variables The number of variables passed to addSyntheticVariables()
+ */
+void fillSyntheticPopulation(AgentVector &pop, unsigned int variables);
+/**
+ * Defines a model with many agents, each with a chain of agent functions
+ * Agent function f of agent a depends on function f-1 of agents a and a+1, so the dependency graph is heavily connected
+ * Each agent also has a message output by its first function, and some environment properties, so the model hierarchy has some depth
+ * @param model The model to define the agents within
+ * @param agents The number of agents to define
+ * @param functions The number of agent functions defined for each agent
+ * @note The first function of each agent is added as a root of the model's dependency graph
+ */
+void defineSyntheticModel(ModelDescription &model, unsigned int agents, unsigned int functions);
+/**
+ * Returns whether a CUDA device is available
+ * Benchmarks which require a device should be skipped (via benchmark::State::SkipWithError()) if this returns false
+ */
+bool hasDevice();
+
+}  // namespace benchmarks
+}  // namespace flamegpu
+
+#endif  // BENCHMARKS_HELPERS_SYNTHETIC_MODEL_H_
@@ -0,0 +1,40 @@
+###################
+# GOOGLEBENCHMARK #
+###################
+
+set(CMAKE_MODULE_PATH ${CMAKE_CURRENT_LIST_DIR}/modules/ ${CMAKE_MODULE_PATH})
+include(FetchContent)
+cmake_policy(SET CMP0079 NEW)
+
+FetchContent_Declare(
+  googlebenchmark
+  GIT_REPOSITORY https://github.com/google/benchmark.git
+  GIT_TAG        v1.6.1
+)
+
+FetchContent_GetProperties(googlebenchmark)
+if(NOT googlebenchmark_POPULATED)
+    FetchContent_Populate(googlebenchmark)
+    # Don't build google benchmark's own tests, as these would require googletest to be fetched a second time
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+    # Suppress installation target, as this makes a warning
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_TESTING)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_GTEST_TESTS)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_INSTALL)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_LTO)
+    mark_as_advanced(FORCE BENCHMARK_USE_LIBCXX)
+    mark_as_advanced(FORCE BENCHMARK_DOWNLOAD_DEPENDENCIES)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_ASSEMBLY_TESTS)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_EXCEPTIONS)
+    mark_as_advanced(FORCE BENCHMARK_ENABLE_DOXYGEN)
+    mark_as_advanced(FORCE BENCHMARK_INSTALL_DOCS)
+    add_subdirectory(${googlebenchmark_SOURCE_DIR} ${googlebenchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+    CMAKE_SET_TARGET_FOLDER("benchmark" "Benchmarks/Dependencies")
+    # Suppress warnigns from this target.
+    include(${CMAKE_CURRENT_LIST_DIR}/../warnings.cmake)
+    if(TARGET benchmark)
+        DisableCompilerWarnings(TARGET benchmark)
+    endif()
+endif()
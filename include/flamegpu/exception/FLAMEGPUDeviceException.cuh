@@ -25,6 +25,10 @@ class DeviceExceptionManager {
     ~DeviceExceptionManager();
     DeviceExceptionBuffer *getDevicePtr(const unsigned int &streamId, const cudaStream_t &stream);
     void checkError(const std::string &function, const unsigned int &streamId, const cudaStream_t &stream);
+    /**
+     * Returns the device memory currently allocated to per stream error buffers, in bytes
+     */
+    size_t getDeviceMemoryUsage() const;
 
  private:
     /**
@@ -411,6 +411,10 @@ DERIVED_FLAMEGPUException(InvalidDependencyGraph, "Agent function dependency gra
  * This should not occur if the shared ID matches ID_NOT_SET
  */
 DERIVED_FLAMEGPUException(AgentIDCollision, "Multiple agents of same type share an ID");
+/**
+ * Defines an error reported by the connections between the coordinator and workers of a distributed ensemble
+ */
+DERIVED_FLAMEGPUException(EnsembleNetworkError, "A distributed ensemble connection failed");
 
 }  // namespace exception
 }  // namespace flamegpu
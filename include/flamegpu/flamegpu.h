@@ -26,8 +26,10 @@
 #include "flamegpu/model/SubModelDescription.h"
 #include "flamegpu/model/SubAgentDescription.h"
 #include "flamegpu/model/SubEnvironmentDescription.h"
+#include "flamegpu/model/VariableUsageAnalysis.h"
 #include "flamegpu/pop/AgentVector.h"
 #include "flamegpu/pop/AgentInstance.h"
+#include "flamegpu/pop/AgentVectorReductions.h"
 #include "flamegpu/gpu/CUDASimulation.h"
 #include "flamegpu/runtime/messaging.h"
 #include "flamegpu/runtime/AgentFunction_shim.cuh"
@@ -32,6 +32,10 @@ class CUDAAgent : public AgentInterface {
 #ifdef VISUALISATION
     friend class visualiser::AgentVis;
 #endif  // VISUALISATION
+    /**
+     * CUDASimulation::buildMemoryReport() requires access to the fat agent's state lists
+     */
+    friend class CUDASimulation;
 
  public:
     /**
@@ -86,9 +90,11 @@ class CUDAAgent : public AgentInterface {
      * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
      * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
      * @param stream CUDA stream to be used for async CUDA operations
+     * @param validateIDs If false, the check that no agents share an ID is skipped
      * @note Scatter is required for initialising submodel vars
+     * @see CUDASimulation::Config::validateAgentIDs
      */
-    void setPopulationData(const AgentVector& population, const std::string &state_name, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t& stream);
+    void setPopulationData(const AgentVector& population, const std::string &state_name, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t& stream, bool validateIDs = true);
     /**
      * Copies population data the device buffers held by this object
      * To the hosts object (overwriting any existing agent data)
@@ -110,6 +116,12 @@ class CUDAAgent : public AgentInterface {
      * Returns the Agent description which this CUDAAgent represents.
      */
     const AgentData &getAgentDescription() const override;
+    /**
+     * Returns the Agent description from the parent CUDASimulation's model
+     * This differs from getAgentDescription() if the CUDAAgent does not store variables eliminated as unused
+     * @see CUDASimulation::Config::eliminateUnusedAgentVariables
+     */
+    const AgentData &getModelAgentDescription() const;
     /**
      * Returns the device pointer to the buffer for the associated state and variable
      * @note This returns data_condition, such that the buffer does not include disabled agents
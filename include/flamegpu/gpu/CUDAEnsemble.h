@@ -1,16 +1,22 @@
 #ifndef INCLUDE_FLAMEGPU_GPU_CUDAENSEMBLE_H_
 #define INCLUDE_FLAMEGPU_GPU_CUDAENSEMBLE_H_
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
 #include <memory>
 #include <set>
 #include <vector>
 
+#include "flamegpu/util/StringPair.h"
 
 namespace flamegpu {
 
 struct ModelData;
+class AgentVector;
 class ModelDescription;
+class RunPlan;
 class RunPlanVector;
 class LoggingConfig;
 class StepLoggingConfig;
@@ -53,6 +59,75 @@ class CUDAEnsemble {
          * This is independent of the EnsembleConfig::quiet
          */
         bool timing = false;
+        /**
+         * If set, simulate() coordinates a distributed ensemble rather than executing runs itself
+         * Workers connect to this address (of the form "host:port", the host may be "0.0.0.0" to accept workers on any interface),
+         * and are assigned runs until every run has completed. Runs assigned to a worker whose connection closes are reassigned.
+         * The logs of every run are returned to the coordinator, and written to out_directory by the coordinator
+         */
+        std::string listen_address = "";
+        /**
+         * If set, simulate() acts as a worker of a distributed ensemble, executing the runs assigned by the coordinator at this address (of the form "host:port")
+         * The worker must be executing the same model and RunPlanVector as the coordinator, and be built for the same platform
+         * @note getLogs() does not return the logs of a worker's runs, they are only returned by the coordinator
+         */
+        std::string coordinator_address = "";
+    };
+    /**
+     * Produces a replicate of a configuration during adaptive sampling
+     * The first argument is the configuration's plan from the base RunPlanVector, the second is the index of the replicate (counted from 0)
+     * @see seedStep()
+     */
+    typedef std::function<RunPlan(const RunPlan&, unsigned int)> ReplicateGenerator;
+    /**
+     * Decides whether a configuration requires further replicates during adaptive sampling
+     * The argument holds the RunLog of each successful replicate of the configuration, in replicate order
+     * The return value is the number of further replicates that the configuration requires, 0 once it has converged
+     * @see confidenceInterval()
+     */
+    typedef std::function<unsigned int(const std::vector<const RunLog*>&)> StoppingCriterion;
+    /**
+     * Config for CUDAEnsemble::simulate(const RunPlanVector &, const AdaptiveSampling &)
+     */
+    struct AdaptiveSampling {
+        /**
+         * Produces the replicates of each configuration
+         */
+        ReplicateGenerator replicate;
+        /**
+         * Decides when each configuration has converged
+         */
+        StoppingCriterion criterion;
+        /**
+         * The number of replicates of each configuration executed before the stopping criterion is first evaluated
+         */
+        unsigned int min_replicates = 3;
+        /**
+         * The maximum number of replicates of each configuration, configurations which reach this without converging are stopped
+         */
+        unsigned int max_replicates = 50;
+        /**
+         * The maximum number of further replicates of a configuration scheduled after each evaluation of the stopping criterion
+         * If 0, the number requested by the stopping criterion is only limited by max_replicates
+         */
+        unsigned int max_batch = 0;
+    };
+    /**
+     * The outcome of adaptive sampling for a single configuration
+     */
+    struct AdaptiveResult {
+        /**
+         * Logs of each successful replicate, in replicate order
+         */
+        std::vector<RunLog> logs;
+        /**
+         * The number of replicates which were executed, including those which failed
+         */
+        unsigned int replicates = 0;
+        /**
+         * True if the stopping criterion was satisfied before max_replicates was reached
+         */
+        bool converged = false;
     };
     /**
      * Initialise CUDA Ensemble
@@ -74,6 +149,36 @@ class CUDAEnsemble {
      * @param plan The plan of individual runs to execute during the ensemble
      */
     void simulate(const RunPlanVector &plan);
+    /**
+     * Execute replicates of each configuration within the plan, until each satisfies the stopping criterion
+     * Replicates are executed in rounds, each configuration's replicates are generated from it's plan by AdaptiveSampling::replicate.
+     * After each round, the stopping criterion of each configuration which executed replicates is evaluated, and the number of further
+     * replicates it requests are scheduled for the next round. Configurations which have converged (or reached max_replicates) are stopped.
+     * This call will block until all configurations have stopped
+     * @param plan The configurations to be sampled, one plan per configuration
+     * @param sampling Config of the adaptive sampling
+     * @throws exception::InvalidArgument If AdaptiveSampling::replicate or AdaptiveSampling::criterion are not set, or min_replicates is 0 or greater than max_replicates
+     * @note getLogs() returns the logs of every run in the order they were executed, which is also the index used for step log files
+     * @see getAdaptiveResults()
+     */
+    void simulate(const RunPlanVector &plan, const AdaptiveSampling &sampling);
+    /**
+     * Returns a replicate generator, which steps the random simulation seed of the configuration's plan
+     * Replicate r receives the seed of the configuration's plan + r * step
+     * @param step The value added to the seed for each subsequent replicate
+     * @note If the configurations share a seed, corresponding replicates of each configuration will also share a seed
+     */
+    static ReplicateGenerator seedStep(uint64_t step = 1);
+    /**
+     * Returns a stopping criterion, which is satisfied once the confidence interval of the mean of a metric is narrower than a threshold
+     * The half width of the interval is estimated as z * s / sqrt(n), where s is the sample standard deviation of the metric over n replicates.
+     * Until it is satisfied, the number of further replicates requested is the estimated number required for the interval to reach the threshold.
+     * @param metric Returns the value of the metric from a replicate's RunLog, e.g. an environment property of the exit log
+     * @param half_width The threshold of the interval's half width
+     * @param relative If true, the threshold is half_width multiplied by the magnitude of the mean
+     * @param z The critical value of the normal distribution, the default of 1.96 gives a 95% confidence interval
+     */
+    static StoppingCriterion confidenceInterval(std::function<double(const RunLog&)> metric, double half_width, bool relative = false, double z = 1.96);
 
     /**
      * @return A mutable reference to the ensemble configuration struct
@@ -108,8 +213,70 @@ class CUDAEnsemble {
      * Return the list of logs collected from the last call to simulate()
      */
     const std::vector<RunLog> &getLogs();
+    /**
+     * Return the outcome of each configuration from the last call to simulate() with adaptive sampling, in the order of the plan
+     * This is empty if the last call to simulate() did not use adaptive sampling
+     */
+    const std::vector<AdaptiveResult> &getAdaptiveResults() const { return adaptive_results; }
+    /**
+     * Set the initial population of every run, replacing any previously set
+     * The populations are held once by the ensemble, and shared read-only by all of it's runners.
+     * Each is copied directly to the device at the start of a run, before init functions are executed.
+     * @param populations Map of {agent name, state name} to the agents to initialise that agent state with
+     * @throws exception::InvalidAgent If an agent is not part of the model
+     * @throws exception::InvalidAgentState If a state is not part of it's agent
+     * @throws exception::InvalidArgument If a population is of a different agent type
+     * @note Pass an rvalue to move the populations, rather than copy them
+     */
+    void setInitialPopulation(util::StringPairUnorderedMap<AgentVector> populations);
+    /**
+     * Set the initial population of a single plan, overriding the populations of every run for the agent states it contains
+     * Agent states not contained within the override retain the population of every run (if set)
+     * @param plan_index Index of the plan within the RunPlanVector passed to simulate(), when using adaptive sampling this applies to every replicate of the plan
+     * @param populations Map of {agent name, state name} to the agents to initialise that agent state with
+     * @throws exception::InvalidAgent If an agent is not part of the model
+     * @throws exception::InvalidAgentState If a state is not part of it's agent
+     * @throws exception::InvalidArgument If a population is of a different agent type
+     * @note If plan_index is out of bounds of the RunPlanVector, simulate() will throw exception::OutOfBoundsException
+     */
+    void setInitialPopulation(unsigned int plan_index, util::StringPairUnorderedMap<AgentVector> populations);
+    /**
+     * Load the initial population of every run from an input file, replacing any previously set
+     * The file is loaded once, every agent state of the model is initialised with the agents loaded from the file (which may be empty)
+     * @param input_file Path to a json or xml state file, as accepted by Simulation's input_file
+     * @note Environment properties and config within the file are ignored, environment properties should be set via the RunPlanVector
+     */
+    void loadInitialPopulation(const std::string &input_file);
+    /**
+     * Load the initial population of a single plan from an input file, overriding the populations of every run
+     * @param plan_index Index of the plan within the RunPlanVector passed to simulate()
+     * @param input_file Path to a json or xml state file, as accepted by Simulation's input_file
+     * @see setInitialPopulation(unsigned int, util::StringPairUnorderedMap<AgentVector>)
+     */
+    void loadInitialPopulation(unsigned int plan_index, const std::string &input_file);
+    /**
+     * Remove all initial populations, including those of individual plans
+     */
+    void clearInitialPopulation();
 
  private:
+    /**
+     * Population shared by runners, agent populations are immutable once held
+     */
+    typedef util::StringPairUnorderedMap<std::shared_ptr<const AgentVector>> SharedPopulation;
+    /**
+     * Validates populations against the model, and moves them into a shared population
+     */
+    SharedPopulation sharePopulation(util::StringPairUnorderedMap<AgentVector> &&populations) const;
+    /**
+     * Loads the population of every agent state from an input file
+     */
+    util::StringPairUnorderedMap<AgentVector> readPopulation(const std::string &input_file) const;
+    /**
+     * Builds the initial population of each plan, empty if no initial population has been set
+     * @param plan_index The index of each plan within the RunPlanVector passed to simulate()
+     */
+    std::vector<SharedPopulation> resolvePopulations(const std::vector<unsigned int> &plan_index) const;
     /**
      * Print command line interface help
      */
@@ -118,6 +285,13 @@ class CUDAEnsemble {
      * Parse CLI into config
      */
     int checkArgs(int argc, const char** argv);
+    /**
+     * Executes each plan, storing their logs in run_logs and recording failures in run_failed
+     * @param plans The plans to execute
+     * @param first_log_index The index which the first plan's step log file is numbered with
+     * @param plan_index The index within the RunPlanVector passed to simulate() of each plan, used to select it's initial population
+     */
+    void runPlans(const RunPlanVector &plans, unsigned int first_log_index, const std::vector<unsigned int> &plan_index);
     /**
      * Config options for the ensemble
      */
@@ -134,6 +308,23 @@ class CUDAEnsemble {
      * Logs collected by simulate()
      */
     std::vector<RunLog> run_logs;
+    /**
+     * Whether each of the runs in run_logs failed
+     * This is not std::vector<bool>, as it's elements are written concurrently by the runners
+     */
+    std::vector<unsigned char> run_failed;
+    /**
+     * Outcome of each configuration from the last call to simulate() with adaptive sampling
+     */
+    std::vector<AdaptiveResult> adaptive_results;
+    /**
+     * Initial population of every run
+     */
+    SharedPopulation initial_population;
+    /**
+     * Initial population overrides of individual plans
+     */
+    std::map<unsigned int, SharedPopulation> plan_populations;
     /**
      * Model description hierarchy for the ensemble, a copy of this will be passed to every CUDASimulation
      */
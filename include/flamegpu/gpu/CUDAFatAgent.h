@@ -141,6 +141,11 @@ class CUDAFatAgent {
      * The number of mapped agents currently represented by this CUDAFatAgent
      */
     unsigned int getMappedAgentCount() const;
+    /**
+     * Returns the device memory currently allocated to new agent output buffers and the device copy of the next agent ID, in bytes
+     * New agent buffers are retained for reuse once freed, so these are included whether or not they are in use
+     */
+    size_t getNewBufferDeviceMemoryUsage();
     /**
      * Returns the next free agent id, and increments the ID tracker by the specified count
      * @param count Number that will be added to the return value on next call to this function
@@ -187,6 +187,11 @@ class CUDAFatAgentStateList {
      * Returns the maximum number of agents that can be stored based on the current buffer allocations
      */
     unsigned int getAllocatedSize() const;
+    /**
+     * Returns the device memory currently allocated to the variable buffers (and their swap buffers), in bytes
+     * This includes variables which are not bound to every agent sharing the state list
+     */
+    size_t getDeviceMemoryUsage() const;
     /**
      * Updates the number of alive agents within the list
      * @param newCount New number of alive (and active agents)
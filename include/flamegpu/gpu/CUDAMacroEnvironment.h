@@ -130,6 +130,11 @@ class CUDAMacroEnvironment {
      * @param curve_header The RTC header to act upon
      */
     void unmapRTCVariables(detail::curve::CurveRTCHost& curve_header) const;
+    /**
+     * Returns the device memory currently allocated to macro properties, in bytes
+     * Mapped submodel macro properties are not included, as they are owned by the master model
+     */
+    size_t getDeviceMemoryUsage() const;
 
 #if !defined(SEATBELTS) || SEATBELTS
     /**
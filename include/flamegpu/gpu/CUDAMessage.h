@@ -51,6 +51,14 @@ class CUDAMessage {
      * @return The current number of messages
      */
     unsigned int getMessageCount() const;
+    /**
+     * @return The device memory currently held by the message read and write lists, in bytes
+     */
+    size_t getMessageListDeviceMemoryUsage() const;
+    /**
+     * @return The device memory currently held by the message specialisation (e.g. partition boundary matrix), in bytes
+     */
+    size_t getSpecialisationDeviceMemoryUsage() const;
     /**
      * Manually update the message count
      * @note This should be used cautiously
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_FLAMEGPU_GPU_CUDASCANCOMPACTION_H_
 #define INCLUDE_FLAMEGPU_GPU_CUDASCANCOMPACTION_H_
 
+#include <cstddef>
+
 namespace flamegpu {
 
 // forward declare classes from other modules
@@ -144,6 +146,10 @@ class CUDAScanCompaction {
      * @see getConfig() for the const variant.
      */
     CUDAScanCompactionConfig &Config(const Type& type, const unsigned int& streamId);
+    /**
+     * Returns the device memory currently allocated to scan flag buffers and cub temp storage, across all streams and types, in bytes
+     */
+    size_t getDeviceMemoryUsage() const;
 
  private:
     /**
@@ -77,6 +77,12 @@ class CUDAScatter {
 
  public:
     CUDAScanCompaction &Scan() { return scan; }
+    const CUDAScanCompaction &getScan() const { return scan; }
+    /**
+     * Returns the device memory currently allocated to per stream scatter metadata, in bytes
+     * This does not include the scan compaction buffers, see CUDAScanCompaction::getDeviceMemoryUsage()
+     */
+    size_t getDeviceMemoryUsage() const;
     /**
      * Convenience wrapper for scatter()
      * Scatters agents from SoA to SoA according to d_position flag
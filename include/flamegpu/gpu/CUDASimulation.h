@@ -1,11 +1,15 @@
 #ifndef INCLUDE_FLAMEGPU_GPU_CUDASIMULATION_H_
 #define INCLUDE_FLAMEGPU_GPU_CUDASIMULATION_H_
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <set>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <utility>
 
 #include "flamegpu/exception/FLAMEGPUDeviceException.cuh"
 #include "flamegpu/sim/Simulation.h"
@@ -80,6 +84,86 @@ class CUDASimulation : public Simulation {
          * Defaults to enabled.
          */
         bool inLayerConcurrency = true;
+        /**
+         * Enable / disable validation that agent populations passed to setPopulationData() do not contain agents which share an ID.
+         * Defaults to enabled.
+         * This check may be a significant part of initialisation for very large populations,
+         * so it can be disabled for trusted inputs (e.g. populations exported by a previous run), however collisions will then go undetected.
+         * @see AgentVectorReductions::countIDCollisions() for checking a population on the host
+         */
+        bool validateAgentIDs = true;
+        /**
+         * Enable / disable recording of the wall time of each layer, agent function, agent function condition,
+         * message index build, agent scatter, host function, step/exit function and step log reduction every step.
+         * Defaults to disabled.
+         * Kernels within a layer are timed with events on their own stream, so in-layer concurrency is retained,
+         * however the additional synchronisation of the host timers adds a small overhead to each step.
+         * @see getElapsedTimeStepBreakdowns()
+         */
+        bool timingBreakdown = false;
+        /**
+         * If greater than 0, a warning is output the first time a single host layer function, step function or exit condition
+         * takes longer than this fraction of the duration of the step in which it executed (e.g. 0.5 warns if a host function takes more than half of a step).
+         * Defaults to 0 (disabled).
+         * @see getElapsedTimeHostFunctions()
+         */
+        double slowHostFunctionFraction = 0;
+        /**
+         * Enable / disable skipping the storage of agent variables which are never read or written by the model.
+         * Defaults to disabled.
+         * This is applied lazily, when the simulation is first initialised after it is enabled (e.g. by applyConfig(), simulate() or setPopulationData()),
+         * using the logging configs attached at that time. It cannot be applied after population data has been set or the simulation has been stepped. Agent variables which are not stored cannot be accessed by host functions,
+         * and take their default value when population data is retrieved.
+         * @see VariableUsageAnalysis for the details of which variables are eliminated
+         * @see getEliminatedAgentVariables()
+         */
+        bool eliminateUnusedAgentVariables = false;
+        /**
+         * Enable / disable counter-based random number generation within agent functions.
+         * Defaults to disabled.
+         * When enabled, agent functions generate random numbers with PhiloxRandom, keyed on the random seed, the agent's id,
+         * the step, the agent function and the number of previous calls. No curand state array is allocated, and the random
+         * numbers received by each agent do not depend on the thread executing it (e.g. the composition of the layer or the order of the population).
+         * The random numbers generated by an agent can be reproduced on the host with PhiloxRandom.
+         * The values generated differ from those generated with this disabled.
+         * This setting also applies to submodels, whose random streams additionally depend on the parent's seed and step.
+         */
+        bool counterBasedRandom = false;
+    };
+    /**
+     * Memory held by a single component of the simulation, in bytes
+     * @see getMemoryReport()
+     */
+    struct MemoryUsage {
+        /**
+         * Host memory currently held
+         */
+        size_t host = 0;
+        /**
+         * Device memory currently held
+         */
+        size_t device = 0;
+        /**
+         * Highest sampled value of host
+         */
+        size_t peak_host = 0;
+        /**
+         * Highest sampled value of device
+         */
+        size_t peak_device = 0;
+    };
+    /**
+     * Host to device copies of environment properties performed within a step
+     */
+    struct EnvironmentUploads {
+        /**
+         * Bytes copied
+         */
+        uint64_t bytes = 0;
+        /**
+         * Number of copies
+         */
+        uint64_t uploads = 0;
     };
     /**
      * Initialise cuda runner
@@ -254,12 +338,75 @@ class CUDASimulation : public Simulation {
      * @return elapsed time of required step in seconds
      */
     double getElapsedTimeStep(unsigned int step) const;
+    /**
+     * Get the breakdown of the duration of each step() since the last call to `reset`
+     * Each map is keyed by a label for the timed component, e.g. "layer 0", "layer 0: condition agent::func", "layer 0: agent::func",
+     * "layer 0: buildIndex message", "layer 0: scatter agent::func", "layer 0: host function 0", "step functions", "exit conditions" and "log reduction".
+     * @return vector of per step breakdowns, in seconds
+     * @note This is only recorded if CUDASimulation::Config::timingBreakdown is enabled, otherwise the vector will be empty
+     */
+    std::vector<std::map<std::string, double>> getElapsedTimeStepBreakdowns() const;
+    /**
+     * Get the breakdown of the duration of an individual step in seconds.
+     * @param step Index of step, must be less than the number of steps executed with CUDASimulation::Config::timingBreakdown enabled.
+     * @return breakdown of the elapsed time of the required step in seconds
+     * @see getElapsedTimeStepBreakdowns()
+     */
+    std::map<std::string, double> getElapsedTimeStepBreakdown(unsigned int step) const;
+    /**
+     * Get the cumulative duration of each host function since the last call to `reset`, including init and exit functions
+     * Each map is keyed by the kind of host function and it's name, "init function <name>", "step function <name>", "exit function <name>",
+     * "exit condition <name>" and "layer <index>: host function <name>".
+     * Functions defined with the FLAMEGPU_HOST_FUNCTION (and derived) macros are named by the macro, and Python callbacks by their class.
+     * Otherwise the name is the function's index within the model's (or layer's) list of host functions, with callbacks following regular functions.
+     * @return map of host function label to elapsed time in seconds
+     */
+    std::map<std::string, double> getElapsedTimeHostFunctions() const;
+    /**
+     * Get the duration of each host layer function, step function and exit condition, within each step() since the last call to `reset`
+     * @return vector of per step maps of host function label to elapsed time in seconds
+     * @see getElapsedTimeHostFunctions() for the format of labels
+     * @note This is only recorded if SimulationConfig().timing is enabled or CUDASimulation::Config::slowHostFunctionFraction is greater than 0, otherwise the vector will be empty
+     */
+    std::vector<std::map<std::string, double>> getElapsedTimeHostFunctionSteps() const;
+    /**
+     * Get the host to device copies of environment properties performed within each step() since the last call to `reset`
+     * Only the modified ranges of the environment are copied, so this is proportional to the properties updated by host functions
+     * Copies performed by submodels are included in the step of the parent model during which the submodel executed
+     * @return vector of per step copies
+     */
+    std::vector<EnvironmentUploads> getEnvironmentUploadSteps() const;
+    /**
+     * Get the host and device memory currently held by the simulation, broken down by component
+     * Components are keyed "agent <agent> state <state>", "agent <agent> new buffers", "message <message>", "message <message> index",
+     * "random", "scan compaction", "scatter", "macro environment", "environment", "host api", "host agent creation" and "device exceptions",
+     * components of submodels are prefixed "submodel <submodel>: ", and "total" sums all components.
+     * Agent state lists are reported once, including any variables which are only bound to mapped submodel agents.
+     *
+     * Peaks are sampled at the end of each step() and by each call to this method, as the library's buffers only grow
+     * (with the exception of RandomManager, if it's shrink modifier has been changed) this captures the peak of each component.
+     * The "total" peak is the highest sampled total, so this can be used to decide how many runs of a model fit on a device concurrently
+     * (CUDAEnsemble::EnsembleConfig::concurrent_runs), allowing additionally for the CUDA context and any RTC kernels.
+     * @return Map of component name to memory usage
+     * @note Only memory allocated by FLAMEGPU is included, user allocations within host functions and the CUDA context itself are not.
+     */
+    std::map<std::string, MemoryUsage> getMemoryReport();
+    /**
+     * Returns the agent variables which are not stored, as CUDAConfig().eliminateUnusedAgentVariables was enabled
+     * @return Map of agent name to the names of it's eliminated variables, agents without eliminated variables are omitted
+     */
+    const std::map<std::string, std::set<std::string>> &getEliminatedAgentVariables() const;
 
     /**
      * Returns the unique instance id of this CUDASimulation instance
      * @note This value is used internally for environment property storage
      */
     using Simulation::getInstanceID;
+    /**
+     * Returns the model to a clean state
+     * @see Simulation::reset()
+     */
+    using Simulation::reset;
 
  protected:
     /**
@@ -268,6 +415,7 @@ class CUDASimulation : public Simulation {
      * Also calls resetStepCounter();
      * @param submodelReset This should only be set to true when called automatically when a submodel reaches it's exit condition during execution. This performs a subset of the regular reset procedure.
      * @note If triggered on a submodel, agent states and environment properties mapped to a parent agent, and random generation are not affected.
+     * @note If triggered on a persistent submodel, only the step counter, message lists and timing data are reset.
      * @note If random was manually seeded, it will return to it's original state. If random was seeded from time, it will return to a new random state.
      */
     void reset(bool submodelReset) override;
@@ -295,11 +443,24 @@ class CUDASimulation : public Simulation {
     void resetDerivedConfig() override;
 
  private:
+    /**
+     * Replaces internal population data for the specified agent, reading directly from a population which may be shared
+     * This is used by SimRunner, so that the initial population of an ensemble is not copied for each run
+     * @param population The agent type and data to replace agents with
+     * @param state_name The agent state to add the agents to
+     * @throw exception::InvalidCudaAgent If the agent type is not recognised
+     */
+    void setPopulationData(const AgentVector& population, const std::string &state_name);
     /**
      * Reinitalises random generation for this model and all submodels
      * @param seed New random seed (this updates stored seed in config)
      */
     void reseed(const uint64_t &seed);
+    /**
+     * Returns the seed used to key PhiloxRandom when CUDAConfig().counterBasedRandom is enabled
+     * Submodels restart their step counter each time they are run, so their seed is mixed with the parent's seed and step
+     */
+    uint64_t philoxSeed() const;
     /**
      * Number of times step() has been called since sim was last reset/init
      */
@@ -325,6 +486,67 @@ class CUDASimulation : public Simulation {
      * Vector of per step timing information in seconds
      */
     std::vector<double> elapsedSecondsPerStep;
+    /**
+     * Vector of per step timing breakdowns in seconds, only populated if CUDASimulation::Config::timingBreakdown is enabled
+     */
+    std::vector<std::map<std::string, double>> elapsedSecondsPerStepBreakdown;
+    /**
+     * Adds the duration to the named component of the current step's timing breakdown
+     * @param label Name of the timed component
+     * @param seconds Duration in seconds
+     */
+    void recordTimingBreakdown(const std::string &label, double seconds);
+    /**
+     * Cumulative duration of each host function in seconds
+     * @see getElapsedTimeHostFunctions()
+     */
+    std::map<std::string, double> elapsedSecondsHostFunctions;
+    /**
+     * Vector of per step host function durations in seconds
+     * @see getElapsedTimeHostFunctionSteps()
+     */
+    std::vector<std::map<std::string, double>> elapsedSecondsPerStepHostFunctions;
+    /**
+     * Labels of host functions which have already been reported as slow, so that each is only reported once
+     * @see CUDASimulation::Config::slowHostFunctionFraction
+     */
+    std::set<std::string> slowHostFunctions;
+    /**
+     * Vector of per step environment property copies
+     */
+    std::vector<EnvironmentUploads> environmentUploadsPerStep;
+    /**
+     * Returns the total host to device copies of environment properties performed by this instance and it's submodels
+     */
+    EnvironmentUploads getEnvironmentUploadTotals() const;
+    /**
+     * Adds the duration to the named host function's cumulative time, and to the current step's host function times
+     * @param label Label of the host function, as returned by getElapsedTimeHostFunctions()
+     * @param seconds Duration in seconds
+     * @param inStep Whether the host function was executed as part of the current step
+     */
+    void recordHostFunctionTime(const std::string &label, double seconds, bool inStep);
+    /**
+     * Outputs a warning for each host function which exceeded CUDASimulation::Config::slowHostFunctionFraction of the step's duration
+     * @param stepSeconds Duration of the current step in seconds
+     */
+    void checkSlowHostFunctions(double stepSeconds);
+    /**
+     * Memory usage of each component as of the most recent sample, including peaks
+     * @see getMemoryReport()
+     */
+    std::map<std::string, MemoryUsage> memoryUsage;
+    /**
+     * Adds the memory currently held by each component of this simulation and it's submodels to report
+     * @param prefix Prepended to the name of each component
+     * @param report The report to add to, peaks are not updated
+     * @param counted Fat agent state lists and fat agents which have already been reported, as these may be shared by submodels
+     */
+    void buildMemoryReport(const std::string &prefix, std::map<std::string, MemoryUsage> &report, std::set<const void*> &counted);
+    /**
+     * Updates memoryUsage with the memory currently held by each component, and updates peaks
+     */
+    void sampleMemoryUsage();
     /**
      * Update the step counter for host and device.
      */
@@ -392,10 +614,23 @@ class CUDASimulation : public Simulation {
     cudaStream_t getStream(const unsigned int n);
 
     /**
-     * Destroy all streams
+     * Destroy all streams, and the timing events which accompany them
      */
     void destroyStreams();
 
+    /**
+     * Pairs of events used to time the kernel launched by each stream index within a layer, when the timing breakdown is enabled
+     * These are created on first use and reused, rather than created per launch
+     */
+    std::vector<std::pair<cudaEvent_t, cudaEvent_t>> timingEvents;
+
+    /**
+     * Get the pair of timing events for the specified stream index, creating them if required
+     * @param n The stream index of the timed launch
+     * @return The start and stop event
+     */
+    const std::pair<cudaEvent_t, cudaEvent_t> &getTimingEvents(const unsigned int n);
+
     /**
      * Synchronize all streams for this simulation.
      * To be used in place of device syncs, to reduce blocking in an ensemble.
@@ -484,9 +719,18 @@ class CUDASimulation : public Simulation {
      * @note called at the end of step() and after all init/hostLayer functions and exit conditions have finished
      */
     void processHostAgentCreation(const unsigned int &streamId);
+    /**
+     * Executes a group of independent host functions concurrently
+     * Each function is executed with a separate HostAPI (and therefore stream and scratch memory), on a pool of host threads which includes the calling thread
+     * Any exception thrown by a host function is rethrown once all of the functions have returned
+     * @param fns The host functions to execute
+     * @return The time taken by each host function in seconds
+     * @note Host agent creation must still be processed by the caller
+     */
+    std::vector<double> runConcurrentHostFunctions(const std::vector<std::function<void(HostAPI*)>> &fns);
 
  public:
-    typedef std::vector<NewAgentStorage> AgentDataBuffer;
+    typedef NewAgentArena AgentDataBuffer;
     typedef std::unordered_map<std::string, AgentDataBuffer> AgentDataBufferStateMap;
     typedef std::unordered_map<std::string, VarOffsetStruct> AgentOffsetMap;
     typedef std::unordered_map<std::string, AgentDataBufferStateMap> AgentDataMap;
@@ -507,6 +751,34 @@ class CUDASimulation : public Simulation {
      * Storage used by host agent creation before copying data to device at end of each step()
      */
     AgentDataMap agentData;
+    /**
+     * HostAPI used by a concurrently executing host function, in addition to host_api
+     */
+    struct ConcurrentHostAPI {
+        /**
+         * Storage used by host agent creation, this is processed alongside agentData
+         */
+        AgentDataMap agentData;
+        std::unique_ptr<HostAPI> api;
+    };
+    /**
+     * HostAPIs used by runConcurrentHostFunctions(), these persist so that their scratch memory can be reused
+     * The HostAPI at index i uses stream index i + 1
+     */
+    std::vector<std::unique_ptr<ConcurrentHostAPI>> concurrent_host_apis;
+    /**
+     * Returns empty host agent creation storage, for each agent state
+     */
+    AgentDataMap createAgentDataMap() const;
+    /**
+     * Device staging buffer used by processHostAgentCreation()
+     * This persists between steps, and only grows when a larger batch of host agents is created
+     */
+    char *d_host_agent_creation_buffer = nullptr;
+    /**
+     * Length of d_host_agent_creation_buffer in bytes
+     */
+    size_t d_host_agent_creation_buffer_len = 0;
     void initOffsetsAndMap();
 #ifdef VISUALISATION
     /**
@@ -532,17 +804,37 @@ class CUDASimulation : public Simulation {
      */
     static std::shared_timed_mutex active_device_maps_mutex;
     /**
-     * Returns false if any agent functions or agent function conditions are not RTC
-     * Used by constructor to set isPureRTC constant value
-     * @param _model The agent model hierarchy to check
+     * Rebuilds the CUDAAgent of each agent which has variables which can be eliminated, without those variables
+     * Called once by initialiseSingletons() if CUDAConfig().eliminateUnusedAgentVariables is enabled
+     * @throws exception::InvalidOperation If population data has already been set, or the simulation has already been stepped
      */
-    static bool detectPureRTC(const std::shared_ptr<const ModelData>& _model);
-
- protected:
+    void eliminateAgentVariables();
+    /**
+     * Throws if the logging config logs an eliminated agent variable
+     * @param logConfig The logging config to validate
+     * @param caller Name of the calling method, for the exception message
+     * @throws exception::InvalidArgument If an eliminated agent variable is logged
+     */
+    void validateLoggedVariables(const LoggingConfig &logConfig, const char *caller) const;
+    /**
+     * Copy of the model without eliminated agent variables, this owns the descriptions of CUDAAgents which have eliminated variables
+     * Nullptr if no variables have been eliminated
+     */
+    std::shared_ptr<const ModelData> storage_model;
+    /**
+     * Agent variables which are not stored
+     * @see getEliminatedAgentVariables()
+     */
+    std::map<std::string, std::set<std::string>> eliminatedAgentVariables;
+    /**
+     * True once eliminateAgentVariables() has been called
+     */
+    bool agentVariablesEliminated = false;
     /**
-     * If true, the model is pureRTC, and hence does not use non-RTC curve
+     * True once a persistent submodel has initialised it's unmapped state, cleared by a full reset
+     * @see SubModelDescription::setPersistent()
      */
-    const bool isPureRTC;
+    bool persistentSubmodelInitialised = false;
 
  public:
     /**
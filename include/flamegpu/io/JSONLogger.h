@@ -69,6 +69,15 @@ class JSONLogger : public Logger{
      */
     template<typename T>
     void logSteps(T &writer, const RunLog &log) const;
+    /**
+     * Writes out per step timing breakdowns as a JSON array via the provided writer
+     * @param writer Rapidjson writer instance
+     * @param log RunLog containing the step timing breakdowns to be written
+     * @tparam T Instance of rapidjson::Writer or subclass (e.g. rapidjson::PrettyWriter)
+     * @note Templated as can't forward declare rapidjson::Writer<rapidjson::StringBuffer>
+     */
+    template<typename T>
+    void logStepTiming(T &writer, const RunLog &log) const;
     /**
      * Writes out an exit log as a JSON object via the provided writer
      * @param writer Rapidjson writer instance
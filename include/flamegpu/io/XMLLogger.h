@@ -63,6 +63,14 @@ class XMLLogger : public Logger{
      * @return The created XMLNode, the calling method will then add it to the main XML hierarchy
      */
     tinyxml2::XMLNode *logSteps(tinyxml2::XMLDocument &doc, const RunLog &log) const;
+    /**
+     * Writes out per step timing breakdowns to the provided node
+     * Each timed component is written as an element, with the label as an attribute, as labels are not valid element names
+     * @param doc tinyxml2 document used for allocating the new element
+     * @param log RunLog containing the step timing breakdowns to be written
+     * @return The created XMLNode, the calling method will then add it to the main XML hierarchy
+     */
+    tinyxml2::XMLNode *logStepTiming(tinyxml2::XMLDocument &doc, const RunLog &log) const;
     /**
      * Writes out an exit log as a JSON object to the provided node
      * @param doc tinyxml2 document used for allocating the new element
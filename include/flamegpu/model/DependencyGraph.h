@@ -2,6 +2,7 @@
 #define INCLUDE_FLAMEGPU_MODEL_DEPENDENCYGRAPH_H_
 
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,11 @@ namespace flamegpu {
  */
 
 class DependencyGraph {
+    /**
+     * Requires access to agentFunctionsConflict()
+     */
+    friend std::vector<LayerMerge> ModelDescription::compactLayers();
+
  public:
     /**
      * Constructors
@@ -50,11 +56,31 @@ class DependencyGraph {
      */
     bool validateDependencyGraph();
     /**
-     * Generates optimal layers based on the dependencies specified and adds them to the model
+     * Generates layers based on the dependencies specified and adds them to the model
+     *
+     * Nodes are list scheduled by their critical path (the total cost of the most expensive chain of dependents, including the node itself),
+     * each layer is filled with the most critical ready nodes which can legally execute concurrently.
+     * A ready node which is more expensive than the rest of the layer is deferred to a later layer, if it has enough slack that doing so
+     * will not extend the critical path, this balances the work within each layer.
+     * Concurrent host functions (see HostFunctionDescription::setConcurrent()) which are ready together share a layer.
      * @param model The model the layers should be added to
      * @throws exception::InvalidDependencyGraph if the model already has layers attached
+     * @see setNodeCost()
      */
     void generateLayers(ModelDescription& model);
+    /**
+     * Sets the estimated cost of a node (e.g. it's mean execution time from profiling), used by generateLayers()
+     * Nodes without a cost set have a cost of 1.0
+     * @param node The agent function, host function or submodel
+     * @param cost The estimated cost, in any consistent unit
+     * @throws exception::InvalidArgument If cost is negative or not finite
+     */
+    void setNodeCost(const DependencyNode& node, double cost);
+    /**
+     * Returns the estimated cost of a node, as used by generateLayers()
+     * @param node The agent function, host function or submodel
+     */
+    double getNodeCost(const DependencyNode& node) const;
     /**
      * Generates a .gv file containing the DOT representation of the dependencies specified
      * @param outputFileName The name of the output file
@@ -89,6 +115,11 @@ class DependencyGraph {
      * Issues a warning if the graph is missing agent functions which are present in the model this dependency graph is attached to
      */
     void checkForUnattachedFunctions();
+    /**
+     * Returns true if the two agent functions cannot be placed in the same layer
+     * These are the same rules enforced by LayerDescription::addAgentFunction()
+     */
+    static bool agentFunctionsConflict(const AgentFunctionData& a, const AgentFunctionData& b);
     /**
      * Returns the name of a given DependencyNode
      * @param node The node to get the name of
@@ -99,6 +130,10 @@ class DependencyGraph {
      * Structured representation of the layers added to the model
      */
     std::vector<std::vector<std::string>> constructedLayers;
+    /**
+     * Estimated costs of nodes, used to schedule layers
+     */
+    std::map<const DependencyNode*, double> nodeCosts;
     /**
      * Root of the model hierarchy, used for validating agent functions belong to correct model when added
      */
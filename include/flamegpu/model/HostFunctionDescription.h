@@ -67,11 +67,25 @@ class HostFunctionDescription : public DependencyNode {
      * @return The name of the host function
      */
     std::string getName();
+    /**
+     * Declares whether the host function is independent of other concurrent host functions
+     * When layers are generated, concurrent host functions which are ready at the same time are placed in the same layer,
+     * so that they are executed concurrently
+     * @param concurrent True if the host function may be executed concurrently with other concurrent host functions
+     * @note Host functions defined via the Python API cannot be executed concurrently
+     * @see LayerDescription::addConcurrentHostFunction()
+     */
+    void setConcurrent(bool concurrent);
+    /**
+     * @return True if the host function may be executed concurrently with other concurrent host functions
+     */
+    bool isConcurrent() const;
 
  private:
     FLAMEGPU_HOST_FUNCTION_POINTER function;
     HostFunctionCallback* callbackObject;
     std::string name;
+    bool concurrent;
 };
 
 }  // namespace flamegpu
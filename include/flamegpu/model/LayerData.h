@@ -39,6 +39,11 @@ struct LayerData {
      * set<HostFunctionCallback*>
      */
     std::set<HostFunctionCallback*> host_functions_callbacks;
+    /**
+     * True if the layer's host functions were added via LayerDescription::addConcurrentHostFunction()
+     * (If true, the layer may hold multiple host functions, which are executed concurrently)
+     */
+    bool concurrent_host_functions = false;
     /**
      * SubModel
      * (If present, layer can hold no host_functions or agent_functions)
@@ -118,6 +118,16 @@ class LayerDescription {
      * @note There is no guarantee on the order in which multiple host functions in the same layer will be executed
      */
     void addHostFunction(FLAMEGPU_HOST_FUNCTION_POINTER func_p);
+    /**
+     * Adds a host function to this layer, which is independent of the other concurrent host functions within the layer
+     * Unlike addHostFunction(), a layer may contain multiple concurrent host functions, which are executed concurrently,
+     * each on a separate host thread with their own HostAPI (and therefore CUDA stream)
+     * @param func_p Function pointer to the host function declared using FLAMEGPU_HOST_FUNCTION notation
+     * @throw exception::InvalidHostFunc If the function has already been added to the layer
+     * @throw exception::InvalidLayerMember If the layer already contains a SubModel, agent functions or a host function added via addHostFunction()
+     * @see ModelDescription::addConcurrentStepFunction() for the requirements of independent functions
+     */
+    void addConcurrentHostFunction(FLAMEGPU_HOST_FUNCTION_POINTER func_p);
     /**
      * Adds a submodel to a layer
      * If layer contains a submodel, it may contain nothing else
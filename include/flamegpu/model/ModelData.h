@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <set>
 #include <typeindex>
 #include <vector>
 #include <string>
@@ -127,6 +128,12 @@ struct ModelData : std::enable_shared_from_this<ModelData>{
      */
     ExitConditionVector exitConditions;
     HostFunctionConditionCallbackVector exitConditionCallbacks;
+    /**
+     * Step functions and exit conditions (within stepFunctions and exitConditions) which were declared independent
+     * Consecutive concurrent functions may be executed concurrently
+     */
+    std::set<FLAMEGPU_STEP_FUNCTION_POINTER> concurrentStepFunctions;
+    std::set<FLAMEGPU_EXIT_CONDITION_POINTER> concurrentExitConditions;
     /**
      * Holds all of the model's environment property definitions
      */
@@ -5,6 +5,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 
 #include "flamegpu/gpu/CUDAEnsemble.h"
@@ -19,6 +20,25 @@ class LayerDescription;
 class SubModelDescription;
 struct ModelData;
 
+/**
+ * Details of a single merge performed by ModelDescription::compactLayers()
+ */
+struct LayerMerge {
+    /**
+     * Index of the first layer which was merged, prior to compaction
+     * The merged layer takes this layer's place (and name)
+     */
+    ModelData::size_type first_layer;
+    /**
+     * Index of the last layer which was merged, prior to compaction
+     */
+    ModelData::size_type last_layer;
+    /**
+     * Names of the agent functions within the merged layer, in their original layer order
+     */
+    std::vector<std::string> agent_functions;
+};
+
 /**
  * This class represents the hierarchy of components for a FLAMEGPU model
  * This is the initial class that should be created by a modeller
@@ -33,6 +53,7 @@ class ModelDescription {
     friend class RunPlanVector;
     friend class RunPlan;
     friend class LoggingConfig;
+    friend class VariableUsageAnalysis;
  public:
     /**
      * Constructor
@@ -190,6 +211,16 @@ class ModelDescription {
      * @note Step functions are executed in the order they were added to the model
      */
     void addStepFunction(FLAMEGPU_STEP_FUNCTION_POINTER func_p);
+    /**
+     * Adds a step function to the simulation, which is independent of the other concurrent step functions
+     * Consecutively added concurrent step functions are executed concurrently, each on a separate host thread with their own HostAPI (and therefore CUDA stream)
+     * @param func_p Pointer to the desired step function
+     * @throws exception::InvalidHostFunc If the step function has already been added to this model description
+     * @note Independent functions must not access (or birth) the same agents, nor access the same environment macro properties, nor rely on the sequence of HostAPI::random
+     * @note Environment properties may be accessed, as the environment is thread-safe
+     * @see addStepFunction()
+     */
+    void addConcurrentStepFunction(FLAMEGPU_STEP_FUNCTION_POINTER func_p);
     /**
      * Adds an exit function to the simulation
      * Exit functions execute once after all simulation steps have completed or an exit conditions has returned EXIT
@@ -238,6 +269,16 @@ class ModelDescription {
      * @note Exit conditions are executed in the order they were added to the model
      */
     void addExitCondition(FLAMEGPU_EXIT_CONDITION_POINTER func_p);
+    /**
+     * Adds an exit condition function to the simulation, which is independent of the other concurrent exit conditions
+     * Consecutively added concurrent exit conditions are executed concurrently, each on a separate host thread with their own HostAPI (and therefore CUDA stream)
+     * All members of a group of concurrent exit conditions are executed, the simulation exits early if any return EXIT
+     * @param func_p Pointer to the desired exit condition function
+     * @throws exception::InvalidHostFunc If the exit condition has already been added to this model description
+     * @see addExitCondition()
+     * @see addConcurrentStepFunction() for the requirements of independent functions
+     */
+    void addConcurrentExitCondition(FLAMEGPU_EXIT_CONDITION_POINTER func_p);
 #ifdef SWIG
     /**
      * Adds an exit condition callback to the simulation
@@ -264,6 +305,18 @@ class ModelDescription {
      * Generates layers from the dependency graph
      */
     void generateLayers();
+    /**
+     * Merges runs of adjacent layers which can execute concurrently without changing the model's behaviour
+     * This reduces the number of synchronisations between layers, for models which define one agent function per layer
+     *
+     * Layers are merged when all of their agent functions could legally share a layer, and no agent function reads state written by a function it is merged with:
+     * they must not share agent states, birth agents into another's input state, or output a message list another inputs or outputs.
+     * Layers containing host functions or submodels are never merged, as they can read and write anything.
+     * If the model has environment macro properties, no layers are merged, as the macro properties accessed by an agent function can't be determined.
+     * @return Details of each merge performed, empty if no layers could be merged
+     * @note LayerDescription references to the layers which were merged into an earlier layer are invalidated
+     */
+    std::vector<LayerMerge> compactLayers();
     /**
      * Returns an immutable reference to the specified agent, which can be used to view the agent's configuration
      * @param agent_name Name which can be used to the refer to the desired agent within the model description hierarchy
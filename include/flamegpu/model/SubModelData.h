@@ -54,6 +54,11 @@ struct SubModelData : std::enable_shared_from_this<SubModelData> {
      * 0 is unlimited, but requires the submodel to have an exit condition
      */
     unsigned int max_steps;
+    /**
+     * If true, unmapped agents, agent states and variables, and unmapped environment properties are retained between executions of the submodel
+     * @see SubModelDescription::setPersistent()
+     */
+    bool persistent;
     /**
      * Name assigned to the submodel at creation
      */
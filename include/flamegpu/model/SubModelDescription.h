@@ -103,6 +103,21 @@ class SubModelDescription : public DependencyNode {
      * 0 is unlimited, however requires the model to have an exit condition
      */
     unsigned int getMaxSteps() const;
+    /**
+     * Set whether the submodel's unmapped state persists between executions of the submodel
+     * By default, each execution of the submodel begins by removing agents from unmapped agents and agent states,
+     * resetting unmapped agent variables of mapped agents and unmapped environment properties to their default values, and executing the submodel's init functions.
+     * If enabled, these are only performed before the first execution (and after the parent model is reset), thereafter the unmapped state
+     * remains resident on the device between executions. Agents created by the parent model still receive default values for unmapped agent variables.
+     * Each execution still resets the submodel's step counter and clears it's message lists, and exit functions are executed at the end of every execution.
+     * @param persistent True if the submodel's unmapped state should persist between executions
+     */
+    void setPersistent(bool persistent);
+    /**
+     * Return whether the submodel's unmapped state persists between executions, defaults to false
+     * @see setPersistent()
+     */
+    bool getPersistent() const;
     const std::string getName();
 
  private:
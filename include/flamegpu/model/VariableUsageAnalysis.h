@@ -0,0 +1,133 @@
+#ifndef INCLUDE_FLAMEGPU_MODEL_VARIABLEUSAGEANALYSIS_H_
+#define INCLUDE_FLAMEGPU_MODEL_VARIABLEUSAGEANALYSIS_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace flamegpu {
+
+struct ModelData;
+class ModelDescription;
+class LoggingConfig;
+
+/**
+ * Identifies agent variables which are never read or written by a model, so that their storage can be skipped
+ *
+ * A variable is considered used if it's name appears as a string literal within the source of an RTC agent function or
+ * function condition of the agent (or of a function which outputs the agent), or if it is logged by an attached LoggingConfig.
+ * Internal variables (those beginning with '_') are always used.
+ *
+ * The source of compiled (non-RTC) agent functions and conditions is not available, so agents with a compiled function (or which
+ * are output by one) are not eligible for elimination. Similarly, agents mapped to a submodel are not eligible, as their storage is
+ * shared with the submodel.
+ * Host functions are not analysed either, as they may access any agent variable by name, instead a warning is reported. It is the
+ * user's responsibility to ensure that host functions do not access eliminated variables.
+ * @see CUDASimulation::Config::eliminateUnusedAgentVariables
+ */
+class VariableUsageAnalysis {
+ public:
+    /**
+     * Usage of an individual agent's variables
+     */
+    struct AgentUsage {
+        /**
+         * Variables which are read or written by the model
+         */
+        std::set<std::string> used;
+        /**
+         * Variables which are never read or written by the analysed components of the model
+         */
+        std::set<std::string> unused;
+        /**
+         * Whether the unused variables can be safely eliminated, this is false if the analysis of the agent is unsound
+         */
+        bool eliminable = true;
+        /**
+         * Reasons that the agent is not eligible for elimination, empty if eliminable
+         */
+        std::vector<std::string> reasons;
+    };
+    /**
+     * Analyses the provided model
+     * @param model The model to analyse
+     */
+    explicit VariableUsageAnalysis(const ModelDescription &model);
+    /**
+     * Analyses the provided model
+     * @param model The model to analyse
+     */
+    explicit VariableUsageAnalysis(const ModelData &model);
+    /**
+     * Marks the agent variables logged by the provided config as used
+     * @param config The logging config, this must have been created from the analysed model
+     * @throws exception::InvalidArgument If the logging config was created for a different model
+     */
+    void addLoggingConfig(const LoggingConfig &config);
+    /**
+     * Returns the usage of each agent's variables, keyed by agent name
+     */
+    const std::map<std::string, AgentUsage> &getAgentUsage() const { return agents; }
+    /**
+     * Returns the usage of the named agent's variables
+     * @param agent_name Name of the agent
+     * @throws exception::InvalidAgentName If the model does not contain an agent with the provided name
+     */
+    const AgentUsage &getAgentUsage(const std::string &agent_name) const;
+    /**
+     * Returns the variables of the named agent which can be eliminated
+     * This is empty if the agent is not eligible for elimination
+     * @param agent_name Name of the agent
+     * @throws exception::InvalidAgentName If the model does not contain an agent with the provided name
+     */
+    std::set<std::string> getEliminableVariables(const std::string &agent_name) const;
+    /**
+     * Returns warnings about components of the model which were not analysed, which do not prevent elimination (e.g. host functions)
+     */
+    const std::vector<std::string> &getWarnings() const { return warnings; }
+    /**
+     * Returns a human readable report of the analysis
+     */
+    std::string getReport() const;
+    /**
+     * Returns the set of string literals within a block of C++ source, comments are skipped and adjacent literals are concatenated
+     * @param source The source to scan
+     */
+    static std::set<std::string> extractStringLiterals(const std::string &source);
+
+ private:
+    /**
+     * Performs the analysis of the model's agent functions, submodels and host functions
+     */
+    void analyse();
+    /**
+     * Moves variables from AgentUsage::unused to AgentUsage::used
+     * @param usage The agent to update
+     * @param names Names which may correspond to the agent's variables
+     */
+    static void markUsed(AgentUsage &usage, const std::set<std::string> &names);
+    /**
+     * Marks the agent as not eligible for elimination
+     * @param usage The agent to update
+     * @param reason The reason
+     */
+    static void markUneliminable(AgentUsage &usage, const std::string &reason);
+    /**
+     * The analysed model
+     */
+    std::shared_ptr<const ModelData> model;
+    /**
+     * Usage of each agent's variables, keyed by agent name
+     */
+    std::map<std::string, AgentUsage> agents;
+    /**
+     * Warnings about components which were not analysed
+     */
+    std::vector<std::string> warnings;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_MODEL_VARIABLEUSAGEANALYSIS_H_
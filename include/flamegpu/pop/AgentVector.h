@@ -223,9 +223,46 @@ class AgentVector {
      */
     AgentVector& operator=(AgentVector &&other) noexcept;
     /**
-     * Default destructor, all memory should be automatically managed.
+     * Destructor, all memory should be automatically managed.
+     * If the vector is mapped, the manifest is updated so the population can be reopened with openMapped()
      */
-    virtual ~AgentVector() = default;
+    virtual ~AgentVector();
+    /**
+     * Constructs a container whose variable buffers are memory-mapped files, rather than host memory
+     * This allows populations larger than host memory to be built, as the OS pages data in and out as it is accessed.
+     *
+     * Each variable is stored in it's own file '<directory>/<variable name>.bin', alongside a manifest describing the population.
+     * Existing files within the directory are overwritten.
+     * Copies of a mapped vector are held in host memory; moving a mapped vector retains the mapping.
+     * @param agent_desc Agent description specifying the agent variables to be represented
+     * @param directory Directory to store the backing files, it will be created if it does not exist
+     * @param count The size of the container
+     * @throws exception::InvalidFilePath If the directory or backing files cannot be created
+     * @see openMapped()
+     * @see syncMapped()
+     */
+    static AgentVector createMapped(const AgentDescription &agent_desc, const std::string &directory, size_type count = 0);
+    /**
+     * Reopens a mapped container previously created with createMapped()
+     * The population is not loaded into memory, it is paged in as it is accessed.
+     * @param agent_desc Agent description specifying the agent variables to be represented
+     * @param directory Directory containing the backing files and manifest
+     * @throws exception::InvalidFilePath If the manifest or a backing file cannot be opened
+     * @throws exception::InvalidInputFile If the manifest or backing files do not match agent_desc
+     */
+    static AgentVector openMapped(const AgentDescription &agent_desc, const std::string &directory);
+    /**
+     * Writes all modified data back to the backing files and updates the manifest
+     * This is also performed when the vector is destroyed
+     * @throws exception::InvalidOperation If the vector is not mapped
+     * @throws exception::InvalidFilePath If the manifest cannot be written
+     */
+    void syncMapped();
+    /**
+     * Returns true if the container's variable buffers are memory-mapped files
+     * @see createMapped()
+     */
+    bool isMapped() const { return !mapped_directory.empty(); }
 
     // Element access
     /**
@@ -611,11 +648,25 @@ class AgentVector {
      * @throws exception::OutOfBoundsException when last > _capacity
      */
     void init(size_type first, size_type last);
+    /**
+     * Replaces all variable buffers with files mapped from the specified directory
+     * @param directory Directory containing the variable buffer files
+     * @param open_existing If true existing files are opened, otherwise new (empty) files are created
+     */
+    void createMappedColumns(const std::string &directory, bool open_existing);
+    /**
+     * Returns the path of the manifest file, within the specified mapped directory
+     */
+    static std::string mappedManifestPath(const std::string &directory);
     std::shared_ptr<const AgentData> agent;
     // Mutable, incase size is increased by DeviceAgentVector hidden application of HostAgentBirth
     mutable size_type _size;
     mutable size_type _capacity;
     std::shared_ptr<AgentDataMap> _data;
+    /**
+     * Directory holding the variable buffer files, empty if the vector is held in host memory
+     */
+    std::string mapped_directory;
 };
 
 }  // namespace flamegpu
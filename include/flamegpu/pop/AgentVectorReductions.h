@@ -0,0 +1,474 @@
+#ifndef INCLUDE_FLAMEGPU_POP_AGENTVECTORREDUCTIONS_H_
+#define INCLUDE_FLAMEGPU_POP_AGENTVECTORREDUCTIONS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include "flamegpu/pop/AgentVector.h"
+#include "flamegpu/runtime/ReductionRequest.h"
+
+namespace flamegpu {
+
+/**
+ * Host implementation of the reductions provided by HostAgentAPI, operating over the agents held by an AgentVector
+ *
+ * The template signatures and overflow semantics (the InT/OutT split) match those of HostAgentAPI,
+ * so results can be used to validate device reductions, or to post-process exported populations.
+ * Large populations are split into contiguous chunks which are reduced concurrently by a number of host threads,
+ * the inner loops operate over raw variable buffers so they can be vectorised by the compiler.
+ * @note Floating point reductions may differ in the least significant bits from HostAgentAPI, as the order of operations differs
+ * @note Custom reduction/transform operators (FLAMEGPU_CUSTOM_REDUCTION/FLAMEGPU_CUSTOM_TRANSFORM) must be host callable
+ */
+class AgentVectorReductions {
+ public:
+    /**
+     * Construct a reduction interface for the provided AgentVector
+     * @param _population The agent population to be reduced, this must outlive the AgentVectorReductions instance
+     * @param _threads The maximum number of host threads to use, 0 selects std::thread::hardware_concurrency()
+     */
+    explicit AgentVectorReductions(const AgentVector &_population, unsigned int _threads = 0);
+    /**
+     * Returns the maximum number of host threads used by a reduction
+     */
+    unsigned int getThreadCount() const { return threads; }
+    /**
+     * Host equivalent of HostAgentAPI::sum()
+     * @param variable The agent variable to perform the sum reduction across
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT>
+    InT sum(const std::string &variable) const;
+    /**
+     * Host equivalent of HostAgentAPI::sum()
+     * @param variable The agent variable to perform the sum reduction across
+     * @tparam OutT The template arg, 'OutT' can be used if the sum is expected to exceed the representation of the type being summed
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT, typename OutT>
+    OutT sum(const std::string &variable) const;
+    /**
+     * Host equivalent of HostAgentAPI::min()
+     * @param variable The agent variable to perform the lowerBound reduction across
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     * @note As with cub::DeviceReduce::Min(), std::numeric_limits<InT>::max() is returned for an empty population
+     */
+    template<typename InT>
+    InT min(const std::string &variable) const;
+    /**
+     * Host equivalent of HostAgentAPI::max()
+     * @param variable The agent variable to perform the upperBound reduction across
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     * @note As with cub::DeviceReduce::Max(), std::numeric_limits<InT>::lowest() is returned for an empty population
+     */
+    template<typename InT>
+    InT max(const std::string &variable) const;
+    /**
+     * Host equivalent of HostAgentAPI::count(), counts the number of occurences of the provided value
+     * @param variable The agent variable to perform the count reduction across
+     * @param value The value to count occurences of
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT>
+    unsigned int count(const std::string &variable, const InT &value) const;
+    /**
+     * Host equivalent of HostAgentAPI::histogramEven()
+     * @param variable The agent variable to perform the reduction across
+     * @param histogramBins The number of bins the histogram should have
+     * @param lowerBound The (inclusive) lower sample value boundary of lowest bin
+     * @param upperBound The (exclusive) upper sample value boundary of upper bin
+     * @note 2nd template arg can be used if calculation requires higher bit type to avoid overflow
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT>
+    std::vector<unsigned int> histogramEven(const std::string &variable, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound) const;
+    template<typename InT, typename OutT>
+    std::vector<OutT> histogramEven(const std::string &variable, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound) const;
+    /**
+     * Host equivalent of HostAgentAPI::reduce(), to perform a reduction with a custom operator
+     * @param variable The agent variable to perform the reduction across
+     * @param reductionOperator The custom reduction function
+     * @param init Initial value of the reduction
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT, typename reductionOperatorT>
+    InT reduce(const std::string &variable, reductionOperatorT reductionOperator, const InT &init) const;
+    /**
+     * Host equivalent of HostAgentAPI::transformReduce(), to perform a custom transform on values before performing a custom reduction
+     * @param variable The agent variable to perform the reduction across
+     * @param transformOperator The custom unary transform function
+     * @param reductionOperator The custom binary reduction function
+     * @param init Initial value of the reduction
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT, typename OutT, typename transformOperatorT, typename reductionOperatorT>
+    OutT transformReduce(const std::string &variable, transformOperatorT transformOperator, reductionOperatorT reductionOperator, const OutT &init) const;
+    /**
+     * Host equivalent of HostAgentAPI::multiReduce()
+     * Each unique variable is read once, calculating it's sum, min and max together
+     * @param requests The (variable, operation) pairs to calculate
+     * @return The result of each request, in the same order as requests
+     * @tparam InT The type of the variables as specified in the model description hierarchy
+     * @tparam OutT The type used to accumulate and return results
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     */
+    template<typename InT>
+    std::vector<InT> multiReduce(const std::vector<ReductionRequest> &requests) const;
+    template<typename InT, typename OutT>
+    std::vector<OutT> multiReduce(const std::vector<ReductionRequest> &requests) const;
+    /**
+     * Counts the agents which share their ID with another agent in the population
+     * This is the host equivalent of the check performed by CUDASimulation::setPopulationData(),
+     * so it can be used to validate a population before it is uploaded
+     * IDs are partitioned into shards, each shard is then sorted and checked for adjacent duplicates by a separate thread
+     * @return The number of agents whose ID matches that of another agent, excluding the first agent with each ID
+     * @note Agents with the ID ID_NOT_SET are ignored, as they will be assigned a unique ID when the simulation starts
+     * @see CUDASimulation::Config::validateAgentIDs
+     */
+    unsigned int countIDCollisions() const;
+
+ private:
+    /**
+     * Populations smaller than this (per thread) are not worth splitting across additional threads
+     */
+    static constexpr AgentVector::size_type MIN_ITEMS_PER_THREAD = 1 << 16;
+    /**
+     * Validates the named variable and returns a pointer to it's buffer
+     * @param variable Name of the variable
+     * @param caller Name of the calling method, used in exception messages
+     * @tparam InT The type of the variable as specified in the model description hierarchy
+     */
+    template<typename InT>
+    const InT *getVariableData(const std::string &variable, const char *caller) const;
+    /**
+     * Calculates the histogram bin of a floating point sample within [lowerBound, upperBound)
+     */
+    template<typename InT>
+    static unsigned int histogramBin(const InT &sample, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound, std::true_type) {
+        const InT scale = static_cast<InT>(histogramBins) / (upperBound - lowerBound);
+        return static_cast<unsigned int>((sample - lowerBound) * scale);
+    }
+    /**
+     * Calculates the histogram bin of an integer sample within [lowerBound, upperBound)
+     * A wider type is used, to avoid overflow of (sample - lowerBound) * histogramBins
+     */
+    template<typename InT>
+    static unsigned int histogramBin(const InT &sample, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound, std::false_type) {
+        const uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(sample) - static_cast<int64_t>(lowerBound));
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(upperBound) - static_cast<int64_t>(lowerBound));
+        return static_cast<unsigned int>((offset * histogramBins) / range);
+    }
+    /**
+     * Returns the number of chunks which the population should be split into
+     */
+    unsigned int getChunkCount() const;
+    /**
+     * Executes fn(chunk_index, first, last) for each chunk of the population concurrently
+     * Chunk 0 is executed on the calling thread
+     * @param chunks The number of chunks, as returned by getChunkCount()
+     * @param fn The function to execute
+     */
+    template<typename Fn>
+    void forEachChunk(unsigned int chunks, Fn fn) const;
+    /**
+     * Launches chunks [1, chunks) on worker threads, executes chunk 0 on the calling thread and joins the workers
+     * This is the non-template part of forEachChunk()
+     */
+    void runChunks(unsigned int chunks, const std::function<void(unsigned int, AgentVector::size_type, AgentVector::size_type)> &fn) const;
+    /**
+     * The population being reduced
+     */
+    const AgentVector &population;
+    /**
+     * The maximum number of threads to use
+     */
+    const unsigned int threads;
+};
+
+//
+// Implementation
+//
+
+template<typename InT>
+const InT *AgentVectorReductions::getVariableData(const std::string &variable, const char *caller) const {
+    const VariableMap &vars = population.getVariableMetaData();
+    const auto var = vars.find(variable);
+    if (var == vars.end()) {
+        THROW exception::InvalidAgentVar("Variable '%s' was not found in agent '%s', "
+            "in AgentVectorReductions::%s().",
+            variable.c_str(), population.getAgentName().c_str(), caller);
+    }
+    if (var->second.elements != 1) {
+        THROW exception::UnsupportedVarType("AgentVectorReductions::%s() does not support agent array variables.", caller);
+    }
+    if (std::type_index(typeid(InT)) != var->second.type) {
+        THROW exception::InvalidVarType("Wrong variable type passed to AgentVectorReductions::%s(). "
+            "This call expects '%s', but '%s' was requested.",
+            caller, var->second.type.name(), typeid(InT).name());
+    }
+    return population.data<InT>(variable);
+}
+template<typename Fn>
+void AgentVectorReductions::forEachChunk(const unsigned int chunks, Fn fn) const {
+    if (chunks <= 1) {
+        fn(0u, 0u, population.size());
+        return;
+    }
+    runChunks(chunks, fn);
+}
+template<typename InT>
+InT AgentVectorReductions::sum(const std::string &variable) const {
+    return sum<InT, InT>(variable);
+}
+template<typename InT, typename OutT>
+OutT AgentVectorReductions::sum(const std::string &variable) const {
+    static_assert(sizeof(InT) <= sizeof(OutT), "Template arg OutT should not be of a smaller size than InT");
+    const InT *const data = getVariableData<InT>(variable, "sum");
+    const unsigned int chunks = getChunkCount();
+    std::vector<OutT> partial(chunks, static_cast<OutT>(0));
+    forEachChunk(chunks, [data, &partial](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        // Independent accumulators break the loop carried dependency, permitting vectorisation
+        OutT acc[4] = {0, 0, 0, 0};
+        AgentVector::size_type i = first;
+        for (; i + 4 <= last; i += 4) {
+            acc[0] += static_cast<OutT>(data[i]);
+            acc[1] += static_cast<OutT>(data[i + 1]);
+            acc[2] += static_cast<OutT>(data[i + 2]);
+            acc[3] += static_cast<OutT>(data[i + 3]);
+        }
+        for (; i < last; ++i)
+            acc[0] += static_cast<OutT>(data[i]);
+        partial[c] = static_cast<OutT>((acc[0] + acc[1]) + (acc[2] + acc[3]));
+    });
+    OutT rtn = static_cast<OutT>(0);
+    for (const OutT &p : partial)
+        rtn += p;
+    return rtn;
+}
+template<typename InT>
+InT AgentVectorReductions::min(const std::string &variable) const {
+    const InT *const data = getVariableData<InT>(variable, "min");
+    const unsigned int chunks = getChunkCount();
+    std::vector<InT> partial(chunks, std::numeric_limits<InT>::max());
+    forEachChunk(chunks, [data, &partial](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        InT acc = std::numeric_limits<InT>::max();
+        for (AgentVector::size_type i = first; i < last; ++i)
+            acc = data[i] < acc ? data[i] : acc;
+        partial[c] = acc;
+    });
+    return *std::min_element(partial.begin(), partial.end());
+}
+template<typename InT>
+InT AgentVectorReductions::max(const std::string &variable) const {
+    const InT *const data = getVariableData<InT>(variable, "max");
+    const unsigned int chunks = getChunkCount();
+    std::vector<InT> partial(chunks, std::numeric_limits<InT>::lowest());
+    forEachChunk(chunks, [data, &partial](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        InT acc = std::numeric_limits<InT>::lowest();
+        for (AgentVector::size_type i = first; i < last; ++i)
+            acc = data[i] > acc ? data[i] : acc;
+        partial[c] = acc;
+    });
+    return *std::max_element(partial.begin(), partial.end());
+}
+template<typename InT>
+unsigned int AgentVectorReductions::count(const std::string &variable, const InT &value) const {
+    const InT *const data = getVariableData<InT>(variable, "count");
+    const unsigned int chunks = getChunkCount();
+    std::vector<unsigned int> partial(chunks, 0);
+    forEachChunk(chunks, [data, &partial, value](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        unsigned int acc = 0;
+        for (AgentVector::size_type i = first; i < last; ++i)
+            acc += data[i] == value ? 1 : 0;
+        partial[c] = acc;
+    });
+    unsigned int rtn = 0;
+    for (const unsigned int &p : partial)
+        rtn += p;
+    return rtn;
+}
+template<typename InT>
+std::vector<unsigned int> AgentVectorReductions::histogramEven(const std::string &variable, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound) const {
+    return histogramEven<InT, unsigned int>(variable, histogramBins, lowerBound, upperBound);
+}
+template<typename InT, typename OutT>
+std::vector<OutT> AgentVectorReductions::histogramEven(const std::string &variable, const unsigned int &histogramBins, const InT &lowerBound, const InT &upperBound) const {
+    if (lowerBound >= upperBound) {
+        THROW exception::InvalidArgument("lowerBound (%s) must be lower than < upperBound (%s) in AgentVectorReductions::histogramEven().",
+            std::to_string(lowerBound).c_str(), std::to_string(upperBound).c_str());
+    }
+    const InT *const data = getVariableData<InT>(variable, "histogramEven");
+    const unsigned int chunks = getChunkCount();
+    std::vector<std::vector<OutT>> partial(chunks, std::vector<OutT>(histogramBins, 0));
+    forEachChunk(chunks, [data, &partial, histogramBins, lowerBound, upperBound](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        std::vector<OutT> &bins = partial[c];
+        for (AgentVector::size_type i = first; i < last; ++i) {
+            const InT sample = data[i];
+            // Samples outside of [lowerBound, upperBound) are ignored, as with cub::DeviceHistogram::HistogramEven()
+            if (sample < lowerBound || !(sample < upperBound))
+                continue;
+            const unsigned int bin = histogramBin(sample, histogramBins, lowerBound, upperBound, std::is_floating_point<InT>());
+            // Floating point rounding can place samples just below upperBound into a non-existent bin
+            ++bins[bin < histogramBins ? bin : histogramBins - 1];
+        }
+    });
+    std::vector<OutT> rtn(histogramBins, 0);
+    for (const auto &p : partial) {
+        for (unsigned int b = 0; b < histogramBins; ++b)
+            rtn[b] += p[b];
+    }
+    return rtn;
+}
+template<typename InT, typename reductionOperatorT>
+InT AgentVectorReductions::reduce(const std::string &variable, reductionOperatorT /*reductionOperator*/, const InT &init) const {
+    const InT *const data = getVariableData<InT>(variable, "reduce");
+    const unsigned int chunks = getChunkCount();
+    std::vector<InT> partial(chunks);
+    std::vector<char> partial_set(chunks, 0);
+    forEachChunk(chunks, [data, &partial, &partial_set](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        if (first == last)
+            return;
+        const typename reductionOperatorT::template binary_function<InT> op;
+        InT acc = data[first];
+        for (AgentVector::size_type i = first + 1; i < last; ++i)
+            acc = op(acc, data[i]);
+        partial[c] = acc;
+        partial_set[c] = 1;
+    });
+    // The initial value is applied exactly once, as with cub::DeviceReduce::Reduce()
+    const typename reductionOperatorT::template binary_function<InT> op;
+    InT rtn = init;
+    for (unsigned int c = 0; c < chunks; ++c) {
+        if (partial_set[c])
+            rtn = op(rtn, partial[c]);
+    }
+    return rtn;
+}
+template<typename InT, typename OutT, typename transformOperatorT, typename reductionOperatorT>
+OutT AgentVectorReductions::transformReduce(const std::string &variable, transformOperatorT /*transformOperator*/, reductionOperatorT /*reductionOperator*/, const OutT &init) const {
+    const InT *const data = getVariableData<InT>(variable, "transformReduce");
+    const unsigned int chunks = getChunkCount();
+    std::vector<OutT> partial(chunks);
+    std::vector<char> partial_set(chunks, 0);
+    forEachChunk(chunks, [data, &partial, &partial_set](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        if (first == last)
+            return;
+        const typename transformOperatorT::template unary_function<InT, OutT> t_op;
+        const typename reductionOperatorT::template binary_function<OutT> r_op;
+        OutT acc = t_op(data[first]);
+        for (AgentVector::size_type i = first + 1; i < last; ++i)
+            acc = r_op(acc, t_op(data[i]));
+        partial[c] = acc;
+        partial_set[c] = 1;
+    });
+    // The initial value is applied exactly once, as with thrust::transform_reduce()
+    const typename reductionOperatorT::template binary_function<OutT> r_op;
+    OutT rtn = init;
+    for (unsigned int c = 0; c < chunks; ++c) {
+        if (partial_set[c])
+            rtn = r_op(rtn, partial[c]);
+    }
+    return rtn;
+}
+template<typename InT>
+std::vector<InT> AgentVectorReductions::multiReduce(const std::vector<ReductionRequest> &requests) const {
+    return multiReduce<InT, InT>(requests);
+}
+template<typename InT, typename OutT>
+std::vector<OutT> AgentVectorReductions::multiReduce(const std::vector<ReductionRequest> &requests) const {
+    static_assert(sizeof(InT) <= sizeof(OutT), "Template arg OutT should not be of a smaller size than InT");
+    // Validate requests and build the list of unique variables
+    std::vector<const InT*> variables;
+    std::vector<std::string> variable_names;
+    std::vector<unsigned int> request_variable;
+    request_variable.reserve(requests.size());
+    for (const ReductionRequest &request : requests) {
+        const InT *const data = getVariableData<InT>(request.variable, "multiReduce");
+        if (request.op != ReductionRequest::Sum && request.op != ReductionRequest::Min && request.op != ReductionRequest::Max) {
+            THROW exception::InvalidArgument("Unknown ReductionRequest::Op (%d) passed to AgentVectorReductions::multiReduce().", static_cast<int>(request.op));
+        }
+        const auto it = std::find(variable_names.begin(), variable_names.end(), request.variable);
+        request_variable.push_back(static_cast<unsigned int>(it - variable_names.begin()));
+        if (it == variable_names.end()) {
+            variable_names.push_back(request.variable);
+            variables.push_back(data);
+        }
+    }
+    // partial[c * vars + v] holds the sum/min/max of variable v within chunk c
+    const size_t vars = variables.size();
+    const unsigned int chunks = getChunkCount();
+    std::vector<OutT> partial_sum(chunks * vars, static_cast<OutT>(0));
+    std::vector<InT> partial_min(chunks * vars, std::numeric_limits<InT>::max());
+    std::vector<InT> partial_max(chunks * vars, std::numeric_limits<InT>::lowest());
+    forEachChunk(chunks, [&](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        for (size_t v = 0; v < vars; ++v) {
+            const InT *const data = variables[v];
+            OutT acc_sum = static_cast<OutT>(0);
+            InT acc_min = std::numeric_limits<InT>::max();
+            InT acc_max = std::numeric_limits<InT>::lowest();
+            for (AgentVector::size_type i = first; i < last; ++i) {
+                const InT x = data[i];
+                acc_sum += static_cast<OutT>(x);
+                acc_min = x < acc_min ? x : acc_min;
+                acc_max = x > acc_max ? x : acc_max;
+            }
+            partial_sum[c * vars + v] = acc_sum;
+            partial_min[c * vars + v] = acc_min;
+            partial_max[c * vars + v] = acc_max;
+        }
+    });
+    std::vector<OutT> rtn;
+    rtn.reserve(requests.size());
+    for (size_t r = 0; r < requests.size(); ++r) {
+        const unsigned int v = request_variable[r];
+        OutT result = static_cast<OutT>(0);
+        InT result_min = std::numeric_limits<InT>::max();
+        InT result_max = std::numeric_limits<InT>::lowest();
+        for (unsigned int c = 0; c < chunks; ++c) {
+            result += partial_sum[c * vars + v];
+            result_min = std::min(result_min, partial_min[c * vars + v]);
+            result_max = std::max(result_max, partial_max[c * vars + v]);
+        }
+        switch (requests[r].op) {
+        case ReductionRequest::Sum: rtn.push_back(result); break;
+        case ReductionRequest::Min: rtn.push_back(static_cast<OutT>(result_min)); break;
+        case ReductionRequest::Max: rtn.push_back(static_cast<OutT>(result_max)); break;
+        }
+    }
+    return rtn;
+}
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_POP_AGENTVECTORREDUCTIONS_H_
@@ -18,7 +18,7 @@ class CUDAScatter;
 class CUDAAgent;
 
 struct VarOffsetStruct;
-struct NewAgentStorage;
+struct NewAgentArena;
 
 /**
  * This class provides an AgentVector interface to agent data currently stored on the device during execution of a CUDASimulation
@@ -37,14 +37,14 @@ class DeviceAgentVector_impl : protected AgentVector {
      * Construct a DeviceAgentVector interface to the on-device data of cuda_agent
      * @param _cuda_agent CUDAAgent instance holding pointers to the desired agent data
      * @param cuda_agent_state Name of the state within cuda_agent to represent.
-     * @param _agentOffsets Agent offset metadata for storing variable data into NewAgentStorage
-     * @param _newAgentData Vector of NewAgentStorage to automatically perform host agent birth when appropriate to save later host-device memcpys
+     * @param _agentOffsets Agent offset metadata for storing variable data into NewAgentArena
+     * @param _newAgentData Arena of new agent data to automatically perform host agent birth when appropriate to save later host-device memcpys
      * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
      * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
      * @param stream CUDA stream to be used for async CUDA operations
      */
     DeviceAgentVector_impl(CUDAAgent& _cuda_agent, const std::string& cuda_agent_state,
-        const VarOffsetStruct& _agentOffsets, std::vector<NewAgentStorage>& _newAgentData,
+        const VarOffsetStruct& _agentOffsets, NewAgentArena& _newAgentData,
         CUDAScatter& scatter, const unsigned int& streamId, const cudaStream_t& stream);
     /**
      * Copy operations are disabled
@@ -357,7 +357,7 @@ class DeviceAgentVector_impl : protected AgentVector {
 
 
     const VarOffsetStruct& agentOffsets;
-    std::vector<NewAgentStorage>& newAgentData;
+    NewAgentArena& newAgentData;
 
     CUDAScatter& scatter;
     const unsigned int& streamId;
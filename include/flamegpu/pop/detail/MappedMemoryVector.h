@@ -0,0 +1,143 @@
+#ifndef INCLUDE_FLAMEGPU_POP_DETAIL_MAPPEDMEMORYVECTOR_H_
+#define INCLUDE_FLAMEGPU_POP_DETAIL_MAPPEDMEMORYVECTOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+
+#include "flamegpu/pop/detail/GenericMemoryVector.h"
+
+namespace flamegpu {
+namespace detail {
+
+/**
+ * Storage class for host copies of variable buffers, backed by a memory-mapped file
+ *
+ * This allows AgentVector to hold populations larger than host memory, as pages are loaded and evicted by the OS page cache on demand.
+ * The file holds the raw variable data, with no header, so it's length is always capacity * variable size.
+ * @see AgentVector::createMapped()
+ * @see AgentVector::openMapped()
+ */
+class MappedMemoryVector : public GenericMemoryVector {
+ public:
+    /**
+     * Creates (or opens) the backing file and maps it
+     * @param _file_path Path to the file which backs this vector
+     * @param prototype An (empty) memory vector of the same type, used to provide type information and to implement clone()
+     * @param open_existing If true, the existing file is opened and it's contents retained, otherwise any existing file is truncated
+     * @throws exception::InvalidFilePath If the file cannot be opened or created
+     * @throws exception::InvalidInputFile If open_existing is set, and the file's length is not a multiple of the variable size
+     */
+    MappedMemoryVector(const std::string &_file_path, const GenericMemoryVector &prototype, bool open_existing);
+    /**
+     * Unmaps and closes the backing file, the file itself is not deleted
+     */
+    ~MappedMemoryVector() override;
+    /**
+     * Returns the type index of the base type of an element.
+     */
+    const std::type_index& getType() const override { return type; }
+    /**
+     * Returns the number of elements in a variable
+     * This is likely to be 1 unless the variable is an array variable
+     */
+    unsigned int getElements() const override { return elements; }
+    /**
+     * Returns the size (in bytes) of a base type of an element of the MappedMemoryVector
+     */
+    size_t getTypeSize() const override { return type_size; }
+    /**
+     * Returns the size (in bytes) of a single element of the MappedMemoryVector.
+     */
+    size_t getVariableSize() const override { return type_size * elements; }
+    /**
+     * Returns a pointer to the front of the mapped buffer
+     * @note If the vector is resized the pointer will become invalid
+     */
+    void* getDataPtr() override { return data; }
+    /**
+     * Returns a const pointer to the front of the mapped buffer
+     * @note If the vector is resized the pointer will become invalid
+     */
+    const void* getReadOnlyDataPtr() const override { return data; }
+    /**
+     * Returns an empty heap backed memory vector of the same type
+     * Copies of a mapped population are not themselves mapped
+     */
+    GenericMemoryVector* clone() const override;
+    /**
+     * Resize the backing file to hold t items, and remap it
+     * Existing items are retained
+     * @param t The size of the buffer (in terms of items, not bytes)
+     * @throws exception::OutOfMemory If the file cannot be resized or mapped
+     */
+    void resize(unsigned int t) override;
+    /**
+     * Returns the number of items the backing file currently holds
+     */
+    unsigned int getCapacity() const { return static_cast<unsigned int>(mapped_bytes / getVariableSize()); }
+    /**
+     * Writes any modified pages back to the backing file
+     */
+    void flush();
+    /**
+     * Returns the path of the backing file
+     */
+    const std::string &getFilePath() const { return file_path; }
+
+ private:
+    /**
+     * Maps mapped_bytes of the backing file, if mapped_bytes is 0 data is set to nullptr
+     */
+    void map();
+    /**
+     * Releases the current mapping, if one exists
+     */
+    void unmap();
+    /**
+     * Releases the current mapping and closes the backing file
+     */
+    void close();
+    /**
+     * Path of the backing file
+     */
+    const std::string file_path;
+    /**
+     * Used to implement clone()
+     */
+    const std::unique_ptr<GenericMemoryVector> prototype;
+    /**
+     * Number of elements per variable (1 if not an array variable)
+     */
+    const unsigned int elements;
+    /**
+     * Type info about the vector base type
+     */
+    const std::type_index type;
+    /**
+     * Size of the base type of a variable
+     */
+    const size_t type_size;
+    /**
+     * Start of the mapping, nullptr if the file is empty
+     */
+    void *data = nullptr;
+    /**
+     * Length of the mapping (and backing file) in bytes
+     */
+    size_t mapped_bytes = 0;
+    /**
+     * OS handle for the backing file (file descriptor or HANDLE), -1 if closed
+     */
+    intptr_t file_handle = -1;
+    /**
+     * OS handle for the file mapping object (Windows only)
+     */
+    intptr_t mapping_handle = 0;
+};
+
+}  // namespace detail
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_POP_DETAIL_MAPPEDMEMORYVECTOR_H_
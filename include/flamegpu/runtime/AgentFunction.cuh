@@ -7,6 +7,7 @@
 #include "flamegpu/defines.h"
 #include "flamegpu/exception/FLAMEGPUDeviceException.cuh"
 #include "flamegpu/runtime/AgentFunction_shim.cuh"
+#include "flamegpu/runtime/utility/PhiloxRandom.cuh"
 
 namespace flamegpu {
 
@@ -27,6 +28,7 @@ typedef void(AgentFunctionWrapper)(
     const void *in_messagelist_metadata,
     const void *out_messagelist_metadata,
     curandState *d_rng,
+    const PhiloxRandom::Key rng_key,
     unsigned int *scanFlag_agentDeath,
     unsigned int *scanFlag_messageOutput,
     unsigned int *scanFlag_agentOutput);  // Can't put __global__ in a typedef
@@ -44,7 +46,8 @@ typedef void(AgentFunctionWrapper)(
  * @param popNo Total number of agents executing the function (number of threads launched)
  * @param in_messagelist_metadata Pointer to the MessageIn metadata struct, it is interpreted by MessageIn
  * @param out_messagelist_metadata Pointer to the MessageOut metadata struct, it is interpreted by MessageOut
- * @param d_rng Array of curand states for this kernel
+ * @param d_rng Array of curand states for this kernel, nullptr if random numbers are counter-based
+ * @param rng_key Key used to generate counter-based random numbers, if d_rng is nullptr
  * @param scanFlag_agentDeath Scanflag array for agent death
  * @param scanFlag_messageOutput Scanflag array for optional message output
  * @param scanFlag_agentOutput Scanflag array for optional agent output
@@ -67,6 +70,7 @@ __global__ void agent_function_wrapper(
     const void *in_messagelist_metadata,
     const void *out_messagelist_metadata,
     curandState *d_rng,
+    const PhiloxRandom::Key rng_key,
     unsigned int *scanFlag_agentDeath,
     unsigned int *scanFlag_messageOutput,
     unsigned int *scanFlag_agentOutput) {
@@ -92,6 +96,7 @@ __global__ void agent_function_wrapper(
         agent_output_hash,
         d_agent_output_nextID,
         d_rng,
+        rng_key,
         scanFlag_agentOutput,
         MessageIn::In(agent_func_name_hash, messagename_inp_hash, in_messagelist_metadata),
         MessageOut::Out(agent_func_name_hash, messagename_outp_hash, out_messagelist_metadata, scanFlag_messageOutput));
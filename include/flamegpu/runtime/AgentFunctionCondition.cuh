@@ -17,6 +17,7 @@ typedef void(AgentFunctionConditionWrapper)(
     detail::curve::Curve::NamespaceHash agent_func_name_hash,
     const unsigned int popNo,
     curandState *d_rng,
+    const PhiloxRandom::Key rng_key,
     unsigned int *scanFlag_conditionResult);  // Can't put __global__ in a typedef
 
 /**
@@ -26,7 +27,8 @@ typedef void(AgentFunctionConditionWrapper)(
  * @param instance_id_hash CURVE hash of the CUDASimulation's instance id
  * @param agent_func_name_hash CURVE hash of the agent + function's names
  * @param popNo Total number of agents exeucting the function (number of threads launched)
- * @param d_rng Array of curand states for this kernel
+ * @param d_rng Array of curand states for this kernel, nullptr if random numbers are counter-based
+ * @param rng_key Key used to generate counter-based random numbers, if d_rng is nullptr
  * @param scanFlag_conditionResult Scanflag array for condition result (this uses same buffer as agent death)
  * @tparam AgentFunctionCondition The modeller defined agent function condition (defined as FLAMEGPU_AGENT_FUNCTION_CONDITION in model code)
  * @note This is basically a cutdown version of agent_function_wrapper
@@ -40,6 +42,7 @@ __global__ void agent_function_condition_wrapper(
     detail::curve::Curve::NamespaceHash agent_func_name_hash,
     const unsigned int popNo,
     curandState *d_rng,
+    const PhiloxRandom::Key rng_key,
     unsigned int *scanFlag_conditionResult) {
 #if !defined(SEATBELTS) || SEATBELTS
     // We place this at the start of shared memory, so we can locate it anywhere in device code without a reference
@@ -59,7 +62,8 @@ __global__ void agent_function_condition_wrapper(
     ReadOnlyDeviceAPI api = ReadOnlyDeviceAPI(
         instance_id_hash,
         agent_func_name_hash,
-        d_rng);
+        d_rng,
+        rng_key);
 
     // call the user specified device function
     {
@@ -47,19 +47,23 @@ class ReadOnlyDeviceAPI {
         detail::curve::Curve::NamespaceHash,
         const unsigned int,
         curandState *,
+        const PhiloxRandom::Key,
         unsigned int *);
 
  public:
     /**
      * @param instance_id_hash CURVE hash of the CUDASimulation's instance id
      * @param agentfuncname_hash CURVE hash of the agent function
-     * @param d_rng Pointer to the device random state buffer to be used
+     * @param d_rng Pointer to the device random state buffer to be used, nullptr if random numbers are counter-based
+     * @param rng_key Key used to generate counter-based random numbers, if d_rng is nullptr
      */
     __device__ ReadOnlyDeviceAPI(
         const detail::curve::Curve::NamespaceHash &instance_id_hash,
         const detail::curve::Curve::NamespaceHash &agentfuncname_hash,
-        curandState *&d_rng)
-        : random(AgentRandom(&d_rng[getThreadIndex()]))
+        curandState *&d_rng,
+        const PhiloxRandom::Key &rng_key)
+        : random(d_rng ? AgentRandom(&d_rng[getThreadIndex()])
+            : AgentRandom(rng_key, detail::curve::Curve::getAgentVariable<id_t>("_id", agentfuncname_hash, getThreadIndex())))
         , environment(DeviceEnvironment(instance_id_hash))
         , agent_func_name_hash(agentfuncname_hash) { }
     /**
@@ -102,7 +106,7 @@ class ReadOnlyDeviceAPI {
 
     /**
      * Provides access to random functionality inside agent functions
-     * @note random state isn't stored within the object, so it can be const
+     * @note random state isn't stored within the object (besides the counter of counter-based random, which is mutable), so it can be const
      */
     const AgentRandom random;
     /**
@@ -165,6 +169,7 @@ class DeviceAPI {
         const void *,
         const void *,
         curandState *,
+        const PhiloxRandom::Key,
         unsigned int *,
         unsigned int *,
         unsigned int *);
@@ -249,7 +254,8 @@ class DeviceAPI {
      * @param agentfuncname_hash Combined CURVE hashes of agent name and func name
      * @param _agent_output_hash Combined CURVE hashes for agent output
      * @param d_agent_output_nextID If agent birth is enabled, a pointer to the next available ID in global memory. Device agent birth will atomically increment this value to allocate IDs.
-     * @param d_rng Device pointer to curand state for this kernel, index 0 should for TID()==0
+     * @param d_rng Device pointer to curand state for this kernel, index 0 should for TID()==0, nullptr if random numbers are counter-based
+     * @param rng_key Key used to generate counter-based random numbers, if d_rng is nullptr
      * @param scanFlag_agentOutput Array for agent output scan flag
      * @param message_in Input message handler
      * @param message_out Output message handler
@@ -260,13 +266,15 @@ class DeviceAPI {
         const detail::curve::Curve::NamespaceHash &_agent_output_hash,
         id_t *&d_agent_output_nextID,
         curandState *&d_rng,
+        const PhiloxRandom::Key &rng_key,
         unsigned int *&scanFlag_agentOutput,
         typename MessageIn::In &&message_in,
         typename MessageOut::Out &&message_out)
         : message_in(message_in)
         , message_out(message_out)
         , agent_out(AgentOut(_agent_output_hash, d_agent_output_nextID, scanFlag_agentOutput))
-        , random(AgentRandom(&d_rng[getThreadIndex()]))
+        , random(d_rng ? AgentRandom(&d_rng[getThreadIndex()])
+            : AgentRandom(rng_key, detail::curve::Curve::getAgentVariable<id_t>("_id", agentfuncname_hash, getThreadIndex())))
         , environment(DeviceEnvironment(instance_id_hash))
         , agent_func_name_hash(agentfuncname_hash)
     { }
@@ -371,7 +379,7 @@ class DeviceAPI {
     const AgentOut agent_out;
     /**
      * Provides access to random functionality inside agent functions
-     * @note random state isn't stored within the object, so it can be const
+     * @note random state isn't stored within the object (besides the counter of counter-based random, which is mutable), so it can be const
      */
     const AgentRandom random;
     /**
@@ -35,10 +35,14 @@ class HostAPI {
      * CUDAFatAgent::assignIDs() makes use of resizeTempStorage()
      */
     friend class CUDAFatAgent;
+    /**
+     * CUDASimulation::getMemoryReport() makes use of getDeviceMemoryUsage()
+     */
+    friend class CUDASimulation;
 
  public:
     // Typedefs repeated from CUDASimulation
-    typedef std::vector<NewAgentStorage> AgentDataBuffer;
+    typedef NewAgentArena AgentDataBuffer;
     typedef std::unordered_map<std::string, AgentDataBuffer> AgentDataBufferStateMap;
     typedef std::unordered_map<std::string, VarOffsetStruct> AgentOffsetMap;
     typedef std::unordered_map<std::string, AgentDataBufferStateMap> AgentDataMap;
@@ -89,7 +93,8 @@ class HostAPI {
         SUM,
         CUSTOM_REDUCE,
         HISTOGRAM_EVEN,
-        SORT
+        SORT,
+        MULTI_REDUCE
     };
     // Can't put type_info in map, deleted constructors, so we use it's hash code
     // Histogram always has type int, so we use number of bins instead
@@ -107,6 +112,10 @@ class HostAPI {
     void resizeTempStorage(const CUB_Config &cc, const unsigned int &items, const size_t &newSize);
     template<typename T>
     void resizeOutputSpace(const unsigned int &items = 1);
+    /**
+     * Returns the device memory currently allocated to cub temp storage and reduction output space, in bytes
+     */
+    size_t getDeviceMemoryUsage() const { return d_cub_temp_size + d_output_space_size; }
     CUDASimulation &agentModel;
     void *d_cub_temp;
     size_t d_cub_temp_size;
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_FLAMEGPU_RUNTIME_HOSTAPI_MACROS_H_
 #define INCLUDE_FLAMEGPU_RUNTIME_HOSTAPI_MACROS_H_
 
+#include <string>
+
 namespace flamegpu {
 
 class HostAPI;
@@ -23,10 +25,12 @@ typedef FLAMEGPU_HOST_FUNCTION_POINTER FLAMEGPU_EXIT_FUNCTION_POINTER;
 /**
  * Macro for defining host functions with the correct input. 
  * Ugly, but has same usage as device functions
+ * The function's name is registered, so that it can be identified in timing output (e.g. CUDASimulation::getElapsedTimeHostFunctions())
  */
 #define FLAMEGPU_HOST_FUNCTION(funcName) \
 void funcName ## _impl(flamegpu::HostAPI* FLAMEGPU); \
 flamegpu::FLAMEGPU_HOST_FUNCTION_POINTER funcName = funcName ## _impl;\
+bool funcName ## _named = flamegpu::detail::registerHostFunctionName(funcName ## _impl, #funcName);\
 void funcName ## _impl(flamegpu::HostAPI* FLAMEGPU)
 
 /**
@@ -49,12 +53,43 @@ typedef FLAMEGPU_HOST_CONDITION_POINTER FLAMEGPU_EXIT_CONDITION_POINTER;
 /**
  * Macro for defining host functions with the correct input.
  * Ugly, but has same usage as device functions
+ * The function's name is registered, so that it can be identified in timing output (e.g. CUDASimulation::getElapsedTimeHostFunctions())
  */
 #define FLAMEGPU_HOST_CONDITION(funcName) \
 flamegpu::CONDITION_RESULT funcName ## _impl(flamegpu::HostAPI* FLAMEGPU); \
 flamegpu::FLAMEGPU_HOST_CONDITION_POINTER funcName = funcName ## _impl;\
+bool funcName ## _named = flamegpu::detail::registerHostFunctionName(funcName ## _impl, #funcName);\
 flamegpu::CONDITION_RESULT funcName ## _impl(flamegpu::HostAPI* FLAMEGPU)
 
+namespace detail {
+/**
+ * Records the name of a host function, this is called by the FLAMEGPU_HOST_FUNCTION macro
+ * @param func The host function
+ * @param name The name of the host function
+ * @return Always true, so that the macro can register the name during static initialisation
+ */
+bool registerHostFunctionName(FLAMEGPU_HOST_FUNCTION_POINTER func, const char *name);
+/**
+ * Records the name of a host condition, this is called by the FLAMEGPU_HOST_CONDITION macro
+ * @param func The host condition
+ * @param name The name of the host condition
+ * @return Always true, so that the macro can register the name during static initialisation
+ */
+bool registerHostFunctionName(FLAMEGPU_HOST_CONDITION_POINTER func, const char *name);
+/**
+ * Returns the name of a host function, if it was defined with the FLAMEGPU_HOST_FUNCTION macro (or a macro derived from it)
+ * @param func The host function
+ * @return The host function's name, or an empty string if the name is not known
+ */
+std::string getHostFunctionName(FLAMEGPU_HOST_FUNCTION_POINTER func);
+/**
+ * Returns the name of a host condition, if it was defined with the FLAMEGPU_HOST_CONDITION macro (or a macro derived from it)
+ * @param func The host condition
+ * @return The host condition's name, or an empty string if the name is not known
+ */
+std::string getHostFunctionName(FLAMEGPU_HOST_CONDITION_POINTER func);
+}  // namespace detail
+
 }  // namespace flamegpu
 
 #endif  // INCLUDE_FLAMEGPU_RUNTIME_HOSTAPI_MACROS_H_
@@ -9,6 +9,7 @@
 #include <thrust/device_ptr.h>
 #include <thrust/sort.h>
 #include <thrust/execution_policy.h>
+#include <thrust/system/cuda/execution_policy.h>
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif  // _MSC_VER
@@ -22,6 +23,7 @@
 #include "flamegpu/sim/AgentInterface.h"
 #include "flamegpu/model/AgentDescription.h"
 #include "flamegpu/runtime/HostAPI.h"
+#include "flamegpu/runtime/ReductionRequest.h"
 #include "flamegpu/gpu/CUDASimulation.h"
 #include "flamegpu/gpu/CUDAAgent.h"
 #include "flamegpu/pop/DeviceAgentVector.h"
@@ -34,12 +36,12 @@ struct funcName ## _impl {\
  public:\
     template <typename OutT>\
     struct binary_function {\
-        __device__ __forceinline__ OutT operator()(const OutT &a, const OutT &b) const;\
+        __host__ __device__ __forceinline__ OutT operator()(const OutT &a, const OutT &b) const;\
     };\
 };\
 funcName ## _impl funcName;\
 template <typename OutT>\
-__device__ __forceinline__ OutT funcName ## _impl::binary_function<OutT>::operator()(const OutT & a, const OutT & b) const
+__host__ __device__ __forceinline__ OutT funcName ## _impl::binary_function<OutT>::operator()(const OutT & a, const OutT & b) const
 
 #define FLAMEGPU_CUSTOM_TRANSFORM(funcName, a)\
 struct funcName ## _impl {\
@@ -51,7 +53,100 @@ struct funcName ## _impl {\
 };\
 funcName ## _impl funcName;\
 template<typename InT, typename OutT>\
-__device__ __forceinline__ OutT funcName ## _impl::unary_function<InT, OutT>::operator()(const InT &a) const
+__host__ __device__ __forceinline__ OutT funcName ## _impl::unary_function<InT, OutT>::operator()(const InT &a) const
+
+namespace detail {
+/**
+ * Maximum number of variables reduced by a single HostAgentAPI::multiReduce() kernel launch
+ * Larger batches are split across multiple launches, which still share a single device to host transfer
+ */
+constexpr unsigned int MULTI_REDUCE_MAX_VARIABLES = 32;
+/**
+ * Block size of the HostAgentAPI::multiReduce() kernels
+ */
+constexpr unsigned int MULTI_REDUCE_BLOCK_SIZE = 256;
+/**
+ * Maximum grid size of the first stage HostAgentAPI::multiReduce() kernel, larger populations are processed with a grid-stride loop
+ */
+constexpr unsigned int MULTI_REDUCE_MAX_GRID_SIZE = 256;
+/**
+ * The fused sum/min/max of a single variable, as calculated by HostAgentAPI::multiReduce()
+ */
+template<typename InT, typename OutT>
+struct MultiReduceValue {
+    OutT sum;
+    InT min;
+    InT max;
+};
+/**
+ * Binary operator combining two MultiReduceValue
+ */
+template<typename InT, typename OutT>
+struct MultiReduceOp {
+    __device__ __forceinline__ MultiReduceValue<InT, OutT> operator()(const MultiReduceValue<InT, OutT> &a, const MultiReduceValue<InT, OutT> &b) const {
+        return { a.sum + b.sum, b.min < a.min ? b.min : a.min, b.max > a.max ? b.max : a.max };
+    }
+};
+/**
+ * Device pointers to the variables reduced by a single kernel launch
+ * These are passed by value as a kernel argument, so they do not require a host to device transfer
+ */
+template<typename InT>
+struct MultiReduceVariables {
+    const InT *ptr[MULTI_REDUCE_MAX_VARIABLES];
+};
+/**
+ * First stage of HostAgentAPI::multiReduce()
+ * Each block calculates the sum/min/max of it's subset of agents, for every variable, writing one partial per block per variable
+ * @param vars Device pointers to the variables to be reduced
+ * @param var_count The number of valid items within vars
+ * @param agent_count The number of agents within each variable buffer
+ * @param d_partials Output buffer of length gridDim.x * var_count, partials are grouped by variable
+ */
+template<typename InT, typename OutT, unsigned int BLOCK_SIZE>
+__global__ void multiReduceBlocks(const MultiReduceVariables<InT> vars, const unsigned int var_count, const unsigned int agent_count, MultiReduceValue<InT, OutT> *d_partials) {
+    typedef cub::BlockReduce<MultiReduceValue<InT, OutT>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+    for (unsigned int v = 0; v < var_count; ++v) {
+        const InT *const d_var = vars.ptr[v];
+        MultiReduceValue<InT, OutT> acc = { static_cast<OutT>(0), cub::Traits<InT>::Max(), cub::Traits<InT>::Lowest() };
+        for (unsigned int i = blockIdx.x * BLOCK_SIZE + threadIdx.x; i < agent_count; i += gridDim.x * BLOCK_SIZE) {
+            const InT x = d_var[i];
+            acc.sum += static_cast<OutT>(x);
+            acc.min = x < acc.min ? x : acc.min;
+            acc.max = x > acc.max ? x : acc.max;
+        }
+        const MultiReduceValue<InT, OutT> block_acc = BlockReduce(temp_storage).Reduce(acc, MultiReduceOp<InT, OutT>());
+        if (threadIdx.x == 0) {
+            d_partials[v * gridDim.x + blockIdx.x] = block_acc;
+        }
+        // temp_storage is reused for the next variable
+        __syncthreads();
+    }
+}
+/**
+ * Second stage of HostAgentAPI::multiReduce()
+ * Block v combines the partials of variable v
+ * @param d_partials Partials output by multiReduceBlocks()
+ * @param partials_per_var The number of partials per variable (the grid size of multiReduceBlocks())
+ * @param d_out Output buffer of length gridDim.x
+ */
+template<typename InT, typename OutT, unsigned int BLOCK_SIZE>
+__global__ void multiReducePartials(const MultiReduceValue<InT, OutT> *d_partials, const unsigned int partials_per_var, MultiReduceValue<InT, OutT> *d_out) {
+    typedef cub::BlockReduce<MultiReduceValue<InT, OutT>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+    const MultiReduceValue<InT, OutT> *const d_var_partials = d_partials + blockIdx.x * partials_per_var;
+    MultiReduceOp<InT, OutT> op;
+    MultiReduceValue<InT, OutT> acc = { static_cast<OutT>(0), cub::Traits<InT>::Max(), cub::Traits<InT>::Lowest() };
+    for (unsigned int i = threadIdx.x; i < partials_per_var; i += BLOCK_SIZE) {
+        acc = op(acc, d_var_partials[i]);
+    }
+    const MultiReduceValue<InT, OutT> block_acc = BlockReduce(temp_storage).Reduce(acc, op);
+    if (threadIdx.x == 0) {
+        d_out[blockIdx.x] = block_acc;
+    }
+}
+}  // namespace detail
 
 /**
  * Collection of HostAPI functions related to agents
@@ -198,6 +293,26 @@ class HostAgentAPI {
      */
     template<typename InT, typename OutT, typename transformOperatorT, typename reductionOperatorT>
     OutT transformReduce(const std::string &variable, transformOperatorT transformOperator, reductionOperatorT reductionOperator, const OutT &init) const;
+    /**
+     * Performs a batch of sum/min/max reductions over one or more variables of the same type
+     *
+     * Each variable is read once by a single fused pass, regardless of how many operations are requested of it,
+     * and all results are returned by a single device to host transfer.
+     * This is more efficient than calling sum(), min() and max() separately, each of which requires it's own pass and synchronisation.
+     * @param requests The (variable, operation) pairs to calculate
+     * @return The result of each request, in the same order as requests
+     * @tparam InT The type of the variables as specified in the model description hierarchy
+     * @tparam OutT The type used to accumulate and return results, can be used if sums are expected to exceed the representation of InT
+     * @note Min and Max results are converted to OutT with static_cast
+     * @throws exception::UnsupportedVarType Array variables are not supported
+     * @throws exception::InvalidAgentVar If the agent does not contain a variable of the same name
+     * @throws exception::InvalidVarType If the passed variable type does not match that specified in the model description hierarchy
+     * @see AgentVectorReductions::multiReduce() for the equivalent host implementation
+     */
+    template<typename InT>
+    std::vector<InT> multiReduce(const std::vector<ReductionRequest> &requests) const;
+    template<typename InT, typename OutT>
+    std::vector<OutT> multiReduce(const std::vector<ReductionRequest> &requests) const;
     /**
      * Sort ordering
      * Ascending or Descending
@@ -320,15 +435,16 @@ OutT HostAgentAPI::sum(const std::string &variable) const {
     if (api.tempStorageRequiresResize(cc, agentCount)) {
         // Resize cub storage
         size_t tempByte = 0;
-        gpuErrchk(cub::DeviceReduce::Sum(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), static_cast<int>(agentCount)));
+        gpuErrchk(cub::DeviceReduce::Sum(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // Resize output storage
     api.resizeOutputSpace<OutT>();
-    gpuErrchk(cub::DeviceReduce::Sum(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), static_cast<int>(agentCount)));
+    gpuErrchk(cub::DeviceReduce::Sum(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
     gpuErrchkLaunch();
     OutT rtn;
-    gpuErrchk(cudaMemcpy(&rtn, api.d_output_space, sizeof(OutT), cudaMemcpyDeviceToHost));
+    gpuErrchk(cudaMemcpyAsync(&rtn, api.d_output_space, sizeof(OutT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     return rtn;
 }
 template<typename InT>
@@ -354,16 +470,17 @@ InT HostAgentAPI::min(const std::string &variable) const {
     if (api.tempStorageRequiresResize(cc, agentCount)) {
         // Resize cub storage
         size_t tempByte = 0;
-        gpuErrchk(cub::DeviceReduce::Min(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount)));
+        gpuErrchk(cub::DeviceReduce::Min(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
         gpuErrchkLaunch();
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // Resize output storage
     api.resizeOutputSpace<InT>();
-    gpuErrchk(cub::DeviceReduce::Min(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount)));
+    gpuErrchk(cub::DeviceReduce::Min(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
     gpuErrchkLaunch();
     InT rtn;
-    gpuErrchk(cudaMemcpy(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost));
+    gpuErrchk(cudaMemcpyAsync(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     return rtn;
 }
 template<typename InT>
@@ -389,16 +506,17 @@ InT HostAgentAPI::max(const std::string &variable) const {
     if (api.tempStorageRequiresResize(cc, agentCount)) {
         // Resize cub storage
         size_t tempByte = 0;
-        gpuErrchk(cub::DeviceReduce::Max(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount)));
+        gpuErrchk(cub::DeviceReduce::Max(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
         gpuErrchkLaunch();
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // Resize output storage
     api.resizeOutputSpace<InT>();
-    gpuErrchk(cub::DeviceReduce::Max(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount)));
+    gpuErrchk(cub::DeviceReduce::Max(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space), static_cast<int>(agentCount), api.stream));
     gpuErrchkLaunch();
     InT rtn;
-    gpuErrchk(cudaMemcpy(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost));
+    gpuErrchk(cudaMemcpyAsync(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     return rtn;
 }
 template<typename InT>
@@ -420,7 +538,7 @@ unsigned int HostAgentAPI::count(const std::string &variable, const InT &value)
     void *var_ptr = agent.getStateVariablePtr(stateName, variable);
     const auto agentCount = agent.getStateSize(stateName);
     // Cast return from ptrdiff_t (int64_t) to (uint32_t)
-    unsigned int rtn = static_cast<unsigned int>(thrust::count(thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr)), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr) + agentCount), value));
+    unsigned int rtn = static_cast<unsigned int>(thrust::count(thrust::cuda::par.on(api.stream), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr)), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr) + agentCount), value));
     gpuErrchkLaunch();
     return rtn;
 }
@@ -456,17 +574,18 @@ std::vector<OutT> HostAgentAPI::histogramEven(const std::string &variable, const
         // Resize cub storage
         size_t tempByte = 0;
         gpuErrchk(cub::DeviceHistogram::HistogramEven(nullptr, tempByte,
-            reinterpret_cast<InT*>(var_ptr), reinterpret_cast<int*>(api.d_output_space), histogramBins + 1, lowerBound, upperBound, static_cast<int>(agentCount)));
+            reinterpret_cast<InT*>(var_ptr), reinterpret_cast<int*>(api.d_output_space), histogramBins + 1, lowerBound, upperBound, static_cast<int>(agentCount), api.stream));
         gpuErrchkLaunch();
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // Resize output storage
     api.resizeOutputSpace<OutT>(histogramBins);
     gpuErrchk(cub::DeviceHistogram::HistogramEven(api.d_cub_temp, api.d_cub_temp_size,
-        reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), histogramBins + 1, lowerBound, upperBound, static_cast<int>(agentCount)));
+        reinterpret_cast<InT*>(var_ptr), reinterpret_cast<OutT*>(api.d_output_space), histogramBins + 1, lowerBound, upperBound, static_cast<int>(agentCount), api.stream));
     gpuErrchkLaunch();
     std::vector<OutT> rtn(histogramBins);
-    gpuErrchk(cudaMemcpy(rtn.data(), api.d_output_space, histogramBins * sizeof(OutT), cudaMemcpyDeviceToHost));
+    gpuErrchk(cudaMemcpyAsync(rtn.data(), api.d_output_space, histogramBins * sizeof(OutT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     return rtn;
 }
 template<typename InT, typename reductionOperatorT>
@@ -493,17 +612,18 @@ InT HostAgentAPI::reduce(const std::string &variable, reductionOperatorT /*reduc
         // Resize cub storage
         size_t tempByte = 0;
         gpuErrchk(cub::DeviceReduce::Reduce(nullptr, tempByte, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space),
-            static_cast<int>(agentCount), typename reductionOperatorT::template binary_function<InT>(), init));
+            static_cast<int>(agentCount), typename reductionOperatorT::template binary_function<InT>(), init, api.stream));
         gpuErrchkLaunch();
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // Resize output storage
     api.resizeOutputSpace<InT>();
     gpuErrchk(cub::DeviceReduce::Reduce(api.d_cub_temp, api.d_cub_temp_size, reinterpret_cast<InT*>(var_ptr), reinterpret_cast<InT*>(api.d_output_space),
-        static_cast<int>(agentCount), typename reductionOperatorT::template binary_function<InT>(), init));
+        static_cast<int>(agentCount), typename reductionOperatorT::template binary_function<InT>(), init, api.stream));
     gpuErrchkLaunch();
     InT rtn;
-    gpuErrchk(cudaMemcpy(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost));
+    gpuErrchk(cudaMemcpyAsync(&rtn, api.d_output_space, sizeof(InT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     return rtn;
 }
 template<typename InT, typename OutT, typename transformOperatorT, typename reductionOperatorT>
@@ -524,11 +644,91 @@ OutT HostAgentAPI::transformReduce(const std::string &variable, transformOperato
     }
     void *var_ptr = agent.getStateVariablePtr(stateName, variable);
     const auto agentCount = agent.getStateSize(stateName);
-    OutT rtn = thrust::transform_reduce(thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr)), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr) + agentCount),
+    OutT rtn = thrust::transform_reduce(thrust::cuda::par.on(api.stream), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr)), thrust::device_ptr<InT>(reinterpret_cast<InT*>(var_ptr) + agentCount),
         typename transformOperatorT::template unary_function<InT, OutT>(), init, typename reductionOperatorT::template binary_function<OutT>());
     gpuErrchkLaunch();
     return rtn;
 }
+template<typename InT>
+std::vector<InT> HostAgentAPI::multiReduce(const std::vector<ReductionRequest> &requests) const {
+    return multiReduce<InT, InT>(requests);
+}
+template<typename InT, typename OutT>
+std::vector<OutT> HostAgentAPI::multiReduce(const std::vector<ReductionRequest> &requests) const {
+    static_assert(sizeof(InT) <= sizeof(OutT), "Template arg OutT should not be of a smaller size than InT");
+    typedef detail::MultiReduceValue<InT, OutT> ValueT;
+    if (population) {
+        // If the user has a DeviceAgentVector out, sync changes
+        population->syncChanges();
+    }
+    const auto &agentDesc = agent.getAgentDescription();
+    // Validate requests and build the list of unique variables, each variable is only reduced once
+    std::vector<std::string> variables;
+    std::vector<unsigned int> request_variable;
+    request_variable.reserve(requests.size());
+    for (const ReductionRequest &request : requests) {
+        const std::type_index typ = agentDesc.description->getVariableType(request.variable);  // This will throw name exception
+        if (agentDesc.variables.at(request.variable).elements != 1) {
+            THROW exception::UnsupportedVarType("HostAgentAPI::multiReduce() does not support agent array variables.");
+        }
+        if (std::type_index(typeid(InT)) != typ) {
+            THROW exception::InvalidVarType("Wrong variable type passed to HostAgentAPI::multiReduce() for variable '%s'. "
+                "This call expects '%s', but '%s' was requested.",
+                request.variable.c_str(), agentDesc.variables.at(request.variable).type.name(), typeid(InT).name());
+        }
+        if (request.op != ReductionRequest::Sum && request.op != ReductionRequest::Min && request.op != ReductionRequest::Max) {
+            THROW exception::InvalidArgument("Unknown ReductionRequest::Op (%d) passed to HostAgentAPI::multiReduce().", static_cast<int>(request.op));
+        }
+        const auto it = std::find(variables.begin(), variables.end(), request.variable);
+        request_variable.push_back(static_cast<unsigned int>(it - variables.begin()));
+        if (it == variables.end()) {
+            variables.push_back(request.variable);
+        }
+    }
+    if (variables.empty()) {
+        return {};
+    }
+    const unsigned int varCount = static_cast<unsigned int>(variables.size());
+    const unsigned int agentCount = agent.getStateSize(stateName);
+    const unsigned int blockSize = detail::MULTI_REDUCE_BLOCK_SIZE;
+    const unsigned int gridSize = std::max(1u, std::min((agentCount + blockSize - 1) / blockSize, detail::MULTI_REDUCE_MAX_GRID_SIZE));
+    // Per block partials are stored within the cub temp storage
+    const unsigned int partialCount = gridSize * std::min(varCount, detail::MULTI_REDUCE_MAX_VARIABLES);
+    HostAPI::CUB_Config cc = { HostAPI::MULTI_REDUCE, sizeof(ValueT) };
+    if (api.tempStorageRequiresResize(cc, partialCount)) {
+        api.resizeTempStorage(cc, partialCount, partialCount * sizeof(ValueT));
+    }
+    // Resize output storage
+    api.resizeOutputSpace<ValueT>(varCount);
+    ValueT *d_partials = reinterpret_cast<ValueT*>(api.d_cub_temp);
+    ValueT *d_out = reinterpret_cast<ValueT*>(api.d_output_space);
+    for (unsigned int first = 0; first < varCount; first += detail::MULTI_REDUCE_MAX_VARIABLES) {
+        const unsigned int launchVarCount = std::min(varCount - first, detail::MULTI_REDUCE_MAX_VARIABLES);
+        detail::MultiReduceVariables<InT> vars = {};
+        for (unsigned int v = 0; v < launchVarCount; ++v) {
+            vars.ptr[v] = reinterpret_cast<const InT*>(agent.getStateVariablePtr(stateName, variables[first + v]));
+        }
+        detail::multiReduceBlocks<InT, OutT, detail::MULTI_REDUCE_BLOCK_SIZE><<<gridSize, blockSize, 0, api.stream>>>(vars, launchVarCount, agentCount, d_partials);
+        gpuErrchkLaunch();
+        detail::multiReducePartials<InT, OutT, detail::MULTI_REDUCE_BLOCK_SIZE><<<launchVarCount, blockSize, 0, api.stream>>>(d_partials, gridSize, d_out + first);
+        gpuErrchkLaunch();
+    }
+    // Single transfer for all results
+    std::vector<ValueT> values(varCount);
+    gpuErrchk(cudaMemcpyAsync(values.data(), d_out, varCount * sizeof(ValueT), cudaMemcpyDeviceToHost, api.stream));
+    gpuErrchk(cudaStreamSynchronize(api.stream));
+    std::vector<OutT> rtn;
+    rtn.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const ValueT &value = values[request_variable[i]];
+        switch (requests[i].op) {
+        case ReductionRequest::Sum: rtn.push_back(value.sum); break;
+        case ReductionRequest::Min: rtn.push_back(static_cast<OutT>(value.min)); break;
+        case ReductionRequest::Max: rtn.push_back(static_cast<OutT>(value.max)); break;
+        }
+    }
+    return rtn;
+}
 
 
 template<typename VarT>
@@ -537,7 +737,7 @@ void HostAgentAPI::sort(const std::string &variable, Order order, int beginBit,
         // If the user has a DeviceAgentVector out, sync changes
         population->syncChanges();
     }
-    const unsigned int streamId = 0;
+    const unsigned int streamId = api.streamId;
     auto &scatter = api.agentModel.singletons->scatter;
     auto &scan = scatter.Scan();
     // Check variable is valid
@@ -563,29 +763,30 @@ void HostAgentAPI::sort(const std::string &variable, Order order, int beginBit,
     unsigned int *vals_in = scan.Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamId).d_ptrs.scan_flag;
     unsigned int *vals_out = scan.Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamId).d_ptrs.position;
     // Create array of TID (use scanflag_death.position)
-    fillTIDArray(vals_in, agentCount, 0);  // @todo - use a non default stream
+    fillTIDArray(vals_in, agentCount, api.stream);
     // Create array of agent values (use scanflag_death.scan_flag)
-    gpuErrchk(cudaMemcpy(keys_in, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice));
+    gpuErrchk(cudaMemcpyAsync(keys_in, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice, api.stream));
     // Check if we need to resize cub storage
     const HostAPI::CUB_Config cc = { HostAPI::SORT, typeid(VarT).hash_code() };
     if (api.tempStorageRequiresResize(cc, agentCount)) {
         // Resize cub storage
         size_t tempByte = 0;
         if (order == Asc) {
-            gpuErrchk(cub::DeviceRadixSort::SortPairs(nullptr, tempByte, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit));
+            gpuErrchk(cub::DeviceRadixSort::SortPairs(nullptr, tempByte, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit, api.stream));
         } else {
-            gpuErrchk(cub::DeviceRadixSort::SortPairsDescending(nullptr, tempByte, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit));
+            gpuErrchk(cub::DeviceRadixSort::SortPairsDescending(nullptr, tempByte, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit, api.stream));
         }
         api.resizeTempStorage(cc, agentCount, tempByte);
     }
     // pair sort
     if (order == Asc) {
-        gpuErrchk(cub::DeviceRadixSort::SortPairs(api.d_cub_temp, api.d_cub_temp_size, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit));
+        gpuErrchk(cub::DeviceRadixSort::SortPairs(api.d_cub_temp, api.d_cub_temp_size, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit, api.stream));
     } else {
-        gpuErrchk(cub::DeviceRadixSort::SortPairsDescending(api.d_cub_temp, api.d_cub_temp_size, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit));
+        gpuErrchk(cub::DeviceRadixSort::SortPairsDescending(api.d_cub_temp, api.d_cub_temp_size, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit, api.stream));
     }
     // Scatter all agent variables
-    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo use a per simulation stream?
+    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, api.stream);
+    gpuErrchk(cudaStreamSynchronize(api.stream));
     if (population) {
         // If the user has a DeviceAgentVector out, purge cache so it redownloads new data on next use
         population->purgeCache();
@@ -599,7 +800,7 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
         // If the user has a DeviceAgentVector out, sync changes
         population->syncChanges();
     }
-    const unsigned int streamId = 0;
+    const unsigned int streamId = api.streamId;
     auto &scatter = api.agentModel.singletons->scatter;
     auto &scan = scatter.Scan();
     const auto &agentDesc = agent.getAgentDescription();
@@ -635,7 +836,7 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
         // Fill
         void *keys1b = scan.Config(CUDAScanCompaction::Type::AGENT_DEATH, streamId).d_ptrs.position;
         void *var_ptr = agent.getStateVariablePtr(stateName, variable1);
-        gpuErrchk(cudaMemcpy(keys1b, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice));
+        gpuErrchk(cudaMemcpyAsync(keys1b, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice, api.stream));
     }
     // Fill array with var2 keys
     {
@@ -646,7 +847,7 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
         // Fill
         void *keys2 = scan.Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamId).d_ptrs.scan_flag;
         void *var_ptr = agent.getStateVariablePtr(stateName, variable2);
-        gpuErrchk(cudaMemcpy(keys2, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice));
+        gpuErrchk(cudaMemcpyAsync(keys2, var_ptr, total_variable_buffer_size, cudaMemcpyDeviceToDevice, api.stream));
     }
     // Define our buffers (here, after resize)
     Var1T *keys1 = reinterpret_cast<Var1T *>(scan.Config(CUDAScanCompaction::Type::AGENT_DEATH, streamId).d_ptrs.scan_flag);
@@ -654,35 +855,36 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
     Var2T *keys2 = reinterpret_cast<Var2T *>(scan.Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamId).d_ptrs.scan_flag);
     unsigned int *vals = scan.Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamId).d_ptrs.position;
     // Init value array
-    fillTIDArray(vals, agentCount, 0);  // @todo - use a non default stream
+    fillTIDArray(vals, agentCount, api.stream);
     // Process variable 2 first
     {
         // pair sort values
         if (order2 == Asc) {
-            thrust::stable_sort_by_key(thrust::device_ptr<Var2T>(keys2), thrust::device_ptr<Var2T>(keys2 + agentCount),
+            thrust::stable_sort_by_key(thrust::cuda::par.on(api.stream), thrust::device_ptr<Var2T>(keys2), thrust::device_ptr<Var2T>(keys2 + agentCount),
             thrust::device_ptr<unsigned int>(vals), thrust::less<Var2T>());
         } else {
-            thrust::stable_sort_by_key(thrust::device_ptr<Var2T>(keys2), thrust::device_ptr<Var2T>(keys2 + agentCount),
+            thrust::stable_sort_by_key(thrust::cuda::par.on(api.stream), thrust::device_ptr<Var2T>(keys2), thrust::device_ptr<Var2T>(keys2 + agentCount),
             thrust::device_ptr<unsigned int>(vals), thrust::greater<Var2T>());
         }
         gpuErrchkLaunch();
         // sort keys1 based on this order
-        sortBuffer(keys1, keys1b, vals, sizeof(Var1T), agentCount, 0);  // @todo use a non default stream
+        sortBuffer(keys1, keys1b, vals, sizeof(Var1T), agentCount, api.stream);
     }
     // Process variable 1 second
     {
         // pair sort
         if (order1 == Asc) {
-            thrust::stable_sort_by_key(thrust::device_ptr<Var1T>(keys1), thrust::device_ptr<Var1T>(keys1 + agentCount),
+            thrust::stable_sort_by_key(thrust::cuda::par.on(api.stream), thrust::device_ptr<Var1T>(keys1), thrust::device_ptr<Var1T>(keys1 + agentCount),
             thrust::device_ptr<unsigned int>(vals), thrust::less<Var1T>());
         } else {
-            thrust::stable_sort_by_key(thrust::device_ptr<Var1T>(keys1), thrust::device_ptr<Var1T>(keys1 + agentCount),
+            thrust::stable_sort_by_key(thrust::cuda::par.on(api.stream), thrust::device_ptr<Var1T>(keys1), thrust::device_ptr<Var1T>(keys1 + agentCount),
             thrust::device_ptr<unsigned int>(vals), thrust::greater<Var1T>());
         }
         gpuErrchkLaunch();
     }
     // Scatter all agent variables
-    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo - use simulation specific stream.
+    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, api.stream);
+    gpuErrchk(cudaStreamSynchronize(api.stream));
 
     if (population) {
         // If the user has a DeviceAgentVector out, purge cache so it redownloads new data on next use
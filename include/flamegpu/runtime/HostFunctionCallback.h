@@ -1,6 +1,8 @@
 #ifndef INCLUDE_FLAMEGPU_RUNTIME_HOSTFUNCTIONCALLBACK_H_
 #define INCLUDE_FLAMEGPU_RUNTIME_HOSTFUNCTIONCALLBACK_H_
 
+#include <string>
+
 #include "flamegpu/runtime/HostAPI_macros.h"
 
 namespace flamegpu {
@@ -19,6 +21,23 @@ class HostFunctionCallback {
      * Virtual destructor for correct inheritance behaviour
      */
     virtual ~HostFunctionCallback() {}
+    /**
+     * Returns the name which labels the callback in timing reports, empty if the callback is unnamed
+     * In Python this is set to the name of the derived class when it is constructed
+     * @see CUDASimulation::getElapsedTimeHostFunctions()
+     */
+    const std::string &getName() const { return name; }
+    /**
+     * Sets the name which labels the callback in timing reports
+     * @param _name The name of the callback
+     */
+    void setName(const std::string &_name) { name = _name; }
+
+ private:
+    /**
+     * Name which labels the callback in timing reports
+     */
+    std::string name;
 };
 
 /**
@@ -37,6 +56,23 @@ class HostFunctionConditionCallback {
      * Virtual destructor for correct inheritance behaviour
      */
     virtual ~HostFunctionConditionCallback() {}
+    /**
+     * Returns the name which labels the callback in timing reports, empty if the callback is unnamed
+     * In Python this is set to the name of the derived class when it is constructed
+     * @see CUDASimulation::getElapsedTimeHostFunctions()
+     */
+    const std::string &getName() const { return name; }
+    /**
+     * Sets the name which labels the callback in timing reports
+     * @param _name The name of the callback
+     */
+    void setName(const std::string &_name) { name = _name; }
+
+ private:
+    /**
+     * Name which labels the callback in timing reports
+     */
+    std::string name;
 };
 
 }  // namespace flamegpu
@@ -81,43 +81,154 @@ struct VarOffsetStruct {
     }
 };
 /**
-* This struct provides a compact memory store for storing generic variables in a single struct
-*/
-struct NewAgentStorage {
-    explicit NewAgentStorage(const VarOffsetStruct &v, id_t id)
-        : data(reinterpret_cast<char*>(malloc(v.totalSize)))
-        , offsets(v) {
-        memcpy(data, offsets.default_data, offsets.totalSize);
+ * Growable contiguous arena which holds the compact representation of agents created by host functions
+ * Records are stored back to back, each of VarOffsetStruct::totalSize bytes, so the populated region
+ * can be copied to the device as-is
+ * Capacity is retained when the arena is cleared, so repeated host agent creation does not return to the allocator
+ */
+struct NewAgentArena {
+    typedef unsigned int size_type;
+    /**
+     * Construct an empty arena
+     * @param _offsets Memory layout of a single agent record
+     */
+    explicit NewAgentArena(const VarOffsetStruct &_offsets)
+        : offsets(_offsets)
+        , data(nullptr)
+        , count(0)
+        , capacity(0) { }
+    /**
+     * Arenas cannot be copied, as NewAgentStorage handles refer to them
+     */
+    NewAgentArena(const NewAgentArena &other) = delete;
+    NewAgentArena &operator=(const NewAgentArena &other) = delete;
+    /**
+     * Arenas can be moved (this is only used whilst building the containing maps)
+     */
+    NewAgentArena(NewAgentArena &&other) noexcept
+        : offsets(other.offsets)
+        , data(other.data)
+        , count(other.count)
+        , capacity(other.capacity) {
+        other.data = nullptr;
+        other.count = 0;
+        other.capacity = 0;
+    }
+    ~NewAgentArena() {
+        free(data);
+    }
+    /**
+     * Append a new agent record initialised to the agent's default values
+     * @param id The ID to assign to the new agent
+     * @return The index of the new record within the arena
+     */
+    size_type append(id_t id) {
+        if (count >= capacity) {
+            reserve(capacity ? capacity * 2 : MIN_CAPACITY);
+        }
+        char *const record = data + static_cast<size_t>(count) * offsets.totalSize;
+        memcpy(record, offsets.default_data, offsets.totalSize);
         // Overwrite _id value
         const auto& var = offsets.vars.find(ID_VARIABLE_NAME);
         if (var == offsets.vars.end()) {
             THROW exception::InvalidOperation("Internal agent ID variable was not found, "
-                "in NewAgentStorage.NewAgentStorage().");
+                "in NewAgentArena::append().");
         }
         // Don't bother checking type/len
-        memcpy(data + var->second.offset, &id, sizeof(id_t));
+        memcpy(record + var->second.offset, &id, sizeof(id_t));
+        return count++;
     }
     /**
-     * New agent storage cannot be copied, as it requires a unique ID
+     * Ensure the arena can hold atleast new_capacity records without reallocating
+     * @param new_capacity The number of records to make room for
+     * @throws exception::OutOfMemory If the allocation fails
      */
-    NewAgentStorage(const NewAgentStorage &other) = delete;
+    void reserve(size_type new_capacity) {
+        if (new_capacity <= capacity)
+            return;
+        char *t_data = reinterpret_cast<char*>(realloc(data, static_cast<size_t>(new_capacity) * offsets.totalSize));
+        if (!t_data) {
+            THROW exception::OutOfMemory("Failed to allocate %llu bytes for host agent creation, "
+                "in NewAgentArena::reserve().",
+                static_cast<unsigned long long>(new_capacity) * offsets.totalSize);  // NOLINT(runtime/int)
+        }
+        data = t_data;
+        capacity = new_capacity;
+    }
     /**
-     * New agent storage can be moved
+     * Returns a pointer to the record at the specified index
+     * @note This pointer is invalidated by calls to append() or reserve()
      */
-    NewAgentStorage(NewAgentStorage &&other) noexcept
-      : data(other.data)
-      , offsets(other.offsets) {
-      other.data = nullptr;
+    char *getRecord(size_type index) const {
+        return data + static_cast<size_t>(index) * offsets.totalSize;
     }
+    /**
+     * Returns a pointer to the start of the populated region of the arena
+     */
+    const char *getData() const { return data; }
+    /**
+     * Returns the number of bytes occupied by records
+     */
+    size_t getDataSize() const { return static_cast<size_t>(count) * offsets.totalSize; }
+    /**
+     * Returns the number of records held
+     */
+    size_type size() const { return count; }
+    /**
+     * Returns true if the arena holds no records
+     */
+    bool empty() const { return count == 0; }
+    /**
+     * Returns the number of records which can be held before the arena must grow
+     */
+    size_type getCapacity() const { return capacity; }
+    /**
+     * Removes all records, the allocated memory is retained for reuse
+     */
+    void clear() { count = 0; }
+    /**
+     * Memory layout of each record
+     */
+    const VarOffsetStruct &offsets;
+
+ private:
+    /**
+     * Number of records allocated the first time the arena grows
+     */
+    static constexpr size_type MIN_CAPACITY = 32;
+    char *data;
+    size_type count;
+    size_type capacity;
+};
+/**
+* This struct provides access to the compact storage of a single new agent held within a NewAgentArena
+* It holds an index rather than a pointer, so it remains valid if the arena grows
+*/
+struct NewAgentStorage {
+    /**
+     * Create a handle to an existing record within an arena
+     * @param _arena The arena holding the record
+     * @param _index Index of the record within the arena
+     */
+    NewAgentStorage(NewAgentArena &_arena, NewAgentArena::size_type _index)
+        : arena(&_arena)
+        , index(_index)
+        , offsets(_arena.offsets) { }
+    /**
+     * Copying new agent storage creates a second handle to the same agent
+     */
+    NewAgentStorage(const NewAgentStorage &other) = default;
     /**
      * Assigning new agent storage copies all items except for internal members (variables that begin with _, such as _id)
      */
     NewAgentStorage& operator=(const NewAgentStorage& hna) {
         if (offsets.vars == hna.offsets.vars) {
+            char *const dest = data();
+            const char *const src = hna.data();
             // Iterate and copy all vars individually, skip those marked as internal
             for (const auto &off : offsets.vars) {
                 if (off.first[0] != '_') {
-                    memcpy(this->data + off.second.offset, hna.data + off.second.offset, off.second.len);
+                    memmove(dest + off.second.offset, src + off.second.offset, off.second.len);
                 }
             }
         } else {
@@ -125,10 +236,6 @@ struct NewAgentStorage {
         }
         return *this;
     }
-    ~NewAgentStorage() {
-        if (data)
-            free(data);
-    }
     template<typename T>
     void setVariable(const std::string &var_name, const T &val) {
         const auto &var = offsets.vars.find(var_name);
@@ -149,7 +256,7 @@ struct NewAgentStorage {
                 "in NewAgentStorage::setVariable().",
                 var_name.c_str());
         }
-        memcpy(data + var->second.offset, &val, var->second.len);
+        memcpy(data() + var->second.offset, &val, var->second.len);
     }
     template<typename T, unsigned int N>
     void setVariable(const std::string &var_name, const std::array<T, N> &val) {
@@ -175,7 +282,7 @@ struct NewAgentStorage {
                 "in NewAgentStorage.setVariable().",
                 var_name.c_str(), var->second.len / sizeof(T), N);
         }
-        memcpy(data + var->second.offset, val.data(), var->second.len);
+        memcpy(data() + var->second.offset, val.data(), var->second.len);
     }
     template<typename T>
     void setVariable(const std::string &var_name, const unsigned int &index, const T &val) {
@@ -201,7 +308,7 @@ struct NewAgentStorage {
                 "in NewAgentStorage.setVariable().",
                 var_name.c_str(), var->second.len / sizeof(T), index);
         }
-        memcpy(data + var->second.offset + (index * sizeof(T)), &val, sizeof(T));
+        memcpy(data() + var->second.offset + (index * sizeof(T)), &val, sizeof(T));
     }
 #ifdef SWIG
     template<typename T>
@@ -228,7 +335,7 @@ struct NewAgentStorage {
                 "in NewAgentStorage.setVariableArray().",
                 var_name.c_str(), var->second.len / sizeof(T), val.size());
         }
-        memcpy(data + var->second.offset, val.data(), var->second.len);
+        memcpy(data() + var->second.offset, val.data(), var->second.len);
     }
 #endif
     template<typename T>
@@ -251,7 +358,9 @@ struct NewAgentStorage {
                 "in NewAgentStorage::getVariable().",
                 var_name.c_str());
         }
-        return *reinterpret_cast<T*>(data + var->second.offset);
+        T rtn;
+        memcpy(&rtn, data() + var->second.offset, sizeof(T));
+        return rtn;
     }
     template<typename T, unsigned int N>
     std::array<T, N> getVariable(const std::string &var_name) {
@@ -278,7 +387,7 @@ struct NewAgentStorage {
                 var_name.c_str(), var->second.len / sizeof(T), N);
         }
         std::array<T, N> rtn;
-        memcpy(rtn.data(), data + var->second.offset, var->second.len);
+        memcpy(rtn.data(), data() + var->second.offset, var->second.len);
         return rtn;
     }
     template<typename T>
@@ -305,7 +414,9 @@ struct NewAgentStorage {
                 "in NewAgentStorage.getVariable().",
                 var_name.c_str(), var->second.len / sizeof(T), index);
         }
-        return *reinterpret_cast<T*>(data + var->second.offset + (index * sizeof(T)));
+        T rtn;
+        memcpy(&rtn, data() + var->second.offset + (index * sizeof(T)), sizeof(T));
+        return rtn;
     }
 #ifdef SWIG
     template<typename T>
@@ -324,20 +435,20 @@ struct NewAgentStorage {
         }
         const size_t elements = var->second.len / sizeof(T);
         std::vector<T> rtn(elements);
-        memcpy(rtn.data(), data + var->second.offset, var->second.len);
+        memcpy(rtn.data(), data() + var->second.offset, var->second.len);
         return rtn;
     }
 #endif
+
+ private:
     /**
-     * Used by CUDASimulation::processHostAgentCreation() which needs raw access to the data buffer
-     */
-    friend class CUDASimulation;
-    /**
-     * Used by DeviceAgentVector which needs raw access to the data buffer if a dependency requires it
+     * Returns a pointer to this agent's record
+     * @note Records are not guaranteed to be aligned, so variables are always accessed via memcpy
      */
-    friend class DeviceAgentVector_impl;
- private:
-    char *data;
+    char *data() const { return arena->getRecord(index); }
+    // Can't use reference here, makes it non-assignable
+    NewAgentArena *arena;
+    NewAgentArena::size_type index;
     const VarOffsetStruct &offsets;
 };
 
@@ -349,8 +460,8 @@ class HostNewAgentAPI {
     /**
      * Assigns a new agent it's storage
      */
-    explicit HostNewAgentAPI(NewAgentStorage &_s)
-        : s(&_s) { }
+    explicit HostNewAgentAPI(const NewAgentStorage &_s)
+        : s(_s) { }
     /**
      * Copy Constructor
      * This does not duplicate the agent, they both point to the same data, it updates the pointed to agent data
@@ -364,7 +475,7 @@ class HostNewAgentAPI {
      */
     HostNewAgentAPI& operator=(const HostNewAgentAPI &hna) {
         if (&hna != this)
-            *s = *hna.s;
+            s = hna.s;
         return *this;
     }
 
@@ -377,7 +488,7 @@ class HostNewAgentAPI {
             THROW exception::ReservedName("Agent variable names cannot begin with '_', this is reserved for internal usage, "
                 "in HostNewAgentAPI::setVariable().");
         }
-        s->setVariable<T>(var_name, val);
+        s.setVariable<T>(var_name, val);
     }
     template<typename T, unsigned int N>
     void setVariable(const std::string &var_name, const std::array<T, N> &val) {
@@ -385,7 +496,7 @@ class HostNewAgentAPI {
             THROW exception::ReservedName("Agent variable names cannot begin with '_', this is reserved for internal usage, "
                 "in HostNewAgentAPI::setVariable().");
         }
-        s->setVariable<T, N>(var_name, val);
+        s.setVariable<T, N>(var_name, val);
     }
     template<typename T>
     void setVariable(const std::string &var_name, const unsigned int &index, const T &val) {
@@ -393,7 +504,7 @@ class HostNewAgentAPI {
             THROW exception::ReservedName("Agent variable names cannot begin with '_', this is reserved for internal usage, "
                 "in HostNewAgentAPI::setVariable().");
         }
-        s->setVariable<T>(var_name, index, val);
+        s.setVariable<T>(var_name, index, val);
     }
 #ifdef SWIG
     template<typename T>
@@ -402,7 +513,7 @@ class HostNewAgentAPI {
             THROW exception::ReservedName("Agent variable names cannot begin with '_', this is reserved for internal usage, "
                 "in HostNewAgentAPI::setVariable().");
         }
-        s->setVariableArray<T>(var_name, val);
+        s.setVariableArray<T>(var_name, val);
     }
 #endif
     /**
@@ -410,20 +521,20 @@ class HostNewAgentAPI {
      */
     template<typename T>
     T getVariable(const std::string &var_name) const {
-        return s->getVariable<T>(var_name);
+        return s.getVariable<T>(var_name);
     }
     template<typename T, unsigned int N>
     std::array<T, N> getVariable(const std::string &var_name) {
-        return s->getVariable<T, N>(var_name);
+        return s.getVariable<T, N>(var_name);
     }
     template<typename T>
     T getVariable(const std::string &var_name, const unsigned int &index) {
-        return s->getVariable<T>(var_name, index);
+        return s.getVariable<T>(var_name, index);
     }
 #ifdef SWIG
     template<typename T>
     std::vector<T> getVariableArray(const std::string &var_name) {
-        return s->getVariableArray<T>(var_name);
+        return s.getVariableArray<T>(var_name);
     }
 #endif
     /**
@@ -431,7 +542,7 @@ class HostNewAgentAPI {
      */
     id_t getID() const {
         try {
-            return s->getVariable<id_t>(ID_VARIABLE_NAME);
+            return s.getVariable<id_t>(ID_VARIABLE_NAME);
         } catch (...) {
             // Rewrite all exceptions
             THROW exception::UnknownInternalError("Internal Error: Unable to read internal ID variable, in HostNewAgentAPI::getID()\n");
@@ -439,8 +550,10 @@ class HostNewAgentAPI {
     }
 
  private:
-    // Can't use reference here, makes it non-assignable
-    NewAgentStorage *s;
+    /**
+     * Handle to the agent's record within the host agent creation arena
+     */
+    NewAgentStorage s;
 };
 
 }  // namespace flamegpu
@@ -0,0 +1,30 @@
+#ifndef INCLUDE_FLAMEGPU_RUNTIME_REDUCTIONREQUEST_H_
+#define INCLUDE_FLAMEGPU_RUNTIME_REDUCTIONREQUEST_H_
+
+#include <string>
+
+namespace flamegpu {
+
+/**
+ * A single (variable, operation) pair within a batch of reductions
+ * @see HostAgentAPI::multiReduce()
+ * @see AgentVectorReductions::multiReduce()
+ */
+struct ReductionRequest {
+    /**
+     * Reduction operations which can be fused into a single pass
+     */
+    enum Op { Sum, Min, Max };
+    /**
+     * Name of the agent variable to reduce
+     */
+    std::string variable;
+    /**
+     * The operation to apply to the variable
+     */
+    Op op;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_RUNTIME_REDUCTIONREQUEST_H_
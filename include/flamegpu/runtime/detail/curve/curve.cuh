@@ -19,6 +19,8 @@
 #ifndef __CUDACC_RTC__
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 #endif
 
 #include "flamegpu/exception/FLAMEGPUDeviceException.cuh"
@@ -42,6 +44,10 @@ namespace curve {
  *
  * cuRVE is a C library and this singleton class acts as a mechanism to ensure that any reference to the library is handled correctly.
  * For example multiple objects may which to request that curve is initialised. This class will ensure that this function call is only made once the first time that a cuRVEInstance is required.
+ *
+ * Variables are located within the hash table via a perfect hash, computed on the host, so device lookups require a single probe.
+ * Each variable hash is assigned to a bucket, the bucket's displacement is combined with the hash to select a unique slot.
+ * Unregistered variables retain their slot, so that re-registering them (e.g. mapping an agent function's variables each layer) does not change the layout.
  */
 class Curve {
  public:
@@ -74,24 +80,47 @@ class Curve {
      */
     template <unsigned int N>
     __device__ __host__ __forceinline__ static VariableHash variableHash(const char(&str)[N]);
+    /**
+     * Returns the displacement bucket of a variable hash
+     * @param variable_hash A cuRVE variable string hash from variableHash.
+     */
+    __device__ __host__ __forceinline__ static unsigned int hashBucket(VariableHash variable_hash);
+    /**
+     * Returns the hash table slot of a variable hash, given the displacement of it's bucket
+     * @param variable_hash A cuRVE variable string hash from variableHash.
+     * @param displacement The displacement of the hash's bucket
+     */
+    __device__ __host__ __forceinline__ static Variable hashSlot(VariableHash variable_hash, VariableHash displacement);
+#ifndef __CUDACC_RTC__
+    /**
+     * Computes a displacement for each bucket, such that every hash is assigned a unique slot
+     * Buckets are placed largest first, each using the first displacement which places all of it's hashes in free slots
+     * @param variable_hashes The hashes to place, these must be unique
+     * @param displacements Output array of DISPLACEMENT_BUCKETS displacements
+     * @return True if a layout was found, this will be false if there are more hashes than MAX_VARIABLES
+     */
+    __host__ static bool buildLayout(const std::vector<VariableHash> &variable_hashes, VariableHash *displacements);
+#endif
     /**
      *  Function for getting a handle (hash table index) to a cuRVE variable from a variable string hash
      *
-     *  Function performs hash collision avoidance using linear probing.
-     *
      *  @param variable_hash A cuRVE variable string hash from variableHash.
-     *  @return Variable Handle for the cuRVE variable.
+     *  @return Variable Handle for the cuRVE variable, or UNKNOWN_VARIABLE if it is not registered.
      */
     __host__ Variable getVariableHandle(VariableHash variable_hash);
     /**
      * Function for registering a variable by a VariableHash
      *
-     * Registers a variable by insertion in a hash table. 
+     * Registers a variable by insertion in a hash table.
+     * If the variable has been registered before, it reuses it's previous slot, otherwise the slots of variables
+     * which share it's bucket (or if necessary the whole table) are recomputed.
+     * If the variable is already registered, it's registration is updated.
      * @param variable_hash A cuRVE variable string hash from variableHash.
      * @param d_ptr a pointer to the vector which holds the hashed variable of give name
      * @param size Size of the data type (this should be the size of a single element if an array variable)
      * @param length Number of elements (1 unless the variable is an array)
      * @return Variable Handle of registered variable or UNKNOWN_VARIABLE if an error is encountered.
+     * @note The handle is only valid until a variable is next registered, as this may change the layout of the hash table
      * @note It is recommend that you instead use the appropriate registerVariable() template function.
      */
     __host__ Variable registerVariableByHash(VariableHash variable_hash, void* d_ptr, size_t size, unsigned int length);
@@ -119,13 +148,14 @@ class Curve {
      * Copy host structures to device
      *
      * This function copies the host hash table to the device, it must be used prior to launching agent functions (and agent function conditions) if Curve has been updated.
-     * 4 memcpys to device are always performed, CURVE does not track whether it has been changed internally.
+     * 5 memcpys to device are always performed, CURVE does not track whether it has been changed internally.
      */
     __host__ void updateDevice();
     /**
      * Function for un-registering a variable by a VariableHash
      *
      *  Un-registers a variable by removing it from the internal hash table.
+     *  The variable's slot is retained, so that it can be re-registered without changing the layout of the hash table.
      *  @note It is recommend to instead use provided unregisterVariable() template function.
      *  @param variable_hash A cuRVE variable string hash from variableHash.
      */
@@ -466,6 +496,9 @@ class Curve {
     __device__ __forceinline__ static void setNewAgentArrayVariable(const char(&variableName)[M], VariableHash namespace_hash, T variable, unsigned int variable_index, unsigned int array_index);
 
     static const int MAX_VARIABLES = 1024;          // !< Default maximum number of cuRVE variables (must be a power of 2)
+    static const unsigned int DISPLACEMENT_BUCKET_BITS = 8;                           // !< log2 of DISPLACEMENT_BUCKETS
+    static const unsigned int DISPLACEMENT_BUCKETS = 1u << DISPLACEMENT_BUCKET_BITS;  // !< Number of buckets which variable hashes are distributed between
+    static const unsigned int MAX_DISPLACEMENT_ATTEMPTS = 1u << 20;                   // !< Number of displacements tried for a bucket, before the layout is considered impossible
     static const VariableHash EMPTY_FLAG = 0;
     static const VariableHash DELETED_FLAG = 1;
 
@@ -505,6 +538,30 @@ class Curve {
      * @see unregisterVariableByHash(VariableHash)
      */
     __host__ void _unregisterVariableByHash(VariableHash variable_hash);
+#ifndef __CUDACC_RTC__
+    /**
+     * Assigns a slot to a variable which has not been registered before
+     * Initially only the variables which share it's bucket are moved, if that fails the whole table is recomputed without the retained slots of unregistered variables
+     * @param variable_hash A cuRVE variable string hash from variableHash.
+     * @return The assigned slot, or UNKNOWN_VARIABLE if the table is full
+     * @note This private version assumes you have already locked mutex
+     */
+    __host__ Variable _addToLayout(VariableHash variable_hash);
+    /**
+     * Moves the variables (registered and retained) to new slots
+     * @param slots Map of variable hash to new slot, variables not included are cleared
+     * @note This private version assumes you have already locked mutex
+     */
+    __host__ void _relocate(const std::unordered_map<VariableHash, unsigned int> &slots);
+    /**
+     * Finds the first displacement which places each of a bucket's hashes in a unique free slot
+     * @param bucket_hashes The hashes of the bucket
+     * @param occupied Flags indicating which slots are unavailable
+     * @param displacement Output displacement
+     * @return True if a displacement was found
+     */
+    __host__ static bool findDisplacement(const std::vector<VariableHash> &bucket_hashes, const std::vector<bool> &occupied, VariableHash &displacement);
+#endif
     /**
      * Device template function for getting a setting a single typed value from a constant string variable name
      *
@@ -589,7 +646,14 @@ class Curve {
     void* h_d_variables[MAX_VARIABLES];           // Host array of pointer to device memory addresses for variable storage
     size_t h_sizes[MAX_VARIABLES];                // Host array of the sizes of registered variable types (Note: RTTI not supported in CUDA so this is the best we can do for now)
     unsigned int h_lengths[MAX_VARIABLES];        // Host array of the length of registered variables (i.e: vector length)
+    VariableHash h_displacements[DISPLACEMENT_BUCKETS];  // Host array of the displacement of each bucket
     bool deviceInitialised;                       // Flag indicating that curve has/hasn't been initialised yet on a device.
+#ifndef __CUDACC_RTC__
+    /**
+     * Slot assigned to each variable hash in the layout, this includes unregistered variables which retain their slot
+     */
+    std::unordered_map<VariableHash, unsigned int> h_slots;
+#endif
 
 #ifndef __CUDACC_RTC__
     /**
@@ -659,6 +723,7 @@ namespace detail {
     extern __device__ char* d_variables[Curve::MAX_VARIABLES];                // Device array of pointer to device memory addresses for variable storage
     extern __constant__ size_t d_sizes[Curve::MAX_VARIABLES];                // Device array of the types of registered variables
     extern __constant__ unsigned int d_lengths[Curve::MAX_VARIABLES];
+    extern __constant__ Curve::VariableHash d_displacements[Curve::DISPLACEMENT_BUCKETS];  // Device array of the displacement of each bucket
 }  // namespace detail
 
 
@@ -706,15 +771,24 @@ __host__ void Curve::unregisterVariable(const char(&variableName)[N]) {
 /**
 * Device side class implementation
 */
-/* loop unrolling of hash collision detection */
+__device__ __host__ __forceinline__ unsigned int Curve::hashBucket(VariableHash variable_hash) {
+    // Fibonacci hashing, the high bits of the product are well mixed
+    return (variable_hash * 2654435761u) >> (32 - DISPLACEMENT_BUCKET_BITS);
+}
+__device__ __host__ __forceinline__ Curve::Variable Curve::hashSlot(VariableHash variable_hash, VariableHash displacement) {
+    // 32 bit finaliser of MurmurHash3, so each displacement produces an unrelated slot
+    variable_hash ^= displacement;
+    variable_hash ^= variable_hash >> 16;
+    variable_hash *= 0x85ebca6bu;
+    variable_hash ^= variable_hash >> 13;
+    variable_hash *= 0xc2b2ae35u;
+    variable_hash ^= variable_hash >> 16;
+    return static_cast<Variable>(variable_hash & (MAX_VARIABLES - 1));
+}
+/* perfect hash, so only a single slot need be checked */
 __device__ __forceinline__ Curve::Variable Curve::getVariable(const VariableHash variable_hash) {
-    for (unsigned int x = 0; x< MAX_VARIABLES; x++) {
-        const Variable i = ((variable_hash + x) & (MAX_VARIABLES - 1));
-        const VariableHash h = curve::detail::d_hashes[i];
-        if (h == variable_hash)
-            return i;
-    }
-    return UNKNOWN_VARIABLE;
+    const Variable i = hashSlot(variable_hash, curve::detail::d_displacements[hashBucket(variable_hash)]);
+    return curve::detail::d_hashes[i] == variable_hash ? i : UNKNOWN_VARIABLE;
 }
 
 
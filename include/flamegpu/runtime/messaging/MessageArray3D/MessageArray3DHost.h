@@ -57,6 +57,12 @@ class MessageArray3D::CUDAModelHandler : public MessageSpecialisationHandler {
      * Returns a pointer to the metadata struct, this is required for reading the message data
      */
     const void *getMetaDataDevicePtr() const override { return d_metadata; }
+    /**
+     * Returns the device memory held by the metadata struct and write flags, in bytes
+     */
+    size_t getDeviceMemoryUsage() const override {
+        return (d_metadata ? sizeof(MetaData) : 0) + d_write_flag_len * sizeof(unsigned int);
+    }
 
  private:
     /**
@@ -65,6 +65,10 @@ class MessageBruteForce::CUDAModelHandler : public MessageSpecialisationHandler
      * Returns a pointer to the metadata struct, this is required for reading the message data
      */
     const void *getMetaDataDevicePtr() const override { return d_metadata; }
+    /**
+     * Returns the device memory held by the metadata struct, in bytes
+     */
+    size_t getDeviceMemoryUsage() const override { return d_metadata ? sizeof(MetaData) : 0; }
 
  private:
     /**
@@ -57,6 +57,14 @@ class MessageBucket::CUDAModelHandler : public MessageSpecialisationHandler {
     * Returns a pointer to the metadata struct, this is required for reading the message data
     */
     const void *getMetaDataDevicePtr() const override { return d_data; }
+    /**
+    * Returns the device memory held by the partition boundary matrix, histogram, sort keys/values and cub temp storage, in bytes
+    */
+    size_t getDeviceMemoryUsage() const override {
+        if (!d_data)
+            return 0;
+        return 2 * (bucketCount + 1) * sizeof(unsigned int) + sizeof(MetaData) + d_CUB_temp_storage_bytes + 2 * d_keys_vals_storage_bytes;
+    }
 
  private:
     /**
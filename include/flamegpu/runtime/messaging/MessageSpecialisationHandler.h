@@ -48,6 +48,11 @@ class MessageSpecialisationHandler {
      * @note: this is slightly CUDA aware. Future abstraction this should be base CUDANone or similar.
      */
     virtual const void *getMetaDataDevicePtr() const { return nullptr; }
+    /**
+     * Returns the device memory currently held by the specialisation (e.g. metadata and index structures), in bytes
+     * This does not include the message lists themselves, which are owned by CUDAMessage
+     */
+    virtual size_t getDeviceMemoryUsage() const { return 0; }
 };
 
 }  // namespace flamegpu
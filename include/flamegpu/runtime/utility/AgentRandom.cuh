@@ -6,6 +6,7 @@
 
 #include "flamegpu/util/detail/StaticAssert.h"
 #include "flamegpu/exception/FLAMEGPUDeviceException.cuh"
+#include "flamegpu/runtime/utility/PhiloxRandom.cuh"
 
 namespace flamegpu {
 
@@ -13,6 +14,8 @@ namespace flamegpu {
  * Utility for accessing random generation within agent functions
  * This should only be instantiated by FLAMEGPU_API
  * Wraps curand functions to access an internal curand state * 
+ * Alternatively, if CUDASimulation::Config::counterBasedRandom is enabled, random numbers are generated by PhiloxRandom,
+ * which is keyed on the agent's id rather than the thread executing the agent
  */
 class AgentRandom {
  public:
@@ -22,6 +25,12 @@ class AgentRandom {
      *   this is a unique instance for the thread among all concurrently executing kernels
      */
     __forceinline__ __device__ AgentRandom(curandState *d_rng);
+    /**
+     * Constructs a counter-based AgentRandom instance
+     * @param key Components of the Philox key and counter shared by the agent function
+     * @param agent_id The id of the executing agent
+     */
+    __forceinline__ __device__ AgentRandom(const PhiloxRandom::Key &key, id_t agent_id);
     /**
      * Returns a float uniformly distributed between 0.0 and 1.0. 
      * @note It may return from 0.0 to 1.0, where 1.0 is included and 0.0 is excluded.
@@ -52,11 +61,22 @@ class AgentRandom {
  private:
     /**
      * Thread-safe index for accessing curand
+     * nullptr if random numbers are counter-based
      */
     curandState *d_random_state;
+    /**
+     * Counter-based generator, only used if d_random_state is nullptr
+     * Mutable as it's counter must advance on each call
+     */
+    mutable PhiloxRandom philox;
 };
 
-__forceinline__ __device__ AgentRandom::AgentRandom(curandState *d_rng) : d_random_state(d_rng) { }
+__forceinline__ __device__ AgentRandom::AgentRandom(curandState *d_rng)
+    : d_random_state(d_rng)
+    , philox(0, 0, 0, 0) { }
+__forceinline__ __device__ AgentRandom::AgentRandom(const PhiloxRandom::Key &key, id_t agent_id)
+    : d_random_state(nullptr)
+    , philox(key, agent_id) { }
 /**
  * All templates are specialised
  */
@@ -66,10 +86,14 @@ __forceinline__ __device__ AgentRandom::AgentRandom(curandState *d_rng) : d_rand
  */
 template<>
 __forceinline__ __device__ float AgentRandom::uniform() const {
+    if (!d_random_state)
+        return philox.uniform<float>();
     return curand_uniform(d_random_state);
 }
 template<>
 __forceinline__ __device__ double AgentRandom::uniform() const {
+    if (!d_random_state)
+        return philox.uniform<double>();
     return curand_uniform_double(d_random_state);
 }
 
@@ -78,10 +102,14 @@ __forceinline__ __device__ double AgentRandom::uniform() const {
  */
 template<>
 __forceinline__ __device__ float AgentRandom::normal() const {
+    if (!d_random_state)
+        return philox.normal<float>();
     return curand_normal(d_random_state);
 }
 template<>
 __forceinline__ __device__ double AgentRandom::normal() const {
+    if (!d_random_state)
+        return philox.normal<double>();
     return curand_normal_double(d_random_state);
 }
 /**
@@ -89,10 +117,14 @@ __forceinline__ __device__ double AgentRandom::normal() const {
  */
 template<>
 __forceinline__ __device__ float AgentRandom::logNormal(const float& mean, const float& stddev) const {
+    if (!d_random_state)
+        return philox.logNormal<float>(mean, stddev);
     return curand_log_normal(d_random_state, mean, stddev);
 }
 template<>
 __forceinline__ __device__ double AgentRandom::logNormal(const double& mean, const double& stddev) const {
+    if (!d_random_state)
+        return philox.logNormal<double>(mean, stddev);
     return curand_log_normal_double(d_random_state, mean, stddev);
 }
 /**
@@ -57,6 +57,25 @@ class ReadOnlyDeviceEnvironment {
      */
     __device__ __forceinline__ ReadOnlyDeviceEnvironment(const detail::curve::Curve::NamespaceHash &_modelname_hash)
         : modelname_hash(_modelname_hash) { }
+#ifndef __CUDACC_RTC__
+    /**
+     * Reads an element of the environment property stored at the location registered with curve
+     * If the property's curve length has EnvironmentManager::OVERFLOW_LENGTH_FLAG set, it has overflowed to global memory
+     * and the location is a device pointer, otherwise the location is an offset into the constant buffer
+     * @param cv Curve variable handle of the property
+     * @param index Index of the element to read
+     * @tparam T Type of the element
+     */
+    template<typename T>
+    __device__ __forceinline__ static T readProperty(const detail::curve::Curve::Variable &cv, const unsigned int &index = 0);
+    /**
+     * Returns the number of elements of the environment property, excluding EnvironmentManager::OVERFLOW_LENGTH_FLAG
+     * @param cv Curve variable handle of the property
+     */
+    __device__ __forceinline__ static unsigned int propertyLength(const detail::curve::Curve::Variable &cv) {
+        return detail::curve::detail::d_lengths[cv] & ~EnvironmentManager::OVERFLOW_LENGTH_FLAG;
+    }
+#endif
 
  public:
     /**
@@ -131,6 +150,15 @@ class DeviceEnvironment : public ReadOnlyDeviceEnvironment {
 
 // Mash compilation of these functions from RTC builds as this requires a dynamic implementation of the function in curve_rtc
 #ifndef __CUDACC_RTC__
+template<typename T>
+__device__ __forceinline__ T ReadOnlyDeviceEnvironment::readProperty(const detail::curve::Curve::Variable &cv, const unsigned int &index) {
+    const char *location = detail::curve::detail::d_variables[cv];
+    // All threads read the same property, so this branch does not diverge
+    if (detail::curve::detail::d_lengths[cv] & EnvironmentManager::OVERFLOW_LENGTH_FLAG) {
+        return *(reinterpret_cast<const T*>(location) + index);
+    }
+    return *(reinterpret_cast<const T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(location)) + index);
+}
 /**
  * Getters
  */
@@ -142,18 +170,18 @@ __device__ __forceinline__ T ReadOnlyDeviceEnvironment::getProperty(const char(&
     if (cv ==  detail::curve::Curve::UNKNOWN_VARIABLE) {
         DTHROW("Environment property with name: %s was not found.\n", name);
 #if defined(USE_GLM)
-    } else if (detail::curve::detail::d_sizes[cv] * detail::curve::detail::d_lengths[cv] != sizeof(T)) {
-        DTHROW("Environment property with name: %s type size mismatch %llu != %llu.\n", name, detail::curve::detail::d_sizes[cv] * detail::curve::detail::d_lengths[cv], sizeof(T));
+    } else if (detail::curve::detail::d_sizes[cv] * propertyLength(cv) != sizeof(T)) {
+        DTHROW("Environment property with name: %s type size mismatch %llu != %llu.\n", name, detail::curve::detail::d_sizes[cv] * propertyLength(cv), sizeof(T));
 #else
     } else if (detail::curve::detail::d_sizes[cv] != sizeof(T)) {
         DTHROW("Environment property with name: %s type size mismatch %llu != %llu.\n", name, detail::curve::detail::d_sizes[cv], sizeof(T));
 #endif
     } else {
-        return *reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv]));
+        return readProperty<T>(cv);
     }
     return {};
 #else
-    return *reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv]));
+    return readProperty<T>(cv);
 #endif
 }
 template<typename T, unsigned int N>
@@ -165,14 +193,14 @@ __device__ __forceinline__ T ReadOnlyDeviceEnvironment::getProperty(const char(&
         DTHROW("Environment property array with name: %s was not found.\n", name);
     } else if (detail::curve::detail::d_sizes[cv] != sizeof(T)) {
         DTHROW("Environment property array with name: %s type size mismatch %llu != %llu.\n", name, detail::curve::detail::d_sizes[cv], sizeof(T));
-    } else if (detail::curve::detail::d_lengths[cv] <= index) {
-        DTHROW("Environment property array with name: %s index %u is out of bounds (length %u).\n", name, index, detail::curve::detail::d_lengths[cv]);
+    } else if (propertyLength(cv) <= index) {
+        DTHROW("Environment property array with name: %s index %u is out of bounds (length %u).\n", name, index, propertyLength(cv));
     } else {
-        return *(reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv])) + index);
+        return readProperty<T>(cv, index);
     }
     return {};
 #else
-    return *(reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv])) + index);
+    return readProperty<T>(cv, index);
 #endif
 }
 
@@ -4,11 +4,11 @@
 #include <cuda_runtime.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <unordered_map>
 #include <array>
 #include <string>
 #include <type_traits>
-#include <list>
 #include <utility>
 #include <typeindex>
 #include <set>
@@ -23,6 +23,8 @@
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
 #include "flamegpu/runtime/detail/curve/curve.cuh"
 #include "flamegpu/util/Any.h"
+#include "flamegpu/util/detail/DirtyRanges.h"
+#include "flamegpu/util/detail/FreeListAllocator.h"
 
 namespace flamegpu {
 
@@ -41,6 +43,8 @@ class JSONStateReader_impl;
 
 /**
  * Singleton manager for managing environment properties storage in constant memory
+ * Each CUDASimulation instance owns a segment of the constant buffer, with it's own lock, which stores it's small properties
+ * Large array properties, and those which do not fit within the instance's segment, overflow to a global memory buffer owned by the instance
  * This is an internal class, that should not be accessed directly by modellers
  * @see EnvironmentDescription For describing the initial state of a model's environment properties
  * @see AgentEnvironment For reading environment properties during agent functions on the device
@@ -60,10 +64,6 @@ class EnvironmentManager {
      * Uses instance to access env properties in host functions
      */
     friend class HostEnvironment;
-    /**
-     * Accesses pointer to hc_buffer
-     */
-    friend class DefragProp;
     /**
      * Accesses properties to find all of a model's vars
      */
@@ -85,16 +85,31 @@ class EnvironmentManager {
 
  public:
     /**
-     * Max amount of space that can be used for storing environmental properties
+     * Max amount of constant memory that can be used for storing environmental properties
+     * This is shared between the segments of all CUDASimulation instances on a device, properties which do not fit overflow to global memory
      */
     static const size_t MAX_BUFFER_SIZE = 10 * 1024;  // 10KB
+    /**
+     * Properties larger than this (bytes) are always stored in global memory, this only affects array properties
+     * Indexing into large arrays with divergent indices would serialise constant cache accesses
+     */
+    static const size_t MAX_CONSTANT_PROPERTY_SIZE = 64;
+    /**
+     * Set within the length registered with curve for properties which have overflowed to global memory
+     * The location registered with curve is then a device pointer, rather than an offset into the constant buffer
+     */
+    static const unsigned int OVERFLOW_LENGTH_FLAG = 1u << 31;
+    /**
+     * Modified ranges of a segment separated by this many bytes or fewer are uploaded with a single copy
+     */
+    static const size_t UPLOAD_MERGE_GAP = 64;
     /**
      * Offset relative to c_buffer
      * Length in bytes
      */
     typedef unsigned int size_type;
     /**
-     * Used to group items required by freeFragments 
+     * Used to group the offset and length of a region of a buffer
      */
     typedef std::pair<ptrdiff_t, size_t> OffsetLen;
     /**
@@ -109,25 +124,28 @@ class EnvironmentManager {
      */
     struct EnvProp {
         /**
-         * @param _offset Offset into c_buffer/hc_buffer
+         * @param _offset Offset into the owning segment's constant or overflow storage
          * @param _length Length of associated storage
          * @param _isConst Is the stored data constant
          * @param _elements How many elements does the stored data contain (1 if not array)
          * @param _type Type of property (from typeid())
-        * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
+         * @param _overflow Is the property stored in the segment's overflow (global memory) storage
+         * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
          */
-        EnvProp(const ptrdiff_t &_offset, const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const ptrdiff_t &_rtc_offset = 0)
+        EnvProp(const ptrdiff_t &_offset, const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const bool &_overflow = false, const ptrdiff_t &_rtc_offset = 0)
             : offset(_offset),
             length(_length),
             isConst(_isConst),
             elements(_elements),
             type(_type),
+            overflow(_overflow),
             rtc_offset(_rtc_offset) {}
         ptrdiff_t offset;
         size_t length;
         bool isConst;
         size_type elements;
         const std::type_index type;
+        bool overflow;
         ptrdiff_t rtc_offset;  // This is set by buildRTCOffsets();
     };
     /**
@@ -144,45 +162,6 @@ class EnvironmentManager {
         const NamePair masterProp;
         const bool isConst;
     };
-    /**
-     * This structure is a clone of EnvProp
-     * However, instead of offset (which points to an offset into hc_buffer)
-     * data is available, which points to host memory
-     */
-    struct DefragProp {
-        /**
-         * @param ep Environment property to clone
-         * @note ep.offset is converted to a host pointer by adding to hc_buffer
-         */
-        explicit DefragProp(const EnvProp &ep)
-            :data(EnvironmentManager::getInstance().hc_buffer + ep.offset),
-            length(ep.length),
-            isConst(ep.isConst),
-            elements(ep.elements),
-            type(ep.type),
-            rtc_offset(ep.rtc_offset) { }
-        /**
-        * @param _data Pointer to the data in host memory
-        * @param _length Length of associated storage
-        * @param _isConst Is the stored data constant
-        * @param _elements How many elements does the stored data contain (1 if not array)
-        * @param _type Type of propert (from typeid())
-        * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
-        */
-        DefragProp(void *_data, const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const ptrdiff_t &_rtc_offset = 0)
-            : data(_data),
-            length(_length),
-            isConst(_isConst),
-            elements(_elements),
-            type(_type),
-            rtc_offset(_rtc_offset) { }
-        void *data;
-        size_t length;
-        bool isConst;
-        size_type elements;
-        const std::type_index type;
-        ptrdiff_t rtc_offset;
-    };
     /**
      * Struct used by rtc_caches
      * Represents a personalised constant cache buffer for a single CUDASimulation instance
@@ -199,46 +178,74 @@ class EnvironmentManager {
         ptrdiff_t nextFree = 0;
     };
     /**
-     * Transparent operators for DefragMap
-     * This allows them to be secondarily ordered based on NamePair if size is equal
-     */
-    friend bool operator<(const std::pair<size_t, const NamePair>& fk, const size_t& lk) { return fk.first < lk; }
-    friend bool operator<(const size_t& lk, const std::pair<size_t, const NamePair>& fk) { return lk < fk.first; }
-    friend bool operator<(const std::pair<size_t, const NamePair>& fk1, const std::pair<size_t, const NamePair>& fk2) {
-        if (fk1.first == fk2.first) {
-            // If size equal, order by instance_id
-            if (fk1.second.first == fk2.second.first) {
-                // If instance id is equal, order by name
-                return fk1.second.second < fk2.second.second;
-            }
-            return fk1.second.first < fk2.second.first;
-        }
-        return fk1.first < fk2.first;
-    }
-    /**
-     * Typedef for the map used for defragementation
-     * The map is ordered by key of type size, therefore a reverse sort creates aligned data
-     * Specify a transparent operator, to allow us to operate only over size_t part of key
+     * Storage for the environment properties of a single CUDASimulation instance
+     * Small properties are stored within the instance's segment of the constant buffer
+     * Large properties, and those which do not fit within the segment, overflow to a global memory buffer
      */
-    typedef std::multimap<std::pair<size_t, const NamePair>, DefragProp, std::less<>> DefragMap;
+    struct EnvSegment {
+        /**
+         * Protects the segment's buffers and update flags
+         * The EnvironmentManager's mutex must also be held (at least shared), to prevent the segment being released
+         */
+        mutable std::shared_timed_mutex mutex;
+        /**
+         * Offset of the segment within c_buffer
+         */
+        ptrdiff_t c_offset = 0;
+        /**
+         * Host copy of the segment's region of c_buffer, this is sized to the segment's capacity
+         */
+        std::vector<char> hc_buffer;
+        /**
+         * Manages the space within hc_buffer
+         */
+        util::detail::FreeListAllocator c_allocator;
+        /**
+         * Host copy of the overflow buffer
+         */
+        std::vector<char> h_overflow;
+        /**
+         * Manages the space within h_overflow, it is unbounded so h_overflow is resized to it's end as it grows
+         */
+        util::detail::FreeListAllocator overflow_allocator;
+        /**
+         * Device copy of the overflow buffer
+         */
+        char *d_overflow = nullptr;
+        /**
+         * Allocated length of d_overflow, it is reallocated if the overflow buffer grows beyond this
+         */
+        size_t d_overflow_capacity = 0;
+        /**
+         * Byte ranges of hc_buffer which have changed since they were last copied to device
+         */
+        util::detail::DirtyRanges c_dirty = util::detail::DirtyRanges(UPLOAD_MERGE_GAP);
+        /**
+         * Byte ranges of h_overflow which have changed since they were last copied to device
+         */
+        util::detail::DirtyRanges overflow_dirty = util::detail::DirtyRanges(UPLOAD_MERGE_GAP);
+        /**
+         * instance_id of the parent model if the instance is a submodel, otherwise the instance's own instance_id
+         * Mapped properties are stored within the segment of the instance which owns them
+         */
+        unsigned int master_instance_id = 0;
+    };
     /**
-     * Activates a models environment properties, by adding them to constant cache
+     * Activates a models environment properties, by creating a segment to store them
      * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      * @param desc environment properties description to use
-     * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
      */
-    void init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC);
+    void init(const unsigned int &instance_id, const EnvironmentDescription &desc);
     /**
      * Submodel variant of init()
-     * Activates a models unmapped environment properties, by adding them to constant cache
+     * Activates a models unmapped environment properties, by creating a segment to store them
      * Maps a models mapped environment properties to their master property
      * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      * @param desc environment properties description to use
-     * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
      * @param master_instance_id instance_id of the CUDASimulation instance of the parent of the submodel
      * @param mapping Metadata for which environment properties are mapped between master and submodels
      */
-    void init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int &master_instance_id, const SubEnvironmentData &mapping);
+    void init(const unsigned int &instance_id, const EnvironmentDescription &desc, const unsigned int &master_instance_id, const SubEnvironmentData &mapping);
     /**
      * RTC functions hold their own unique constants for environment variables. This function copies all environment variable to the RTC copies.
      * It can not be incorporated into init() as init will be called before RTC functions have been compiled.
@@ -247,7 +254,7 @@ class EnvironmentManager {
      */
     void initRTC(const CUDASimulation &cudaSimulation);
     /**
-     * Deactives all environmental properties linked to the named model from constant cache
+     * Deactives all environmental properties linked to the named model, releasing it's segment
      * @param curve The Curve singleton instance to use, it is important that we purge curve for the correct device
      * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      */
@@ -596,9 +603,16 @@ class EnvironmentManager {
      */
     inline std::type_index type(const unsigned int &instance_id, const std::string &var_name) const { return type(toName(instance_id, var_name)); }
     /**
-     * Returns the available space remaining (bytes) for storing environmental properties
+     * Returns the space (bytes) of the constant buffer which is not reserved by an instance's segment
+     * Properties which do not fit within the constant buffer overflow to global memory, so this does not limit the properties that can be stored
+     */
+    inline size_t freeSpace() const { std::shared_lock<std::shared_timed_mutex> lock(mutex); return c_segments.getFreeSpace(); }
+    /**
+     * Returns the space (bytes) occupied by the environmental properties of the specified instance
+     * Mapped properties are not included, as they are stored by the master model's instance
+     * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      */
-    inline size_t freeSpace() const { std::shared_lock<std::shared_timed_mutex> lock(mutex); return m_freeSpace; }
+    size_t getPropertiesSize(const unsigned int &instance_id) const;
     /**
      * This is the string used to generate CURVE_NAMESPACE_HASH
      */
@@ -623,17 +637,39 @@ class EnvironmentManager {
         return mapped_properties;
     }
     /**
+     * Returns a host pointer to the data of the named property
      * Used by IO methods to efficiently access environment
+     * @param name name used for accessing the property, this may be a mapped property
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
      * @note You must acquire a lock on mutex before calling this method
      */
-    const void * getHostBuffer() const {
-        return hc_buffer;
-    }
+    const char *getHostPtr(const NamePair &name) const;
     /**
-     * Updates the copy of the environment property cache on the device
+     * Copies the modified ranges of the segments read by the specified instance to the device
+     * This is the instance's own segment, and the segments of it's parent models (which store it's mapped properties)
      * @param instance_id Used to update the specified instance's rtc too
+     * @note You must acquire a shared lock on mutex before calling this method
      */
     void updateDevice(const unsigned int &instance_id);
+    /**
+     * Cumulative count of the host to device copies performed by updateDevice()
+     */
+    struct UploadCounters {
+        /**
+         * Total bytes copied
+         */
+        uint64_t bytes = 0;
+        /**
+         * Total number of copies
+         */
+        uint64_t uploads = 0;
+    };
+    /**
+     * Returns the cumulative copies performed by updateDevice() for the specified instance, since it was initialised
+     * This includes copies of parent model segments, performed on behalf of a submodel instance
+     * @param instance_id instance_id of the CUDASimulation instance
+     */
+    UploadCounters getUploadCounters(const unsigned int &instance_id) const;
 
  private:
     /**
@@ -654,24 +690,105 @@ class EnvironmentManager {
      */
     void newProperty(const NamePair &name, const char *ptr, const size_t &len, const bool &isConst, const size_type &elements, const std::type_index &type);
     /**
-     * Cleanup freeFragments
-     * @param curve The curve instance to use (important if thread has cuda device set wrong)
-     * @param mergeProps Used by init to defragement whilst merging in new data
-     * @param newmaps Namepairs of newly mapped properties, yet to to be setup (essentially ones not yet registered in curve)
-     * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
-     * @note any EnvPROP
+     * Common init handler, creates the instance's segment and stores it's unmapped properties
+     * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
+     * @param master_instance_id instance_id of the parent model, or instance_id if the instance is not a submodel
+     * @param desc environment properties description to use
+     * @param mapping Metadata for which environment properties are mapped between master and submodels, nullptr if not a submodel
+     * @note Lock mutex before calling this method
+     */
+    void initSegment(const unsigned int &instance_id, const unsigned int &master_instance_id, const EnvironmentDescription &desc, const SubEnvironmentData *mapping);
+    /**
+     * Reserves a region of c_buffer for a new segment
+     * If insufficient contiguous space remains, the largest free region is reserved instead, and properties which do not fit overflow to global memory
+     * @param len The requested length of the segment, this should be a multiple of sizeof(void*)
+     * @return The offset and length of the reserved region
+     * @note Lock mutex before calling this method
+     */
+    OffsetLen reserveSegment(const size_t &len);
+    /**
+     * Allocates storage for a new property within a segment, and copies it's data into the segment's host storage
+     * The property is stored in the segment's constant buffer region if it is small enough and fits, otherwise it overflows to global memory
+     * @param segment The segment to store the property
+     * @param ptr Host pointer to the property's data
+     * @param length Length of the property's data
+     * @param typeSize Size of the property's base type, this is used for alignment
+     * @param[out] overflow Set to true if the property has overflowed to global memory
+     * @return Offset of the property within the selected storage
+     * @note Lock mutex before calling this method
+     */
+    static ptrdiff_t storeProperty(EnvSegment &segment, const char *ptr, const size_t &length, const size_t &typeSize, bool &overflow);
+    /**
+     * Ensures that the segment's device overflow buffer can hold it's host overflow buffer, reallocating it if required
+     * @param segment The segment to update
+     * @return true if d_overflow was reallocated, this invalidates the locations registered with curve and the rtc cache
+     * @note Lock mutex before calling this method
+     */
+    static bool allocateOverflow(EnvSegment &segment);
+    /**
+     * Updates the locations registered with curve, and stored in the rtc cache, of properties stored in the instance's overflow buffer
+     * Also updates any properties mapped to them
+     * @param curve The curve instance to use
+     * @param instance_id Instance id of the segment whose overflow buffer was reallocated
+     * @note Lock mutex before calling this method
+     */
+    void relocateOverflow(detail::curve::Curve &curve, const unsigned int &instance_id);
+    /**
+     * Returns the location of a property which is registered with curve
+     * This is an offset into c_buffer for properties stored in the constant buffer, otherwise a device pointer
+     * @param name Name of an unmapped property
+     * @note Lock mutex before calling this method
+     */
+    void *getDeviceLocation(const NamePair &name) const;
+    /**
+     * Registers a property with curve, at the location of the property which stores it's data
+     * @param curve The curve instance to use
+     * @param name Name of the property to register
+     * @param owner Name of the property which stores the data, this differs from name if the property is mapped
+     * @note Lock mutex before calling this method
+     */
+    void registerCurveVariable(detail::curve::Curve &curve, const NamePair &name, const NamePair &owner);
+    /**
+     * Returns the name of the property which stores the named property's data
+     * This is the (ultimate) master property if the named property is mapped, otherwise name
+     * @param name name used for accessing the property
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
+     * @note Lock mutex before calling this method
+     */
+    const NamePair &getOwner(const NamePair &name) const;
+    /**
+     * Copies data into a property, updating the rtc cache and flagging the owning segment for upload
+     * @param name name used for accessing the property, this may be a mapped property
+     * @param src Host pointer to the data to copy
+     * @param offset Offset in bytes within the property to copy to
+     * @param len Number of bytes to copy
+     * @param old If not nullptr, the previous value is copied here before it is overwritten
+     */
+    void writeProperty(const NamePair &name, const void *src, const size_t &offset, const size_t &len, void *old);
+    /**
+     * Copies data out of a property
+     * @param name name used for accessing the property, this may be a mapped property
+     * @param dst Host pointer to copy the data to
+     * @param offset Offset in bytes within the property to copy from
+     * @param len Number of bytes to copy
      */
-    void defragment(detail::curve::Curve &curve, const DefragMap * mergeProps = nullptr, std::set<NamePair> newmaps = {}, bool isPureRTC = false);
+    void readProperty(const NamePair &name, void *dst, const size_t &offset, const size_t &len) const;
     /**
-     * This is the RTC version of defragment()
+     * Lays out the rtc cache for the named instance
      * RTC Constant offsets are fixed at RTC time, and exist in their own constant block.
-     * Therefore if the main constant cache is defragmented, and offsets change, the RTC constants will be incorrect.
      * Which fix this by maintaining a seperate constant cache per CUDASimulation instance
+     * Properties stored in global memory, are represented in the rtc cache by a device pointer to their data
      * @param instance_id Instance id of the cuda agent model that owns the properties
      * @param master_instance_id Instance id of the parent model (If this isn't a submodel, pass instance_id here too
-     * @param mergeProperties Ordered map of properties to be stored.
+     * @param orderedProperties Names of the (unmapped) properties to be stored, in order of decreasing alignment requirement
      */
-    void buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const DefragMap &mergeProperties);
+    void buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const std::vector<NamePair> &orderedProperties);
+    /**
+     * Copies a property's current value (or device pointer if it's stored in global memory) into the rtc cache
+     * @param cache The rtc cache to update
+     * @param name Name of an unmapped property
+     */
+    void writeRTCValue(RTCEnvPropCache &cache, const NamePair &name);
     /**
      * Returns the rtccache ptr for the named instance id
      * @param instance_id Instance id of the cuda agent model that owns the properties
@@ -686,21 +803,13 @@ class EnvironmentManager {
      */
     const char *c_buffer;
     /**
-     * Host copy of the device memory pointed to by c_buffer
-     */
-    char hc_buffer[MAX_BUFFER_SIZE];
-    /**
-     * Offset relative to c_buffer, where no more data has been stored
+     * Manages the regions of c_buffer reserved by segments
      */
-    ptrdiff_t nextFree;
+    util::detail::FreeListAllocator c_segments;
     /**
-     * Unused space within c_buffer, including gaps in freeFragments
+     * Storage of each CUDASimulation instance's properties
      */
-    size_t m_freeSpace;
-    /**
-     * List of fragments remaining from deleted environment variables
-     */
-    std::list<OffsetLen> freeFragments;
+    std::unordered_map<unsigned int, std::unique_ptr<EnvSegment>> segments;
     /**
      * Host copy of data related to each stored property
      */
@@ -722,20 +831,12 @@ class EnvironmentManager {
      * Flag indicating that curve has/hasn't been initialised yet on a device.
      */
     bool deviceInitialised;
-    /*
-     * Convenience fn for managing deviceRequiresUpdate
-     * @param instance_id Sim instance id, UINT_MAX sets all
-     */
-    void setDeviceRequiresUpdateFlag(const unsigned int &instance_id = UINT_MAX);
     /**
      * These flags control what happens when updateDevice() is called
      * Their primary purpose is to cause the device memory to updated as lazily as possible
+     * Whether the segment's themselves require updating is tracked by EnvSegment
      */
     struct EnvUpdateFlags {
-        /**
-         * Update the device constant cache for main C env var storage
-         */
-        bool c_update_required = true;
         /**
          * Update the RTC environment cache for a specific CUDASimulation instance
          */
@@ -746,27 +847,41 @@ class EnvironmentManager {
          * As properties are registered with curve when they are first added to EnvironmentManager
          **/
         bool curve_registration_required = false;
+        /**
+         * Copies performed by updateDevice() for the instance
+         */
+        UploadCounters uploads;
     };
     /**
      * Flag indicating whether the device copy is upto date
-     * sim_instance_id:(C needs update, RTC needs update)
+     * sim_instance_id:(RTC needs update, curve registration required)
      */
     std::unordered_map<unsigned int, EnvUpdateFlags> deviceRequiresUpdate;
     /**
      * Function to initialise device-side portions of the environment manager
      */
     void initialiseDevice();
+    /**
+     * Copies each modified range of a host buffer to the device, and then clears the ranges
+     * @param dirty The modified ranges of h_buffer
+     * @param d_ptr Device copy of h_buffer
+     * @param h_buffer The host buffer
+     * @param counters Incremented by the copies performed
+     * @note You must acquire a lock on the owning segment's mutex before calling this method
+     */
+    static void uploadRanges(util::detail::DirtyRanges &dirty, char *d_ptr, const std::vector<char> &h_buffer, UploadCounters &counters);
     /**
      * Managed multi-threaded access to the internal storage
      * All read-only methods take a shared-lock
      * All methods which modify the internals require a unique-lock
+     * Methods which only read or write property data, only require a shared-lock, and instead lock the affected segment
      * Some private methods expect a lock to be gained before calling (to prevent the same thread attempting to lock the mutex twice)
      */
     mutable std::shared_timed_mutex mutex;
     std::shared_lock<std::shared_timed_mutex> getSharedLock() const { return std::shared_lock<std::shared_timed_mutex>(mutex); }
     std::unique_lock<std::shared_timed_mutex> getUniqueLock() const { return std::unique_lock<std::shared_timed_mutex>(mutex); }
     /**
-     * This mutex exists to stop defrag being called, between curve being updated, and an agent function executing
+     * This mutex exists to stop curve registrations being changed, between curve being updated, and an agent function executing
      */
     mutable std::shared_timed_mutex device_mutex;
     std::shared_lock<std::shared_timed_mutex> getDeviceSharedLock() const { return std::shared_lock<std::shared_timed_mutex>(device_mutex); }
@@ -860,24 +975,9 @@ T EnvironmentManager::setProperty(const NamePair &name, const T &value) {
             "in EnvironmentManager::set().",
             name.first, name.second.c_str());
     }
-    // Copy old data to return
-    T rtn = getProperty<T>(name);
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
-    // Store data
-    memcpy(hc_buffer + buffOffset, &value, sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
-
+    // Store data, copying old data to return
+    T rtn;
+    writeProperty(name, &value, 0, sizeof(T), &rtn);
     return rtn;
 }
 template<typename T>
@@ -903,24 +1003,9 @@ std::array<T, N> EnvironmentManager::setProperty(const NamePair &name, const std
             "in EnvironmentManager::set().",
             array_len, N);
     }
-    // Copy old data to return
-    std::array<T, N> rtn = getProperty<T, N>(name);
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
-    // Store data
-    memcpy(hc_buffer + buffOffset, value.data(), N * sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
-
+    // Store data, copying old data to return
+    std::array<T, N> rtn;
+    writeProperty(name, value.data(), 0, N * sizeof(T), rtn.data());
     return rtn;
 }
 template<typename T, EnvironmentManager::size_type N>
@@ -947,29 +1032,9 @@ std::vector<T> EnvironmentManager::setPropertyArray(const NamePair& name, const
             "in EnvironmentManager::set().",
             array_len, value.size());
     }
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
-    // Copy old data to return
+    // Store data, copying old data to return
     std::vector<T> rtn(value.size());
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + buffOffset), array_len * sizeof(T));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + buffOffset), array_len * sizeof(T));
-    }
-    // Store data
-    memcpy(hc_buffer + buffOffset, value.data(), value.size() * sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
-
+    writeProperty(name, value.data(), 0, value.size() * sizeof(T), rtn.data());
     return rtn;
 }
 #endif
@@ -992,25 +1057,9 @@ T EnvironmentManager::setProperty(const NamePair &name, const size_type &index,
             "in EnvironmentManager::set().",
             index, array_len);
     }
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset + index * sizeof(T);
-    } else {
-        const auto &master_name = mapped_properties.at(name).masterProp;
-        buffOffset = properties.at(master_name).offset + index * sizeof(T);
-    }
-    // Copy old data to return
-    T rtn = *reinterpret_cast<T*>(hc_buffer + buffOffset);
-    // Store data
-    memcpy(hc_buffer + buffOffset, &value, sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
-
+    // Store data, copying old data to return
+    T rtn;
+    writeProperty(name, &value, index * sizeof(T), sizeof(T), &rtn);
     return rtn;
 }
 template<typename T>
@@ -1033,12 +1082,10 @@ T EnvironmentManager::getProperty(const NamePair &name) {
             "in EnvironmentManager::get().",
             name.first, name.second.c_str(), typ_id.name(), typeid(T).name());
     }
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    // Copy old data to return
-    const auto a = properties.find(name);
-    if (a != properties.end())
-        return *reinterpret_cast<T*>(hc_buffer + a->second.offset);
-    return *reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset);
+    // Copy data to return
+    T rtn;
+    readProperty(name, &rtn, 0, sizeof(T));
+    return rtn;
 }
 template<typename T>
 T EnvironmentManager::getProperty(const unsigned int &instance_id, const std::string &var_name) {
@@ -1062,15 +1109,9 @@ std::array<T, N> EnvironmentManager::getProperty(const NamePair &name) {
             "in EnvironmentManager::get().",
             array_len, N);
     }
-    // Copy old data to return
+    // Copy data to return
     std::array<T, N> rtn;
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + a->second.offset), N * sizeof(T));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset), N * sizeof(T));
-    }
+    readProperty(name, rtn.data(), 0, N * sizeof(T));
     return rtn;
 }
 template<typename T, EnvironmentManager::size_type N>
@@ -1095,12 +1136,10 @@ T EnvironmentManager::getProperty(const NamePair &name, const size_type &index)
             "in EnvironmentManager::set().",
             index, array_len);
     }
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    // Copy old data to return
-    const auto a = properties.find(name);
-    if (a != properties.end())
-        return *reinterpret_cast<T*>(hc_buffer + a->second.offset + index * sizeof(T));
-    return *reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset + index * sizeof(T));
+    // Copy data to return
+    T rtn;
+    readProperty(name, &rtn, index * sizeof(T), sizeof(T));
+    return rtn;
 }
 #ifdef SWIG
 template<typename T>
@@ -1116,15 +1155,9 @@ std::vector<T> EnvironmentManager::getPropertyArray(const NamePair& name) {
             name.first, name.second.c_str(), typ_id.name(), typeid(T).name());
     }
     const size_type array_len = length(name);
-    // Copy old data to return
+    // Copy data to return
     std::vector<T> rtn(static_cast<size_t>(array_len));
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + a->second.offset), array_len * sizeof(T));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset), array_len * sizeof(T));
-    }
+    readProperty(name, rtn.data(), 0, array_len * sizeof(T));
     return rtn;
 }
 #endif
@@ -0,0 +1,247 @@
+#ifndef INCLUDE_FLAMEGPU_RUNTIME_UTILITY_PHILOXRANDOM_CUH_
+#define INCLUDE_FLAMEGPU_RUNTIME_UTILITY_PHILOXRANDOM_CUH_
+
+#ifndef __CUDACC_RTC__
+#include <cmath>
+#include <cstdint>
+#include <string>
+#endif  // __CUDACC_RTC__
+
+#include "flamegpu/defines.h"
+#include "flamegpu/util/detail/StaticAssert.h"
+
+namespace flamegpu {
+
+/**
+ * Counter-based random number generator, using the Philox4x32-10 bijection
+ *
+ * Rather than advancing a stored state, each value is generated directly from a key and a counter.
+ * When CUDASimulation::Config::counterBasedRandom is enabled, agent functions generate random numbers in this way,
+ * keyed on the simulation's seed, and counted by the agent's id, the step, the agent function and the number of
+ * random numbers previously generated by the agent within the agent function.
+ * Therefore, the random numbers an agent receives do not depend on which thread executes it, and no per-thread state is stored.
+ *
+ * The same implementation is available on the host, so that the random numbers generated by an agent can be reproduced.
+ * Uniform distributions produce identical values on the host and device, however the normal and log-normal distributions
+ * depend on transcendental functions, so may differ in their least significant bits.
+ * @see AgentRandom
+ */
+class PhiloxRandom {
+ public:
+    /**
+     * Components of the Philox key and counter which are shared by all agents executing an agent function
+     */
+    struct Key {
+        /**
+         * Random seed of the simulation
+         */
+        uint64_t seed;
+        /**
+         * Step during which the agent function is executing
+         */
+        unsigned int step;
+        /**
+         * Identifies the agent function (or agent function condition)
+         * @see agentFunctionStream()
+         */
+        unsigned int stream;
+    };
+    /**
+     * A single output of the Philox bijection
+     */
+    struct Block {
+        unsigned int v[4];
+    };
+    /**
+     * Constructs the random stream of an agent during the execution of an agent function
+     * @param key Components of the key and counter shared by the agent function
+     * @param agent_id The id of the agent
+     */
+    __host__ __device__ __forceinline__ PhiloxRandom(const Key &key, id_t agent_id);
+    /**
+     * Constructs the random stream of an agent during the execution of an agent function
+     * @param seed Random seed of the simulation
+     * @param agent_id The id of the agent
+     * @param step Step during which the agent function is executing
+     * @param stream Identifies the agent function (or agent function condition)
+     */
+    __host__ __device__ __forceinline__ PhiloxRandom(uint64_t seed, id_t agent_id, unsigned int step, unsigned int stream);
+    /**
+     * Returns a float uniformly distributed between 0.0 and 1.0.
+     * @note It may return from 0.0 to 1.0, where 1.0 is included and 0.0 is excluded.
+     * @note Available as float or double
+     */
+    template<typename T>
+    __host__ __device__ __forceinline__ T uniform();
+    /**
+     * Returns a normally distributed float with mean 0.0 and standard deviation 1.0.
+     * @note Available as float or double
+     */
+    template<typename T>
+    __host__ __device__ __forceinline__ T normal();
+    /**
+     * Returns a log-normally distributed float based on a normal distribution with the given mean and standard deviation.
+     * @note Available as float or double
+     */
+    template<typename T>
+    __host__ __device__ __forceinline__ T logNormal(const T& mean, const T& stddev);
+    /**
+     * Returns an integer uniformly distributed in the inclusive range [min, max]
+     * @note Available as signed and unsigned: char, short, int, long long
+     */
+    template<typename T>
+    __host__ __device__ __forceinline__ T uniform(const T& min, const T& max);
+    /**
+     * Returns the next block of 4 random 32-bit integers, and advances the call index
+     * Each of the above distributions consumes a single block
+     */
+    __host__ __device__ __forceinline__ Block next();
+    /**
+     * Returns the number of blocks which have been generated
+     */
+    __host__ __device__ __forceinline__ unsigned int getCallIndex() const { return call_index; }
+    /**
+     * Applies the Philox4x32-10 bijection to a counter
+     * @param counter The 128-bit counter
+     * @param key The 64-bit key
+     */
+    __host__ __device__ __forceinline__ static Block philox4x32_10(Block counter, const unsigned int key[2]);
+#ifndef __CUDACC_RTC__
+    /**
+     * Returns the value of Key::stream used by an agent function
+     * @param agent_name Name of the agent
+     * @param func_name Name of the agent function
+     * @param condition If true, the value used by the agent function's condition is returned
+     */
+    static unsigned int agentFunctionStream(const std::string &agent_name, const std::string &func_name, bool condition = false) {
+        // FNV-1a, as the value must be independent of the simulation's instance
+        const std::string name = agent_name + "::" + func_name + (condition ? "::condition" : "");
+        unsigned int hash = 2166136261u;
+        for (const char &c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+#endif  // __CUDACC_RTC__
+
+ private:
+    /**
+     * Philox round multipliers and key increments, as defined by Salmon et al. (2011)
+     */
+    static const unsigned int M0 = 0xD2511F53u;
+    static const unsigned int M1 = 0xCD9E8D57u;
+    static const unsigned int W0 = 0x9E3779B9u;
+    static const unsigned int W1 = 0xBB67AE85u;
+    /**
+     * Returns the high 32 bits of the product a * b
+     */
+    __host__ __device__ __forceinline__ static unsigned int mulhi(unsigned int a, unsigned int b);
+    /**
+     * Key, formed from the seed
+     */
+    unsigned int key[2];
+    /**
+     * Agent id, step and stream, which form the remainder of the counter
+     */
+    unsigned int id, step, stream;
+    /**
+     * Number of blocks generated, forms the first word of the counter
+     */
+    unsigned int call_index = 0;
+};
+
+__host__ __device__ __forceinline__ PhiloxRandom::PhiloxRandom(const Key &_key, id_t agent_id)
+    : PhiloxRandom(_key.seed, agent_id, _key.step, _key.stream) { }
+__host__ __device__ __forceinline__ PhiloxRandom::PhiloxRandom(uint64_t seed, id_t agent_id, unsigned int _step, unsigned int _stream)
+    : key{ static_cast<unsigned int>(seed), static_cast<unsigned int>(seed >> 32) }
+    , id(agent_id)
+    , step(_step)
+    , stream(_stream) { }
+
+__host__ __device__ __forceinline__ unsigned int PhiloxRandom::mulhi(unsigned int a, unsigned int b) {
+#ifdef __CUDA_ARCH__
+    return __umulhi(a, b);
+#else
+    return static_cast<unsigned int>((static_cast<uint64_t>(a) * b) >> 32);
+#endif
+}
+__host__ __device__ __forceinline__ PhiloxRandom::Block PhiloxRandom::philox4x32_10(Block c, const unsigned int _key[2]) {
+    unsigned int k0 = _key[0], k1 = _key[1];
+    for (int round = 0; round < 10; ++round) {
+        const unsigned int hi0 = mulhi(M0, c.v[0]);
+        const unsigned int lo0 = M0 * c.v[0];
+        const unsigned int hi1 = mulhi(M1, c.v[2]);
+        const unsigned int lo1 = M1 * c.v[2];
+        c = Block{ { hi1 ^ c.v[1] ^ k0, lo1, hi0 ^ c.v[3] ^ k1, lo0 } };
+        k0 += W0;
+        k1 += W1;
+    }
+    return c;
+}
+__host__ __device__ __forceinline__ PhiloxRandom::Block PhiloxRandom::next() {
+    return philox4x32_10(Block{ { call_index++, stream, id, step } }, key);
+}
+
+/**
+ * Uniform floating point
+ * Scaled such that 0.0 is excluded and 1.0 included, matching curand, the conversions are exact so results match on host and device
+ */
+template<>
+__host__ __device__ __forceinline__ float PhiloxRandom::uniform() {
+    return static_cast<float>(next().v[0] >> 8) * 5.9604645e-08f + 5.9604645e-08f;  // 2^-24
+}
+template<>
+__host__ __device__ __forceinline__ double PhiloxRandom::uniform() {
+    const Block b = next();
+    const uint64_t x = (static_cast<uint64_t>(b.v[0]) << 32 | b.v[1]) >> 11;
+    return static_cast<double>(x) * 1.1102230246251565e-16 + 1.1102230246251565e-16;  // 2^-53
+}
+/**
+ * Normal floating point, Box-Muller transform of a single block (the second value is discarded)
+ */
+template<>
+__host__ __device__ __forceinline__ float PhiloxRandom::normal() {
+    const Block b = next();
+    const float u1 = static_cast<float>(b.v[0] >> 8) * 5.9604645e-08f + 5.9604645e-08f;
+    const float u2 = static_cast<float>(b.v[1] >> 8) * 5.9604645e-08f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+template<>
+__host__ __device__ __forceinline__ double PhiloxRandom::normal() {
+    const Block b = next();
+    const double u1 = static_cast<double>((static_cast<uint64_t>(b.v[0]) << 32 | b.v[1]) >> 11) * 1.1102230246251565e-16 + 1.1102230246251565e-16;
+    const double u2 = static_cast<double>((static_cast<uint64_t>(b.v[2]) << 32 | b.v[3]) >> 11) * 1.1102230246251565e-16;
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+/**
+ * Log Normal floating point
+ */
+template<>
+__host__ __device__ __forceinline__ float PhiloxRandom::logNormal(const float& mean, const float& stddev) {
+    return expf(mean + stddev * normal<float>());
+}
+template<>
+__host__ __device__ __forceinline__ double PhiloxRandom::logNormal(const double& mean, const double& stddev) {
+    return exp(mean + stddev * normal<double>());
+}
+/**
+ * Uniform Int, matches the scaling used by AgentRandom
+ */
+template<typename T>
+__host__ __device__ __forceinline__ T PhiloxRandom::uniform(const T& min, const T& max) {
+    static_assert(util::detail::StaticAssert::_Is_IntType<T>::value, "Invalid template argument for PhiloxRandom::uniform(const T& lowerBound, const T& max)");
+    return static_cast<T>(min + (max - min) * uniform<float>());
+}
+template<>
+__host__ __device__ __forceinline__ int64_t PhiloxRandom::uniform(const int64_t& min, const int64_t& max) {
+    return static_cast<int64_t>(min + (max - min) * uniform<double>());
+}
+template<>
+__host__ __device__ __forceinline__ uint64_t PhiloxRandom::uniform(const uint64_t& min, const uint64_t& max) {
+    return static_cast<uint64_t>(min + (max - min) * uniform<double>());
+}
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_RUNTIME_UTILITY_PHILOXRANDOM_CUH_
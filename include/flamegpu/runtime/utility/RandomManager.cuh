@@ -3,6 +3,7 @@
 
 #include <curand_kernel.h>
 #include <cstdint>
+#include <mutex>
 #include <random>
 #include <string>
 
@@ -83,6 +84,14 @@ class RandomManager {
      * Returns length of curand state array currently allocated
      */
     size_type size();
+    /**
+     * Returns the device memory currently allocated to the curand state array, in bytes
+     */
+    size_t getDeviceMemoryUsage() const { return static_cast<size_t>(length) * sizeof(curandState); }
+    /**
+     * Returns the host memory currently allocated to hold curand states which have been shrunk away from the device, in bytes
+     */
+    size_t getHostMemoryUsage() const { return static_cast<size_t>(h_max_random_size) * sizeof(curandState); }
     uint64_t seed();
     curandState *cudaRandomState();
 
@@ -138,6 +147,10 @@ class RandomManager {
      * @note - std::default_random_engine is platform (compiler) specific. GCC (7.4) defaults to a linear_congruential_engine, which returns the same sequence for seeds 0 and 1. mt19937 is the default in MSVC and generally seems more sane (but using the 64 bit variant).
      */
     std::mt19937_64 host_rng;
+    /**
+     * Protects host_rng, as concurrent host functions may generate random numbers from separate threads
+     */
+    std::mutex host_rng_mutex;
 
     /**
      * Flag indicating that the device memory has been initialised, and therefore might need resetting
@@ -185,6 +198,7 @@ class RandomManager {
 
 template<typename T, typename dist>
 T RandomManager::getDistribution(dist &distribution) {
+    std::lock_guard<std::mutex> lock(host_rng_mutex);
     return distribution(host_rng);
 }
 
@@ -6,6 +6,8 @@
 #include <set>
 #include <mutex>
 #include <utility>
+#include <map>
+#include <vector>
 
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/AgentLoggingConfig_Reductions.cuh"
@@ -180,20 +182,66 @@ util::Any getAgentVariableMaxFunc(HostAgentAPI &ai, const std::string &variable_
     return util::Any(ai.max<T>(variable_name));
 }
 
+namespace detail {
+/**
+ * Calculates the standard deviation of an agent variable, given it's mean
+ */
 template<typename T>
-util::Any getAgentVariableStandardDevFunc(HostAgentAPI &ai, const std::string &variable_name) {
+double getAgentVariableStandardDev(HostAgentAPI &ai, const std::string &variable_name, const double mean) {
     // Todo, workout how to make this more multi-thread/deviceable.
     // Todo, streams for the memcpy?
-    // Work out the Mean
-    const double mean = ai.sum<T, typename sum_input_t<T>::result_t>(variable_name) / static_cast<double>(ai.count());
-    // Then for each number: subtract the Mean and square the result
+    // For each number: subtract the Mean and square the result
     // Then work out the mean of those squared differences.
     auto lock = std::unique_lock<std::mutex>(detail::STANDARD_DEVIATION_MEAN_mutex);
     gpuErrchk(cudaMemcpyToSymbol(detail::STANDARD_DEVIATION_MEAN, &mean, sizeof(double)));
     const double variance = ai.transformReduce<T, double>(variable_name, detail::standard_deviation_subtract_mean, detail::standard_deviation_add, 0) / static_cast<double>(ai.count());
     lock.unlock();
     // Take the square root of that and we are done!
-    return util::Any(sqrt(variance));
+    return sqrt(variance);
+}
+}  // namespace detail
+
+template<typename T>
+util::Any getAgentVariableStandardDevFunc(HostAgentAPI &ai, const std::string &variable_name) {
+    // Work out the Mean
+    const double mean = ai.sum<T, typename sum_input_t<T>::result_t>(variable_name) / static_cast<double>(ai.count());
+    return util::Any(detail::getAgentVariableStandardDev<T>(ai, variable_name, mean));
+}
+/**
+ * @brief FLAMEGPU log batch reduction function pointer definition
+ *  Calculates every reduction of variables of type T using HostAgentAPI::multiReduce(), so each variable is only read once
+ *  Mean and standard deviation are derived from the fused sum, standard deviation requires an additional pass
+ */
+template<typename T>
+void getAgentVariableMultiReductionFunc(HostAgentAPI &ai, const std::vector<LoggingConfig::NameReductionFn> &reductions, std::map<LoggingConfig::NameReductionFn, util::Any> &results) {
+    typedef typename sum_input_t<T>::result_t sum_t;
+    std::vector<ReductionRequest> requests;
+    requests.reserve(reductions.size());
+    for (const auto &r : reductions) {
+        const ReductionRequest::Op op = r.reduction == LoggingConfig::Min ? ReductionRequest::Min :
+            r.reduction == LoggingConfig::Max ? ReductionRequest::Max : ReductionRequest::Sum;
+        requests.push_back({r.name, op});
+    }
+    const std::vector<sum_t> values = ai.multiReduce<T, sum_t>(requests);
+    const double count = static_cast<double>(ai.count());
+    for (size_t i = 0; i < reductions.size(); ++i) {
+        const auto &r = reductions[i];
+        switch (r.reduction) {
+        case LoggingConfig::Mean:
+            results.emplace(r, util::Any(values[i] / count));
+            break;
+        case LoggingConfig::StandardDev:
+            results.emplace(r, util::Any(detail::getAgentVariableStandardDev<T>(ai, r.name, values[i] / count)));
+            break;
+        case LoggingConfig::Min:
+        case LoggingConfig::Max:
+            results.emplace(r, util::Any(static_cast<T>(values[i])));
+            break;
+        case LoggingConfig::Sum:
+            results.emplace(r, util::Any(values[i]));
+            break;
+        }
+    }
 }
 
 template<typename T>
@@ -201,35 +249,35 @@ void AgentLoggingConfig::logMean(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMeanFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Mean, fn}, std::type_index(typeid(T)), "Mean");
+    log({variable_name, LoggingConfig::Mean, fn, getAgentVariableMultiReductionFunc<T>}, std::type_index(typeid(T)), "Mean");
 }
 template<typename T>
 void AgentLoggingConfig::logStandardDev(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableStandardDevFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::StandardDev, fn}, std::type_index(typeid(T)), "StandardDev");
+    log({variable_name, LoggingConfig::StandardDev, fn, getAgentVariableMultiReductionFunc<T>}, std::type_index(typeid(T)), "StandardDev");
 }
 template<typename T>
 void AgentLoggingConfig::logMin(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMinFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Min, fn}, std::type_index(typeid(T)), "Min");
+    log({variable_name, LoggingConfig::Min, fn, getAgentVariableMultiReductionFunc<T>}, std::type_index(typeid(T)), "Min");
 }
 template<typename T>
 void AgentLoggingConfig::logMax(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMaxFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Max, fn}, std::type_index(typeid(T)), "Max");
+    log({variable_name, LoggingConfig::Max, fn, getAgentVariableMultiReductionFunc<T>}, std::type_index(typeid(T)), "Max");
 }
 template<typename T>
 void AgentLoggingConfig::logSum(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableSumFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Sum, fn}, std::type_index(typeid(T)), "Sum");
+    log({variable_name, LoggingConfig::Sum, fn, getAgentVariableMultiReductionFunc<T>}, std::type_index(typeid(T)), "Sum");
 }
 
 }  // namespace flamegpu
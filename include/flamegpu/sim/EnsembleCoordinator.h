@@ -0,0 +1,165 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_ENSEMBLECOORDINATOR_H_
+#define INCLUDE_FLAMEGPU_SIM_ENSEMBLECOORDINATOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/sim/EnsembleProtocol.h"
+#include "flamegpu/util/detail/Socket.h"
+
+namespace flamegpu {
+
+struct RunLog;
+
+/**
+ * The coordinator of a distributed ensemble, which assigns runs to workers and collects their logs
+ *
+ * This class is used by CUDAEnsemble when EnsembleConfig::listen_address is set, in place of SimRunner instances.
+ * Workers may connect at any time, each requests runs until every run has completed. If a worker's connection closes (e.g. the process exits),
+ * the runs assigned to it which have not returned a result are assigned to the remaining (or future) workers.
+ * Messages are received incrementally from whichever workers are readable, so a worker which is slow to send a (large) message does not delay the others.
+ * @see EnsembleProtocol
+ */
+class EnsembleCoordinator {
+    friend class CUDAEnsemble;
+    /**
+     * Constructs a new EnsembleCoordinator, which listens for workers
+     * @param address Address to listen on, of the form "host:port"
+     * @param model_name Name of the model, workers must match this
+     * @param verbose If true more information will be written to stdout
+     * @param run_logs Reference to the vector to store received run logs, it's length is the number of runs
+     * @param run_failed Reference to the vector to flag runs which fail
+     * @param log_export_queue The queue of logs to exported to disk
+     * @param log_export_queue_mutex This mutex must be locked to access log_export_queue
+     * @param log_export_queue_cdn The condition is notified every time a log has been added to the queue
+     * @throws exception::EnsembleNetworkError If the address could not be listened on
+     */
+    EnsembleCoordinator(const std::string &address,
+        const std::string &model_name,
+        bool verbose,
+        std::vector<RunLog> &run_logs,
+        std::vector<unsigned char> &run_failed,
+        std::queue<unsigned int> &log_export_queue,
+        std::mutex &log_export_queue_mutex,
+        std::condition_variable &log_export_queue_cdn);
+    /**
+     * Serves workers until every run has completed
+     * @return The number of runs which failed
+     */
+    unsigned int run();
+    /**
+     * The state of a connected worker
+     */
+    struct Worker {
+        explicit Worker(util::detail::Socket &&_socket)
+            : socket(std::move(_socket)) { }
+        util::detail::Socket socket;
+        /**
+         * Unique index of the worker, in the order they connected
+         */
+        unsigned int id = 0;
+        /**
+         * Whether the worker has completed the handshake
+         */
+        bool welcomed = false;
+        /**
+         * The number of requests awaiting an assigned run
+         */
+        unsigned int requests = 0;
+        /**
+         * Runs assigned to the worker, which have not returned a result
+         */
+        std::set<unsigned int> assigned;
+        /**
+         * Holds the partially received message from the worker
+         */
+        EnsembleProtocol::Receiver receiver;
+    };
+    /**
+     * Receives the bytes available from a readable worker, handling the message if it is complete
+     * @return false if the worker's connection closed, or it must be disconnected
+     */
+    bool receive(Worker &worker);
+    /**
+     * Handles a message received from a worker
+     * @return false if the worker must be disconnected
+     * @throws exception::EnsembleNetworkError If the message is malformed, or a reply could not be sent
+     */
+    bool handleMessage(Worker &worker, EnsembleProtocol::Message type, const std::string &payload);
+    /**
+     * Marks a run as complete, and notifies the logger
+     */
+    void complete(unsigned int run_id, bool failed);
+    /**
+     * Returns the runs assigned to a disconnected worker to the queue of unassigned runs
+     */
+    void reassign(Worker &worker);
+    /**
+     * The duration, in seconds, that the coordinator waits for workers to disconnect after every run has completed
+     */
+    static const unsigned int SHUTDOWN_TIMEOUT = 5;
+    /**
+     * The socket listening for workers
+     */
+    util::detail::Socket listener;
+    /**
+     * Name of the model
+     */
+    const std::string model_name;
+    /**
+     * Flag for whether to print progress
+     */
+    const bool verbose;
+    /**
+     * Connected workers
+     */
+    std::list<Worker> workers;
+    /**
+     * Number of workers which have connected
+     */
+    unsigned int worker_count = 0;
+    /**
+     * Runs which are not assigned to a worker
+     */
+    std::deque<unsigned int> unassigned;
+    /**
+     * Number of runs which have completed
+     */
+    unsigned int completed = 0;
+    /**
+     * Number of runs which failed
+     */
+    unsigned int failed = 0;
+    // External references
+    /**
+     * Reference to the vector to store received run logs
+     */
+    std::vector<RunLog> &run_logs;
+    /**
+     * Reference to the vector to flag runs which fail
+     */
+    std::vector<unsigned char> &run_failed;
+    /**
+     * The queue of logs to exported to disk
+     */
+    std::queue<unsigned int> &log_export_queue;
+    /**
+     * This mutex must be locked to access log_export_queue
+     */
+    std::mutex &log_export_queue_mutex;
+    /**
+     * The condition is notified every time a log has been added to the queue
+     */
+    std::condition_variable &log_export_queue_cdn;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_ENSEMBLECOORDINATOR_H_
@@ -0,0 +1,169 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_ENSEMBLEPROTOCOL_H_
+#define INCLUDE_FLAMEGPU_SIM_ENSEMBLEPROTOCOL_H_
+
+#include <cstdint>
+#include <string>
+
+namespace flamegpu {
+
+struct RunLog;
+namespace util {
+namespace detail {
+class Socket;
+}  // namespace detail
+}  // namespace util
+
+/**
+ * Messages exchanged between the coordinator and workers of a distributed ensemble
+ *
+ * Each message is framed by a header holding it's type and the length of it's payload.
+ * Values are written in the byte order of the host, so the coordinator and workers must be built for the same platform.
+ *
+ * A worker opens a connection with Hello, the coordinator replies with Welcome or Reject.
+ * Each runner of the worker then sends Request, the coordinator replies with Assign, or Finished once every run has completed.
+ * After executing an assigned run, the worker sends Result (or Failure if the run threw an exception).
+ * If a worker's connection closes, the runs assigned to it which have not returned a result are assigned to other workers.
+ */
+class EnsembleProtocol {
+ public:
+    /**
+     * Incremented whenever the format of a message changes
+     */
+    static const uint32_t VERSION = 1;
+    /**
+     * The largest payload which will be received (1 GiB), longer messages are treated as malformed
+     * This prevents a corrupt length from exhausting the receiver's memory
+     */
+    static const uint64_t MAX_PAYLOAD = 1ull << 30;
+    /**
+     * Type of a message
+     */
+    enum Message : uint32_t {
+        /**
+         * Worker -> Coordinator, payload: protocol version, plan count, model name
+         */
+        Hello = 1,
+        /**
+         * Coordinator -> Worker, payload: empty
+         */
+        Welcome,
+        /**
+         * Coordinator -> Worker, payload: reason, the connection is closed after sending
+         */
+        Reject,
+        /**
+         * Worker -> Coordinator, payload: empty
+         */
+        Request,
+        /**
+         * Coordinator -> Worker, payload: run index
+         */
+        Assign,
+        /**
+         * Coordinator -> Worker, payload: empty, the connection is closed after sending
+         */
+        Finished,
+        /**
+         * Worker -> Coordinator, payload: run index, RunLog
+         */
+        Result,
+        /**
+         * Worker -> Coordinator, payload: run index, error message
+         */
+        Failure
+    };
+    /**
+     * Sends a message
+     * @param socket The connection to send the message on
+     * @param type The type of the message
+     * @param payload The payload of the message
+     * @throws exception::EnsembleNetworkError If the connection failed, or the payload exceeds MAX_PAYLOAD
+     */
+    static void send(util::detail::Socket &socket, Message type, const std::string &payload = "");
+    /**
+     * Incrementally receives messages from a connection
+     * This allows a receiver serving many connections to read whatever bytes are available from each,
+     * so that a slow or stalled connection midway through a (potentially large) message does not block the others
+     */
+    class Receiver {
+     public:
+        /**
+         * Receives the bytes available on the connection, up to the end of the current message
+         * This only blocks if no bytes are available, so should be called once the socket has been polled as readable
+         * @param socket The connection to receive from
+         * @return false if the connection was closed between messages
+         * @throws exception::EnsembleNetworkError If the connection failed or closed midway through a message, or the message is malformed or exceeds MAX_PAYLOAD
+         * @see util::detail::Socket::poll()
+         */
+        bool receiveSome(util::detail::Socket &socket);
+        /**
+         * Returns whether the current message has been completely received
+         */
+        bool isComplete() const;
+        /**
+         * Returns the completely received message, and begins receiving the next message
+         * @param type Returns the type of the message
+         * @param payload Returns the payload of the message
+         * @throws exception::InvalidOperation If the message has not been completely received
+         */
+        void take(Message &type, std::string &payload);
+
+     private:
+        /**
+         * Header of the current message, it's type followed by the length of it's payload
+         */
+        char header[sizeof(uint32_t) + sizeof(uint64_t)];
+        /**
+         * Number of bytes of header which have been received
+         */
+        size_t header_received = 0;
+        /**
+         * Payload of the current message, this is allocated once the header has been received
+         */
+        std::string payload;
+        /**
+         * Number of bytes of payload which have been received
+         */
+        size_t payload_received = 0;
+    };
+    /**
+     * Receives a message, blocking until it is available
+     * @param socket The connection to receive the message from
+     * @param type Returns the type of the message
+     * @param payload Returns the payload of the message
+     * @return false if the connection was closed
+     * @throws exception::EnsembleNetworkError If the connection failed, or the message is malformed or exceeds MAX_PAYLOAD
+     */
+    static bool receive(util::detail::Socket &socket, Message &type, std::string &payload);
+    /**
+     * Appends a value to a payload
+     */
+    static void write(std::string &payload, uint32_t value);
+    static void write(std::string &payload, uint64_t value);
+    static void write(std::string &payload, const std::string &value);
+    /**
+     * Reads a value from a payload
+     * @param payload The payload to read
+     * @param offset Offset of the value within the payload, this is advanced past the value
+     * @throws exception::EnsembleNetworkError If the payload is too short
+     */
+    static uint32_t readUInt32(const std::string &payload, size_t &offset);
+    static uint64_t readUInt64(const std::string &payload, size_t &offset);
+    static std::string readString(const std::string &payload, size_t &offset);
+    /**
+     * Appends a RunLog to a payload
+     * @throws exception::EnsembleNetworkError If the log contains a value of a type which is not supported
+     */
+    static void write(std::string &payload, const RunLog &log);
+    /**
+     * Reads a RunLog from a payload
+     * @param payload The payload to read
+     * @param offset Offset of the RunLog within the payload, this is advanced past the RunLog
+     * @throws exception::EnsembleNetworkError If the payload is malformed
+     */
+    static RunLog readRunLog(const std::string &payload, size_t &offset);
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_ENSEMBLEPROTOCOL_H_
@@ -0,0 +1,95 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_ENSEMBLEWORKER_H_
+#define INCLUDE_FLAMEGPU_SIM_ENSEMBLEWORKER_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "flamegpu/util/detail/Socket.h"
+
+namespace flamegpu {
+
+struct RunLog;
+
+/**
+ * The connection of a distributed ensemble's worker to it's coordinator
+ *
+ * This class is used by CUDAEnsemble when EnsembleConfig::coordinator_address is set, it is shared by all of the worker's SimRunner instances.
+ * Rather than selecting runs from a shared counter, each SimRunner requests the index of it's next run from the coordinator, and returns the RunLog.
+ * @see EnsembleProtocol
+ */
+class EnsembleWorker {
+    friend class CUDAEnsemble;
+    friend class SimRunner;
+    /**
+     * Connects to the coordinator, retrying for up to CONNECT_TIMEOUT seconds if it is not yet listening
+     * @param address Address of the coordinator, of the form "host:port"
+     * @param plan_count The number of plans within the worker's RunPlanVector, this must match the coordinator
+     * @param model_name Name of the worker's model, this must match the coordinator
+     * @throws exception::EnsembleNetworkError If the coordinator could not be reached, or rejected the worker
+     */
+    EnsembleWorker(const std::string &address, unsigned int plan_count, const std::string &model_name);
+    /**
+     * Requests the index of the next run to execute from the coordinator
+     * This is safe to call from multiple threads, replies are interchangeable so each caller takes the next reply to any request
+     * Only the receive path is locked while waiting for a reply, so other runners may return results meanwhile
+     * @param run_id Returns the index of the run
+     * @return false if every run has completed, or the connection was lost
+     */
+    bool nextRun(unsigned int &run_id);
+    /**
+     * Returns the log of a completed run to the coordinator
+     * This is safe to call from multiple threads, if the connection was lost it has no effect
+     * @param run_id Index of the run
+     * @param log The run's log
+     */
+    void sendResult(unsigned int run_id, const RunLog &log);
+    /**
+     * Reports a failed run to the coordinator
+     * This is safe to call from multiple threads, if the connection was lost it has no effect
+     * @param run_id Index of the run
+     * @param message The error which caused the run to fail
+     */
+    void sendFailure(unsigned int run_id, const std::string &message);
+    /**
+     * Sends a message under send_mutex, marking the connection as lost if it fails
+     */
+    void send(int type, const std::string &payload);
+    /**
+     * The duration, in seconds, that the worker retries connecting to the coordinator
+     */
+    static const unsigned int CONNECT_TIMEOUT = 30;
+    /**
+     * Number of plans within the worker's RunPlanVector
+     */
+    const unsigned int plan_count;
+    /**
+     * Connection to the coordinator
+     */
+    util::detail::Socket socket;
+    /**
+     * This mutex must be locked to send on socket
+     */
+    std::mutex send_mutex;
+    /**
+     * This mutex must be locked to receive from socket
+     * It is separate from send_mutex, as a runner waiting for it's next run must not prevent others returning their results
+     */
+    std::mutex receive_mutex;
+    /**
+     * Set once the coordinator has reported that every run has completed
+     */
+    std::atomic<bool> finished = {false};
+    /**
+     * Set if the connection to the coordinator closed before it reported that every run had completed
+     */
+    std::atomic<bool> connection_lost = {false};
+    /**
+     * Number of runs completed by the worker
+     */
+    std::atomic<unsigned int> completed_runs = {0};
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_ENSEMBLEWORKER_H_
@@ -80,6 +80,7 @@ struct LogFrame {
  */
 struct RunLog {
     friend class CUDASimulation;
+    friend class EnsembleProtocol;
     /**
      * Constructs an empty RunLog
      */
@@ -113,6 +114,13 @@ struct RunLog {
      * @note This value is configured via StepLoggingConfig::setFrequency()
      */
     unsigned int getStepLogFrequency() const { return step_log_frequency; }
+    /**
+     * Return the ordered list of per step timing breakdowns
+     * @return The duration (in seconds) of each timed component of each step, keyed by component label
+     * @note This is only populated if CUDASimulation::Config::timingBreakdown was enabled, otherwise it will be empty
+     * @see CUDASimulation::getElapsedTimeStepBreakdowns()
+     */
+    const std::list<std::map<std::string, double>> &getStepTimingLog() const { return step_timing; }
 
  private:
     /**
@@ -131,6 +139,10 @@ struct RunLog {
      * Step log frequency
      */
     unsigned int step_log_frequency = 0;
+    /**
+     * Ordered list of per step timing breakdowns
+     */
+    std::list<std::map<std::string, double>> step_timing;
 };
 /**
  * Frame of logging data related to a specific agent type and state.
@@ -6,6 +6,7 @@
 #include <set>
 #include <utility>
 #include <memory>
+#include <vector>
 
 #include "flamegpu/util/StringPair.h"
 #include "flamegpu/runtime/HostAgentAPI.cuh"
@@ -35,6 +36,10 @@ class LoggingConfig {
      * CUDASimulation::processStepLog() Requires access for reading the config
      */
     friend class CUDASimulation;
+    /**
+     * Requires access for reading the logged agent variables
+     */
+    friend class VariableUsageAnalysis;
 
  public:
     /**
@@ -60,6 +65,12 @@ class LoggingConfig {
      * @note - this leads to a swig warning 504 which is suppressed.
      */
     typedef util::Any (ReductionFn)(HostAgentAPI &ai, const std::string &variable_name);
+    struct NameReductionFn;
+    /**
+     * MultiReductionFn is a prototype for functions which perform a batch of reductions over variables of the same type
+     * Each result is stored in results, keyed by the corresponding member of reductions
+     */
+    typedef void (MultiReductionFn)(HostAgentAPI &ai, const std::vector<NameReductionFn> &reductions, std::map<NameReductionFn, util::Any> &results);
     /**
      * A user configured reduction to be logged
      */
@@ -77,6 +88,11 @@ class LoggingConfig {
          * (Reduction functions are templated so much be instantiated)
          */
         ReductionFn *function;
+        /**
+         * Pointer to instantiated batch reduction function for the variable's type
+         * Reductions which share a multi_function are calculated together, by a single fused pass
+         */
+        MultiReductionFn *multi_function;
         /**
          * Generic ordering function, to allow instances of this type to be stored in ordered collections
          * The defined order is not important
@@ -208,6 +208,8 @@ void RunPlan::setProperty(const std::string &name, const T&value) {
             name.c_str(), it->second.data.elements);
     }
     // Store property
+    // Any can't be assigned, so replace any existing override
+    property_overrides.erase(name);
     property_overrides.emplace(name, util::Any(&value, sizeof(T), typeid(T), 1));
 }
 template<typename T, EnvironmentManager::size_type N>
@@ -230,6 +232,8 @@ void RunPlan::setProperty(const std::string &name, const std::array<T, N> &value
             name.c_str(), it->second.data.elements, N);
     }
     // Store property
+    // Any can't be assigned, so replace any existing override
+    property_overrides.erase(name);
     property_overrides.emplace(name, util::Any(value.data(), sizeof(T) * N, typeid(T), N));
 }
 template<typename T>
@@ -285,6 +289,8 @@ void RunPlan::setPropertyArray(const std::string &name, const EnvironmentManager
             name.c_str(), value.size(), N);
     }
     // Store property
+    // Any can't be assigned, so replace any existing override
+    property_overrides.erase(name);
     property_overrides.emplace(name, util::Any(value.data(), sizeof(T) * N, typeid(T), N));
 }
 #endif
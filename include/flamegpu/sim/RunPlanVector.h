@@ -1,6 +1,12 @@
 #ifndef INCLUDE_FLAMEGPU_SIM_RUNPLANVECTOR_H_
 #define INCLUDE_FLAMEGPU_SIM_RUNPLANVECTOR_H_
 
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <random>
 #include <vector>
 #include <unordered_map>
@@ -8,6 +14,7 @@
 #include <memory>
 
 #include "flamegpu/sim/RunPlan.h"
+#include "flamegpu/runtime/utility/PhiloxRandom.cuh"
 #include "flamegpu/util/detail/StaticAssert.h"
 
 
@@ -19,11 +26,16 @@ class EnvironmentDescription;
 /**
  * Vector of RunPlan
  * Contains additional methods for generating collections of RunPlans and combining RunPlanVectors
+ *
+ * Environment properties set by the methods of RunPlanVector are stored compactly, as a column of values per property, rather than
+ * within each RunPlan. A plan's values are copied into the RunPlan when it is accessed by (non-const) reference, as it may then be modified.
+ * Random property values are generated from the random property seed and the index of the plan within the vector, so they do not depend
+ * on any other plan, and large vectors are generated in parallel.
  */
 class RunPlanVector : private std::vector<RunPlan>  {
     friend class RunPlan;
     friend class SimRunner;
-    friend void CUDAEnsemble::simulate(const RunPlanVector &plans);
+    friend class CUDAEnsemble;
 
  public:
     /**
@@ -131,13 +143,13 @@ class RunPlanVector : private std::vector<RunPlan>  {
     template<typename T>
     void setPropertyUniformDistribution(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max);
     /**
-     * Seed the internal random generator used for random property distributions
+     * Set the seed used to generate random property distributions
      * This will only affect subsequent calls to setPropertyRandom()
      * @param seed The random seed to be used
      */
     void setRandomPropertySeed(const uint64_t &seed);
     /**
-     * Get the seed used for the internal random generator used for random property distributions
+     * Get the seed used to generate random property distributions
      * This will only valid for calls to setPropertyRandom() since the last call toSetRandomPropertySeed
      * @return the seed used for random properties since the last call to setPropertyRandom
      */
@@ -236,6 +248,8 @@ class RunPlanVector : private std::vector<RunPlan>  {
     void setPropertyLogNormalRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &mean, const T &stddev);
     /**
      * Use a random distribution to generate parameters for the named environment property
+     * The value of each plan is generated by a copy of the distribution, using a counter-based generator keyed by the random property seed,
+     * the plan's index and the property. Therefore the value of a plan can be reproduced without generating the values of the preceding plans.
      * @param name The name of the environment property to set
      * @param distribution The random distribution to use for generating random property values
      * @tparam T The type of the environment property, this must match the ModelDescription
@@ -261,20 +275,187 @@ class RunPlanVector : private std::vector<RunPlan>  {
      */
     template<typename T, typename rand_dist>
     void setPropertyRandom(const std::string &name, const EnvironmentManager::size_type &index, rand_dist &distribution);
+    /**
+     * An environment property (or element of an environment property array) and the range it is to be sampled over
+     * Integer properties are sampled over the inclusive range [min, max], floating point properties over the range [min, max)
+     * @see setPropertyLatinHypercube()
+     * @see setPropertySobol()
+     * @see setPropertyHalton()
+     */
+    struct PropertyRange {
+        PropertyRange() = default;
+        /**
+         * @param _name The name of the environment property
+         * @param _min The lower bound of the range
+         * @param _max The upper bound of the range
+         */
+        PropertyRange(const std::string &_name, const double &_min, const double &_max)
+            : name(_name), min(_min), max(_max) { }
+        /**
+         * @param _name The name of the environment property array
+         * @param _index The index of the element within the environment property array
+         * @param _min The lower bound of the range
+         * @param _max The upper bound of the range
+         */
+        PropertyRange(const std::string &_name, const EnvironmentManager::size_type &_index, const double &_min, const double &_max)
+            : name(_name), index(_index), is_element(true), min(_min), max(_max) { }
+        std::string name;
+        EnvironmentManager::size_type index = 0;
+        /**
+         * If true, index identifies an element of an environment property array
+         */
+        bool is_element = false;
+        double min = 0;
+        double max = 0;
+    };
+    /**
+     * Maximum number of properties which can be sampled by setPropertySobol()
+     */
+    static const unsigned int SOBOL_MAX_DIMENSIONS = 21;
+    /**
+     * Sample several environment properties together with a Latin hypercube design
+     * The range of each property is divided into size() equal strata, each of which is sampled by exactly one plan.
+     * The pairing of strata between properties, and the position within each stratum, are generated from the random property seed
+     * @param properties The environment properties to sample and their ranges, each property forms a dimension of the design
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
+     * @throws exception::InvalidEnvPropertyType If a property is an array, and an index was not provided
+     * @throws std::out_of_range If an index is greater than or equal to the length of the environment property array
+     * @throws std::out_of_range If this vector has a length less than 2
+     */
+    void setPropertyLatinHypercube(const std::vector<PropertyRange> &properties);
+    /**
+     * Sample several environment properties together with a Sobol low-discrepancy sequence
+     * The plan at index i receives point i of the sequence, so the first plan samples the lower bound of each range.
+     * Direction numbers are those of Joe and Kuo (2008), the sequence is most uniform when size() is a power of 2.
+     * The design does not depend on the random property seed
+     * @param properties The environment properties to sample and their ranges, each property forms a dimension of the design
+     * @throws exception::InvalidArgument If more than SOBOL_MAX_DIMENSIONS properties are provided
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
+     * @throws exception::InvalidEnvPropertyType If a property is an array, and an index was not provided
+     * @throws std::out_of_range If an index is greater than or equal to the length of the environment property array
+     * @throws std::out_of_range If this vector has a length less than 2
+     */
+    void setPropertySobol(const std::vector<PropertyRange> &properties);
+    /**
+     * Sample several environment properties together with a Halton low-discrepancy sequence
+     * The plan at index i receives point i + 1 of the sequence, the dimension d uses the radical inverse in the base of the d-th prime.
+     * The uniformity of Halton sequences degrades as the number of dimensions increases, so setPropertySobol() is preferable for many properties.
+     * The design does not depend on the random property seed
+     * @param properties The environment properties to sample and their ranges, each property forms a dimension of the design
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
+     * @throws exception::InvalidEnvPropertyType If a property is an array, and an index was not provided
+     * @throws std::out_of_range If an index is greater than or equal to the length of the environment property array
+     * @throws std::out_of_range If this vector has a length less than 2
+     */
+    void setPropertyHalton(const std::vector<PropertyRange> &properties);
 
     /**
      * Expose inherited std::vector methods/classes
      */     
 #ifndef SWIG
-    using std::vector<RunPlan>::begin;
-    using std::vector<RunPlan>::end;
+    using std::vector<RunPlan>::iterator;
+    using std::vector<RunPlan>::size_type;
     using std::vector<RunPlan>::size;
-    using std::vector<RunPlan>::operator[];
-    using std::vector<RunPlan>::insert;
+    /**
+     * Read only iterator over the plans
+     * Dereferencing returns a copy of the plan, including the property values stored by the vector, so the compact storage is not affected
+     */
+    class const_iterator {
+     public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef RunPlan value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef RunPlan reference;
+        const_iterator() : vec(nullptr), pos(0) { }
+        reference operator*() const { return (*vec)[pos]; }
+        const_iterator &operator++() { ++pos; return *this; }
+        const_iterator operator++(int) { const_iterator rtn(*this); ++pos; return rtn; }
+        const_iterator &operator--() { --pos; return *this; }
+        const_iterator operator--(int) { const_iterator rtn(*this); --pos; return rtn; }
+        const_iterator operator+(const difference_type n) const { return const_iterator(vec, pos + n); }
+        const_iterator operator-(const difference_type n) const { return const_iterator(vec, pos - n); }
+        difference_type operator-(const const_iterator &other) const { return static_cast<difference_type>(pos) - static_cast<difference_type>(other.pos); }
+        bool operator==(const const_iterator &other) const { return vec == other.vec && pos == other.pos; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+     private:
+        friend class RunPlanVector;
+        const_iterator(const RunPlanVector *_vec, const size_type _pos) : vec(_vec), pos(_pos) { }
+        const RunPlanVector *vec;
+        size_type pos;
+    };
+    /**
+     * Returns an iterator to the first plan
+     * @note The values of all plans are copied out of the compact property storage, as they may be modified via the iterator
+     */
+    iterator begin();
+    /**
+     * Returns an iterator past the final plan
+     * @note This does not copy plans out of the compact property storage, begin() must be used to access plans via the returned iterator
+     */
+    iterator end();
+    /**
+     * Returns a read only iterator to the first plan
+     */
+    const_iterator begin() const { return cbegin(); }
+    /**
+     * Returns a read only iterator past the final plan
+     */
+    const_iterator end() const { return cend(); }
+    /**
+     * Returns a read only iterator to the first plan
+     */
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    /**
+     * Returns a read only iterator past the final plan
+     */
+    const_iterator cend() const { return const_iterator(this, size()); }
+    /**
+     * Returns the plan at the specified index
+     * @param pos Index of the plan
+     * @note The values of the plan are copied out of the compact property storage, as it may be modified via the returned reference
+     */
+    RunPlan& operator[](size_type pos);
+    /**
+     * Returns a copy of the plan at the specified index, including the property values stored by the vector
+     * @param pos Index of the plan
+     */
+    RunPlan operator[](size_type pos) const;
+    /**
+     * Inserts a copy of a plan before the specified position
+     * @param pos Position before which the plan will be inserted
+     * @param value The plan to insert
+     * @return Iterator to the inserted plan
+     */
+    iterator insert(const_iterator pos, const RunPlan& value);
+    /**
+     * Inserts copies of a plan before the specified position
+     * @param pos Position before which the plans will be inserted
+     * @param count The number of copies to insert
+     * @param value The plan to insert
+     * @return Iterator to the first inserted plan
+     */
+    iterator insert(const_iterator pos, size_type count, const RunPlan& value);
+    /**
+     * Inserts a copy of a plan before the specified position
+     * @param pos Position before which the plan will be inserted
+     * @param value The plan to insert
+     * @return Iterator to the inserted plan
+     */
+    iterator insert(iterator pos, const RunPlan& value);
+    /**
+     * Inserts copies of a plan before the specified position
+     * @param pos Position before which the plans will be inserted
+     * @param count The number of copies to insert
+     * @param value The plan to insert
+     * @return Iterator to the first inserted plan
+     */
+    iterator insert(iterator pos, size_type count, const RunPlan& value);
 #else
     // Can't get SWIG %import to use std::vector<RunPlan> so manually implement the required items
     size_t size() const { return std::vector<RunPlan>::size(); }
-    RunPlan& operator[] (const size_t _Pos) { return std::vector<RunPlan>::operator[](_Pos); }
+    RunPlan& operator[] (const size_t _Pos);
 #endif
 
     /**
@@ -289,15 +470,137 @@ class RunPlanVector : private std::vector<RunPlan>  {
 
  private:
     RunPlanVector(const std::shared_ptr<const std::unordered_map<std::string, EnvironmentDescription::PropData>> &environment, const bool &allow_0_steps);
+#ifndef SWIG
     /**
-     * Seed used for the current `rand` instance, which is only valid for elements generated since the last call to setRandomPropertySeed
+     * Counter-based random engine which generates the random values of a single plan's property
+     * Satisfies the requirements of UniformRandomBitGenerator, so that it can be passed to std:: distributions
      */
-    uint64_t randomPropertySeed;
+    class PlanRandomEngine {
+     public:
+        typedef uint64_t result_type;
+        /**
+         * @param seed The random property seed
+         * @param plan_index Index of the plan within the vector
+         * @param stream Identifies the property (and array element)
+         */
+        PlanRandomEngine(uint64_t seed, uint64_t plan_index, unsigned int stream)
+            : philox(seed, static_cast<id_t>(plan_index), static_cast<unsigned int>(plan_index >> 32), stream) { }
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT64_MAX; }
+        result_type operator()() {
+            const PhiloxRandom::Block b = philox.next();
+            return static_cast<uint64_t>(b.v[0]) << 32 | b.v[1];
+        }
+        /**
+         * Returns an integer uniformly distributed in the inclusive range [min, max]
+         * Unlike std::uniform_int_distribution, the result does not depend on the standard library's implementation
+         */
+        template<typename T>
+        T uniformInt(const T &min, const T &max);
+        /**
+         * Returns a floating point value uniformly distributed in the range [min, max)
+         */
+        template<typename T>
+        T uniformReal(const T &min, const T &max) { return static_cast<T>(min + (max - min) * (1 - philox.uniform<T>())); }
+        /**
+         * Returns a normally distributed floating point value
+         */
+        template<typename T>
+        T normal(const T &mean, const T &stddev) { return mean + stddev * philox.normal<T>(); }
+        /**
+         * Returns a log normally distributed floating point value
+         */
+        template<typename T>
+        T logNormal(const T &mean, const T &stddev) { return philox.logNormal<T>(mean, stddev); }
+
+     private:
+        PhiloxRandom philox;
+    };
+    /**
+     * Adapts a function of PlanRandomEngine to the requirements of RandomNumberDistribution, for use with setPropertyRandom()
+     */
+    template<typename T>
+    struct EngineDistribution {
+        std::function<T(PlanRandomEngine &)> fn;
+        void reset() { }
+        T operator()(PlanRandomEngine &engine) const { return fn(engine); }
+    };
+    /**
+     * Sets an element of the named property of each plan to the value returned by generator
+     * The property must have been validated by the caller
+     * @param name The name of the environment property to set
+     * @param prop The environment property's description
+     * @param index The index of the element within the environment property array to set
+     * @param generator Returns the value for the plan of the provided index, the provided engine is unique to the plan and element
+     * @tparam T The type of the environment property
+     */
+    template<typename T>
+    void fillProperty(const std::string &name, const EnvironmentDescription::PropData &prop, EnvironmentManager::size_type index, const std::function<T(size_type, PlanRandomEngine &)> &generator);
+    /**
+     * Validates the properties passed to a space-filling design
+     * @param properties The environment properties to sample and their ranges
+     * @param caller Name of the calling method, for error messages
+     * @return The description of each property
+     */
+    std::vector<const EnvironmentDescription::PropData*> validateRanges(const std::vector<PropertyRange> &properties, const char *caller) const;
+    /**
+     * Sets the property of each plan by scaling a value in the range [0, 1) to the property's range
+     * @param range The environment property to set and it's range
+     * @param prop The environment property's description
+     * @param unit Returns the value in the range [0, 1) for the plan of the provided index
+     */
+    void fillPropertyRange(const PropertyRange &range, const EnvironmentDescription::PropData &prop, const std::function<double(size_type)> &unit);
+    /**
+     * Type specific implementation of fillPropertyRange()
+     */
+    template<typename T>
+    void fillPropertyRange(const PropertyRange &range, const EnvironmentDescription::PropData &prop, const std::function<double(size_type)> &unit);
+    /**
+     * Returns the value of PhiloxRandom::Key::stream used for the named property (and element)
+     */
+    static unsigned int propertyStream(const std::string &name, EnvironmentManager::size_type index);
+    /**
+     * Calls fn for ranges of plan indices which together cover the vector, in parallel if the vector is large
+     * @param fn Function which receives the first and one past the last index of the range
+     */
+    void forEachPlan(const std::function<void(size_type, size_type)> &fn);
+    /**
+     * Returns the column of the named property, creating it if required
+     * Returns nullptr if all plans have been copied out of the compact storage
+     */
+    std::vector<char> *getColumn(const std::string &name, const EnvironmentDescription::PropData &prop);
+    /**
+     * Returns a pointer to the storage of the named property of a plan, within either the column or the plan's own overrides
+     */
+    char *propertyStorage(size_type plan, const std::string &name, const EnvironmentDescription::PropData &prop, std::vector<char> *column);
+    /**
+     * Copies the values of the plan at index pos from the property columns into plan
+     */
+    void applyColumns(size_type pos, RunPlan &plan) const;
+    /**
+     * Copies the plan at index pos out of the compact property storage
+     */
+    void materialise(size_type pos);
+    /**
+     * Appends a copy of plan, moving any of it's overrides which correspond to a property column into the column
+     */
+    void pushPlan(const RunPlan &plan);
+#endif
     /**
-     * Random distribution used by setPropertyRandom()
+     * Seed used when generating random properties, which is only valid for elements generated since the last call to setRandomPropertySeed
      * Initially set to a random seed with std::random_device (which is a platform specific source of random integers)
      */
-    std::mt19937_64 rand;
+    uint64_t randomPropertySeed;
+    /**
+     * Environment property values set by the methods of this class, a contiguous column per property
+     * The value of the plan at index i begins at byte i * PropData::data.length
+     */
+    std::map<std::string, std::vector<char>> property_columns;
+    /**
+     * Whether each plan's column values have been copied into its RunPlan::property_overrides
+     * Properties of these plans are set directly within their property_overrides, as they may be referenced externally
+     */
+    std::vector<bool> materialised;
     std::shared_ptr<const std::unordered_map<std::string, EnvironmentDescription::PropData>> environment;
     const bool allow_0_steps;
 };
@@ -321,9 +624,7 @@ void RunPlanVector::setProperty(const std::string &name, const T &value) {
             "in RunPlanVector::setProperty()\n",
             name.c_str(), it->second.data.elements);
     }
-    for (auto &i : *this) {
-        i.setProperty<T>(name, value);
-    }
+    fillProperty<T>(name, it->second, 0, [&value](size_type, PlanRandomEngine &) { return value; });
 }
 template<typename T, EnvironmentManager::size_type N>
 void RunPlanVector::setProperty(const std::string &name, const std::array<T, N> &value) {
@@ -344,8 +645,8 @@ void RunPlanVector::setProperty(const std::string &name, const std::array<T, N>
             "in RunPlanVector::setProperty()\n",
             name.c_str(), it->second.data.elements, N);
     }
-    for (auto &i : *this) {
-        i.setProperty<T, N>(name, value);
+    for (EnvironmentManager::size_type j = 0; j < N; ++j) {
+        fillProperty<T>(name, it->second, j, [&value, j](size_type, PlanRandomEngine &) { return value[j]; });
     }
 }
 template<typename T>
@@ -362,13 +663,11 @@ void RunPlanVector::setProperty(const std::string &name, const EnvironmentManage
             "in RunPlanVector::setProperty()\n",
             name.c_str(), it->second.data.type.name(), std::type_index(typeid(T)).name());
     }
-    if (index > it->second.data.elements) {
+    if (index >= it->second.data.elements) {
         throw std::out_of_range("Environment property array index out of bounds "
             "in RunPlanVector::setProperty()\n");
     }
-    for (auto &i : *this) {
-        i.setProperty<T>(name, index, value);
-    }
+    fillProperty<T>(name, it->second, index, [&value](size_type, PlanRandomEngine &) { return value; });
 }
 #ifdef SWIG
 template<typename T>
@@ -395,8 +694,8 @@ void RunPlanVector::setPropertyArray(const std::string &name, const EnvironmentM
             "in RunPlanVector::setPropertyArray()\n",
             name.c_str(), value.size(), N);
     }
-    for (auto &i : *this) {
-        i.setPropertyArray<T>(name, N, value);
+    for (EnvironmentManager::size_type j = 0; j < N; ++j) {
+        fillProperty<T>(name, it->second, j, [&value, j](size_type, PlanRandomEngine &) { return value[j]; });
     }
 }
 #endif
@@ -424,12 +723,11 @@ void RunPlanVector::setPropertyUniformDistribution(const std::string &name, cons
             "in RunPlanVector::setPropertyUniformDistribution()\n",
             name.c_str(), it->second.data.elements);
     }
-    unsigned int ct = 0;
-    for (auto &i : *this) {
-        const double a = static_cast<double>(ct++) / (this->size() - 1);
-        const T lerp = static_cast<T>(round(min * (1.0 - a) + max * a));
-        i.setProperty<T>(name, lerp);
-    }
+    const size_type count = this->size();
+    fillProperty<T>(name, it->second, 0, [&min, &max, count](size_type i, PlanRandomEngine &) {
+        const double a = static_cast<double>(i) / (count - 1);
+        return static_cast<T>(round(min * (1.0 - a) + max * a));
+    });
 }
 template<typename T>
 void RunPlanVector::setPropertyUniformDistribution(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max) {
@@ -449,16 +747,15 @@ void RunPlanVector::setPropertyUniformDistribution(const std::string &name, cons
             "in RunPlanVector::setPropertyUniformDistribution()\n",
             name.c_str(), it->second.data.type.name(), std::type_index(typeid(T)).name());
     }
-    if (index > it->second.data.elements) {
+    if (index >= it->second.data.elements) {
         throw std::out_of_range("Environment property array index out of bounds "
             "in RunPlanVector::setPropertyUniformDistribution()\n");
     }
-    unsigned int ct = 0;
-    for (auto &i : *this) {
-        const double a = static_cast<double>(ct++) / (this->size() - 1);
-        const T lerp = static_cast<T>(round(min * (1.0 - a) + max * a));
-        i.setProperty<T>(name, index, lerp);
-    }
+    const size_type count = this->size();
+    fillProperty<T>(name, it->second, index, [&min, &max, count](size_type i, PlanRandomEngine &) {
+        const double a = static_cast<double>(i) / (count - 1);
+        return static_cast<T>(round(min * (1.0 - a) + max * a));
+    });
 }
 
 template<typename T, typename rand_dist>
@@ -484,9 +781,11 @@ void RunPlanVector::setPropertyRandom(const std::string &name, rand_dist &distri
             "in RunPlanVector::setPropertyRandom()\n",
             name.c_str(), it->second.data.elements);
     }
-    for (auto &i : *this) {
-        i.setProperty<T>(name, static_cast<T>(distribution(this->rand)));
-    }
+    fillProperty<T>(name, it->second, 0, [&distribution](size_type, PlanRandomEngine &engine) {
+        rand_dist dist(distribution);
+        dist.reset();
+        return static_cast<T>(dist(engine));
+    });
 }
 template<typename T, typename rand_dist>
 void RunPlanVector::setPropertyRandom(const std::string &name, const EnvironmentManager::size_type &index, rand_dist &distribution) {
@@ -506,110 +805,112 @@ void RunPlanVector::setPropertyRandom(const std::string &name, const Environment
             "in RunPlanVector::setPropertyRandom()\n",
             name.c_str(), it->second.data.type.name(), std::type_index(typeid(T)).name());
     }
-    if (index > it->second.data.elements) {
+    if (index >= it->second.data.elements) {
         throw std::out_of_range("Environment property array index out of bounds "
             "in RunPlanVector::setPropertyRandom()\n");
     }
-    for (auto &i : *this) {
-        i.setProperty<T>(name, index, static_cast<T>(distribution(this->rand)));
-    }
+    fillProperty<T>(name, it->second, index, [&distribution](size_type, PlanRandomEngine &engine) {
+        rand_dist dist(distribution);
+        dist.reset();
+        return static_cast<T>(dist(engine));
+    });
 }
 /**
  * Convenience random implementations
+ * These use the engine's own distributions, so that the generated values do not depend on the standard library's implementation
  */
 template<typename T>
 void RunPlanVector::setPropertyUniformRandom(const std::string &name, const T &min, const T &max) {
     static_assert(util::detail::StaticAssert::_Is_IntType<T>::value, "Invalid template argument for RunPlanVector::setPropertyUniformRandom(const std::string &name, const T &min, const T&max)");
-    std::uniform_int_distribution<T> dist(min, max);
+    EngineDistribution<T> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformInt<T>(min, max); }};
     setPropertyRandom<T>(name, dist);
 }
 template<typename T>
 void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max) {
     static_assert(util::detail::StaticAssert::_Is_IntType<T>::value, "Invalid template argument for RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T&max)");
-    std::uniform_int_distribution<T> dist(min, max);
+    EngineDistribution<T> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformInt<T>(min, max); }};
     setPropertyRandom<T>(name, index, dist);
 }
 template<typename T>
 void RunPlanVector::setPropertyNormalRandom(const std::string &name, const T &mean, const T &stddev) {
     static_assert(util::detail::StaticAssert::_Is_RealType<T>::value, "Invalid template argument for RunPlanVector::setPropertyNormalRandom(const std::string &name, const T &mean, const T &stddev)");
-    std::normal_distribution<T> dist(mean, stddev);
+    EngineDistribution<T> dist{[mean, stddev](PlanRandomEngine &engine) { return engine.normal<T>(mean, stddev); }};
     setPropertyRandom<T>(name, dist);
 }
 template<typename T>
 void RunPlanVector::setPropertyNormalRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &mean, const T &stddev) {
     static_assert(util::detail::StaticAssert::_Is_RealType<T>::value,
         "Invalid template argument for RunPlanVector::setPropertyNormalRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &mean, const T &stddev)");
-    std::normal_distribution<T> dist(mean, stddev);
+    EngineDistribution<T> dist{[mean, stddev](PlanRandomEngine &engine) { return engine.normal<T>(mean, stddev); }};
     setPropertyRandom<T>(name, index, dist);
 }
 template<typename T>
 void RunPlanVector::setPropertyLogNormalRandom(const std::string &name, const T &mean, const T &stddev) {
     static_assert(util::detail::StaticAssert::_Is_RealType<T>::value,
     "Invalid template argument for RunPlanVector::setPropertyLogNormalRandom(const std::string &name, const T &mean, const T &stddev)");
-    std::lognormal_distribution<T> dist(mean, stddev);
+    EngineDistribution<T> dist{[mean, stddev](PlanRandomEngine &engine) { return engine.logNormal<T>(mean, stddev); }};
     setPropertyRandom<T>(name, dist);
 }
 template<typename T>
 void RunPlanVector::setPropertyLogNormalRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &mean, const T &stddev) {
     static_assert(util::detail::StaticAssert::_Is_RealType<T>::value,
     "Invalid template argument for RunPlanVector::setPropertyLogNormalRandom(const std::string &name, const EnvironmentManager::size_type &index, const T &mean, const T &stddev)");
-    std::lognormal_distribution<T> dist(mean, stddev);
+    EngineDistribution<T> dist{[mean, stddev](PlanRandomEngine &engine) { return engine.logNormal<T>(mean, stddev); }};
     setPropertyRandom<T>(name, index, dist);
 }
 /**
  * Special cases
- * std::random doesn't support char, emulate behaviour
- * char != signed char (or unsigned char)
+ * Floating point types use a uniform real distribution
  */
 template<>
 inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const float &min, const float &max) {
-    std::uniform_real_distribution<float> dist(min, max);
+    EngineDistribution<float> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformReal<float>(min, max); }};
     setPropertyRandom<float>(name, dist);
 }
 template<>
 inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const float &min, const float &max) {
-    std::uniform_real_distribution<float> dist(min, max);
+    EngineDistribution<float> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformReal<float>(min, max); }};
     setPropertyRandom<float>(name, index, dist);
 }
 template<>
 inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const double &min, const double &max) {
-    std::uniform_real_distribution<double> dist(min, max);
+    EngineDistribution<double> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformReal<double>(min, max); }};
     setPropertyRandom<double>(name, dist);
 }
 template<>
 inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const double &min, const double &max) {
-    std::uniform_real_distribution<double> dist(min, max);
+    EngineDistribution<double> dist{[min, max](PlanRandomEngine &engine) { return engine.uniformReal<double>(min, max); }};
     setPropertyRandom<double>(name, index, dist);
 }
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const char &min, const char &max) {
-    std::uniform_int_distribution<int16_t> dist(min, max);
-    setPropertyRandom<char>(name, dist);
-}
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const char &min, const char &max) {
-    std::uniform_int_distribution<int16_t> dist(min, max);
-    setPropertyRandom<char>(name, index, dist);
-}
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const unsigned char &min, const unsigned char &max) {
-    std::uniform_int_distribution<uint16_t> dist(min, max);
-    setPropertyRandom<unsigned char>(name, dist);
-}
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const unsigned char &min, const unsigned char &max) {
-    std::uniform_int_distribution<uint16_t> dist(min, max);
-    setPropertyRandom<unsigned char>(name, index, dist);
-}
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const signed char &min, const signed char &max) {
-    std::uniform_int_distribution<int16_t> dist(min, max);
-    setPropertyRandom<signed char>(name, dist);
+
+template<typename T>
+T RunPlanVector::PlanRandomEngine::uniformInt(const T &min, const T &max) {
+    // Operate on the offset from min as a 64-bit unsigned integer, so that all integer types are supported
+    const uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+    uint64_t offset = (*this)();
+    if (range != UINT64_MAX) {
+        // Reject values from the incomplete final interval, so that the result is unbiased
+        const uint64_t n = range + 1;
+        const uint64_t limit = (UINT64_MAX / n) * n;
+        while (offset >= limit) {
+            offset = (*this)();
+        }
+        offset %= n;
+    }
+    return static_cast<T>(static_cast<uint64_t>(min) + offset);
 }
-template<>
-inline void RunPlanVector::setPropertyUniformRandom(const std::string &name, const EnvironmentManager::size_type &index, const signed char &min, const signed char &max) {
-    std::uniform_int_distribution<int16_t> dist(min, max);
-    setPropertyRandom<signed char>(name, index, dist);
+template<typename T>
+void RunPlanVector::fillProperty(const std::string &name, const EnvironmentDescription::PropData &prop, const EnvironmentManager::size_type index, const std::function<T(size_type, PlanRandomEngine &)> &generator) {
+    std::vector<char> *column = getColumn(name, prop);
+    const uint64_t seed = randomPropertySeed;
+    const unsigned int stream = propertyStream(name, index);
+    forEachPlan([&](const size_type first, const size_type last) {
+        for (size_type i = first; i < last; ++i) {
+            PlanRandomEngine engine(seed, i, stream);
+            const T value = generator(i, engine);
+            memcpy(propertyStorage(i, name, prop, column) + index * sizeof(T), &value, sizeof(T));
+        }
+    });
 }
 
 }  // namespace flamegpu
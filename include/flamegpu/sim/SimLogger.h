@@ -23,6 +23,7 @@ class SimLogger {
      * Constructs a new SimLogger
      * @param run_logs Reference to the vector to store generate run logs
      * @param run_plans Reference to the vector of run configurations to be executed
+     * @param first_log_index The index which the first run's step log file is numbered with
      * @param out_directory The directory to write logs to disk
      * @param out_format The format to write logs to disk.
      * @param log_export_queue The queue of logs to exported to disk
@@ -31,6 +32,7 @@ class SimLogger {
      */
     SimLogger(const std::vector<RunLog> &run_logs,
         const RunPlanVector &run_plans,
+        unsigned int first_log_index,
         const std::string &out_directory,
         const std::string &out_format,
         std::queue<unsigned int> &log_export_queue,
@@ -53,6 +55,10 @@ class SimLogger {
      * Reference to the vector of run configurations to be executed
      */
     const RunPlanVector &run_plans;
+    /**
+     * The index which the first run's step log file is numbered with
+     */
+    const unsigned int first_log_index;
     /**
      * The directory to write logs to disk
      */
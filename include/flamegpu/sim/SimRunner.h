@@ -9,13 +9,16 @@
 #include <thread>
 #include <vector>
 #include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/util/StringPair.h"
 
 namespace flamegpu {
 
 struct ModelData;
+class AgentVector;
 class LoggingConfig;
 class StepLoggingConfig;
 class RunPlanVector;
+class EnsembleWorker;
 
 /**
  * A thread class which executes RunPlans on a single GPU
@@ -37,9 +40,12 @@ class SimRunner {
      * @param _runner_id A unique index assigned to the runner
      * @param _verbose If true more information will be written to stdout
      * @param run_logs Reference to the vector to store generate run logs
+     * @param run_failed Reference to the vector to flag runs which fail
      * @param log_export_queue The queue of logs to exported to disk
      * @param log_export_queue_mutex This mutex must be locked to access log_export_queue
      * @param log_export_queue_cdn The condition is notified every time a log has been added to the queue
+     * @param run_populations The initial population of each run, or empty if no initial populations are set
+     * @param _worker If provided, runs are requested from and returned to the coordinator of a distributed ensemble, rather than selected by _next_run
      */
     SimRunner(const std::shared_ptr<const ModelData> _model,
         std::atomic<unsigned int> &_err_ct,
@@ -51,9 +57,12 @@ class SimRunner {
         unsigned int _runner_id,
         bool _verbose,
         std::vector<RunLog> &run_logs,
+        std::vector<unsigned char> &run_failed,
         std::queue<unsigned int> &log_export_queue,
         std::mutex &log_export_queue_mutex,
-        std::condition_variable &log_export_queue_cdn);
+        std::condition_variable &log_export_queue_cdn,
+        const std::vector<util::StringPairUnorderedMap<std::shared_ptr<const AgentVector>>> &run_populations,
+        EnsembleWorker *_worker = nullptr);
     /**
      * Each sim runner takes it's own clone of model description hierarchy, so it can manipulate environment without conflict
      */
@@ -82,6 +91,11 @@ class SimRunner {
      * Start executing the SimRunner in it's separate thread
      */
     void start();
+    /**
+     * Selects the next run to execute, storing it in run_id
+     * @return false if there are no further runs to execute
+     */
+    bool nextRun();
     // External references
     /**
      * Reference to an atomic integer for tracking how many errors have occurred
@@ -107,6 +121,10 @@ class SimRunner {
      * Reference to the vector to store generate run logs
      */
     std::vector<RunLog> &run_logs;
+    /**
+     * Reference to the vector to flag runs which fail, each element is only written by the runner which executed the run
+     */
+    std::vector<unsigned char> &run_failed;
     /**
      * The queue of logs to exported to disk
      */
@@ -119,6 +137,14 @@ class SimRunner {
      * The condition is notified every time a log has been added to the queue
      */
     std::condition_variable &log_export_queue_cdn;
+    /**
+     * The initial population of each run, these are shared by all runners so must not be modified
+     */
+    const std::vector<util::StringPairUnorderedMap<std::shared_ptr<const AgentVector>>> &run_populations;
+    /**
+     * The connection to the coordinator of a distributed ensemble, if the runner is part of a worker
+     */
+    EnsembleWorker *const worker;
 };
 
 }  // namespace flamegpu
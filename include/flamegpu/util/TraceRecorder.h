@@ -0,0 +1,103 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_TRACERECORDER_H_
+#define INCLUDE_FLAMEGPU_UTIL_TRACERECORDER_H_
+
+#include <cstdint>
+#include <string>
+
+namespace flamegpu {
+namespace util {
+
+/**
+ * In-memory recorder for the ranges marked by the NVTX_PUSH, NVTX_POP and NVTX_RANGE macros.
+ * This provides timelines of a run without a profiler attached, which can be exported in the Chrome trace-event format
+ * (viewable with chrome://tracing or https://ui.perfetto.dev)
+ *
+ * Macro `USE_NVTX_TRACE` must be defined (CMake option NVTX_TRACE) for the NVTX macros to forward ranges to the recorder,
+ * this does not require NVTX itself, and may be combined with USE_NVTX.
+ * Recording is disabled until start() is called, so the only cost whilst disabled is an atomic load per range.
+ *
+ * Each thread records completed ranges into it's own fixed size, lock-free ring buffer,
+ * so ranges from concurrent threads (e.g. CUDAEnsemble runner threads) do not contend, even whilst being exported.
+ * If a thread's ring buffer fills, it's oldest ranges are overwritten.
+ */
+class TraceRecorder {
+ public:
+    /**
+     * Default number of completed ranges retained per thread
+     */
+    static const unsigned int DEFAULT_EVENTS_PER_THREAD = 1 << 16;
+    /**
+     * Range labels longer than this are truncated
+     */
+    static const unsigned int MAX_LABEL_LENGTH = 95;
+    /**
+     * Ranges nested deeper than this are not recorded (although they must still be balanced)
+     */
+    static const unsigned int MAX_DEPTH = 64;
+    /**
+     * Returns whether the NVTX macros were built to forward ranges to the recorder
+     * @note If this returns false, ranges can still be recorded manually via push() and pop()
+     */
+    static constexpr bool isAvailable() {
+#if defined(USE_NVTX_TRACE)
+        return true;
+#else
+        return false;
+#endif
+    }
+    /**
+     * Clears any previously recorded ranges and begins recording
+     * @param eventsPerThread The number of completed ranges retained by each thread's ring buffer
+     * @throws exception::InvalidArgument If eventsPerThread is 0
+     * @throws exception::InvalidOperation If the recorder is already recording
+     */
+    static void start(unsigned int eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    /**
+     * Stops recording, recorded ranges are retained until the next call to start() or clear()
+     * Ranges open at the time of the call are not recorded
+     */
+    static void stop();
+    /**
+     * Returns whether the recorder is currently recording
+     */
+    static bool isRecording();
+    /**
+     * Discards all recorded ranges
+     * @throws exception::InvalidOperation If the recorder is currently recording
+     */
+    static void clear();
+    /**
+     * Returns the number of completed ranges currently held, across all threads
+     */
+    static uint64_t getEventCount();
+    /**
+     * Returns the number of completed ranges which have been overwritten due to a thread's ring buffer filling
+     */
+    static uint64_t getDroppedEventCount();
+    /**
+     * Writes the recorded ranges to file as Chrome trace-event JSON
+     * Each range is written as a complete ('X') event, with microsecond timestamps relative to the earliest recorded range.
+     * Each thread which recorded ranges is assigned a sequential thread id, in order of it's first recorded range.
+     * @param path The file to output
+     * @throws exception::InvalidFilePath If the file cannot be opened for writing
+     * @note This may be called whilst recording, ranges which complete after a thread's buffer has been copied are omitted,
+     *       as are ranges overwritten whilst the buffer is being copied.
+     */
+    static void exportChromeTrace(const std::string &path);
+    /**
+     * Opens a range on the calling thread, if recording
+     * @param label Label of the range, this is copied so need not outlive the call
+     * @see NVTX_PUSH
+     */
+    static void push(const char *label);
+    /**
+     * Closes the most recently opened range on the calling thread, if recording
+     * @see NVTX_POP
+     */
+    static void pop();
+};
+
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_TRACERECORDER_H_
@@ -0,0 +1,67 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGES_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGES_H_
+
+#include <cstddef>
+#include <map>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Tracks the byte ranges of a host buffer which have been modified since it was last copied to the device
+ * Overlapping and adjacent ranges are coalesced as they are marked, so that the buffer can be uploaded with the minimum number of copies.
+ * Ranges separated by a gap no larger than the merge gap are also coalesced, as copying a few unmodified bytes is cheaper than an additional copy.
+ */
+class DirtyRanges {
+ public:
+    /**
+     * Constructs an empty set of ranges
+     * @param mergeGap Ranges separated by this many bytes or fewer are coalesced into a single range
+     */
+    explicit DirtyRanges(size_t mergeGap = 0);
+    /**
+     * Marks a range of bytes as modified
+     * @param offset Offset of the first modified byte
+     * @param length Number of modified bytes, if 0 this has no effect
+     */
+    void mark(size_t offset, size_t length);
+    /**
+     * Clears all ranges
+     * Call this after the modified ranges have been copied to the device
+     */
+    void clear();
+    /**
+     * Returns true if no ranges are marked
+     */
+    bool empty() const { return ranges.empty(); }
+    /**
+     * Returns the coalesced ranges, as a map of offset to end (one past the last byte)
+     * Ranges are ordered by offset, and do not overlap
+     */
+    const std::map<size_t, size_t> &getRanges() const { return ranges; }
+    /**
+     * Returns the total number of bytes within the coalesced ranges
+     */
+    size_t getBytes() const;
+    /**
+     * Returns the merge gap specified at construction
+     */
+    size_t getMergeGap() const { return mergeGap; }
+
+ private:
+    /**
+     * Ranges separated by this many bytes or fewer are coalesced
+     */
+    size_t mergeGap;
+    /**
+     * Map of range offset to range end
+     */
+    std::map<size_t, size_t> ranges;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGES_H_
@@ -0,0 +1,110 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_FREELISTALLOCATOR_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_FREELISTALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Manages the allocation of regions within a buffer of fixed (or unbounded) capacity, it does not own any memory itself
+ *
+ * Regions are allocated from the lowest addressed free block of the smallest size class which can hold them (with the requested alignment),
+ * otherwise from the end of the used space. Size classes are powers of two, so allocation only searches the free blocks of a single class
+ * before taking the first block of a larger class.
+ * Freed regions are coalesced with adjacent free blocks, and regions freed at the end of the used space return it to the end.
+ */
+class FreeListAllocator {
+ public:
+    /**
+     * Returned by allocate() if the buffer has insufficient space
+     */
+    static const ptrdiff_t OUT_OF_SPACE = -1;
+    /**
+     * Constructs an allocator for an empty buffer
+     * @param capacity Length of the buffer, by default this is unbounded
+     */
+    explicit FreeListAllocator(size_t capacity = std::numeric_limits<size_t>::max());
+    /**
+     * Allocates a region
+     * @param length Length of the region, must be greater than 0
+     * @param alignment Required alignment of the region's offset, must be greater than 0
+     * @return Offset of the allocated region, or OUT_OF_SPACE if the buffer has insufficient space
+     */
+    ptrdiff_t allocate(size_t length, size_t alignment = 1);
+    /**
+     * Returns a region previously returned by allocate()
+     * @param offset Offset of the region
+     * @param length Length of the region, as passed to allocate()
+     */
+    void deallocate(ptrdiff_t offset, size_t length);
+    /**
+     * Returns the capacity of the buffer
+     */
+    size_t getCapacity() const { return capacity; }
+    /**
+     * Returns the offset of the end of the used space, all allocated regions lie before this
+     */
+    size_t getEnd() const { return end; }
+    /**
+     * Returns the number of bytes which are not allocated
+     */
+    size_t getFreeSpace() const { return capacity - allocated; }
+    /**
+     * Returns the length of the largest contiguous free region, including the space after the end of the used space
+     */
+    size_t getLargestFreeBlock() const;
+    /**
+     * Returns the number of free blocks before the end of the used space
+     */
+    size_t getFreeBlockCount() const { return free_blocks.size(); }
+
+ private:
+    /**
+     * Number of size classes, one per bit of size_t
+     */
+    static const unsigned int SIZE_CLASSES = std::numeric_limits<size_t>::digits;
+    /**
+     * Returns the size class of a block, floor(log2(length))
+     */
+    static unsigned int sizeClass(size_t length);
+    /**
+     * Adds a free block, coalescing it with any adjacent free blocks and the end of the used space
+     */
+    void insertFree(size_t offset, size_t length);
+    /**
+     * Removes a free block
+     */
+    void eraseFree(std::map<size_t, size_t>::iterator it);
+    /**
+     * Length of the buffer
+     */
+    size_t capacity;
+    /**
+     * Offset of the end of the used space
+     */
+    size_t end = 0;
+    /**
+     * Total length of allocated regions
+     */
+    size_t allocated = 0;
+    /**
+     * Free blocks before end, map of offset to length
+     */
+    std::map<size_t, size_t> free_blocks;
+    /**
+     * Offsets of the free blocks within each size class
+     */
+    std::array<std::set<size_t>, SIZE_CLASSES> size_classes;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_FREELISTALLOCATOR_H_
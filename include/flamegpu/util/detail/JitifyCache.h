@@ -87,6 +87,20 @@ class JitifyCache {
      * @note Will only clear the cache files used by the current build (debug or release)
      */
     void clearDiskCache();
+    /**
+     * Returns whether a kernel matching the provided sources is available from the in-memory or on-disk cache
+     * This performs the same lookup as loadKernel(), without loading or compiling the kernel
+     * @param kernel_src Source code for the user defined agent function/condition
+     * @param dynamic_header Dynamic header source generated by curve rtc
+     */
+    bool isCached(const std::string &kernel_src, const std::string &dynamic_header) const;
+    /**
+     * Returns the key used to identify a kernel within the in-memory and on-disk caches
+     * This combines the CUDA version, compute capability, SEATBELTS and FLAMEGPU version with a hash of the sources
+     * @param kernel_src Source code for the user defined agent function/condition
+     * @param dynamic_header Dynamic header source generated by curve rtc
+     */
+    static std::string getCacheKey(const std::string &kernel_src, const std::string &dynamic_header);
 
  private:
     /**
@@ -0,0 +1,120 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_SOCKET_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Minimal blocking TCP socket, used by the coordinator and workers of a distributed ensemble
+ *
+ * Sockets are move-only, the underlying connection is closed when the owning instance is destroyed.
+ * Operations which fail throw exception::EnsembleNetworkError.
+ */
+class Socket {
+ public:
+#ifdef _WIN32
+    typedef uintptr_t Handle;
+#else
+    typedef int Handle;
+#endif
+    /**
+     * Constructs a socket which is not connected
+     */
+    Socket();
+    ~Socket();
+    Socket(Socket &&other) noexcept;
+    Socket &operator=(Socket &&other) noexcept;
+    Socket(const Socket &other) = delete;
+    Socket &operator=(const Socket &other) = delete;
+    /**
+     * Creates a socket which listens for connections
+     * @param host Address of the interface to listen on, e.g. "127.0.0.1" or "0.0.0.0" for all interfaces
+     * @param port Port to listen on, if 0 a free port is chosen
+     * @see getPort()
+     */
+    static Socket listen(const std::string &host, uint16_t port);
+    /**
+     * Creates a socket connected to a listening socket
+     * @param host Host name or address of the listening socket
+     * @param port Port of the listening socket
+     */
+    static Socket connect(const std::string &host, uint16_t port);
+    /**
+     * Splits an address of the form "host:port"
+     * @param address The address to split
+     * @param host Returns the host
+     * @param port Returns the port
+     * @throws exception::InvalidArgument If the address is not of the form "host:port"
+     */
+    static void parseAddress(const std::string &address, std::string &host, uint16_t &port);
+    /**
+     * Accepts a connection to a listening socket, blocking until one is available
+     */
+    Socket accept();
+    /**
+     * Returns the local port which the socket is bound to
+     */
+    uint16_t getPort() const;
+    /**
+     * Returns whether the socket is open
+     */
+    bool isOpen() const;
+    /**
+     * Closes the socket, if it is open
+     */
+    void close();
+    /**
+     * Sends the whole of a buffer
+     * @param data The buffer to send
+     * @param length Length of the buffer in bytes
+     * @throws exception::EnsembleNetworkError If the connection was closed or failed
+     */
+    void sendAll(const void *data, size_t length);
+    /**
+     * Receives exactly length bytes, blocking until they are available
+     * @param data The buffer to receive into
+     * @param length Number of bytes to receive
+     * @return false if the connection was closed by the peer before any bytes were received
+     * @throws exception::EnsembleNetworkError If the connection failed, or was closed after a partial receive
+     */
+    bool receiveAll(void *data, size_t length);
+    /**
+     * Receives up to length bytes, this only blocks if no bytes are available
+     * @param data The buffer to receive into
+     * @param length Maximum number of bytes to receive
+     * @return The number of bytes received, 0 if the connection was closed by the peer
+     * @throws exception::EnsembleNetworkError If the connection failed
+     * @see poll()
+     */
+    size_t receiveSome(void *data, size_t length);
+    /**
+     * Waits until any of the sockets can be read (or accepted) without blocking
+     * @param sockets The sockets to wait on
+     * @param timeout_ms The maximum duration to wait in milliseconds
+     * @return The indices of the readable sockets, empty if the timeout was reached
+     */
+    static std::vector<size_t> poll(const std::vector<const Socket*> &sockets, int timeout_ms);
+
+ private:
+    explicit Socket(Handle handle);
+    /**
+     * Initialises the platform's socket library (only required by Windows)
+     */
+    static void initialise();
+    /**
+     * The native socket
+     */
+    Handle handle;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_SOCKET_H_
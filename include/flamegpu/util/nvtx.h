@@ -7,6 +7,7 @@
  * Utility namespace for handling of NVTX profiling markers/ranges, wrapped in macros to avoid performance impact if not enabled.
  * 
  * Macro `USE_NVTX` must be defined to be enabled.
+ * Macro `USE_NVTX_TRACE` may also (or instead) be defined, to forward markers to util::TraceRecorder.
  * Use NVTX_PUSH, NVTX_POP, NVTX_RANGE macros to use.
  */
 
@@ -19,6 +20,9 @@
         #include "nvToolsExt.h"
     #endif
 #endif
+#if defined(USE_NVTX_TRACE)
+    #include "flamegpu/util/TraceRecorder.h"
+#endif
 
 /* @todo - Make these macros testable.
    If USE_NVTX is enabled, store static counts of push/pop/range's
@@ -41,14 +45,18 @@ const uint32_t palette[] = {0xff1b9e77, 0xffd95f02, 0xff7570b3, 0xffe7298a, 0xff
  */
 const uint32_t colourCount = sizeof(palette) / sizeof(uint32_t);
 
-#if defined(USE_NVTX)
 /**
  * Method to push an NVTX marker for improved profiling, if NVTX is defined
  * @param label label for the NVTX marker
  * @note The number of pushes must match the number of pops.
  * @see NVTX_PUSH to use with minimal performance impact
  */
+#if defined(USE_NVTX) || defined(USE_NVTX_TRACE)
 inline void push(const char * label) {
+#if defined(USE_NVTX_TRACE)
+    TraceRecorder::push(label);
+#endif
+#if defined(USE_NVTX)
     // Static variable to track the next colour to be used with auto rotation.
     static uint32_t nextColourIdx = 0;
 
@@ -72,6 +80,7 @@ inline void push(const char * label) {
 
     // Increment the counter tracking the next colour to use.
     nextColourIdx = colourIdx + 1;
+#endif
 }
 #else
 inline void push(const char *) {
@@ -87,6 +96,9 @@ inline void pop() {
     #if defined(USE_NVTX)
         nvtxRangePop();
     #endif
+    #if defined(USE_NVTX_TRACE)
+        TraceRecorder::pop();
+    #endif
 }
 
 /**
@@ -115,8 +127,8 @@ class NVTXRange {
 }  // namespace util
 }  // namespace flamegpu
 
-// If USE_NVTX is enabled, provide macros which actually use NVTX
-#if defined(USE_NVTX)
+// If USE_NVTX or USE_NVTX_TRACE is enabled, provide macros which actually use NVTX and/or the trace recorder
+#if defined(USE_NVTX) || defined(USE_NVTX_TRACE)
 /**
  * Macro which creates a scope-based NVTX range, with auto-popping of the marker.
  * If NVTX is defined, this constructs an util::nvtx::NVTXRange object with the specified label.
@@ -136,7 +148,7 @@ class NVTXRange {
  */
 #define NVTX_POP() ::flamegpu::util::nvtx::pop()
 #else
-// If NVTX is not enabled, provide macros which do nothing and optimise out any arguments.
+// If neither is enabled, provide macros which do nothing and optimise out any arguments.
 // Documentation is for the enabled version for doxygen.
 /**
  * Macro which creates a scope-based NVTX range, with auto-popping of the marker.
@@ -37,6 +37,13 @@ DeviceExceptionBuffer *DeviceExceptionManager::getDevicePtr(const unsigned int &
     memset(&hd_buffer[streamId], 0, sizeof(DeviceExceptionBuffer));
     return d_buffer[streamId];
 }
+size_t DeviceExceptionManager::getDeviceMemoryUsage() const {
+    size_t rtn = 0;
+    for (const auto &i : d_buffer) {
+        rtn += i ? sizeof(DeviceExceptionBuffer) : 0;
+    }
+    return rtn;
+}
 void DeviceExceptionManager::checkError(const std::string &function, const unsigned int &streamId, const cudaStream_t &stream) {
     if (streamId >= CUDAScanCompaction::MAX_STREAMS) {
         THROW exception::OutOfBoundsException("Stream id %u is out of bounds, %u >= %u, "
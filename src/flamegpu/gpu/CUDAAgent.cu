@@ -2,6 +2,7 @@
 
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -111,14 +112,7 @@ void CUDAAgent::mapRuntimeVariables(const AgentFunctionData& func, const unsigne
 
         // maximum population num
         if (func.func || func.condition) {
-#ifdef _DEBUG
-            const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + agent_hash + func_hash + instance_id, d_ptr, type_size, agent_count);
-            if (cv != static_cast<int>((var_hash + agent_hash + func_hash + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' Variable '%s' has a collision and may work improperly.\n", func.name.c_str(), mmp.first.c_str());
-            }
-#else
             curve.registerVariableByHash(var_hash + agent_hash + func_hash + instance_id, d_ptr, type_size, agent_count);
-#endif
         }
         // Map RTC variables to agent function (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
         if (!func.rtc_func_name.empty()) {
@@ -165,7 +159,7 @@ void CUDAAgent::unmapRuntimeVariables(const AgentFunctionData& func, const unsig
     // No current need to unmap RTC variables as they are specific to the agent functions and thus do not persist beyond the scope of a single function
 }
 
-void CUDAAgent::setPopulationData(const AgentVector& population, const std::string& state_name, CUDAScatter& scatter, const unsigned int& streamId, const cudaStream_t& stream) {
+void CUDAAgent::setPopulationData(const AgentVector& population, const std::string& state_name, CUDAScatter& scatter, const unsigned int& streamId, const cudaStream_t& stream, const bool validateIDs) {
     // Validate agent state
     auto our_state = state_map.find(state_name);
     if (our_state == state_map.end()) {
@@ -184,7 +178,9 @@ void CUDAAgent::setPopulationData(const AgentVector& population, const std::stri
     our_state->second->setAgentData(population, scatter, streamId, stream);
     fat_agent->markIDsUnset();
     // Validate that there are no ID collisions
-    validateIDCollisions();
+    if (validateIDs) {
+        validateIDCollisions();
+    }
 }
 void CUDAAgent::getPopulationData(AgentVector& population, const std::string& state_name) const {
     // Validate agent state
@@ -204,21 +200,24 @@ void CUDAAgent::getPopulationData(AgentVector& population, const std::string& st
     // This call hierarchy validates agent desc matches
     our_state->second->getAgentData(population);
 }
-__global__ void generateCollisionFlags(const id_t* d_sortedKeys, id_t* d_flagsOut, unsigned int threads, id_t UNSET_FLAG) {
+__global__ void countCollisions(const id_t* d_sortedKeys, unsigned int* d_collisionCount, unsigned int threads, id_t UNSET_FLAG) {
     const unsigned int id = blockIdx.x * blockDim.x + threadIdx.x;
+    bool collision = false;
     if (id < threads) {
         const id_t my_id = d_sortedKeys[id];
-        if (my_id != UNSET_FLAG && my_id == d_sortedKeys[id+1]) {
-            assert(UNSET_FLAG == 0);
-            d_flagsOut[id] = 1;  // my_id; // any non-0 value basically
-        }
+        collision = my_id != UNSET_FLAG && my_id == d_sortedKeys[id + 1];
+    }
+    // Every thread must reach the barrier, so the bounds check cannot return early
+    const int blockCollisions = __syncthreads_count(collision);
+    if (threadIdx.x == 0 && blockCollisions) {
+        atomicAdd(d_collisionCount, static_cast<unsigned int>(blockCollisions));
     }
 }
 void CUDAAgent::validateIDCollisions() const {
     NVTX_RANGE("CUDAAgent::validateIDCollisions");
     // All data is on device, so use a device technique to check for collisions
-    // Sort agent IDs, have a simple kernel check for neighbouring ID collisions to set a flag
-    // Scan that flag
+    // Sort agent IDs, then a single kernel counts neighbouring ID collisions
+    // The sort is limited to the significant bits of the largest ID, which for most populations avoids several radix passes
     // This could be improved by reusing buffers from elsewhere (e.g. StreamResources), rather than making temporary allocations for each method call
     // However, I'm also concerned that a model with agents added to multiple states and no agent birth would then pre-allocate larger buffers than required during execution
 
@@ -227,11 +226,23 @@ void CUDAAgent::validateIDCollisions() const {
     for (const auto &s : state_map) {
         agentCount += s.second->getSize();
     }
-    if (!agentCount) return;
-    // Allocate buffers we will use
-    id_t * d_keysIn = nullptr, *d_keysOut = nullptr;
-    gpuErrchk(cudaMalloc(&d_keysIn, sizeof(id_t) * agentCount));
-    gpuErrchk(cudaMalloc(&d_keysOut, sizeof(id_t) * agentCount));
+    // A single agent cannot collide
+    if (agentCount < 2) return;
+    // Query the temp storage required by cub, so all buffers can be carved from a single allocation
+    size_t sort_temp_bytes = 0, max_temp_bytes = 0;
+    gpuErrchk(cub::DeviceRadixSort::SortKeys(nullptr, sort_temp_bytes, static_cast<id_t*>(nullptr), static_cast<id_t*>(nullptr), agentCount));
+    gpuErrchk(cub::DeviceReduce::Max(nullptr, max_temp_bytes, static_cast<id_t*>(nullptr), static_cast<id_t*>(nullptr), agentCount));
+    const size_t temp_storage_bytes = std::max(sort_temp_bytes, max_temp_bytes);
+    // Layout: [keysIn][keysOut][max id][collision count][cub temp], each rounded up to preserve alignment
+    const size_t ALIGN = 256;
+    const size_t keys_bytes = ((sizeof(id_t) * agentCount + ALIGN - 1) / ALIGN) * ALIGN;
+    char *d_buffer = nullptr;
+    gpuErrchk(cudaMalloc(&d_buffer, 2 * keys_bytes + 2 * ALIGN + temp_storage_bytes));
+    id_t *d_keysIn = reinterpret_cast<id_t*>(d_buffer);
+    id_t *d_keysOut = reinterpret_cast<id_t*>(d_buffer + keys_bytes);
+    id_t *d_maxID = reinterpret_cast<id_t*>(d_buffer + 2 * keys_bytes);
+    unsigned int *d_collisionCount = reinterpret_cast<unsigned int*>(d_buffer + 2 * keys_bytes + ALIGN);
+    void *d_temp_storage = d_buffer + 2 * keys_bytes + 2 * ALIGN;
     // Copy agent IDs to keysIn buff
     ptrdiff_t buffOffset = 0;
     for (const auto& s : state_map) {
@@ -239,39 +250,40 @@ void CUDAAgent::validateIDCollisions() const {
         gpuErrchk(cudaMemcpy(d_keysIn + buffOffset, s.second->getVariablePointer(ID_VARIABLE_NAME), t_size * sizeof(id_t), cudaMemcpyDeviceToDevice));
         buffOffset += t_size;
     }
+    // Find the number of significant bits in the largest ID
+    size_t temp_bytes = temp_storage_bytes;
+    gpuErrchk(cub::DeviceReduce::Max(d_temp_storage, temp_bytes, d_keysIn, d_maxID, agentCount));
+    gpuErrchkLaunch();
+    id_t maxID = ID_NOT_SET;
+    gpuErrchk(cudaMemcpy(&maxID, d_maxID, sizeof(id_t), cudaMemcpyDeviceToHost));
+    if (maxID == ID_NOT_SET) {
+        // No IDs have been set, so they cannot collide
+        gpuErrchk(cudaFree(d_buffer));
+        return;
+    }
+    int endBit = 0;
+    while (endBit < static_cast<int>(sizeof(id_t) * 8) && (maxID >> endBit)) {
+        ++endBit;
+    }
     // Sort agent ids into d_keysOut
-    void* d_temp_storage = nullptr;
-    size_t temp_storage_bytes = 0;
-    gpuErrchk(cub::DeviceRadixSort::SortKeys(d_temp_storage, temp_storage_bytes, d_keysIn, d_keysOut, agentCount));
-    gpuErrchk(cudaMalloc(&d_temp_storage, temp_storage_bytes));
-    gpuErrchk(cub::DeviceRadixSort::SortKeys(d_temp_storage, temp_storage_bytes, d_keysIn, d_keysOut, agentCount));
-    // Reset d_keysIn
-    gpuErrchk(cudaMemset(d_keysIn, 0, sizeof(id_t) * agentCount));
-    // Launch a kernel to set flags if keys overlap their neighbour
+    temp_bytes = temp_storage_bytes;
+    gpuErrchk(cub::DeviceRadixSort::SortKeys(d_temp_storage, temp_bytes, d_keysIn, d_keysOut, agentCount, 0, endBit));
+    gpuErrchkLaunch();
+    // Launch a kernel to count keys which match their neighbour
+    gpuErrchk(cudaMemset(d_collisionCount, 0, sizeof(unsigned int)));
     const unsigned int blockSize = 1024;
-    const unsigned int blocks = ((agentCount-1) / blockSize) + 1;
-    generateCollisionFlags<<<blocks, blockSize>>>(d_keysOut, d_keysIn, agentCount-1, ID_NOT_SET);
+    const unsigned int blocks = ((agentCount - 1 - 1) / blockSize) + 1;
+    countCollisions<<<blocks, blockSize>>>(d_keysOut, d_collisionCount, agentCount - 1, ID_NOT_SET);
     gpuErrchkLaunch();
-    // Check whether any flags were set
-    size_t temp_storage_bytes2 = 0;
-    gpuErrchk(cub::DeviceReduce::Sum(nullptr, temp_storage_bytes2, d_keysIn, d_keysOut, agentCount - 1));
-    if (temp_storage_bytes2 > temp_storage_bytes) {
-        gpuErrchk(cudaFree(d_temp_storage));
-        temp_storage_bytes = temp_storage_bytes2;
-        gpuErrchk(cudaMalloc(&d_temp_storage, temp_storage_bytes));
-    }
-    gpuErrchk(cub::DeviceReduce::Sum(d_temp_storage, temp_storage_bytes, d_keysIn, d_keysOut, agentCount - 1));
-    id_t flagsSet = 0;
-    gpuErrchk(cudaMemcpy(&flagsSet, d_keysOut, sizeof(id_t), cudaMemcpyDeviceToHost));
+    unsigned int collisions = 0;
+    gpuErrchk(cudaMemcpy(&collisions, d_collisionCount, sizeof(unsigned int), cudaMemcpyDeviceToHost));
     // Cleanup
-    gpuErrchk(cudaFree(d_temp_storage));
-    gpuErrchk(cudaFree(d_keysIn));
-    gpuErrchk(cudaFree(d_keysOut));
-    if (flagsSet) {
+    gpuErrchk(cudaFree(d_buffer));
+    if (collisions) {
         THROW exception::AgentIDCollision("%u agents of type '%s' share an ID with another agent of the same type, "
             "you may need to explicitly reset agent IDs for 1 or more populations before adding them to the CUDASimulation, "
             "in CUDAAgent::validateIDCollisions()\n",
-            static_cast<unsigned int>(flagsSet), agent_description.name.c_str());
+            collisions, agent_description.name.c_str());
     }
 }
 /**
@@ -328,6 +340,9 @@ void CUDAAgent::setStateAgentCount(const std::string& state, const unsigned int&
 const AgentData &CUDAAgent::getAgentDescription() const {
     return agent_description;
 }
+const AgentData &CUDAAgent::getModelAgentDescription() const {
+    return *cudaSimulation.getModelDescription().agents.at(agent_description.name);
+}
 void *CUDAAgent::getStateVariablePtr(const std::string &state_name, const std::string &variable_name) {
     // check the cuda agent state map to find the correct state list for functions starting state
     const auto &sm = state_map.find(state_name);
@@ -437,14 +452,7 @@ void CUDAAgent::mapNewRuntimeVariables(const CUDAAgent& func_agent, const AgentF
 
             // maximum population num
             if (func.func) {
-#ifdef _DEBUG
-                const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + (_agent_birth_hash ^ func_hash) + instance_id, d_ptr, type_size, maxLen);
-                if (cv != static_cast<int>((var_hash + (_agent_birth_hash ^ func_hash) + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' New Agent Variable '%s' has a collision and may work improperly.\n", func.name.c_str(), mmp.first.c_str());
-                }
-#else
                 curve.registerVariableByHash(var_hash + (_agent_birth_hash ^ func_hash) + instance_id, d_ptr, type_size, maxLen);
-#endif
             } else  {
                 // Map RTC variables (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
                 // Copy data to rtc header cache
@@ -565,7 +573,7 @@ void CUDAAgent::addInstantitateRTCFunction(const AgentFunctionData& func, const
                 const char* type = p.second.type.name();
                 unsigned int elements = p.second.elements;
                 ptrdiff_t offset = p.second.rtc_offset;
-                curve_header.registerEnvVariable(variableName, offset, type, p.second.length/elements, elements);
+                curve_header.registerEnvVariable(variableName, offset, type, p.second.length/elements, elements, p.second.overflow);
             }
         }
         // Set mapped environment variables in curve
@@ -576,7 +584,7 @@ void CUDAAgent::addInstantitateRTCFunction(const AgentFunctionData& func, const
                 const char* type = p.type.name();
                 unsigned int elements = p.elements;
                 ptrdiff_t offset = p.rtc_offset;
-                curve_header.registerEnvVariable(variableName, offset, type, p.length/elements, elements);
+                curve_header.registerEnvVariable(variableName, offset, type, p.length/elements, elements, p.overflow);
             }
         }
     }
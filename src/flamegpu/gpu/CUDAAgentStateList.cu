@@ -2,6 +2,7 @@
 
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>
+#include <cstring>
 
 #include "flamegpu/gpu/CUDAAgent.h"
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
@@ -78,8 +79,8 @@ void *CUDAAgentStateList::getVariablePointer(const std::string &variable_name) {
     return var->second->data_condition;
 }
 void CUDAAgentStateList::setAgentData(const AgentVector& population, CUDAScatter& scatter, const unsigned int& streamId, const cudaStream_t& stream) {
-    // Validate AgentData matches
-    if (!population.matchesAgentType(agent.getAgentDescription())) {
+    // Validate AgentData matches (the population may contain variables which are not stored)
+    if (!population.matchesAgentType(agent.getModelAgentDescription())) {
         THROW exception::InvalidCudaAgentDesc("Agent description for agent '%s' does not match that of AgentVector, "
             "in CUDAAgentStateList::setAgentData()",
             population.getAgentName().c_str());
@@ -113,8 +114,8 @@ void CUDAAgentStateList::setAgentData(const AgentVector& population, CUDAScatter
     parent_list->setAgentCount(data_count);
 }
 void CUDAAgentStateList::getAgentData(AgentVector& population) const {
-    // Validate AgentData matches
-    if (!population.matchesAgentType(agent.getAgentDescription())) {
+    // Validate AgentData matches (the population may contain variables which are not stored)
+    if (!population.matchesAgentType(agent.getModelAgentDescription())) {
         THROW exception::InvalidCudaAgentDesc("Agent description for agent '%s' does not match that of AgentVector, "
             "in CUDAAgentStateList::setAgentData()",
             population.getAgentName().c_str());
@@ -136,6 +137,16 @@ void CUDAAgentStateList::getAgentData(AgentVector& population) const {
             // copy the host data to the GPU
             gpuErrchk(cudaMemcpy(v_data, _var.second->data, var_elements * var_size * data_count, cudaMemcpyDeviceToHost));
         }
+        // Variables which are not stored take their default value
+        for (const auto& var : population.agent->variables) {
+            if (variables.find(var.first) == variables.end()) {
+                const size_t var_size = var.second.type_size * var.second.elements;
+                char* v_data = static_cast<char*>(const_cast<void*>(static_cast<const AgentVector&>(population).data(var.first)));
+                for (unsigned int i = 0; i < data_count; ++i) {
+                    memcpy(v_data + i * var_size, var.second.default_value, var_size);
+                }
+            }
+        }
     }
     population._size = data_count;  // Private AgentVector::resize() does not update size
 }
@@ -1,7 +1,9 @@
 #include "flamegpu/gpu/CUDAEnsemble.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <thread>
 #include <set>
@@ -15,12 +17,16 @@
 #include "flamegpu/util/detail/compute_capability.cuh"
 #include "flamegpu/util/detail/SteadyClockTimer.h"
 #include "flamegpu/gpu/CUDASimulation.h"
+#include "flamegpu/io/StateReaderFactory.h"
 #include "flamegpu/io/StateWriterFactory.h"
+#include "flamegpu/pop/AgentVector.h"
 #include "flamegpu/util/detail/filesystem.h"
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/SimRunner.h"
 #include "flamegpu/sim/LogFrame.h"
 #include "flamegpu/sim/SimLogger.h"
+#include "flamegpu/sim/EnsembleCoordinator.h"
+#include "flamegpu/sim/EnsembleWorker.h"
 
 namespace flamegpu {
 
@@ -36,10 +42,24 @@ CUDAEnsemble::~CUDAEnsemble() {
 
 
 void CUDAEnsemble::simulate(const RunPlanVector &plans) {
+    if (!plan_populations.empty() && plan_populations.rbegin()->first >= plans.size()) {
+        THROW exception::OutOfBoundsException("Initial population was set for plan %u, but the RunPlanVector only contains %u plans, in CUDAEnsemble::simulate()",
+            plan_populations.rbegin()->first, static_cast<unsigned int>(plans.size()));
+    }
+    adaptive_results.clear();
+    std::vector<unsigned int> plan_index(plans.size());
+    for (unsigned int i = 0; i < plans.size(); ++i) {
+        plan_index[i] = i;
+    }
+    runPlans(plans, 0, plan_index);
+}
+void CUDAEnsemble::runPlans(const RunPlanVector &plans, const unsigned int first_log_index, const std::vector<unsigned int> &plan_index) {
     // Validate that RunPlan model matches CUDAEnsemble model
     if (*plans.environment != this->model->environment->properties) {
         THROW exception::InvalidArgument("RunPlan is for a different ModelDescription, in CUDAEnsemble::simulate()");
     }
+    // Select each run's initial population, these are shared rather than copied per run
+    const std::vector<SharedPopulation> run_populations = resolvePopulations(plan_index);
     // Validate/init output directories
     if (!config.out_directory.empty()) {
         // Validate out format is right
@@ -70,30 +90,49 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
     // Resize means we can setup logs during execution out of order, without risk of list being reallocated
     run_logs.clear();
     run_logs.resize(plans.size());
-    // Workout how many devices and runner we will be executing
-    int ct = -1;
-    gpuErrchk(cudaGetDeviceCount(&ct));
+    run_failed.assign(plans.size(), 0);
+    // Logging thread-safety items
+    std::queue<unsigned int> log_export_queue;
+    std::mutex log_export_queue_mutex;
+    std::condition_variable log_export_queue_cdn;
+    // Distributed ensembles, connect before any threads are started
+    if (!config.listen_address.empty() && !config.coordinator_address.empty()) {
+        THROW exception::InvalidArgument("Only one of the listen_address and coordinator_address config options may be set, in CUDAEnsemble::simulate()");
+    }
+    std::unique_ptr<EnsembleCoordinator> coordinator;
+    std::unique_ptr<EnsembleWorker> worker;
     std::set<int> devices;
-    if (config.devices.size()) {
-        devices = config.devices;
+    if (!config.listen_address.empty()) {
+        // The coordinator does not execute any runs itself
+        coordinator = std::unique_ptr<EnsembleCoordinator>(new EnsembleCoordinator(config.listen_address, model->name, !config.quiet, run_logs, run_failed, log_export_queue, log_export_queue_mutex, log_export_queue_cdn));
     } else {
-        for (int i = 0; i < ct; ++i) {
-        devices.emplace(i);
+        if (!config.coordinator_address.empty()) {
+            worker = std::unique_ptr<EnsembleWorker>(new EnsembleWorker(config.coordinator_address, static_cast<unsigned int>(plans.size()), model->name));
         }
-    }
-    // Check that each device is capable, and init cuda context
-    for (auto d = devices.begin(); d != devices.end(); ++d) {
-        if (!util::detail::compute_capability::checkComputeCapability(*d)) {
-            fprintf(stderr, "FLAMEGPU2 has not been built with an appropriate compute capability for device %d, this device will not be used.\n", *d);
-            d = devices.erase(d);
-            --d;
+        // Workout how many devices and runner we will be executing
+        int ct = -1;
+        gpuErrchk(cudaGetDeviceCount(&ct));
+        if (config.devices.size()) {
+            devices = config.devices;
         } else {
-            gpuErrchk(cudaSetDevice(*d));
-            gpuErrchk(cudaFree(nullptr));
+            for (int i = 0; i < ct; ++i) {
+            devices.emplace(i);
+            }
         }
+        // Check that each device is capable, and init cuda context
+        for (auto d = devices.begin(); d != devices.end(); ++d) {
+            if (!util::detail::compute_capability::checkComputeCapability(*d)) {
+                fprintf(stderr, "FLAMEGPU2 has not been built with an appropriate compute capability for device %d, this device will not be used.\n", *d);
+                d = devices.erase(d);
+                --d;
+            } else {
+                gpuErrchk(cudaSetDevice(*d));
+                gpuErrchk(cudaFree(nullptr));
+            }
+        }
+        // Return to device 0 (or check original device first?)
+        gpuErrchk(cudaSetDevice(0));
     }
-    // Return to device 0 (or check original device first?)
-    gpuErrchk(cudaSetDevice(0));
 
     // Init runners, devices * concurrent runs
     std::atomic<unsigned int> err_ct = {0};
@@ -107,11 +146,6 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
     // Reset the elapsed time.
     ensemble_elapsed_time = 0.;
 
-    // Logging thread-safety items
-    std::queue<unsigned int> log_export_queue;
-    std::mutex log_export_queue_mutex;
-    std::condition_variable log_export_queue_cdn;
-
     // Init with placement new
     {
         if (!config.quiet)
@@ -119,19 +153,24 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
         unsigned int i = 0;
         for (auto &d : devices) {
             for (unsigned int j = 0; j < config.concurrent_runs; ++j) {
-                new (&runners[i++]) SimRunner(model, err_ct, next_run, plans, step_log_config, exit_log_config, d, j, !config.quiet, run_logs, log_export_queue, log_export_queue_mutex, log_export_queue_cdn);
+                new (&runners[i++]) SimRunner(model, err_ct, next_run, plans, step_log_config, exit_log_config, d, j, !config.quiet, run_logs, run_failed, log_export_queue, log_export_queue_mutex, log_export_queue_cdn, run_populations, worker.get());
             }
         }
     }
 
-    // Init log worker
+    // Init log worker, a distributed ensemble's logs are written by the coordinator
     SimLogger *log_worker = nullptr;
-    if (!config.out_directory.empty() && !config.out_format.empty()) {
-        log_worker = new SimLogger(run_logs, plans, config.out_directory, config.out_format, log_export_queue, log_export_queue_mutex, log_export_queue_cdn);
-    } else if (!config.out_directory.empty() ^ !config.out_format.empty())  {
+    if (!worker && !config.out_directory.empty() && !config.out_format.empty()) {
+        log_worker = new SimLogger(run_logs, plans, first_log_index, config.out_directory, config.out_format, log_export_queue, log_export_queue_mutex, log_export_queue_cdn);
+    } else if (!worker && (!config.out_directory.empty() ^ !config.out_format.empty()))  {
         fprintf(stderr, "Warning: Only 1 of out_directory and out_format is set, both must be set for logging to commence to file.\n");
     }
 
+    // Serve workers until all runs have completed
+    if (coordinator) {
+        err_ct = coordinator->run();
+        coordinator.reset();
+    }
     // Wait for all runners to exit
     for (unsigned int i = 0; i < TOTAL_RUNNERS; ++i) {
         runners[i].thread.join();
@@ -153,8 +192,18 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
     ensemble_timer.stop();
     ensemble_elapsed_time = ensemble_timer.getElapsedSeconds();
 
+    // Free memory
+    free(runners);
+
+    if (worker && worker->connection_lost) {
+        THROW exception::EnsembleNetworkError("Lost connection to coordinator %s before all runs had completed, in CUDAEnsemble::simulate()", config.coordinator_address.c_str());
+    }
     // Ensemble has finished, print summary
-    if (!config.quiet) {
+    if (!config.quiet && worker) {
+        printf("\rCUDAEnsemble worker completed %u runs successfully!\n", worker->completed_runs.load());
+        if (err_ct)
+            printf("There were a total of %u errors.\n", err_ct.load());
+    } else if (!config.quiet) {
         printf("\rCUDAEnsemble completed %u runs successfully!\n", static_cast<unsigned int>(plans.size() - err_ct));
         if (err_ct)
             printf("There were a total of %u errors.\n", err_ct.load());
@@ -162,9 +211,112 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
     if (config.timing) {
         printf("Ensemble time elapsed: %fs\n", ensemble_elapsed_time);
     }
-
-    // Free memory
-    free(runners);
+}
+void CUDAEnsemble::simulate(const RunPlanVector &plans, const AdaptiveSampling &sampling) {
+    if (!sampling.replicate || !sampling.criterion) {
+        THROW exception::InvalidArgument("AdaptiveSampling requires both a replicate generator and a stopping criterion, in CUDAEnsemble::simulate()");
+    }
+    if (!config.listen_address.empty() || !config.coordinator_address.empty()) {
+        THROW exception::InvalidArgument("AdaptiveSampling is not supported by distributed ensembles, in CUDAEnsemble::simulate()");
+    }
+    if (sampling.min_replicates == 0 || sampling.min_replicates > sampling.max_replicates) {
+        THROW exception::InvalidArgument("AdaptiveSampling::min_replicates (%u) must be in the range [1, max_replicates (%u)], in CUDAEnsemble::simulate()",
+            sampling.min_replicates, sampling.max_replicates);
+    }
+    if (!plan_populations.empty() && plan_populations.rbegin()->first >= plans.size()) {
+        THROW exception::OutOfBoundsException("Initial population was set for plan %u, but the RunPlanVector only contains %u plans, in CUDAEnsemble::simulate()",
+            plan_populations.rbegin()->first, static_cast<unsigned int>(plans.size()));
+    }
+    adaptive_results.clear();
+    adaptive_results.resize(plans.size());
+    // The number of replicates of each configuration to execute in the next round
+    std::vector<unsigned int> pending(plans.size(), sampling.min_replicates);
+    std::vector<RunLog> all_logs;
+    double total_elapsed_time = 0;
+    while (true) {
+        // Build the round's plans from the configurations with pending replicates
+        RunPlanVector round(plans.environment, plans.allow_0_steps);
+        std::vector<unsigned int> round_config;
+        for (unsigned int c = 0; c < plans.size(); ++c) {
+            if (!pending[c])
+                continue;
+            const RunPlan base = plans[c];
+            for (unsigned int r = 0; r < pending[c]; ++r) {
+                round += sampling.replicate(base, adaptive_results[c].replicates++);
+                round_config.push_back(c);
+            }
+        }
+        if (round.size() == 0)
+            break;
+        runPlans(round, static_cast<unsigned int>(all_logs.size()), round_config);
+        total_elapsed_time += ensemble_elapsed_time;
+        // Sort the logs by configuration, runs were added in replicate order
+        for (unsigned int i = 0; i < round.size(); ++i) {
+            if (!run_failed[i])
+                adaptive_results[round_config[i]].logs.push_back(run_logs[i]);
+        }
+        all_logs.insert(all_logs.end(), std::make_move_iterator(run_logs.begin()), std::make_move_iterator(run_logs.end()));
+        // Evaluate the stopping criterion of the configurations which executed this round
+        for (unsigned int c = 0; c < plans.size(); ++c) {
+            if (!pending[c])
+                continue;
+            pending[c] = 0;
+            AdaptiveResult &result = adaptive_results[c];
+            std::vector<const RunLog*> logs;
+            logs.reserve(result.logs.size());
+            for (const auto &log : result.logs) {
+                logs.push_back(&log);
+            }
+            const unsigned int required = sampling.criterion(logs);
+            if (!required) {
+                result.converged = true;
+            } else if (result.replicates < sampling.max_replicates) {
+                pending[c] = std::min(required, sampling.max_replicates - result.replicates);
+                if (sampling.max_batch)
+                    pending[c] = std::min(pending[c], sampling.max_batch);
+            }
+        }
+    }
+    run_logs = std::move(all_logs);
+    ensemble_elapsed_time = total_elapsed_time;
+    if (!config.quiet) {
+        unsigned int converged = 0;
+        for (const auto &result : adaptive_results) {
+            converged += result.converged ? 1 : 0;
+        }
+        printf("CUDAEnsemble adaptive sampling executed %u runs, %u/%u configurations converged.\n",
+            static_cast<unsigned int>(run_logs.size()), converged, static_cast<unsigned int>(plans.size()));
+    }
+}
+CUDAEnsemble::ReplicateGenerator CUDAEnsemble::seedStep(const uint64_t step) {
+    return [step](const RunPlan &base, const unsigned int replicate) {
+        RunPlan rtn = base;
+        rtn.setRandomSimulationSeed(base.getRandomSimulationSeed() + replicate * step);
+        return rtn;
+    };
+}
+CUDAEnsemble::StoppingCriterion CUDAEnsemble::confidenceInterval(std::function<double(const RunLog&)> metric, const double half_width, const bool relative, const double z) {
+    return [metric, half_width, relative, z](const std::vector<const RunLog*> &logs) -> unsigned int {
+        // At least 2 samples are required to estimate the variance
+        if (logs.size() < 2)
+            return static_cast<unsigned int>(2 - logs.size());
+        // Welford's algorithm
+        double mean = 0, m2 = 0;
+        unsigned int n = 0;
+        for (const auto &log : logs) {
+            const double x = metric(*log);
+            const double delta = x - mean;
+            mean += delta / ++n;
+            m2 += delta * (x - mean);
+        }
+        const double stddev = sqrt(m2 / (n - 1));
+        const double threshold = relative ? half_width * std::abs(mean) : half_width;
+        if (z * stddev / sqrt(static_cast<double>(n)) <= threshold)
+            return 0;
+        // Estimate the number of samples required for the interval to reach the threshold
+        const double required = threshold > 0 ? std::ceil(pow(z * stddev / threshold, 2)) : static_cast<double>(UINT_MAX);
+        return required > n ? static_cast<unsigned int>(std::min(required - n, static_cast<double>(UINT_MAX))) : 1;
+    };
 }
 
 void CUDAEnsemble::initialise(int argc, const char** argv) {
@@ -254,6 +406,33 @@ int CUDAEnsemble::checkArgs(int argc, const char** argv) {
             }
             continue;
         }
+        // -i/--in <file.xml/file.json>, Initial population of every run
+        if (arg.compare("--in") == 0 || arg.compare("-i") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            loadInitialPopulation(argv[++i]);
+            continue;
+        }
+        // --listen <host:port>, Coordinate a distributed ensemble
+        if (arg.compare("--listen") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.listen_address = argv[++i];
+            continue;
+        }
+        // --coordinator <host:port>, Act as a worker of a distributed ensemble
+        if (arg.compare("--coordinator") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.coordinator_address = argv[++i];
+            continue;
+        }
         // -q/--quiet, Don't report progress to console.
         if (arg.compare("--quiet") == 0 || arg.compare("-q") == 0) {
             config.quiet = true;
@@ -281,6 +460,9 @@ void CUDAEnsemble::printHelp(const char *executable) {
     printf(line_fmt, "-c, --concurrent <runs>", "Number of concurrent simulations to run per device");
     printf(line_fmt, "", "By default, 4 will be used.");
     printf(line_fmt, "-o, --out <directory> <filetype>", "Directory and filetype for ensemble outputs");
+    printf(line_fmt, "-i, --in <file.xml/file.json>", "Initial population of every run (XML or JSON)");
+    printf(line_fmt, "--listen <host:port>", "Coordinate a distributed ensemble, assigning runs to workers");
+    printf(line_fmt, "--coordinator <host:port>", "Execute runs assigned by the coordinator of a distributed ensemble");
     printf(line_fmt, "-q, --quiet", "Don't print progress information to console");
     printf(line_fmt, "-t, --timing", "Output timing information to stdout");
 }
@@ -303,5 +485,85 @@ void CUDAEnsemble::setExitLog(const LoggingConfig &exitConfig) {
 const std::vector<RunLog> &CUDAEnsemble::getLogs() {
     return run_logs;
 }
+void CUDAEnsemble::setInitialPopulation(util::StringPairUnorderedMap<AgentVector> populations) {
+    initial_population = sharePopulation(std::move(populations));
+}
+void CUDAEnsemble::setInitialPopulation(const unsigned int plan_index, util::StringPairUnorderedMap<AgentVector> populations) {
+    SharedPopulation shared = sharePopulation(std::move(populations));
+    plan_populations.erase(plan_index);
+    plan_populations.emplace(plan_index, std::move(shared));
+}
+void CUDAEnsemble::loadInitialPopulation(const std::string &input_file) {
+    initial_population = sharePopulation(readPopulation(input_file));
+}
+void CUDAEnsemble::loadInitialPopulation(const unsigned int plan_index, const std::string &input_file) {
+    SharedPopulation shared = sharePopulation(readPopulation(input_file));
+    plan_populations.erase(plan_index);
+    plan_populations.emplace(plan_index, std::move(shared));
+}
+void CUDAEnsemble::clearInitialPopulation() {
+    initial_population.clear();
+    plan_populations.clear();
+}
+CUDAEnsemble::SharedPopulation CUDAEnsemble::sharePopulation(util::StringPairUnorderedMap<AgentVector> &&populations) const {
+    SharedPopulation rtn;
+    for (auto &pop : populations) {
+        const auto agent = model->agents.find(pop.first.first);
+        if (agent == model->agents.end()) {
+            THROW exception::InvalidAgent("Agent '%s' was not found, "
+                "in CUDAEnsemble::setInitialPopulation()",
+                pop.first.first.c_str());
+        }
+        if (agent->second->states.find(pop.first.second) == agent->second->states.end()) {
+            THROW exception::InvalidAgentState("State '%s' was not found in agent '%s', "
+                "in CUDAEnsemble::setInitialPopulation()",
+                pop.first.second.c_str(), pop.first.first.c_str());
+        }
+        if (!pop.second.matchesAgentType(*agent->second)) {
+            THROW exception::InvalidArgument("Population for agent '%s' state '%s' is of a different agent type, "
+                "in CUDAEnsemble::setInitialPopulation()",
+                pop.first.first.c_str(), pop.first.second.c_str());
+        }
+        rtn.emplace(pop.first, std::make_shared<const AgentVector>(std::move(pop.second)));
+    }
+    return rtn;
+}
+util::StringPairUnorderedMap<AgentVector> CUDAEnsemble::readPopulation(const std::string &input_file) const {
+    // Build population vector
+    util::StringPairUnorderedMap<std::shared_ptr<AgentVector>> pops;
+    for (auto &agent : model->agents) {
+        for (const auto &state : agent.second->states) {
+            pops.emplace(util::StringPair{ agent.first, state }, std::make_shared<AgentVector>(*agent.second->description));
+        }
+    }
+    // Environment properties are set by the RunPlans, so those loaded are discarded
+    util::StringUint32PairUnorderedMap<util::Any> env_init;
+    const auto env_desc = model->environment->getPropertiesMap();
+    std::unique_ptr<io::StateReader> reader(io::StateReaderFactory::createReader(model->name, env_desc, env_init, pops, input_file, nullptr));
+    reader->parse();
+    util::StringPairUnorderedMap<AgentVector> rtn;
+    for (auto &pop : pops) {
+        rtn.emplace(pop.first, std::move(*pop.second));
+    }
+    return rtn;
+}
+std::vector<CUDAEnsemble::SharedPopulation> CUDAEnsemble::resolvePopulations(const std::vector<unsigned int> &plan_index) const {
+    std::vector<SharedPopulation> rtn;
+    if (initial_population.empty() && plan_populations.empty())
+        return rtn;
+    rtn.reserve(plan_index.size());
+    for (const unsigned int i : plan_index) {
+        const auto override_it = plan_populations.find(i);
+        if (override_it == plan_populations.end()) {
+            rtn.push_back(initial_population);
+            continue;
+        }
+        // Agent states within the override replace those of every run
+        SharedPopulation pop = override_it->second;
+        pop.insert(initial_population.begin(), initial_population.end());
+        rtn.push_back(std::move(pop));
+    }
+    return rtn;
+}
 
 }  // namespace flamegpu
@@ -1,5 +1,9 @@
 #include "flamegpu/gpu/CUDAFatAgent.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "flamegpu/gpu/CUDAScatter.cuh"
 #include "flamegpu/runtime/HostAPI.h"
 #include "flamegpu/util/nvtx.h"
@@ -300,6 +304,14 @@ void CUDAFatAgent::freeNewBuffer(void *buff) {
     assert(false);
 }
 unsigned int CUDAFatAgent::getMappedAgentCount() const { return mappedAgentCount; }
+size_t CUDAFatAgent::getNewBufferDeviceMemoryUsage() {
+    std::lock_guard<std::mutex> guard(d_newLists_mutex);
+    size_t rtn = d_nextID ? sizeof(id_t) : 0;
+    for (const auto &b : d_newLists) {
+        rtn += b.size;
+    }
+    return rtn;
+}
 __global__ void allocateIDs(id_t*agentIDs, unsigned int threads, id_t UNSET_FLAG, id_t _nextID) {
     const unsigned int tid = blockIdx.x * blockDim.x + threadIdx.x;
     if (tid < threads) {
@@ -339,8 +351,10 @@ void CUDAFatAgent::notifyDeviceBirths(unsigned int newCount) {
 void CUDAFatAgent::assignIDs(HostAPI& hostapi) {
     NVTX_RANGE("CUDAFatAgent::assignIDs");
     if (agent_ids_have_init) return;
-    id_t h_max = ID_NOT_SET;
     // Find the max ID within the current agents
+    // The reductions of every state are issued together, so that only a single copy back to the host (and synchronisation) is required
+    std::vector<std::pair<id_t*, unsigned int>> idBuffers;
+    unsigned int maxSize = 0;
     for (auto& s : states_unique) {
         if (!s->getSize())
             continue;
@@ -348,19 +362,29 @@ void CUDAFatAgent::assignIDs(HostAPI& hostapi) {
         assert(s->getSizeWithDisabled() == s->getSize());
         auto vb = s->getVariableBuffer(0, ID_VARIABLE_NAME);  // _id always belongs to the root agent
         if (vb && vb->data) {
-            // Reduce for max
-            HostAPI::CUB_Config cc = { HostAPI::MAX, typeid(id_t).hash_code() };
-            if (hostapi.tempStorageRequiresResize(cc, s->getSize())) {
-                // Resize cub storage
-                size_t tempByte = 0;
-                gpuErrchk(cub::DeviceReduce::Max(nullptr, tempByte, static_cast<id_t*>(vb->data), reinterpret_cast<id_t*>(hostapi.d_output_space), s->getSize()));
-                gpuErrchkLaunch();
-                hostapi.resizeTempStorage(cc, s->getSize(), tempByte);
-            }
-            hostapi.resizeOutputSpace<id_t>();
-            gpuErrchk(cub::DeviceReduce::Max(hostapi.d_cub_temp, hostapi.d_cub_temp_size, static_cast<id_t*>(vb->data), reinterpret_cast<id_t*>(hostapi.d_output_space), s->getSize()));
-            gpuErrchk(cudaMemcpy(&h_max, hostapi.d_output_space, sizeof(id_t), cudaMemcpyDeviceToHost));
-            _nextID = std::max(_nextID, h_max + 1);
+            idBuffers.emplace_back(static_cast<id_t*>(vb->data), s->getSize());
+            maxSize = std::max(maxSize, s->getSize());
+        }
+    }
+    if (!idBuffers.empty()) {
+        // Reduce for max
+        HostAPI::CUB_Config cc = { HostAPI::MAX, typeid(id_t).hash_code() };
+        if (hostapi.tempStorageRequiresResize(cc, maxSize)) {
+            // Resize cub storage
+            size_t tempByte = 0;
+            gpuErrchk(cub::DeviceReduce::Max(nullptr, tempByte, idBuffers[0].first, reinterpret_cast<id_t*>(hostapi.d_output_space), maxSize, hostapi.stream));
+            gpuErrchkLaunch();
+            hostapi.resizeTempStorage(cc, maxSize, tempByte);
+        }
+        hostapi.resizeOutputSpace<id_t>(static_cast<unsigned int>(idBuffers.size()));
+        for (size_t i = 0; i < idBuffers.size(); ++i) {
+            gpuErrchk(cub::DeviceReduce::Max(hostapi.d_cub_temp, hostapi.d_cub_temp_size, idBuffers[i].first, reinterpret_cast<id_t*>(hostapi.d_output_space) + i, idBuffers[i].second, hostapi.stream));
+        }
+        std::vector<id_t> h_max(idBuffers.size(), ID_NOT_SET);
+        gpuErrchk(cudaMemcpyAsync(h_max.data(), hostapi.d_output_space, idBuffers.size() * sizeof(id_t), cudaMemcpyDeviceToHost, hostapi.stream));
+        gpuErrchk(cudaStreamSynchronize(hostapi.stream));
+        for (const id_t &m : h_max) {
+            _nextID = std::max(_nextID, m + 1);
         }
     }
 
@@ -374,11 +398,12 @@ void CUDAFatAgent::assignIDs(HostAPI& hostapi) {
         if (vb && vb->data && s->getSize()) {
             const unsigned int blockSize = 1024;
             const unsigned int blocks = ((s->getSize() - 1) / blockSize) + 1;
-            allocateIDs<< <blocks, blockSize >> > (static_cast<id_t*>(vb->data), s->getSize(), ID_NOT_SET, _nextID);
+            allocateIDs<< <blocks, blockSize, 0, hostapi.stream >> > (static_cast<id_t*>(vb->data), s->getSize(), ID_NOT_SET, _nextID);
             gpuErrchkLaunch();
         }
         _nextID += s->getSizeWithDisabled();
     }
+    gpuErrchk(cudaStreamSynchronize(hostapi.stream));
 
     agent_ids_have_init = true;
 }
@@ -124,6 +124,14 @@ unsigned int CUDAFatAgentStateList::getSizeWithDisabled() const {
 unsigned int CUDAFatAgentStateList::getAllocatedSize() const {
     return bufferLen;
 }
+size_t CUDAFatAgentStateList::getDeviceMemoryUsage() const {
+    size_t rtn = 0;
+    for (const auto &buff : variables_unique) {
+        // data and data_swap
+        rtn += 2 * buff->type_size * buff->elements * bufferLen;
+    }
+    return rtn;
+}
 void CUDAFatAgentStateList::setAgentCount(const unsigned int &newCount, const bool &resetDisabled) {
     if ((resetDisabled && newCount > bufferLen) || (!resetDisabled && (newCount + disabledAgents> bufferLen))) {
         THROW exception::InvalidMemoryCapacity("Agent count will exceed allocated buffer size, "
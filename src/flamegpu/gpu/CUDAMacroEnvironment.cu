@@ -85,6 +85,22 @@ void CUDAMacroEnvironment::free() {
         }
     }
 }
+size_t CUDAMacroEnvironment::getDeviceMemoryUsage() const {
+    size_t rtn = 0;
+    for (const auto& prop : properties) {
+        if (prop.second.d_ptr && !prop.second.is_sub) {
+            rtn += prop.second.type_size
+                * prop.second.elements[0]
+                * prop.second.elements[1]
+                * prop.second.elements[2]
+                * prop.second.elements[3];
+#if !defined(SEATBELTS) || SEATBELTS
+            rtn += sizeof(unsigned int);  // Extra uint is used as read-write flag by seatbelts
+#endif
+        }
+    }
+    return rtn;
+}
 void CUDAMacroEnvironment::purge() {
     for (auto& prop : properties)
         prop.second.d_ptr = nullptr;
@@ -100,14 +116,7 @@ void CUDAMacroEnvironment::mapRuntimeVariables() const {
         // get the agent variable size
         const unsigned int length = mmp.second.elements[0] * mmp.second.elements[1] * mmp.second.elements[2] * mmp.second.elements[3];
 
-#ifdef _DEBUG
-            const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + MACRO_NAMESPACE_HASH + cudaSimulation.getInstanceID(), mmp.second.d_ptr, mmp.second.type_size, length);
-            if (cv != static_cast<int>((var_hash + MACRO_NAMESPACE_HASH + cudaSimulation.getInstanceID()) % detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "detail::curve::Curve Warning: Environment macro property '%s' has a collision and may work improperly.\n", mmp.first.c_str());
-            }
-#else
             curve.registerVariableByHash(var_hash + MACRO_NAMESPACE_HASH + cudaSimulation.getInstanceID(), mmp.second.d_ptr, mmp.second.type_size, length);
-#endif
     }
 }
 
@@ -69,6 +69,19 @@ unsigned int CUDAMessage::getMaximumListSize() const {
 unsigned int CUDAMessage::getMessageCount() const {
     return message_count;
 }
+size_t CUDAMessage::getMessageListDeviceMemoryUsage() const {
+    if (!message_list)
+        return 0;
+    size_t message_size = 0;
+    for (const auto &v : message_description.variables) {
+        message_size += v.second.type_size * v.second.elements;
+    }
+    // Read and write (swap) lists
+    return 2 * message_size * max_list_size;
+}
+size_t CUDAMessage::getSpecialisationDeviceMemoryUsage() const {
+    return specialisation_handler->getDeviceMemoryUsage();
+}
 void CUDAMessage::setMessageCount(const unsigned int &_message_count) {
     if (_message_count > max_list_size) {
         THROW exception::OutOfBoundsException("message count exceeds allocated message list size (%u > %u) in CUDAMessage::setMessageCount().", _message_count, max_list_size);
@@ -116,14 +129,7 @@ void CUDAMessage::mapReadRuntimeVariables(const AgentFunctionData& func, const C
         if (func.func) {
             // maximum population size
             unsigned int length = this->getMessageCount();  // check to see if it is equal to pop
-#ifdef _DEBUG
-            const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + agent_hash + func_hash + message_hash + instance_id, d_ptr, size, length);
-            if (cv != static_cast<int>((var_hash + agent_hash + func_hash + message_hash + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' Message In Variable '%s' has a collision and may work improperly.\n", message_name.c_str(), mmp.first.c_str());
-            }
-#else
             curve.registerVariableByHash(var_hash + agent_hash + func_hash + message_hash + instance_id, d_ptr, size, length);
-#endif
         } else {
             // Map RTC variables (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
             // Copy data to rtc header cache
@@ -167,14 +173,7 @@ void CUDAMessage::mapWriteRuntimeVariables(const AgentFunctionData& func, const
         if (func.func) {
             // maximum population size
             unsigned int length = writeLen;  // check to see if it is equal to pop
-#ifdef _DEBUG
-            const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + agent_hash + func_hash + message_hash + instance_id, d_ptr, size, length);
-            if (cv != static_cast<int>((var_hash + agent_hash + func_hash + message_hash + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' Message '%s' Out? Variable '%s' has a collision and may work improperly.\n", func.name.c_str(), message_name.c_str(), mmp.first.c_str());
-            }
-#else
             curve.registerVariableByHash(var_hash + agent_hash + func_hash + message_hash + instance_id, d_ptr, size, length);
-#endif
         } else {
             // Map RTC variables (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
             // Copy data to rtc header cache
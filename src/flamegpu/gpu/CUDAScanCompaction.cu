@@ -31,6 +31,17 @@ const CUDAScanCompactionConfig &CUDAScanCompaction::getConfig(const Type& type,
 CUDAScanCompactionConfig &CUDAScanCompaction::Config(const Type& type, const unsigned int& streamId) {
     return configs[type][streamId];
 }
+size_t CUDAScanCompaction::getDeviceMemoryUsage() const {
+    size_t rtn = 0;
+    for (const auto &type : configs) {
+        for (const auto &cfg : type) {
+            // scan_flag and position
+            rtn += 2 * cfg.scan_flag_len * sizeof(unsigned int);
+            rtn += cfg.hd_cub_temp ? cfg.cub_temp_size : 0;
+        }
+    }
+    return rtn;
+}
 /**
  *
  */
@@ -50,6 +50,14 @@ void CUDAScatter::StreamData::resize(const unsigned int &newLen) {
     }
 }
 
+size_t CUDAScatter::getDeviceMemoryUsage() const {
+    size_t rtn = 0;
+    for (const auto &s : streamResources) {
+        rtn += s.d_data ? s.data_len * sizeof(ScatterData) : 0;
+    }
+    return rtn;
+}
+
 void CUDAScatter::purge() {
     for (auto &s : streamResources) {
         s.purge();
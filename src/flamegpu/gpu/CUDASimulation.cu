@@ -3,14 +3,23 @@
 #include <curand_kernel.h>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <string>
+#include <map>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "flamegpu/model/AgentFunctionData.cuh"
 #include "flamegpu/model/LayerData.h"
 #include "flamegpu/model/AgentDescription.h"
 #include "flamegpu/model/SubModelData.h"
 #include "flamegpu/model/SubAgentData.h"
+#include "flamegpu/model/VariableUsageAnalysis.h"
 #include "flamegpu/runtime/HostAPI.h"
+#include "flamegpu/runtime/utility/PhiloxRandom.cuh"
 #include "flamegpu/gpu/CUDAScanCompaction.h"
 #include "flamegpu/util/nvtx.h"
 #include "flamegpu/util/detail/compute_capability.cuh"
@@ -21,6 +30,7 @@
 #include "flamegpu/runtime/detail/curve/curve_rtc.cuh"
 #include "flamegpu/runtime/HostFunctionCallback.h"
 #include "flamegpu/gpu/CUDAAgent.h"
+#include "flamegpu/gpu/CUDAFatAgent.h"
 #include "flamegpu/gpu/CUDAMessage.h"
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/LogFrame.h"
@@ -33,6 +43,23 @@ namespace flamegpu {
 namespace {
     // file-scope only variable used to cache the driver mode
     bool deviceUsingWDDM = false;
+    /**
+     * Returns the label used to time a host function
+     * @param prefix Kind of host function, e.g. "step function "
+     * @param name Name of the host function, if known
+     * @param index Index of the host function, used if the name is not known
+     */
+    std::string hostFunctionLabel(const std::string &prefix, const std::string &name, const unsigned int index) {
+        return prefix + (name.empty() ? std::to_string(index) : name);
+    }
+    // Returns the end of the group of consecutive concurrent functions beginning at fns[i], or i + 1 if fns[i] is not concurrent
+    template<typename Fn>
+    size_t concurrentGroupEnd(const std::vector<Fn> &fns, const std::set<Fn> &concurrent, size_t i) {
+        if (!concurrent.count(fns[i]))
+            return i + 1;
+        while (++i < fns.size() && concurrent.count(fns[i])) { }
+        return i;
+    }
     // Inlined method in the anonymous namespace to create a new timer, subject to the driver model.
     std::unique_ptr<util::detail::Timer> getDriverAppropriateTimer() {
         if (!deviceUsingWDDM) {
@@ -41,6 +68,45 @@ namespace {
             return std::unique_ptr<util::detail::Timer>(new util::detail::SteadyClockTimer());
         }
     }
+    /**
+     * Pair of events recorded either side of work issued to a single stream.
+     * Used by the timing breakdown, so that concurrent kernels within a layer can be timed individually.
+     * The events are owned by the CUDASimulation, so that they are not created and destroyed per launch.
+     */
+    class StreamEventTimer {
+     public:
+        /**
+         * Records the start event in the provided stream
+         * @param _stream The stream which the timed work is issued to
+         * @param events The start and stop event, these must not be in use by another timer
+         */
+        StreamEventTimer(cudaStream_t _stream, const std::pair<cudaEvent_t, cudaEvent_t> &events)
+            : stream(_stream)
+            , startEvent(events.first)
+            , stopEvent(events.second) {
+            gpuErrchk(cudaEventRecord(startEvent, stream));
+        }
+        /**
+         * Record the stop event in the stream
+         */
+        void stop() {
+            gpuErrchk(cudaEventRecord(stopEvent, stream));
+        }
+        /**
+         * Waits for the stop event, and returns the elapsed time between the two events in seconds
+         */
+        double getElapsedSeconds() {
+            float ms = 0;
+            gpuErrchk(cudaEventSynchronize(stopEvent));
+            gpuErrchk(cudaEventElapsedTime(&ms, startEvent, stopEvent));
+            return ms / 1000.0;
+        }
+
+     private:
+        cudaStream_t stream;
+        cudaEvent_t startEvent;
+        cudaEvent_t stopEvent;
+    };
 }  // anonymous namespace
 
 std::map<int, std::atomic<int>> CUDASimulation::active_device_instances;
@@ -67,8 +133,7 @@ CUDASimulation::CUDASimulation(const std::shared_ptr<const ModelData> &_model)
     , streams(std::vector<cudaStream_t>())
     , singletons(nullptr)
     , singletonsInitialised(false)
-    , rtcInitialised(false)
-    , isPureRTC(detectPureRTC(model)) {
+    , rtcInitialised(false) {
     ++active_instances;
     initOffsetsAndMap();
     // Register the signal handler.
@@ -96,21 +161,56 @@ CUDASimulation::CUDASimulation(const std::shared_ptr<const ModelData> &_model)
         submodel_map.emplace(it_sm->first, std::unique_ptr<CUDASimulation>(new CUDASimulation(it_sm->second, this)));
     }
 }
-bool CUDASimulation::detectPureRTC(const std::shared_ptr<const ModelData>& _model) {
-    const auto& am = _model->agents;
-    for (auto it = am.cbegin(); it != am.cend(); ++it) {
-        for (const auto& af : it->second->functions) {
-            if (af.second->func || af.second->condition)
-                return false;
+void CUDASimulation::eliminateAgentVariables() {
+    if (agentVariablesEliminated)
+        return;
+    bool visualisationCreated = false;
+#ifdef VISUALISATION
+    visualisationCreated = static_cast<bool>(visualisation);
+#endif
+    bool populationAllocated = false;
+    for (const auto &agent : model->agents) {
+        for (const auto &state : agent.second->states) {
+            populationAllocated |= agent_map.at(agent.first)->getStateAllocatedSize(state) > 0;
         }
     }
-    // TODO: In future this will need to be extended for new forms of device function, e.g. device init
-    const auto& as = _model->submodels;
-    for (auto it = as.cbegin(); it != as.cend(); ++it) {
-        if (!detectPureRTC(it->second->submodel))
-          return false;
+    if (populationAllocated || rtcInitialised || step_count || visualisationCreated) {
+        THROW exception::InvalidOperation("Unused agent variables cannot be eliminated after population data has been set, the simulation has been stepped or the visualisation has been created, "
+            "CUDAConfig().eliminateUnusedAgentVariables must be enabled before any of these occur, "
+            "in CUDASimulation::eliminateAgentVariables()\n");
+    }
+    agentVariablesEliminated = true;
+    VariableUsageAnalysis analysis(*model);
+    if (step_log_config)
+        analysis.addLoggingConfig(*step_log_config);
+    if (exit_log_config)
+        analysis.addLoggingConfig(*exit_log_config);
+    std::shared_ptr<ModelData> stripped = model->clone();
+    for (const auto &agent : model->agents) {
+        const std::set<std::string> eliminable = analysis.getEliminableVariables(agent.first);
+        if (eliminable.empty())
+            continue;
+        for (const auto &v : eliminable) {
+            stripped->agents.at(agent.first)->variables.erase(v);
+        }
+        eliminatedAgentVariables.emplace(agent.first, eliminable);
+    }
+    if (eliminatedAgentVariables.empty())
+        return;
+    storage_model = stripped;
+    // Replace the CUDAAgents, these do not yet hold any device memory
+    for (const auto &agent : eliminatedAgentVariables) {
+        agent_map.at(agent.first) = std::make_unique<CUDAAgent>(*storage_model->agents.at(agent.first), *this);
+    }
+    if (getSimulationConfig().verbose) {
+        fprintf(stdout, "%s", analysis.getReport().c_str());
+    }
+    for (const auto &warning : analysis.getWarnings()) {
+        fprintf(stderr, "Warning: %s\n", warning.c_str());
     }
-    return true;
+}
+const std::map<std::string, std::set<std::string>> &CUDASimulation::getEliminatedAgentVariables() const {
+    return eliminatedAgentVariables;
 }
 CUDASimulation::CUDASimulation(const std::shared_ptr<SubModelData> &submodel_desc, CUDASimulation *master_model)
     : Simulation(submodel_desc, master_model)
@@ -120,8 +220,7 @@ CUDASimulation::CUDASimulation(const std::shared_ptr<SubModelData> &submodel_des
     , streams(std::vector<cudaStream_t>())
     , singletons(nullptr)
     , singletonsInitialised(false)
-    , rtcInitialised(false)
-    , isPureRTC(master_model->isPureRTC) {
+    , rtcInitialised(false) {
     ++active_instances;
     initOffsetsAndMap();
     // Ensure submodel is valid
@@ -203,7 +302,13 @@ CUDASimulation::~CUDASimulation() {
     message_map.clear();
     submodel_map.clear();
     host_api.reset();
+    concurrent_host_apis.clear();
     macro_env.free();
+    if (d_host_agent_creation_buffer) {
+        gpuErrchk(cudaFree(d_host_agent_creation_buffer));
+        d_host_agent_creation_buffer = nullptr;
+        d_host_agent_creation_buffer_len = 0;
+    }
 #ifdef VISUALISATION
     visualisation.reset();
 #endif
@@ -235,12 +340,20 @@ void CUDASimulation::initFunctions() {
     initFunctionsTimer->start();
 
     // Execute normal init functions
+    util::detail::SteadyClockTimer hostFnTimer;
+    unsigned int hostFnIndex = 0;
     for (auto &initFn : model->initFunctions) {
+        hostFnTimer.start();
         initFn(this->host_api.get());
+        hostFnTimer.stop();
+        recordHostFunctionTime(hostFunctionLabel("init function ", detail::getHostFunctionName(initFn), hostFnIndex++), hostFnTimer.getElapsedSeconds(), false);
     }
     // Execute init function callbacks (python)
     for (auto &initFn : model->initFunctionCallbacks) {
+        hostFnTimer.start();
         initFn->run(this->host_api.get());
+        hostFnTimer.stop();
+        recordHostFunctionTime(hostFunctionLabel("init function ", initFn->getName(), hostFnIndex++), hostFnTimer.getElapsedSeconds(), false);
     }
     // Check if host agent creation was used in init functions
     if (model->initFunctions.size() || model->initFunctionCallbacks.size()) {
@@ -261,12 +374,20 @@ void CUDASimulation::exitFunctions() {
     exitFunctionsTimer->start();
 
     // Execute exit functions
+    util::detail::SteadyClockTimer hostFnTimer;
+    unsigned int hostFnIndex = 0;
     for (auto &exitFn : model->exitFunctions) {
+        hostFnTimer.start();
         exitFn(this->host_api.get());
+        hostFnTimer.stop();
+        recordHostFunctionTime(hostFunctionLabel("exit function ", detail::getHostFunctionName(exitFn), hostFnIndex++), hostFnTimer.getElapsedSeconds(), false);
     }
     // Execute any exit functions from swig/python
     for (auto &exitFn : model->exitFunctionCallbacks) {
+        hostFnTimer.start();
         exitFn->run(this->host_api.get());
+        hostFnTimer.stop();
+        recordHostFunctionTime(hostFunctionLabel("exit function ", exitFn->getName(), hostFnIndex++), hostFnTimer.getElapsedSeconds(), false);
     }
 
     // Record, store and output the elapsed time of the step.
@@ -285,6 +406,17 @@ bool CUDASimulation::step() {
     // Time the individual step, using a CUDAEventTimer if possible, else a steadyClockTimer.
     std::unique_ptr<util::detail::Timer> stepTimer = getDriverAppropriateTimer();
     stepTimer->start();
+    // Components of the step are timed with host timers, as they synchronise
+    const bool timingBreakdown = getCUDAConfig().timingBreakdown;
+    util::detail::SteadyClockTimer breakdownTimer;
+    if (timingBreakdown) {
+        this->elapsedSecondsPerStepBreakdown.push_back({});
+    }
+    // Per step host function times are only retained if they will be reported or checked
+    if (getSimulationConfig().timing || getCUDAConfig().slowHostFunctionFraction > 0) {
+        this->elapsedSecondsPerStepHostFunctions.push_back({});
+    }
+    const EnvironmentUploads envUploadsBefore = getEnvironmentUploadTotals();
 
     // Init any unset agent IDs
     this->assignAgentIDs();
@@ -307,17 +439,34 @@ bool CUDASimulation::step() {
     // Execute each layer of the simulation.
     unsigned int layerIndex = 0;
     for (auto& layer : model->layers) {
+        if (timingBreakdown)
+            breakdownTimer.start();
         // Execute the individual layer
         stepLayer(layer, layerIndex);
+        if (timingBreakdown) {
+            breakdownTimer.stop();
+            recordTimingBreakdown("layer " + std::to_string(layerIndex), breakdownTimer.getElapsedSeconds());
+        }
         // Increment counter
         ++layerIndex;
     }
 
     // Run the step functions (including pyhton.)
+    if (timingBreakdown)
+        breakdownTimer.start();
     stepStepFunctions();
+    if (timingBreakdown) {
+        breakdownTimer.stop();
+        recordTimingBreakdown("step functions", breakdownTimer.getElapsedSeconds());
+        breakdownTimer.start();
+    }
 
     // Run the exit conditons, detecting wheter or not any we
     bool exitRequired = this->stepExitConditions();
+    if (timingBreakdown) {
+        breakdownTimer.stop();
+        recordTimingBreakdown("exit conditions", breakdownTimer.getElapsedSeconds());
+    }
 
     // Record, store and output the elapsed time of the step.
     stepTimer->stop();
@@ -327,11 +476,29 @@ bool CUDASimulation::step() {
         // Resolution is 0.5 microseconds, so print to 1 us.
         fprintf(stdout, "Step %d Processing time: %.6f s\n", this->step_count, stepMilliseconds);
     }
+    checkSlowHostFunctions(stepMilliseconds);
+    {
+        const EnvironmentUploads envUploadsAfter = getEnvironmentUploadTotals();
+        EnvironmentUploads envUploads;
+        envUploads.bytes = envUploadsAfter.bytes - envUploadsBefore.bytes;
+        envUploads.uploads = envUploadsAfter.uploads - envUploadsBefore.uploads;
+        this->environmentUploadsPerStep.push_back(envUploads);
+    }
 
     // Update step count at the end of the step - when it has completed.
     incrementStepCounter();
     // Update the log for the step.
+    if (timingBreakdown)
+        breakdownTimer.start();
     processStepLog();
+    if (timingBreakdown) {
+        breakdownTimer.stop();
+        recordTimingBreakdown("log reduction", breakdownTimer.getElapsedSeconds());
+        // The breakdown is complete, so it can be added to the run log
+        run_log->step_timing.push_back(this->elapsedSecondsPerStepBreakdown.back());
+    }
+    // Buffers only grow during a step, so sampling at the end of the step captures the peak
+    sampleMemoryUsage();
     // Return false if any exit condition's passed.
     return !exitRequired;
 }
@@ -341,8 +508,16 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
 
     std::string message_name;
 
+    // Kernels are timed with events in their stream, other components of the layer are timed with a host timer
+    const bool timingBreakdown = getCUDAConfig().timingBreakdown;
+    const std::string timingLabel = "layer " + std::to_string(layerIndex) + ": ";
+    std::vector<std::pair<std::string, StreamEventTimer>> kernelTimers;
+    util::detail::SteadyClockTimer breakdownTimer;
+
     // If the layer contains a sub model, it can only execute the sub model.
     if (layer->sub_model) {
+        if (timingBreakdown)
+            breakdownTimer.start();
         auto &sm = submodel_map.at(layer->sub_model->name);
         sm->resetStepCounter();
         sm->simulate();
@@ -350,6 +525,10 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
         // Next layer, this layer cannot also contain agent functions
         // Ensure syncrhonisation has occured.
         this->synchronizeAllStreams();
+        if (timingBreakdown) {
+            breakdownTimer.stop();
+            recordTimingBreakdown(timingLabel + "submodel " + layer->sub_model->name, breakdownTimer.getElapsedSeconds());
+        }
         return;
     }
 
@@ -399,15 +578,16 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
     if (totalThreads > 0) {
         auto env_shared_lock = this->singletons->environment.getSharedLock();
         auto env_device_lock = this->singletons->environment.getDeviceSharedLock();
+        // RTC functions read overflowed environment properties from global memory, so this is required by them too
+        this->singletons->environment.updateDevice(instance_id);
         if (!has_rtc_func_cond) {
-            this->singletons->environment.updateDevice(instance_id);
             this->singletons->curve.updateDevice();
 
             // this->synchronizeAllStreams();  // Not required, the above is snchronizing.
         }
 
-        // Ensure RandomManager is the correct size to accommodate all threads to be launched
-        curandState *d_rng = singletons->rng.resize(totalThreads);  // @todo - stream + sync.
+        // Ensure RandomManager is the correct size to accommodate all threads to be launched, counter-based random requires no state
+        curandState *d_rng = getCUDAConfig().counterBasedRandom ? nullptr : singletons->rng.resize(totalThreads);  // @todo - stream + sync.
         // Track which stream to use for concurrency
         streamIdx = 0;
         // Sum the total number of threads being launched in the layer, for rng offsetting.
@@ -439,13 +619,18 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                 detail::curve::Curve::NamespaceHash agentname_hash = detail::curve::Curve::variableRuntimeHash(agent_name.c_str());
                 detail::curve::Curve::NamespaceHash funcname_hash = detail::curve::Curve::variableRuntimeHash(func_name.c_str());
                 detail::curve::Curve::NamespaceHash agent_func_name_hash = agentname_hash + funcname_hash + instance_id;
-                curandState *t_rng = d_rng + totalThreads;
+                curandState *t_rng = d_rng ? d_rng + totalThreads : nullptr;
+                const PhiloxRandom::Key rng_key = {philoxSeed(), step_count, PhiloxRandom::agentFunctionStream(agent_name, func_name, true)};
                 unsigned int *scanFlag_agentDeath = this->singletons->scatter.Scan().Config(CUDAScanCompaction::Type::AGENT_DEATH, streamIdx).d_ptrs.scan_flag;
                 unsigned int sm_size = 0;
 #if !defined(SEATBELTS) || SEATBELTS
                 auto *error_buffer = this->singletons->exception.getDevicePtr(streamIdx, this->getStream(streamIdx));
                 sm_size = sizeof(error_buffer);
 #endif
+                if (timingBreakdown) {
+                    kernelTimers.emplace_back(timingLabel + "condition " + agent_name + "::" + func_name,
+                        StreamEventTimer(this->getStream(streamIdx), getTimingEvents(streamIdx)));
+                }
                 // switch between normal and RTC agent function condition
                 if (func_des->condition) {
                     // calculate the grid block size for agent function condition
@@ -461,6 +646,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                     agent_func_name_hash,
                     state_list_size,
                     t_rng,
+                    rng_key,
                     scanFlag_agentDeath);
                     gpuErrchkLaunch();
                 } else {  // RTC function
@@ -481,6 +667,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                         reinterpret_cast<void*>(&agent_func_name_hash),
                         const_cast<void *>(reinterpret_cast<const void*>(&state_list_size)),
                         reinterpret_cast<void*>(&t_rng),
+                        const_cast<void*>(reinterpret_cast<const void*>(&rng_key)),
                         reinterpret_cast<void*>(&scanFlag_agentDeath) });
                     if (a != CUresult::CUDA_SUCCESS) {
                         const char* err_str = nullptr;
@@ -489,6 +676,9 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                     }
                     gpuErrchkLaunch();
                 }
+                if (timingBreakdown) {
+                    kernelTimers.back().second.stop();
+                }
 
                 totalThreads += state_list_size;
                 ++streamIdx;
@@ -500,6 +690,10 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
         this->synchronizeAllStreams();
         env_shared_lock.unlock();
         env_device_lock.unlock();
+        for (auto &timer : kernelTimers) {
+            recordTimingBreakdown(timer.first, timer.second.getElapsedSeconds());
+        }
+        kernelTimers.clear();
     }
 
     // Track stream index
@@ -528,7 +722,13 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             this->singletons->exception.checkError("condition " + func_des->name, streamIdx, this->getStream(streamIdx));
 #endif
             // Process agent function condition
+            if (timingBreakdown)
+                breakdownTimer.start();
             cuda_agent.processFunctionCondition(*func_des, this->singletons->scatter, streamIdx, this->getStream(streamIdx));
+            if (timingBreakdown) {
+                breakdownTimer.stop();
+                recordTimingBreakdown(timingLabel + "condition scatter " + func_agent->name + "::" + func_des->name, breakdownTimer.getElapsedSeconds());
+            }
             // Increment the stream tracker.
             ++streamIdx;
         }
@@ -560,7 +760,13 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             std::string inpMessage_name = im->name;
             CUDAMessage& cuda_message = getCUDAMessage(inpMessage_name);
             // Construct PBM here if required!!
+            if (timingBreakdown)
+                breakdownTimer.start();
             cuda_message.buildIndex(this->singletons->scatter, streamIdx, this->getStream(streamIdx));  // This is synchronous.
+            if (timingBreakdown) {
+                breakdownTimer.stop();
+                recordTimingBreakdown(timingLabel + "buildIndex " + inpMessage_name, breakdownTimer.getElapsedSeconds());
+            }
             // Map variables after, as index building can swap arrays
             cuda_message.mapReadRuntimeVariables(*func_des, cuda_agent, instance_id);
         }
@@ -616,14 +822,15 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
     if (totalThreads > 0) {
         auto env_shared_lock = this->singletons->environment.getSharedLock();
         auto env_device_lock = this->singletons->environment.getDeviceSharedLock();
+        // RTC functions read overflowed environment properties from global memory, so this is required by them too
+        this->singletons->environment.updateDevice(instance_id);
         if (!has_rtc_func) {
-            this->singletons->environment.updateDevice(instance_id);
             this->singletons->curve.updateDevice();
             this->synchronizeAllStreams();  // This is not strictly required as updateDevice is synchronous.
         }
 
-        // Ensure RandomManager is the correct size to accommodate all threads to be launched
-        curandState *d_rng = singletons->rng.resize(totalThreads);
+        // Ensure RandomManager is the correct size to accommodate all threads to be launched, counter-based random requires no state
+        curandState *d_rng = getCUDAConfig().counterBasedRandom ? nullptr : singletons->rng.resize(totalThreads);
         // Total threads is now used to provide kernel launches an offset to thread-safe thread-index
         totalThreads = 0;
         streamIdx = 0;
@@ -688,7 +895,8 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             int gridSize = 0;  // The actual grid size needed, based on input size
 
             // Agent function kernel wrapper args
-            curandState * t_rng = d_rng + totalThreads;
+            curandState * t_rng = d_rng ? d_rng + totalThreads : nullptr;
+            const PhiloxRandom::Key rng_key = {philoxSeed(), step_count, PhiloxRandom::agentFunctionStream(agent_name, func_name)};
             unsigned int *scanFlag_agentDeath = func_des->has_agent_death ? this->singletons->scatter.Scan().Config(CUDAScanCompaction::Type::AGENT_DEATH, streamIdx).d_ptrs.scan_flag : nullptr;
             unsigned int *scanFlag_messageOutput = this->singletons->scatter.Scan().Config(CUDAScanCompaction::Type::MESSAGE_OUTPUT, streamIdx).d_ptrs.scan_flag;
             unsigned int *scanFlag_agentOutput = this->singletons->scatter.Scan().Config(CUDAScanCompaction::Type::AGENT_OUTPUT, streamIdx).d_ptrs.scan_flag;
@@ -697,6 +905,10 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             auto *error_buffer = this->singletons->exception.getDevicePtr(streamIdx, this->getStream(streamIdx));
             sm_size = sizeof(error_buffer);
     #endif
+            if (timingBreakdown) {
+                kernelTimers.emplace_back(timingLabel + agent_name + "::" + func_name,
+                    StreamEventTimer(this->getStream(streamIdx), getTimingEvents(streamIdx)));
+            }
 
             if (func_des->func) {   // compile time specified agent function launch
                 // calculate the grid block size for main agent function
@@ -718,6 +930,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                     d_in_messagelist_metadata,
                     d_out_messagelist_metadata,
                     t_rng,
+                    rng_key,
                     scanFlag_agentDeath,
                     scanFlag_messageOutput,
                     scanFlag_agentOutput);
@@ -745,6 +958,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                     const_cast<void*>(reinterpret_cast<const void*>(&d_in_messagelist_metadata)),
                     const_cast<void*>(reinterpret_cast<const void*>(&d_out_messagelist_metadata)),
                     const_cast<void*>(reinterpret_cast<const void*>(&t_rng)),
+                    const_cast<void*>(reinterpret_cast<const void*>(&rng_key)),
                     reinterpret_cast<void*>(&scanFlag_agentDeath),
                     reinterpret_cast<void*>(&scanFlag_messageOutput),
                     reinterpret_cast<void*>(&scanFlag_agentOutput)});
@@ -755,6 +969,9 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                 }
                 gpuErrchkLaunch();
             }
+            if (timingBreakdown) {
+                kernelTimers.back().second.stop();
+            }
             totalThreads += state_list_size;
             ++streamIdx;
         }
@@ -763,6 +980,10 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
         this->synchronizeAllStreams();
         env_shared_lock.unlock();
         env_device_lock.unlock();
+        for (auto &timer : kernelTimers) {
+            recordTimingBreakdown(timer.first, timer.second.getElapsedSeconds());
+        }
+        kernelTimers.clear();
     }
 
     streamIdx = 0;
@@ -776,6 +997,8 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
         CUDAAgent& cuda_agent = getCUDAAgent(func_agent->name);
 
         const unsigned int state_list_size = cuda_agent.getStateSize(func_des->initial_state);
+        if (timingBreakdown)
+            breakdownTimer.start();
         // If agent function wasn't executed, these are redundant
         if (state_list_size > 0) {
             // check if a function has an input message
@@ -826,6 +1049,10 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             // This means that curve is cleaned up before we throw exception (mostly prevents curve being polluted if we catch and handle errors)
             this->singletons->exception.checkError(func_des->name, streamIdx, this->getStream(streamIdx));
 #endif
+            if (timingBreakdown) {
+                breakdownTimer.stop();
+                recordTimingBreakdown(timingLabel + "scatter " + func_agent->name + "::" + func_des->name, breakdownTimer.getElapsedSeconds());
+            }
         }
 
         ++streamIdx;
@@ -850,35 +1077,96 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
 void CUDASimulation::layerHostFunctions(const std::shared_ptr<LayerData>& layer, const unsigned int layerIndex) {
     NVTX_RANGE("CUDASimulation::stepHostFunctions");
     // Execute all host functions attached to layer
-    // TODO: Concurrency?
     assert(host_api);
-    for (auto &stepFn : layer->host_functions) {
-        NVTX_RANGE("hostFunc");
-        stepFn(this->host_api.get());
+    const bool timingBreakdown = getCUDAConfig().timingBreakdown;
+    const std::string timingLabel = "layer " + std::to_string(layerIndex) + ": ";
+    util::detail::SteadyClockTimer breakdownTimer;
+    // Host functions are labelled by their name if known, else their index within the layer, callbacks follow regular host functions
+    unsigned int hostFnIndex = 0;
+    if (layer->concurrent_host_functions && layer->host_functions.size() > 1) {
+        // Concurrent host functions are executed together
+        std::vector<std::function<void(HostAPI*)>> fns;
+        std::vector<std::string> labels;
+        for (auto &stepFn : layer->host_functions) {
+            fns.push_back(stepFn);
+            labels.push_back(hostFunctionLabel(timingLabel + "host function ", detail::getHostFunctionName(stepFn), hostFnIndex++));
+        }
+        const std::vector<double> elapsed = runConcurrentHostFunctions(fns);
+        for (size_t i = 0; i < labels.size(); ++i) {
+            recordHostFunctionTime(labels[i], elapsed[i], true);
+            if (timingBreakdown) {
+                recordTimingBreakdown(labels[i], elapsed[i]);
+            }
+        }
+    } else {
+        for (auto &stepFn : layer->host_functions) {
+            NVTX_RANGE("hostFunc");
+            const std::string label = hostFunctionLabel(timingLabel + "host function ", detail::getHostFunctionName(stepFn), hostFnIndex++);
+            breakdownTimer.start();
+            stepFn(this->host_api.get());
+            breakdownTimer.stop();
+            recordHostFunctionTime(label, breakdownTimer.getElapsedSeconds(), true);
+            if (timingBreakdown) {
+                recordTimingBreakdown(label, breakdownTimer.getElapsedSeconds());
+            }
+        }
     }
     // Execute all host function callbacks attached to layer
     for (auto &stepFn : layer->host_functions_callbacks) {
         NVTX_RANGE("hostFunc_swig");
+        const std::string label = hostFunctionLabel(timingLabel + "host function ", stepFn->getName(), hostFnIndex++);
+        breakdownTimer.start();
         stepFn->run(this->host_api.get());
+        breakdownTimer.stop();
+        recordHostFunctionTime(label, breakdownTimer.getElapsedSeconds(), true);
+        if (timingBreakdown) {
+            recordTimingBreakdown(label, breakdownTimer.getElapsedSeconds());
+        }
     }
     // If we have host layer functions, we might have host agent creation
     if (layer->host_functions.size() || (layer->host_functions_callbacks.size())) {
+        if (timingBreakdown)
+            breakdownTimer.start();
         // @todo - What is the most appropriate stream to use here?
         processHostAgentCreation(0);
+        if (timingBreakdown) {
+            breakdownTimer.stop();
+            recordTimingBreakdown(timingLabel + "host agent creation", breakdownTimer.getElapsedSeconds());
+        }
     }
 }
 
 void CUDASimulation::stepStepFunctions() {
     NVTX_RANGE("CUDASimulation::step::StepFunctions");
     // Execute step functions
-    for (auto &stepFn : model->stepFunctions) {
-        NVTX_RANGE("stepFunc");
-        stepFn(this->host_api.get());
+    util::detail::SteadyClockTimer hostFnTimer;
+    unsigned int hostFnIndex = 0;
+    const auto &stepFunctions = model->stepFunctions;
+    for (size_t i = 0; i < stepFunctions.size();) {
+        const size_t groupEnd = concurrentGroupEnd(stepFunctions, model->concurrentStepFunctions, i);
+        if (groupEnd - i > 1) {
+            // Consecutive concurrent step functions are executed together
+            const std::vector<std::function<void(HostAPI*)>> fns(stepFunctions.begin() + i, stepFunctions.begin() + groupEnd);
+            const std::vector<double> elapsed = runConcurrentHostFunctions(fns);
+            for (size_t j = 0; j < elapsed.size(); ++j) {
+                recordHostFunctionTime(hostFunctionLabel("step function ", detail::getHostFunctionName(stepFunctions[i + j]), hostFnIndex++), elapsed[j], true);
+            }
+        } else {
+            NVTX_RANGE("stepFunc");
+            hostFnTimer.start();
+            stepFunctions[i](this->host_api.get());
+            hostFnTimer.stop();
+            recordHostFunctionTime(hostFunctionLabel("step function ", detail::getHostFunctionName(stepFunctions[i]), hostFnIndex++), hostFnTimer.getElapsedSeconds(), true);
+        }
+        i = groupEnd;
     }
     // Execute step function callbacks
     for (auto &stepFn : model->stepFunctionCallbacks) {
         NVTX_RANGE("stepFunc_swig");
+        hostFnTimer.start();
         stepFn->run(this->host_api.get());
+        hostFnTimer.stop();
+        recordHostFunctionTime(hostFunctionLabel("step function ", stepFn->getName(), hostFnIndex++), hostFnTimer.getElapsedSeconds(), true);
     }
     // If we have step functions, we might have host agent creation
     if (model->stepFunctions.size() || model->stepFunctionCallbacks.size()) {
@@ -893,8 +1181,35 @@ bool CUDASimulation::stepExitConditions() {
     bool exitConditionExit = false;
 
     // Execute exit conditions
-    for (auto &exitCdns : model->exitConditions) {
-        if (exitCdns(this->host_api.get()) == EXIT) {
+    util::detail::SteadyClockTimer hostFnTimer;
+    unsigned int hostFnIndex = 0;
+    const auto &exitConditions = model->exitConditions;
+    for (size_t i = 0; i < exitConditions.size();) {
+        const size_t groupEnd = concurrentGroupEnd(exitConditions, model->concurrentExitConditions, i);
+        CONDITION_RESULT result = CONTINUE;
+        if (groupEnd - i > 1) {
+            // Consecutive concurrent exit conditions are all executed together, exiting if any return EXIT
+            std::vector<CONDITION_RESULT> results(groupEnd - i, CONTINUE);
+            std::vector<std::function<void(HostAPI*)>> fns;
+            for (size_t j = i; j < groupEnd; ++j) {
+                const FLAMEGPU_EXIT_CONDITION_POINTER exitCdns = exitConditions[j];
+                CONDITION_RESULT &r = results[j - i];
+                fns.push_back([exitCdns, &r](HostAPI *api) { r = exitCdns(api); });
+            }
+            const std::vector<double> elapsed = runConcurrentHostFunctions(fns);
+            for (size_t j = 0; j < elapsed.size(); ++j) {
+                recordHostFunctionTime(hostFunctionLabel("exit condition ", detail::getHostFunctionName(exitConditions[i + j]), hostFnIndex++), elapsed[j], true);
+                if (results[j] == EXIT)
+                    result = EXIT;
+            }
+        } else {
+            hostFnTimer.start();
+            result = exitConditions[i](this->host_api.get());
+            hostFnTimer.stop();
+            recordHostFunctionTime(hostFunctionLabel("exit condition ", detail::getHostFunctionName(exitConditions[i]), hostFnIndex++), hostFnTimer.getElapsedSeconds(), true);
+        }
+        i = groupEnd;
+        if (result == EXIT) {
             #ifdef VISUALISATION
                 if (visualisation) {
                     visualisation->updateBuffers(step_count+1);
@@ -907,8 +1222,13 @@ bool CUDASimulation::stepExitConditions() {
     }
     // Execute exit condition callbacks
     if (!exitConditionExit) {
+        hostFnIndex = static_cast<unsigned int>(model->exitConditions.size());
         for (auto &exitCdns : model->exitConditionCallbacks) {
-            if (exitCdns->run(this->host_api.get()) == EXIT) {
+            hostFnTimer.start();
+            const CONDITION_RESULT result = exitCdns->run(this->host_api.get());
+            hostFnTimer.stop();
+            recordHostFunctionTime(hostFunctionLabel("exit condition ", exitCdns->getName(), hostFnIndex++), hostFnTimer.getElapsedSeconds(), true);
+            if (result == EXIT) {
                 #ifdef VISUALISATION
                 if (visualisation) {
                     visualisation->updateBuffers(step_count+1);
@@ -958,8 +1278,11 @@ void CUDASimulation::simulate() {
     // Init any unset agent IDs
     this->assignAgentIDs();
 
+    // Persistent submodels only initialise their unmapped state on their first execution
+    const bool initialiseState = !(submodel && submodel->persistent && persistentSubmodelInitialised);
+
     // Reinitialise any unmapped agent variables
-    if (submodel) {
+    if (submodel && initialiseState) {
         int streamIdx = 0;
         for (auto &a : agent_map) {
             a.second->initUnmappedVars(this->singletons->scatter, streamIdx, this->getStream(streamIdx));
@@ -970,12 +1293,22 @@ void CUDASimulation::simulate() {
     // Reset the class' elapsed time value.
     this->elapsedSecondsSimulation = 0.f;
     this->elapsedSecondsPerStep.clear();
+    this->elapsedSecondsPerStepBreakdown.clear();
+    this->elapsedSecondsHostFunctions.clear();
+    this->elapsedSecondsPerStepHostFunctions.clear();
+    this->slowHostFunctions.clear();
+    this->environmentUploadsPerStep.clear();
     if (getSimulationConfig().steps > 0) {
         this->elapsedSecondsPerStep.reserve(getSimulationConfig().steps);
     }
 
     // Execute init functions
-    this->initFunctions();
+    if (initialiseState) {
+        this->initFunctions();
+    }
+    if (submodel && submodel->persistent) {
+        persistentSubmodelInitialised = true;
+    }
 
     // Reset and log initial state to step log 0
     resetLog();
@@ -1037,7 +1370,13 @@ void CUDASimulation::reset(bool submodelReset) {
     // Reset step counter
     resetStepCounter();
 
-    if (singletonsInitialised) {
+    // Persistent submodels retain their unmapped state between executions
+    const bool retainState = submodelReset && submodel && submodel->persistent;
+    if (!submodelReset) {
+        persistentSubmodelInitialised = false;
+    }
+
+    if (singletonsInitialised && !retainState) {
         // Reset environment properties
         singletons->environment.resetModel(instance_id, *model->environment);
 
@@ -1050,8 +1389,11 @@ void CUDASimulation::reset(bool submodelReset) {
     // Cull agents
     if (submodel) {
         // Submodels only want to reset unmapped states, otherwise they will break parent model
-        for (auto &a : agent_map) {
-            a.second->cullUnmappedStates();
+        // Persistent submodels retain agents in unmapped states until the parent model is reset
+        if (!retainState) {
+            for (auto &a : agent_map) {
+                a.second->cullUnmappedStates();
+            }
         }
     } else {
         for (auto &a : agent_map) {
@@ -1076,9 +1418,17 @@ void CUDASimulation::reset(bool submodelReset) {
     // Reset any timing data.
     this->elapsedSecondsSimulation = 0.f;
     this->elapsedSecondsPerStep.clear();
+    this->elapsedSecondsPerStepBreakdown.clear();
+    this->elapsedSecondsHostFunctions.clear();
+    this->elapsedSecondsPerStepHostFunctions.clear();
+    this->slowHostFunctions.clear();
+    this->environmentUploadsPerStep.clear();
 }
 
 void CUDASimulation::setPopulationData(AgentVector& population, const std::string& state_name) {
+    setPopulationData(static_cast<const AgentVector&>(population), state_name);
+}
+void CUDASimulation::setPopulationData(const AgentVector& population, const std::string& state_name) {
     // Ensure singletons have been initialised
     initialiseSingletons();
     NVTX_RANGE("CUDASimulation::setPopulationData()");
@@ -1089,7 +1439,7 @@ void CUDASimulation::setPopulationData(AgentVector& population, const std::strin
             population.getAgentName().c_str());
     }
     // This call hierarchy validates agent desc matches and state is valid
-    it->second->setPopulationData(population, state_name, this->singletons->scatter, 0, 0);  // Streamid shouldn't matter here, also using default stream.
+    it->second->setPopulationData(population, state_name, this->singletons->scatter, 0, 0, getCUDAConfig().validateAgentIDs);  // Streamid shouldn't matter here, also using default stream.
 #ifdef VISUALISATION
     if (visualisation) {
         visualisation->updateBuffers();
@@ -1157,6 +1507,7 @@ void CUDASimulation::setStepLog(const StepLoggingConfig &stepConfig) {
     if (*stepConfig.model != *model) {
         THROW exception::InvalidArgument("Model descriptions attached to LoggingConfig and CUDASimulation do not match, in CUDASimulation::setStepLog()\n");
     }
+    validateLoggedVariables(stepConfig, "setStepLog");
     // Set internal config
     step_log_config = std::make_shared<StepLoggingConfig>(stepConfig);
 }
@@ -1165,10 +1516,26 @@ void CUDASimulation::setExitLog(const LoggingConfig &exitConfig) {
     if (*exitConfig.model != *model) {
         THROW exception::InvalidArgument("Model descriptions attached to LoggingConfig and CUDASimulation do not match, in CUDASimulation::setExitLog()\n");
     }
+    validateLoggedVariables(exitConfig, "setExitLog");
     // Set internal config
     exit_log_config = std::make_shared<LoggingConfig>(exitConfig);
 }
 
+void CUDASimulation::validateLoggedVariables(const LoggingConfig &logConfig, const char *caller) const {
+    for (const auto &agent : logConfig.agents) {
+        const auto eliminated = eliminatedAgentVariables.find(agent.first.first);
+        if (eliminated == eliminatedAgentVariables.end())
+            continue;
+        for (const auto &reduction : *agent.second.first) {
+            if (eliminated->second.find(reduction.name) != eliminated->second.end()) {
+                THROW exception::InvalidArgument("Agent '%s' variable '%s' cannot be logged, as it was eliminated by CUDAConfig().eliminateUnusedAgentVariables, "
+                    "in CUDASimulation::%s()\n",
+                    agent.first.first.c_str(), reduction.name.c_str(), caller);
+            }
+        }
+    }
+}
+
 bool CUDASimulation::checkArgs_derived(int argc, const char** argv, int &i) {
     // Get arg as lowercase
     std::string arg(argv[i]);
@@ -1240,6 +1607,7 @@ void CUDASimulation::applyConfig_derived() {
         // We're not actually going to use this value, but it might be useful there later
         // Calling apply config a second time would reinit GPU, which might clear existing gpu allocations etc
         sm.second->CUDAConfig().device_id = config.device_id;
+        sm.second->CUDAConfig().counterBasedRandom = config.counterBasedRandom;
     }
 
     // Initialise singletons once a device has been selected.
@@ -1262,6 +1630,17 @@ void CUDASimulation::reseed(const uint64_t &seed) {
         i *= 13;
     }
 }
+uint64_t CUDASimulation::philoxSeed() const {
+    const uint64_t seed = singletons->rng.seed();
+    if (!mastermodel)
+        return seed;
+    // The parent's step is constant whilst this submodel runs, so it distinguishes each run of the submodel
+    uint64_t parent = mastermodel->philoxSeed() ^ (static_cast<uint64_t>(mastermodel->step_count) * 0x9E3779B97F4A7C15ull);
+    // SplitMix64 finaliser, so that consecutive parent steps produce unrelated keys
+    parent = (parent ^ (parent >> 30)) * 0xBF58476D1CE4E5B9ull;
+    parent = (parent ^ (parent >> 27)) * 0x94D049BB133111EBull;
+    return seed ^ parent ^ (parent >> 31);
+}
 /**
  * These values are ony used by CUDASimulation::initialiseSingletons()
  * Can't put a __device__ symbol method static
@@ -1272,6 +1651,10 @@ namespace {
 }  // namespace
 
 void CUDASimulation::initialiseSingletons() {
+    // Eliminate unused agent variables once, before any agent storage is allocated
+    if (config.eliminateUnusedAgentVariables && !agentVariablesEliminated) {
+        eliminateAgentVariables();
+    }
     // Only do this once.
     if (!singletonsInitialised) {
         // If the device has not been specified, also check the compute capability is OK
@@ -1325,10 +1708,10 @@ void CUDASimulation::initialiseSingletons() {
 
         // Populate the environment properties
         if (!submodel) {
-            singletons->environment.init(instance_id, *model->environment, isPureRTC);
+            singletons->environment.init(instance_id, *model->environment);
             macro_env.init();
         } else {
-            singletons->environment.init(instance_id, *model->environment, isPureRTC, mastermodel->getInstanceID(), *submodel->subenvironment);
+            singletons->environment.init(instance_id, *model->environment, mastermodel->getInstanceID(), *submodel->subenvironment);
             macro_env.init(*submodel->subenvironment, mastermodel->macro_env);
         }
 
@@ -1435,58 +1818,124 @@ void CUDASimulation::initOffsetsAndMap() {
         agentOffsets.emplace(agent.first, VarOffsetStruct(agent.second->variables));
     }
     // Build data
-    agentData.clear();
-    for (const auto &agent : md.agents) {
+    agentData = createAgentDataMap();
+    // Concurrent HostAPIs are recreated on demand, with the new offsets
+    concurrent_host_apis.clear();
+}
+
+CUDASimulation::AgentDataMap CUDASimulation::createAgentDataMap() const {
+    AgentDataMap rtn;
+    for (const auto &agent : getModelDescription().agents) {
+        const VarOffsetStruct &offsets = agentOffsets.at(agent.first);
         AgentDataBufferStateMap agent_states;
         for (const auto&state : agent.second->states)
-            agent_states.emplace(state, AgentDataBuffer());
-        agentData.emplace(agent.first, std::move(agent_states));
+            agent_states.emplace(state, AgentDataBuffer(offsets));
+        rtn.emplace(agent.first, std::move(agent_states));
     }
+    return rtn;
 }
 
 void CUDASimulation::processHostAgentCreation(const unsigned int &streamId) {
-    size_t t_bufflen = 0;
-    char *t_buff = nullptr;
-    char *dt_buff = nullptr;
-    // For each agent type
-    for (auto &agent : agentData) {
-        // We need size of agent
-        const VarOffsetStruct &offsets = agentOffsets.at(agent.first);
-        // For each state within the agent
-        for (auto &state : agent.second) {
-            // If the buffer has data
-            if (state.second.size()) {
-                size_t size_req = offsets.totalSize * state.second.size();
-                {  // Ensure we have enough temp memory
-                    if (size_req > t_bufflen) {
-                        if (t_buff) {
-                            free(t_buff);
-                            gpuErrchk(cudaFree(dt_buff));
+    // Concurrent host functions create agents within their own HostAPI's storage
+    std::vector<AgentDataMap*> sources = {&agentData};
+    for (auto &c : concurrent_host_apis) {
+        sources.push_back(&c->agentData);
+    }
+    for (AgentDataMap *source : sources) {
+        // For each agent type
+        for (auto &agent : *source) {
+            // We need size of agent
+            const VarOffsetStruct &offsets = agentOffsets.at(agent.first);
+            // For each state within the agent
+            for (auto &state : agent.second) {
+                // If the buffer has data
+                if (!state.second.empty()) {
+                    const size_t size_req = state.second.getDataSize();
+                    // Ensure the persistent device staging buffer is large enough
+                    if (size_req > d_host_agent_creation_buffer_len) {
+                        if (d_host_agent_creation_buffer) {
+                            gpuErrchk(cudaFree(d_host_agent_creation_buffer));
                         }
-                        t_buff = reinterpret_cast<char*>(malloc(size_req));
-                        gpuErrchk(cudaMalloc(&dt_buff, size_req));
-                        t_bufflen = size_req;
+                        gpuErrchk(cudaMalloc(&d_host_agent_creation_buffer, size_req));
+                        d_host_agent_creation_buffer_len = size_req;
                     }
+                    // Arena records are already contiguous, so copy them to device directly
+                    gpuErrchk(cudaMemcpyAsync(d_host_agent_creation_buffer, state.second.getData(), size_req, cudaMemcpyHostToDevice, this->getStream(streamId)));
+                    // Scatter to device
+                    auto &cudaagent = agent_map.at(agent.first);
+                    cudaagent->scatterHostCreation(state.first, state.second.size(), d_host_agent_creation_buffer, offsets, this->singletons->scatter, streamId, this->getStream(streamId));
+                    // Clear buffer, retaining it's allocation for the next step
+                    state.second.clear();
                 }
-                // Copy buffer memory into a single block
-                for (unsigned int i = 0; i < state.second.size(); ++i) {
-                    memcpy(t_buff + (i*offsets.totalSize), state.second[i].data, offsets.totalSize);
-                }
-                // Copy t_buff to device
-                gpuErrchk(cudaMemcpyAsync(dt_buff, t_buff, size_req, cudaMemcpyHostToDevice, this->getStream(streamId)));
-                // Scatter to device
-                auto &cudaagent = agent_map.at(agent.first);
-                cudaagent->scatterHostCreation(state.first, static_cast<unsigned int>(state.second.size()), dt_buff, offsets, this->singletons->scatter, streamId, this->getStream(streamId));
-                // Clear buffer
-                state.second.clear();
             }
         }
     }
-    // Release temp memory
-    if (t_buff) {
-        free(t_buff);
-        gpuErrchk(cudaFree(dt_buff));
+}
+
+std::vector<double> CUDASimulation::runConcurrentHostFunctions(const std::vector<std::function<void(HostAPI*)>> &fns) {
+    NVTX_RANGE("CUDASimulation::runConcurrentHostFunctions");
+    // Each thread requires it's own HostAPI, and therefore stream index, of which there are a limited number
+    const unsigned int threads = static_cast<unsigned int>(std::min<size_t>(fns.size(), CUDAScanCompaction::MAX_STREAMS));
+    this->createStreams(threads);
+    while (concurrent_host_apis.size() + 1 < threads) {
+        const unsigned int streamId = static_cast<unsigned int>(concurrent_host_apis.size()) + 1;
+        std::unique_ptr<ConcurrentHostAPI> c(new ConcurrentHostAPI());
+        c->agentData = createAgentDataMap();
+        c->api = std::make_unique<HostAPI>(*this, singletons->rng, singletons->scatter, agentOffsets, c->agentData, macro_env, streamId, getStream(streamId));
+        concurrent_host_apis.push_back(std::move(c));
+    }
+    std::vector<double> elapsed(fns.size(), 0);
+    std::vector<std::exception_ptr> exceptions(fns.size());
+    std::vector<std::exception_ptr> thread_exceptions(threads);
+    // Functions are assigned to threads statically, so that each function always uses the same HostAPI
+    // This keeps the order (and therefore IDs) of host created agents reproducible, as processHostAgentCreation() visits the HostAPIs in order
+    const auto work = [&fns, &elapsed, &exceptions, threads](HostAPI *api, const unsigned int t) {
+        util::detail::SteadyClockTimer timer;
+        for (size_t i = t; i < fns.size(); i += threads) {
+            NVTX_RANGE("hostFunc_concurrent");
+            timer.start();
+            try {
+                fns[i](api);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+            timer.stop();
+            elapsed[i] = timer.getElapsedSeconds();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    const int device_id = getCUDAConfig().device_id;
+    for (unsigned int t = 1; t < threads; ++t) {
+        HostAPI *api = concurrent_host_apis[t - 1]->api.get();
+        workers.emplace_back([&work, &thread_exceptions, t, api, device_id]() {
+            try {
+                // The active device is selected per host thread
+                gpuErrchk(cudaSetDevice(device_id));
+            } catch (...) {
+                thread_exceptions[t] = std::current_exception();
+                return;
+            }
+            work(api, t);
+        });
+    }
+    work(host_api.get(), 0);
+    for (auto &w : workers) {
+        w.join();
+    }
+    // Ensure work issued by the host functions to their streams is complete
+    for (unsigned int t = 0; t < threads; ++t) {
+        gpuErrchk(cudaStreamSynchronize(getStream(t)));
+    }
+    for (const auto &e : thread_exceptions) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+    for (const auto &e : exceptions) {
+        if (e)
+            std::rethrow_exception(e);
     }
+    return elapsed;
 }
 
 void CUDASimulation::RTCSafeCudaMemcpyToSymbol(const void* symbol, const char* rtc_symbol_name, const void* src, size_t count, size_t offset) const {
@@ -1560,6 +2009,161 @@ double CUDASimulation::getElapsedTimeStep(unsigned int step) const {
     return this->elapsedSecondsPerStep.at(step);
 }
 
+std::vector<std::map<std::string, double>> CUDASimulation::getElapsedTimeStepBreakdowns() const {
+    // returns a copy, as with getElapsedTimeSteps()
+    return this->elapsedSecondsPerStepBreakdown;
+}
+
+std::map<std::string, double> CUDASimulation::getElapsedTimeStepBreakdown(unsigned int step) const {
+    if (step >= this->elapsedSecondsPerStepBreakdown.size()) {
+        THROW exception::OutOfBoundsException("getElapsedTimeStepBreakdown out of bounds.\n");
+    }
+    return this->elapsedSecondsPerStepBreakdown[step];
+}
+
+void CUDASimulation::recordTimingBreakdown(const std::string &label, const double seconds) {
+    if (this->elapsedSecondsPerStepBreakdown.empty())
+        return;
+    // Accumulate, in case a component is executed multiple times within a step
+    this->elapsedSecondsPerStepBreakdown.back()[label] += seconds;
+}
+
+std::map<std::string, double> CUDASimulation::getElapsedTimeHostFunctions() const {
+    return this->elapsedSecondsHostFunctions;
+}
+
+std::vector<std::map<std::string, double>> CUDASimulation::getElapsedTimeHostFunctionSteps() const {
+    return this->elapsedSecondsPerStepHostFunctions;
+}
+
+std::vector<CUDASimulation::EnvironmentUploads> CUDASimulation::getEnvironmentUploadSteps() const {
+    return this->environmentUploadsPerStep;
+}
+
+CUDASimulation::EnvironmentUploads CUDASimulation::getEnvironmentUploadTotals() const {
+    const EnvironmentManager::UploadCounters counters = singletons->environment.getUploadCounters(instance_id);
+    EnvironmentUploads rtn;
+    rtn.bytes = counters.bytes;
+    rtn.uploads = counters.uploads;
+    // Submodels only execute within a step of their parent, so their copies are attributed to the parent's step
+    for (const auto &sm : submodel_map) {
+        const EnvironmentUploads sm_totals = sm.second->getEnvironmentUploadTotals();
+        rtn.bytes += sm_totals.bytes;
+        rtn.uploads += sm_totals.uploads;
+    }
+    return rtn;
+}
+
+void CUDASimulation::recordHostFunctionTime(const std::string &label, const double seconds, const bool inStep) {
+    this->elapsedSecondsHostFunctions[label] += seconds;
+    // A step may not be in progress if the host function is called from the HostAPI of a submodel's parent, or a direct call to stepLayer
+    if (inStep && (getSimulationConfig().timing || getCUDAConfig().slowHostFunctionFraction > 0) && !this->elapsedSecondsPerStepHostFunctions.empty()) {
+        this->elapsedSecondsPerStepHostFunctions.back()[label] += seconds;
+    }
+}
+
+void CUDASimulation::checkSlowHostFunctions(const double stepSeconds) {
+    const double fraction = getCUDAConfig().slowHostFunctionFraction;
+    if (fraction <= 0 || this->elapsedSecondsPerStepHostFunctions.empty())
+        return;
+    for (const auto &hostFn : this->elapsedSecondsPerStepHostFunctions.back()) {
+        if (hostFn.second > fraction * stepSeconds && this->slowHostFunctions.insert(hostFn.first).second) {
+            fprintf(stderr, "Warning: Host function '%s' took %.6f s, %.1f%% of step %u (%.6f s), "
+                "this warning is only output once per host function.\n",
+                hostFn.first.c_str(), hostFn.second, 100.0 * hostFn.second / stepSeconds, this->step_count, stepSeconds);
+        }
+    }
+}
+
+std::map<std::string, CUDASimulation::MemoryUsage> CUDASimulation::getMemoryReport() {
+    sampleMemoryUsage();
+    // returns a copy, as with getElapsedTimeSteps()
+    return this->memoryUsage;
+}
+
+void CUDASimulation::buildMemoryReport(const std::string &prefix, std::map<std::string, MemoryUsage> &report, std::set<const void*> &counted) {
+    for (auto &a : agent_map) {
+        std::shared_ptr<CUDAFatAgent> fat_agent = a.second->getFatAgent();
+        for (const auto &s : fat_agent->getStateMap(a.second->getFatIndex())) {
+            // State lists are shared with mapped submodel agents, so only report each once
+            if (counted.insert(s.second.get()).second) {
+                report[prefix + "agent " + a.first + " state " + s.first].device += s.second->getDeviceMemoryUsage();
+            }
+        }
+        if (counted.insert(fat_agent.get()).second) {
+            report[prefix + "agent " + a.first + " new buffers"].device += fat_agent->getNewBufferDeviceMemoryUsage();
+        }
+    }
+    for (const auto &m : message_map) {
+        report[prefix + "message " + m.first].device += m.second->getMessageListDeviceMemoryUsage();
+        report[prefix + "message " + m.first + " index"].device += m.second->getSpecialisationDeviceMemoryUsage();
+    }
+    report[prefix + "macro environment"].device += macro_env.getDeviceMemoryUsage();
+    {
+        MemoryUsage &creation = report[prefix + "host agent creation"];
+        creation.device += d_host_agent_creation_buffer_len;
+        std::vector<const AgentDataMap*> sources = {&agentData};
+        for (const auto &c : concurrent_host_apis) {
+            sources.push_back(&c->agentData);
+        }
+        for (const AgentDataMap *source : sources) {
+            for (const auto &agent : *source) {
+                for (const auto &state : agent.second) {
+                    creation.host += static_cast<size_t>(state.second.getCapacity()) * state.second.offsets.totalSize;
+                }
+            }
+        }
+    }
+    if (host_api) {
+        report[prefix + "host api"].device += host_api->getDeviceMemoryUsage();
+    }
+    for (const auto &c : concurrent_host_apis) {
+        report[prefix + "host api"].device += c->api->getDeviceMemoryUsage();
+    }
+    if (singletonsInitialised) {
+        MemoryUsage &random = report[prefix + "random"];
+        random.host += singletons->rng.getHostMemoryUsage();
+        random.device += singletons->rng.getDeviceMemoryUsage();
+        report[prefix + "scatter"].device += singletons->scatter.getDeviceMemoryUsage();
+        report[prefix + "scan compaction"].device += singletons->scatter.getScan().getDeviceMemoryUsage();
+        // Properties are held in a host buffer, which is mirrored to device constant memory
+        MemoryUsage &environment = report[prefix + "environment"];
+        const size_t env_size = singletons->environment.getPropertiesSize(instance_id);
+        environment.host += env_size;
+        environment.device += env_size;
+#if !defined(SEATBELTS) || SEATBELTS
+        report[prefix + "device exceptions"].device += singletons->exception.getDeviceMemoryUsage();
+#endif
+    }
+    for (auto &sm : submodel_map) {
+        sm.second->buildMemoryReport(prefix + "submodel " + sm.first + ": ", report, counted);
+    }
+}
+
+void CUDASimulation::sampleMemoryUsage() {
+    std::map<std::string, MemoryUsage> report;
+    std::set<const void*> counted;
+    buildMemoryReport("", report, counted);
+    MemoryUsage total;
+    for (const auto &r : report) {
+        total.host += r.second.host;
+        total.device += r.second.device;
+    }
+    report["total"] = total;
+    // Components which no longer exist retain their peak
+    for (auto &m : memoryUsage) {
+        m.second.host = 0;
+        m.second.device = 0;
+    }
+    for (const auto &r : report) {
+        MemoryUsage &m = memoryUsage[r.first];
+        m.host = r.second.host;
+        m.device = r.second.device;
+        m.peak_host = std::max(m.peak_host, m.host);
+        m.peak_device = std::max(m.peak_device, m.device);
+    }
+}
+
 void CUDASimulation::initEnvironmentMgr() {
     if (!singletons) {
         THROW exception::UnknownInternalError("CUDASimulation::initEnvironmentMgr() called before singletons member initialised.");
@@ -1604,6 +2208,7 @@ void CUDASimulation::initEnvironmentMgr() {
 }
 void CUDASimulation::resetLog() {
     run_log->step.clear();
+    run_log->step_timing.clear();
     run_log->exit = LogFrame();
     run_log->random_seed = SimulationConfig().random_seed;
     run_log->step_log_frequency = step_log_config ? step_log_config->frequency : 0;
@@ -1626,12 +2231,14 @@ void CUDASimulation::processStepLog() {
         const std::string &agent_state = name_state.first.second;
         HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
         auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
-        // Log individual variable reductions
+        // Group variable reductions by type, so each group can be calculated by a single fused pass
+        std::map<LoggingConfig::MultiReductionFn*, std::vector<LoggingConfig::NameReductionFn>> multi_reductions;
         for (const auto &name_reduction : *name_state.second.first) {
-            // Perform the corresponding reduction
-            auto result = name_reduction.function(host_agent, name_reduction.name);
-            // Store the result
-            agent_state_log.first.emplace(name_reduction, std::move(result));
+            multi_reductions[name_reduction.multi_function].push_back(name_reduction);
+        }
+        // Perform the reductions, results are stored directly into the log
+        for (const auto &multi_reduction : multi_reductions) {
+            multi_reduction.first(host_agent, multi_reduction.second, agent_state_log.first);
         }
         // Log count of agents in state
         if (name_state.second.second) {
@@ -1659,12 +2266,14 @@ void CUDASimulation::processExitLog() {
         const std::string &agent_state = name_state.first.second;
         HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
         auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
-        // Log individual variable reductions
+        // Group variable reductions by type, so each group can be calculated by a single fused pass
+        std::map<LoggingConfig::MultiReductionFn*, std::vector<LoggingConfig::NameReductionFn>> multi_reductions;
         for (const auto &name_reduction : *name_state.second.first) {
-            // Perform the corresponding reduction
-            auto result = name_reduction.function(host_agent, name_reduction.name);
-            // Store the result
-            agent_state_log.first.emplace(name_reduction, std::move(result));
+            multi_reductions[name_reduction.multi_function].push_back(name_reduction);
+        }
+        // Perform the reductions, results are stored directly into the log
+        for (const auto &multi_reduction : multi_reductions) {
+            multi_reduction.first(host_agent, multi_reduction.second, agent_state_log.first);
         }
         // Log count of agents in state
         if (name_state.second.second) {
@@ -1709,6 +2318,22 @@ void CUDASimulation::destroyStreams() {
         gpuErrchk(cudaStreamDestroy(stream));
     }
     streams.clear();
+    // Destroy timing events
+    for (auto &events : timingEvents) {
+        gpuErrchk(cudaEventDestroy(events.first));
+        gpuErrchk(cudaEventDestroy(events.second));
+    }
+    timingEvents.clear();
+}
+
+const std::pair<cudaEvent_t, cudaEvent_t> &CUDASimulation::getTimingEvents(const unsigned int n) {
+    while (timingEvents.size() <= n) {
+        std::pair<cudaEvent_t, cudaEvent_t> events;
+        gpuErrchk(cudaEventCreate(&events.first));
+        gpuErrchk(cudaEventCreate(&events.second));
+        timingEvents.push_back(events);
+    }
+    return timingEvents[n];
 }
 
 void CUDASimulation::synchronizeAllStreams() {
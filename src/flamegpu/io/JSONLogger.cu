@@ -192,6 +192,22 @@ void JSONLogger::logSteps(T &writer, const RunLog &log) const {
     writer.EndArray();
 }
 template<typename T>
+void JSONLogger::logStepTiming(T &writer, const RunLog &log) const {
+    writer.Key("timing");
+    writer.StartArray();
+    {
+        for (const auto &step : log.getStepTimingLog()) {
+            writer.StartObject();
+            for (const auto &component : step) {
+                writer.Key(component.first.c_str());
+                writer.Double(component.second);
+            }
+            writer.EndObject();
+        }
+    }
+    writer.EndArray();
+}
+template<typename T>
 void JSONLogger::logExit(T &writer, const RunLog &log) const {
     writer.Key("exit");
     writeLogFrame(writer, log.getExitLog());
@@ -212,6 +228,10 @@ void JSONLogger::logCommon(T &writer, const RunLog &log, const RunPlan *plan, bo
         // Log step log
         if (doLogSteps) {
             logSteps(*writer, log);
+            // Log step timing breakdown, if it was recorded
+            if (!log.getStepTimingLog().empty()) {
+                logStepTiming(*writer, log);
+            }
         }
 
         // Log exit log
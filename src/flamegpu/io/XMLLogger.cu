@@ -77,6 +77,10 @@ void XMLLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogConf
     // Log step log
     if (doLogSteps) {
         pRoot->InsertEndChild(logSteps(doc, log));
+        // Log step timing breakdown, if it was recorded
+        if (!log.getStepTimingLog().empty()) {
+            pRoot->InsertEndChild(logStepTiming(doc, log));
+        }
     }
 
     // Log exit log
@@ -137,6 +141,22 @@ tinyxml2::XMLNode *XMLLogger::logSteps(tinyxml2::XMLDocument &doc, const RunLog
     }
     return pStepsElement;
 }
+tinyxml2::XMLNode *XMLLogger::logStepTiming(tinyxml2::XMLDocument &doc, const RunLog &log) const {
+    tinyxml2::XMLElement *pTimingElement = doc.NewElement("timing");
+    {
+        for (const auto &step : log.getStepTimingLog()) {
+            tinyxml2::XMLElement *pStepElement = doc.NewElement("step");
+            for (const auto &component : step) {
+                tinyxml2::XMLElement *pComponentElement = doc.NewElement("component");
+                pComponentElement->SetAttribute("label", component.first.c_str());
+                pComponentElement->SetText(component.second);
+                pStepElement->InsertEndChild(pComponentElement);
+            }
+            pTimingElement->InsertEndChild(pStepElement);
+        }
+    }
+    return pTimingElement;
+}
 tinyxml2::XMLNode *XMLLogger::logExit(tinyxml2::XMLDocument &doc, const RunLog &log) const {
     tinyxml2::XMLElement *pExitElement = doc.NewElement("exit");
     pExitElement->InsertEndChild(writeLogFrame(doc, log.getExitLog()));
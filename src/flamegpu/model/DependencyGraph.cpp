@@ -1,5 +1,12 @@
 #include "flamegpu/model/DependencyGraph.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include "flamegpu/model/AgentData.h"
+
 namespace flamegpu {
 
 DependencyGraph::DependencyGraph() {
@@ -8,7 +15,7 @@ DependencyGraph::DependencyGraph() {
 DependencyGraph::DependencyGraph(const ModelData* _model) : model(_model) {
 }
 
-DependencyGraph::DependencyGraph(const DependencyGraph& other) : model(other.model) {
+DependencyGraph::DependencyGraph(const DependencyGraph& other) : nodeCosts(other.nodeCosts), model(other.model) {
     for (const auto& root : other.roots) {
         roots.push_back(root);
     }
@@ -86,135 +93,208 @@ void DependencyGraph::generateLayers(ModelDescription& _model) {
     validateDependencyGraph();
     checkForUnattachedFunctions();
 
-    // Lambda to walk the graph and set minimum layer depths of nodes
-    std::function<void(DependencyNode*, int)> setMinLayerDepths;
-    setMinLayerDepths = [&setMinLayerDepths] (DependencyNode* node, int depth) {
-        if (depth >= node->getMinimumLayerDepth()) {
-            node->setMinimumLayerDepth(depth);
+    // Collect each node once, in the order they are first reached from the roots
+    // This order is used to break ties, so that the generated layers are deterministic
+    std::vector<DependencyNode*> nodes;
+    std::map<DependencyNode*, size_t> nodeIndex;
+    std::function<void(DependencyNode*)> collectNodes;
+    collectNodes = [&collectNodes, &nodes, &nodeIndex] (DependencyNode* node) {
+        if (nodeIndex.find(node) != nodeIndex.end()) {
+            return;
         }
+        nodeIndex.emplace(node, nodes.size());
+        nodes.push_back(node);
         for (auto child : node->getDependents()) {
-            setMinLayerDepths(child, depth + 1);
+            collectNodes(child);
         }
     };
-
-    // Set minimum layer depths
     for (auto root : roots) {
-        setMinLayerDepths(root, 0);
+        collectNodes(root);
     }
 
-    // Build list of functions in their respective ideal layers assuming no conflicts
-    std::vector<std::vector<DependencyNode*>> idealLayers;
-    std::function<void(DependencyNode*)> buildIdealLayers;
-    buildIdealLayers = [&buildIdealLayers, &idealLayers] (DependencyNode* node) {
-        // New layers required
-        std::vector<std::vector<DependencyNode*>>::size_type nodeDepth = node->getMinimumLayerDepth();
-        while (nodeDepth >= idealLayers.size()) {
-            idealLayers.push_back(std::vector<DependencyNode*>());
-        }
-
-        // Add node to relevant layer if node hasn't already been added
-        bool alreadyAdded = false;
-        for (auto& includedNode : idealLayers[nodeDepth]) {
-            if (node == includedNode) {
-                alreadyAdded = true;
+    // Calculate the critical path of each node, the total cost of the most expensive chain of dependents including the node itself
+    std::vector<double> criticalPath(nodes.size(), -1.0);
+    std::function<double(DependencyNode*)> calcCriticalPath;
+    calcCriticalPath = [this, &calcCriticalPath, &criticalPath, &nodeIndex] (DependencyNode* node) {
+        const size_t i = nodeIndex.at(node);
+        if (criticalPath[i] < 0) {
+            double longestChild = 0;
+            for (auto child : node->getDependents()) {
+                longestChild = std::max(longestChild, calcCriticalPath(child));
             }
+            criticalPath[i] = getNodeCost(*node) + longestChild;
         }
-        if (!alreadyAdded) {
-            idealLayers[nodeDepth].push_back(node);
-        }
+        return criticalPath[i];
+    };
+    for (auto root : roots) {
+        calcCriticalPath(root);
+    }
 
-        // Repeat for children
+    // Count the unscheduled dependencies of each node, nodes with none are ready to be scheduled
+    std::vector<unsigned int> pendingDependencies(nodes.size(), 0);
+    for (auto node : nodes) {
         for (auto child : node->getDependents()) {
-            buildIdealLayers(child);
+            ++pendingDependencies[nodeIndex.at(child)];
+        }
+    }
+    std::vector<DependencyNode*> ready;
+    for (auto node : nodes) {
+        if (pendingDependencies[nodeIndex.at(node)] == 0) {
+            ready.push_back(node);
         }
+    }
+    const auto moreCritical = [&criticalPath, &nodeIndex] (DependencyNode* a, DependencyNode* b) {
+        const size_t i_a = nodeIndex.at(a);
+        const size_t i_b = nodeIndex.at(b);
+        if (criticalPath[i_a] != criticalPath[i_b]) {
+            return criticalPath[i_a] > criticalPath[i_b];
+        }
+        return i_a < i_b;
+    };
+    const auto isConcurrentHostFunction = [] (DependencyNode* node) {
+        HostFunctionDescription* hdf = dynamic_cast<HostFunctionDescription*>(node);
+        return hdf && hdf->isConcurrent() && hdf->getFunctionPtr() != nullptr;
     };
 
-    for (auto root : roots) {
-        buildIdealLayers(root);
+    // List schedule the nodes into layers
+    std::vector<std::vector<DependencyNode*>> plannedLayers;
+    while (!ready.empty()) {
+        std::sort(ready.begin(), ready.end(), moreCritical);
+        std::vector<DependencyNode*> layer;
+        std::vector<DependencyNode*> deferred;
+        // The most critical ready node is always scheduled
+        layer.push_back(ready[0]);
+        double layerCost = getNodeCost(*ready[0]);
+        const double remainingCriticalPath = criticalPath[nodeIndex.at(ready[0])];
+        // Host functions and submodels must be alone in their layer, unless they are concurrent host functions
+        const bool agentLayer = dynamic_cast<AgentFunctionDescription*>(ready[0]) != nullptr;
+        const bool concurrentHostLayer = isConcurrentHostFunction(ready[0]);
+        for (size_t i = 1; i < ready.size(); ++i) {
+            DependencyNode* node = ready[i];
+            AgentFunctionDescription* afd = agentLayer ? dynamic_cast<AgentFunctionDescription*>(node) : nullptr;
+            bool fits = afd != nullptr;
+            for (size_t j = 0; fits && j < layer.size(); ++j) {
+                fits = !agentFunctionsConflict(*static_cast<AgentFunctionDescription*>(layer[j])->function, *afd->function);
+            }
+            if (concurrentHostLayer) {
+                fits = isConcurrentHostFunction(node);
+            }
+            // Defer a node which would lengthen this layer, if it can start after this layer without extending the critical path
+            const double cost = getNodeCost(*node);
+            if (fits && cost > layerCost && layerCost + criticalPath[nodeIndex.at(node)] <= remainingCriticalPath) {
+                fits = false;
+            }
+            if (fits) {
+                layer.push_back(node);
+                layerCost = std::max(layerCost, cost);
+            } else {
+                deferred.push_back(node);
+            }
+        }
+        // Dependents of the scheduled nodes may now be ready
+        for (auto node : layer) {
+            for (auto child : node->getDependents()) {
+                if (--pendingDependencies[nodeIndex.at(child)] == 0) {
+                    deferred.push_back(child);
+                }
+            }
+        }
+        plannedLayers.push_back(std::move(layer));
+        ready.swap(deferred);
     }
 
-    // idealLayers now contains DependencyNode pointers in their ideal layers, i.e. assuming no conflicts.
-    // Now iterate structure attempting to add functions to layers.
-    // If we encounter conflicts, introduce additional layers as necessary
+    // Add the planned layers to the model
+    const auto addNode = [] (LayerDescription& layer, DependencyNode* node) {
+        // Add node based on its concrete type
+        if (AgentFunctionDescription* afd = dynamic_cast<AgentFunctionDescription*>(node)) {
+            layer.addAgentFunction(*afd);
+        } else if (SubModelDescription* smd = dynamic_cast<SubModelDescription*>(node)) {
+            layer.addSubModel(*smd);
+        } else if (HostFunctionDescription* hdf = dynamic_cast<HostFunctionDescription*>(node)) {
+            // function ptr, callback object should be mutually exclusive. Callback only used for SWIG, ptr only for non-SWIG.
+            // If ptr is available, use that
+            if (hdf->getFunctionPtr() != nullptr) {
+                if (hdf->isConcurrent()) {
+                    layer.addConcurrentHostFunction(hdf->getFunctionPtr());
+                } else {
+                    layer.addHostFunction(hdf->getFunctionPtr());
+                }
+            } else {
+                layer._addHostFunctionCallback(hdf->getCallbackObject());
+            }
+        }
+    };
     constructedLayers.clear();
-    for (auto idealLayer : idealLayers) {
+    for (const auto& plannedLayer : plannedLayers) {
         // Request a new layer from the model
         LayerDescription* layer = &_model.newLayer();
         constructedLayers.emplace_back();
-        // Attempt to add each node in the idealLayer to the layer
-        for (auto node : idealLayer) {
-            // Add node based on its concrete type
-            // Agent function
-            if (AgentFunctionDescription* afd = dynamic_cast<AgentFunctionDescription*>(node)) {
-                try {
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                } catch (const exception::InvalidAgentFunc&) {
-                    // Conflict, create new layer and add to that instead
-                    layer = &_model.newLayer();
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                    // printf("New function execution layer created - exception::InvalidAgentFunc exception\n");
-                } catch (const exception::InvalidLayerMember&) {
-                    layer = &_model.newLayer();
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                    // printf("New function execution layer created - exception::InvalidLayerMember exception\n");
-                }
+        for (auto node : plannedLayer) {
+            bool conflict = false;
+            try {
+                addNode(*layer, node);
+            } catch (const exception::InvalidAgentFunc&) {
+                conflict = true;
+            } catch (const exception::InvalidLayerMember&) {
+                conflict = true;
+            } catch (const exception::InvalidSubModel&) {
+                conflict = true;
             }
-
-            // Submodel
-            if (SubModelDescription* smd = dynamic_cast<SubModelDescription*>(node)) {
-                try {
-                    layer->addSubModel(*smd);
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                } catch (const exception::InvalidLayerMember&) {
-                    layer = &_model.newLayer();
-                    layer->addSubModel(*smd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                    // printf("New submodel layer created - exception::InvalidLayerMember exception\n");
-                } catch (const exception::InvalidSubModel&) {
-                    layer = &_model.newLayer();
-                    layer->addSubModel(*smd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                    // printf("New submodel layer created - exception::InvalidSubModel exception\n");
-                }
+            if (conflict) {
+                // Conflict which the schedule did not predict, create new layer and add to that instead
+                layer = &_model.newLayer();
+                addNode(*layer, node);
+                constructedLayers.emplace_back();
             }
+            constructedLayers.back().emplace_back(DependencyGraph::getNodeName(node));
+        }
+    }
+}
 
-            // Host function
-            if (HostFunctionDescription* hdf = dynamic_cast<HostFunctionDescription*>(node)) {
-                // function ptr, callback object should be mutually exclusive. Callback only used for SWIG, ptr only for non-SWIG.
-                // If ptr is available, use that
-                if (hdf->getFunctionPtr() != nullptr) {
-                    try {
-                        layer->addHostFunction(hdf->getFunctionPtr());
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                    } catch (const exception::InvalidLayerMember&) {
-                        layer = &_model.newLayer();
-                        layer->addHostFunction(hdf->getFunctionPtr());
-                        constructedLayers.emplace_back();
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                        // printf("New host function layer created - exception::InvalidLayerMember exception\n");
-                    }
-                } else {
-                    try {
-                        layer->_addHostFunctionCallback(hdf->getCallbackObject());
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                    } catch (const exception::InvalidLayerMember&) {
-                        layer = &_model.newLayer();
-                        layer->_addHostFunctionCallback(hdf->getCallbackObject());
-                        constructedLayers.emplace_back();
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                        // printf("New host function layer created - exception::InvalidLayerMember exception\n");
-                    }
-                }
+void DependencyGraph::setNodeCost(const DependencyNode& node, const double cost) {
+    if (!std::isfinite(cost) || cost < 0) {
+        THROW exception::InvalidArgument("Node cost must be a finite value greater than or equal to 0, %f is not valid, "
+            "in DependencyGraph::setNodeCost()\n", cost);
+    }
+    nodeCosts[&node] = cost;
+}
+
+double DependencyGraph::getNodeCost(const DependencyNode& node) const {
+    const auto it = nodeCosts.find(&node);
+    return it == nodeCosts.end() ? 1.0 : it->second;
+}
+
+bool DependencyGraph::agentFunctionsConflict(const AgentFunctionData& a, const AgentFunctionData& b) {
+    const auto a_parent = a.parent.lock();
+    const auto b_parent = b.parent.lock();
+    if (a_parent && b_parent) {
+        // Functions of the same agent may not share a state
+        if (a_parent->name == b_parent->name) {
+            if (b.initial_state == a.initial_state ||
+                b.initial_state == a.end_state ||
+                b.end_state == a.initial_state ||
+                b.end_state == a.end_state) {
+                return true;
             }
         }
+        // Functions may not birth agents into a state which the other takes as input
+        const auto a_agent_out = a.agent_output.lock();
+        if (a_agent_out && b_parent->name == a_agent_out->name && b.initial_state == a.agent_output_state) {
+            return true;
+        }
+        const auto b_agent_out = b.agent_output.lock();
+        if (b_agent_out && a_parent->name == b_agent_out->name && a.initial_state == b.agent_output_state) {
+            return true;
+        }
     }
+    // Functions may not output to a message list which the other inputs or outputs
+    const auto a_message_out = a.message_output.lock();
+    const auto a_message_in = a.message_input.lock();
+    const auto b_message_out = b.message_output.lock();
+    const auto b_message_in = b.message_input.lock();
+    return (a_message_out && b_message_out && a_message_out == b_message_out) ||
+        (a_message_out && b_message_in && a_message_out == b_message_in) ||
+        (a_message_in && b_message_out && a_message_in == b_message_out);
 }
 
 bool DependencyGraph::validateSubTree(DependencyNode* node) {
@@ -13,11 +13,15 @@ namespace flamegpu {
 HostFunctionDescription::HostFunctionDescription(std::string name, FLAMEGPU_HOST_FUNCTION_POINTER host_function) {
     this->name = name;
     this->function = host_function;
+    this->callbackObject = nullptr;
+    this->concurrent = false;
 }
 
 HostFunctionDescription::HostFunctionDescription(std::string name, HostFunctionCallback *func_callback) {
     this->name = name;
+    this->function = nullptr;
     this->callbackObject = func_callback;
+    this->concurrent = false;
 }
 
 bool HostFunctionDescription::operator==(const HostFunctionDescription& rhs) const {
@@ -43,4 +47,12 @@ HostFunctionCallback* HostFunctionDescription::getCallbackObject() {
     return callbackObject;
 }
 
+void HostFunctionDescription::setConcurrent(const bool _concurrent) {
+    concurrent = _concurrent;
+}
+
+bool HostFunctionDescription::isConcurrent() const {
+    return concurrent;
+}
+
 }  // namespace flamegpu
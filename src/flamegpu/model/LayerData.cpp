@@ -13,6 +13,7 @@ LayerData::LayerData(const std::shared_ptr<const ModelData> &model, const std::s
 LayerData::LayerData(const std::shared_ptr<const ModelData> &model, const LayerData &other)
     : host_functions(other.host_functions)
     , host_functions_callbacks(other.host_functions_callbacks)
+    , concurrent_host_functions(other.concurrent_host_functions)
     , description(model ? new LayerDescription(model, this) : nullptr)
     , name(other.name)
     , index(other.index) {
@@ -45,7 +46,8 @@ bool LayerData::operator==(const LayerData &rhs) const {
     && agent_functions.size() == rhs.agent_functions.size()
     && host_functions.size() == rhs.host_functions.size()
     && host_functions_callbacks.size() == rhs.host_functions_callbacks.size()
-    && host_functions_callbacks == rhs.host_functions_callbacks) {
+    && host_functions_callbacks == rhs.host_functions_callbacks
+    && concurrent_host_functions == rhs.concurrent_host_functions) {
         // Compare pointed to values, not pointers
         for (auto &a : agent_functions) {
             bool success = false;
@@ -145,6 +145,22 @@ void LayerDescription::addHostFunction(FLAMEGPU_HOST_FUNCTION_POINTER func_p) {
             "in LayerDescription::addHostFunction().");
     }
 }
+void LayerDescription::addConcurrentHostFunction(FLAMEGPU_HOST_FUNCTION_POINTER func_p) {
+    if (layer->sub_model) {
+        THROW exception::InvalidLayerMember("A layer containing a submodel may not also contain a host function, "
+        "in LayerDescription::addConcurrentHostFunction()\n");
+    }
+    if (!layer->agent_functions.empty() || !layer->host_functions_callbacks.empty() ||
+        (!layer->host_functions.empty() && !layer->concurrent_host_functions)) {
+        THROW exception::InvalidLayerMember("A layer containing agent functions or a non-concurrent host function may not have a concurrent host function added, "
+        "in LayerDescription::addConcurrentHostFunction()\n");
+    }
+    if (!layer->host_functions.insert(func_p).second) {
+        THROW exception::InvalidHostFunc("HostFunction has already been added to LayerDescription,"
+            "in LayerDescription::addConcurrentHostFunction().");
+    }
+    layer->concurrent_host_functions = true;
+}
 void LayerDescription::addSubModel(const std::string &name) {
     if (!layer->host_functions.empty() || !layer->agent_functions.empty() || !layer->host_functions_callbacks.empty()) {
         THROW exception::InvalidLayerMember("A layer containing agent functions and/or host functions, may not also contain a submodel, "
@@ -76,6 +76,8 @@ ModelData::ModelData(const ModelData &other)
     , exitFunctionCallbacks(other.exitFunctionCallbacks)
     , exitConditions(other.exitConditions)
     , exitConditionCallbacks(other.exitConditionCallbacks)
+    , concurrentStepFunctions(other.concurrentStepFunctions)
+    , concurrentExitConditions(other.concurrentExitConditions)
     , environment(new EnvironmentDescription(*other.environment))
     , name(other.name)
     , dependencyGraph(new DependencyGraph(*other.dependencyGraph)) {
@@ -148,6 +150,8 @@ bool ModelData::operator==(const ModelData& rhs) const {
                     return false;
                 if (stepFunctionCallbacks != rhs.stepFunctionCallbacks)
                     return false;
+                if (concurrentStepFunctions != rhs.concurrentStepFunctions)
+                    return false;
             }
             {  // Exit fns (set)
                 if (exitFunctions != rhs.exitFunctions)
@@ -160,6 +164,8 @@ bool ModelData::operator==(const ModelData& rhs) const {
                     return false;
                 if (exitConditionCallbacks != rhs.exitConditionCallbacks)
                     return false;
+                if (concurrentExitConditions != rhs.concurrentExitConditions)
+                    return false;
             }
             return true;
     }
@@ -1,5 +1,7 @@
 #include "flamegpu/model/ModelDescription.h"
 
+#include <algorithm>
+
 #include "flamegpu/model/DependencyGraph.h"
 #include "flamegpu/model/AgentDescription.h"
 #include "flamegpu/model/LayerDescription.h"
@@ -149,6 +151,14 @@ void ModelDescription::addStepFunction(FLAMEGPU_STEP_FUNCTION_POINTER func_p) {
     }
     model->stepFunctions.push_back(func_p);
 }
+void ModelDescription::addConcurrentStepFunction(FLAMEGPU_STEP_FUNCTION_POINTER func_p) {
+    if (std::find(model->stepFunctions.begin(), model->stepFunctions.end(), func_p) != model->stepFunctions.end()) {
+        THROW exception::InvalidHostFunc("Attempted to add same step function twice,"
+            "in ModelDescription::addConcurrentStepFunction()");
+    }
+    model->stepFunctions.push_back(func_p);
+    model->concurrentStepFunctions.insert(func_p);
+}
 void ModelDescription::addExitFunction(FLAMEGPU_EXIT_FUNCTION_POINTER func_p) {
     if (std::find(model->exitFunctions.begin(), model->exitFunctions.end(), func_p) != model->exitFunctions.end()) {
         THROW exception::InvalidHostFunc("Attempted to add same exit function twice,"
@@ -164,11 +174,81 @@ void ModelDescription::addExitCondition(FLAMEGPU_EXIT_CONDITION_POINTER func_p)
     }
     model->exitConditions.push_back(func_p);
 }
+void ModelDescription::addConcurrentExitCondition(FLAMEGPU_EXIT_CONDITION_POINTER func_p) {
+    if (std::find(model->exitConditions.begin(), model->exitConditions.end(), func_p) != model->exitConditions.end()) {
+        THROW exception::InvalidHostFunc("Attempted to add same exit condition twice,"
+            "in ModelDescription::addConcurrentExitCondition()");
+    }
+    model->exitConditions.push_back(func_p);
+    model->concurrentExitConditions.insert(func_p);
+}
 
 void ModelDescription::generateLayers() {
     model->dependencyGraph->generateLayers(*this);
 }
 
+std::vector<LayerMerge> ModelDescription::compactLayers() {
+    // Macro property accesses can't be determined, even RTC source may refer to a macro property without it's name as a literal
+    // So agent functions may only be merged if the model has no macro properties
+    const bool has_macro_properties = !model->environment->getMacroPropertiesMap().empty();
+    // Two agent functions may be merged if they could share a layer
+    const auto compatible = [has_macro_properties](const AgentFunctionData& a, const AgentFunctionData& b) {
+        return !has_macro_properties && !DependencyGraph::agentFunctionsConflict(a, b);
+    };
+    // Host functions and submodels may access anything, so act as barriers
+    const auto mergeable = [](const LayerData& layer) {
+        return !layer.sub_model && layer.host_functions.empty() && layer.host_functions_callbacks.empty();
+    };
+    // Agent function names of a layer, sorted as std::set of shared_ptr is ordered by address
+    const auto functionNames = [](const LayerData& layer) {
+        std::vector<std::string> rtn;
+        for (const auto& f : layer.agent_functions) {
+            rtn.push_back(f->name);
+        }
+        std::sort(rtn.begin(), rtn.end());
+        return rtn;
+    };
+
+    std::vector<LayerMerge> rtn;
+    ModelData::LayerList compacted;
+    ModelData::size_type index = 0;
+    for (const auto& layer : model->layers) {
+        bool merge = !compacted.empty() && mergeable(*compacted.back()) && mergeable(*layer);
+        if (merge) {
+            for (const auto& a : compacted.back()->agent_functions) {
+                for (const auto& b : layer->agent_functions) {
+                    if (!compatible(*a, *b)) {
+                        merge = false;
+                        break;
+                    }
+                }
+                if (!merge)
+                    break;
+            }
+        }
+        if (merge) {
+            // Record the merge, extending the previous record if this continues the same run of layers
+            if (rtn.empty() || rtn.back().first_layer != compacted.back()->index) {
+                rtn.push_back(LayerMerge{ compacted.back()->index, index, functionNames(*compacted.back()) });
+            }
+            rtn.back().last_layer = index;
+            const std::vector<std::string> names = functionNames(*layer);
+            rtn.back().agent_functions.insert(rtn.back().agent_functions.end(), names.begin(), names.end());
+            compacted.back()->agent_functions.insert(layer->agent_functions.begin(), layer->agent_functions.end());
+        } else {
+            compacted.push_back(layer);
+        }
+        ++index;
+    }
+    // Update the indices of the remaining layers
+    model->layers = compacted;
+    index = 0;
+    for (const auto& layer : model->layers) {
+        layer->index = index++;
+    }
+    return rtn;
+}
+
 /**
  * Accessors
  */
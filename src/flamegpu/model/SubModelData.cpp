@@ -13,7 +13,8 @@ bool SubModelData::operator==(const SubModelData& rhs) const {
     // Compare members
     if (subagents.size() == rhs.subagents.size()
         && (submodel == rhs.submodel || *submodel == *rhs.submodel)
-        && max_steps == rhs.max_steps) {
+        && max_steps == rhs.max_steps
+        && persistent == rhs.persistent) {
         // Compare subagents map
         for (auto &v : subagents) {
             auto _v = rhs.subagents.find(v.first);
@@ -34,6 +35,7 @@ bool SubModelData::operator!=(const SubModelData& rhs) const {
 SubModelData::SubModelData(const std::shared_ptr<ModelData> &model, const SubModelData &other)
     : submodel(other.submodel->clone())
     , max_steps(other.max_steps)
+    , persistent(other.persistent)
     , name(other.name)
     , description(model ? new SubModelDescription(model, this) : nullptr) {
     // Note, this does not init subagents!
@@ -42,6 +44,7 @@ SubModelData::SubModelData(const std::shared_ptr<ModelData> &model, const SubMod
 SubModelData::SubModelData(const std::shared_ptr<ModelData> &model, const std::string &submodel_name, const std::shared_ptr<ModelData> &_submodel)
     : submodel(_submodel)
     , max_steps(0)
+    , persistent(false)
     , name(submodel_name)
     , description(new SubModelDescription(model, this))  { }
 
@@ -129,6 +129,12 @@ void SubModelDescription::setMaxSteps(const unsigned int &max_steps) {
 unsigned int SubModelDescription::getMaxSteps() const {
     return data->max_steps;
 }
+void SubModelDescription::setPersistent(const bool persistent) {
+    data->persistent = persistent;
+}
+bool SubModelDescription::getPersistent() const {
+    return data->persistent;
+}
 const std::string SubModelDescription::getName() {
     return data->name;
 }
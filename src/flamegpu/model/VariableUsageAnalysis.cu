@@ -0,0 +1,219 @@
+#include "flamegpu/model/VariableUsageAnalysis.h"
+
+#include <sstream>
+
+#include "flamegpu/model/ModelDescription.h"
+#include "flamegpu/model/ModelData.h"
+#include "flamegpu/model/AgentData.h"
+#include "flamegpu/model/AgentFunctionData.cuh"
+#include "flamegpu/model/LayerData.h"
+#include "flamegpu/model/SubModelData.h"
+#include "flamegpu/model/SubAgentData.h"
+#include "flamegpu/sim/LoggingConfig.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+
+VariableUsageAnalysis::VariableUsageAnalysis(const ModelDescription &_model)
+    : model(_model.model) {
+    analyse();
+}
+VariableUsageAnalysis::VariableUsageAnalysis(const ModelData &_model)
+    : model(_model.shared_from_this()) {
+    analyse();
+}
+void VariableUsageAnalysis::addLoggingConfig(const LoggingConfig &config) {
+    if (*config.model != *model) {
+        THROW exception::InvalidArgument("Model descriptions attached to LoggingConfig and VariableUsageAnalysis do not match, "
+            "in VariableUsageAnalysis::addLoggingConfig()\n");
+    }
+    for (const auto &agent : config.agents) {
+        std::set<std::string> names;
+        for (const auto &reduction : *agent.second.first) {
+            names.insert(reduction.name);
+        }
+        markUsed(agents.at(agent.first.first), names);
+    }
+}
+const VariableUsageAnalysis::AgentUsage &VariableUsageAnalysis::getAgentUsage(const std::string &agent_name) const {
+    const auto it = agents.find(agent_name);
+    if (it == agents.end()) {
+        THROW exception::InvalidAgentName("Agent '%s' was not found in the model description, "
+            "in VariableUsageAnalysis::getAgentUsage()\n",
+            agent_name.c_str());
+    }
+    return it->second;
+}
+std::set<std::string> VariableUsageAnalysis::getEliminableVariables(const std::string &agent_name) const {
+    const AgentUsage &usage = getAgentUsage(agent_name);
+    return usage.eliminable ? usage.unused : std::set<std::string>();
+}
+std::string VariableUsageAnalysis::getReport() const {
+    std::stringstream ss;
+    ss << "Agent variable usage of model '" << model->name << "':\n";
+    for (const auto &agent : agents) {
+        const AgentUsage &usage = agent.second;
+        ss << "  Agent '" << agent.first << "': " << usage.used.size() << " used, " << usage.unused.size() << " unused";
+        if (!usage.eliminable) {
+            ss << ", not eligible for elimination\n";
+            for (const auto &reason : usage.reasons) {
+                ss << "    " << reason << "\n";
+            }
+        } else {
+            ss << "\n";
+        }
+        for (const auto &v : usage.unused) {
+            ss << "    unused: " << v << "\n";
+        }
+    }
+    for (const auto &warning : warnings) {
+        ss << "  Warning: " << warning << "\n";
+    }
+    return ss.str();
+}
+std::set<std::string> VariableUsageAnalysis::extractStringLiterals(const std::string &source) {
+    std::set<std::string> rtn;
+    std::string literal;
+    bool open_literal = false;  // A literal has been read, but may continue via concatenation with the next literal
+    size_t i = 0;
+    while (i < source.size()) {
+        const char c = source[i];
+        if (c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+            // Line comment
+            i = source.find('\n', i);
+            if (i == std::string::npos)
+                break;
+        } else if (c == '/' && i + 1 < source.size() && source[i + 1] == '*') {
+            // Block comment
+            i = source.find("*/", i + 2);
+            if (i == std::string::npos)
+                break;
+            i += 2;
+        } else if (c == '"' || c == '\'') {
+            // String or character literal, escape sequences are retained verbatim
+            std::string value;
+            for (++i; i < source.size() && source[i] != c && source[i] != '\n'; ++i) {
+                if (source[i] == '\\' && i + 1 < source.size()) {
+                    value += source[i++];
+                }
+                value += source[i];
+            }
+            ++i;
+            if (c == '"') {
+                literal += value;
+                open_literal = true;
+            }
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            ++i;
+        } else {
+            if (open_literal) {
+                rtn.insert(literal);
+                literal.clear();
+                open_literal = false;
+            }
+            ++i;
+        }
+    }
+    if (open_literal) {
+        rtn.insert(literal);
+    }
+    return rtn;
+}
+void VariableUsageAnalysis::analyse() {
+    agents.clear();
+    warnings.clear();
+    for (const auto &agent : model->agents) {
+        AgentUsage &usage = agents[agent.first];
+        for (const auto &v : agent.second->variables) {
+            // Internal variables are always required
+            if (v.first[0] == '_') {
+                usage.used.insert(v.first);
+            } else {
+                usage.unused.insert(v.first);
+            }
+        }
+    }
+    // Agent functions and function conditions
+    for (const auto &agent : model->agents) {
+        AgentUsage &usage = agents.at(agent.first);
+        for (const auto &f : agent.second->functions) {
+            const AgentFunctionData &func = *f.second;
+            const auto output = func.agent_output.lock();
+            if (func.func) {
+                markUneliminable(usage, "Agent function '" + func.name + "' is not an RTC function, so it's variable usage cannot be analysed.");
+                if (output) {
+                    markUneliminable(agents.at(output->name), "Agent function '" + agent.first + "::" + func.name + "' outputs this agent and is not an RTC function, so it's variable usage cannot be analysed.");
+                }
+            } else if (!func.rtc_source.empty()) {
+                const std::set<std::string> literals = extractStringLiterals(func.rtc_source);
+                markUsed(usage, literals);
+                if (output) {
+                    markUsed(agents.at(output->name), literals);
+                }
+            }
+            if (func.condition) {
+                markUneliminable(usage, "Agent function condition of '" + func.name + "' is not an RTC function condition, so it's variable usage cannot be analysed.");
+            } else if (!func.rtc_condition_source.empty()) {
+                markUsed(usage, extractStringLiterals(func.rtc_condition_source));
+            }
+        }
+    }
+    // Agents mapped to submodels share their storage with the submodel
+    for (const auto &sm : model->submodels) {
+        for (const auto &sa : sm.second->subagents) {
+            if (const auto master = sa.second->masterAgent.lock()) {
+                markUneliminable(agents.at(master->name), "Agent is mapped to submodel '" + sm.first + "'.");
+            }
+        }
+    }
+    // Host functions are not analysed
+    std::vector<std::string> host_functions;
+    const auto addHostFunctions = [&host_functions](const std::string &kind, const std::vector<std::string> &names, const size_t callbacks) {
+        for (const auto &name : names) {
+            host_functions.push_back(kind + " '" + (name.empty() ? "<unnamed>" : name) + "'");
+        }
+        if (callbacks) {
+            host_functions.push_back(std::to_string(callbacks) + " " + kind + " callback(s)");
+        }
+    };
+    {
+        std::vector<std::string> names;
+        for (const auto &fn : model->initFunctions)
+            names.push_back(detail::getHostFunctionName(fn));
+        addHostFunctions("init function", names, model->initFunctionCallbacks.size());
+        names.clear();
+        for (const auto &fn : model->stepFunctions)
+            names.push_back(detail::getHostFunctionName(fn));
+        addHostFunctions("step function", names, model->stepFunctionCallbacks.size());
+        names.clear();
+        for (const auto &fn : model->exitFunctions)
+            names.push_back(detail::getHostFunctionName(fn));
+        addHostFunctions("exit function", names, model->exitFunctionCallbacks.size());
+        names.clear();
+        for (const auto &fn : model->exitConditions)
+            names.push_back(detail::getHostFunctionName(fn));
+        addHostFunctions("exit condition", names, model->exitConditionCallbacks.size());
+        for (const auto &layer : model->layers) {
+            names.clear();
+            for (const auto &fn : layer->host_functions)
+                names.push_back(detail::getHostFunctionName(fn));
+            addHostFunctions("host layer function", names, layer->host_functions_callbacks.size());
+        }
+    }
+    for (const auto &fn : host_functions) {
+        warnings.push_back("The variable usage of " + fn + " is not analysed, it must not access eliminated agent variables.");
+    }
+}
+void VariableUsageAnalysis::markUsed(AgentUsage &usage, const std::set<std::string> &names) {
+    for (const auto &name : names) {
+        if (usage.unused.erase(name)) {
+            usage.used.insert(name);
+        }
+    }
+}
+void VariableUsageAnalysis::markUneliminable(AgentUsage &usage, const std::string &reason) {
+    usage.eliminable = false;
+    usage.reasons.push_back(reason);
+}
+
+}  // namespace flamegpu
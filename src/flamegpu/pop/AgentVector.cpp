@@ -1,6 +1,11 @@
 #include "flamegpu/pop/AgentVector.h"
+
+#include <fstream>
+
 #include "flamegpu/model/AgentDescription.h"
 #include "flamegpu/pop/AgentVector_Agent.h"
+#include "flamegpu/pop/detail/MappedMemoryVector.h"
+#include "flamegpu/util/detail/filesystem.h"
 
 // @todo - this shouldn't be required anymore?
 #ifdef max
@@ -39,10 +44,20 @@ AgentVector::AgentVector(AgentVector&& other) noexcept
     _data->clear();
     // Swap data
     std::swap(*_data, *other._data);  // Not 100% sure this will work as intended
+    std::swap(mapped_directory, other.mapped_directory);
     // Purge other
     other._size = 0;
     other._capacity = 0;
 }
+AgentVector::~AgentVector() {
+    if (isMapped()) {
+        try {
+            syncMapped();
+        } catch (...) {
+            // Destructors must not throw, the data files are still valid but the manifest may be stale
+        }
+    }
+}
 
 AgentVector& AgentVector::operator=(const AgentVector& other) {
     // Self assignment
@@ -65,6 +80,11 @@ AgentVector& AgentVector::operator=(const AgentVector& other) {
     return *this;
 }
 AgentVector& AgentVector::operator=(AgentVector&& other) noexcept {
+    if (isMapped()) {
+        try {
+            syncMapped();
+        } catch (...) { }
+    }
     agent = other.agent->clone();
     _size = other._size;
     _capacity = other._capacity;
@@ -72,12 +92,115 @@ AgentVector& AgentVector::operator=(AgentVector&& other) noexcept {
     _data->clear();
     // Swap data
     std::swap(*_data, *other._data);  // Not 100% sure this will work as intended
+    mapped_directory = std::move(other.mapped_directory);
+    other.mapped_directory.clear();
     // Purge other
     other._size = 0;
     other._capacity = 0;
     return *this;
 }
 
+AgentVector AgentVector::createMapped(const AgentDescription& agent_desc, const std::string& directory, size_type count) {
+    if (directory.empty()) {
+        THROW exception::InvalidFilePath("A directory must be provided, "
+            "in AgentVector::createMapped()\n");
+    }
+    try {
+        util::detail::filesystem::recursive_create_dir(directory);
+    } catch (const std::exception &e) {
+        THROW exception::InvalidFilePath("Unable to create directory '%s': %s, "
+            "in AgentVector::createMapped()\n", directory.c_str(), e.what());
+    }
+    AgentVector rtn(agent_desc);
+    rtn.createMappedColumns(directory, false);
+    rtn.mapped_directory = directory;
+    rtn.resize(count);
+    rtn.syncMapped();
+    return rtn;
+}
+AgentVector AgentVector::openMapped(const AgentDescription& agent_desc, const std::string& directory) {
+    const std::string manifest_path = mappedManifestPath(directory);
+    std::ifstream manifest(manifest_path);
+    if (!manifest.is_open()) {
+        THROW exception::InvalidFilePath("Unable to open manifest '%s', "
+            "in AgentVector::openMapped()\n", manifest_path.c_str());
+    }
+    AgentVector rtn(agent_desc);
+    const AgentData &desc = *rtn.agent;
+    std::string header, agent_name;
+    unsigned int version = 0;
+    size_type size = 0, capacity = 0;
+    size_t variable_count = 0;
+    manifest >> header >> version >> agent_name >> size >> capacity >> variable_count;
+    if (!manifest || header != "flamegpu_agentvector" || version != 1 || size > capacity) {
+        THROW exception::InvalidInputFile("Manifest '%s' is not a valid AgentVector manifest, "
+            "in AgentVector::openMapped()\n", manifest_path.c_str());
+    }
+    if (agent_name != desc.name || variable_count != desc.variables.size()) {
+        THROW exception::InvalidInputFile("Manifest '%s' describes a population of agent '%s' with %u variables, which does not match agent '%s', "
+            "in AgentVector::openMapped()\n", manifest_path.c_str(), agent_name.c_str(), static_cast<unsigned int>(variable_count), desc.name.c_str());
+    }
+    for (size_t i = 0; i < variable_count; ++i) {
+        std::string name;
+        size_t type_size = 0;
+        unsigned int elements = 0;
+        manifest >> name >> type_size >> elements;
+        const auto it = desc.variables.find(name);
+        if (!manifest || it == desc.variables.end() || it->second.type_size != type_size || it->second.elements != elements) {
+            THROW exception::InvalidInputFile("Manifest '%s' variable '%s' does not match agent '%s', "
+                "in AgentVector::openMapped()\n", manifest_path.c_str(), name.c_str(), desc.name.c_str());
+        }
+    }
+    rtn.createMappedColumns(directory, true);
+    for (const auto &v : *rtn._data) {
+        const unsigned int file_capacity = static_cast<const detail::MappedMemoryVector*>(v.second.get())->getCapacity();
+        if (file_capacity != capacity) {
+            THROW exception::InvalidInputFile("Data file for variable '%s' holds %u agents, manifest '%s' expects %u, "
+                "in AgentVector::openMapped()\n", v.first.c_str(), file_capacity, manifest_path.c_str(), capacity);
+        }
+    }
+    rtn._capacity = capacity;
+    rtn._size = size;
+    // Only set once validated, so that a population which doesn't match won't have it's manifest rewritten
+    rtn.mapped_directory = directory;
+    return rtn;
+}
+void AgentVector::syncMapped() {
+    if (!isMapped()) {
+        THROW exception::InvalidOperation("AgentVector is not mapped, "
+            "in AgentVector::syncMapped()\n");
+    }
+    for (auto &v : *_data) {
+        static_cast<detail::MappedMemoryVector*>(v.second.get())->flush();
+    }
+    const std::string manifest_path = mappedManifestPath(mapped_directory);
+    std::ofstream manifest(manifest_path, std::ios::trunc);
+    if (!manifest.is_open()) {
+        THROW exception::InvalidFilePath("Unable to write manifest '%s', "
+            "in AgentVector::syncMapped()\n", manifest_path.c_str());
+    }
+    manifest << "flamegpu_agentvector 1\n";
+    manifest << agent->name << "\n";
+    manifest << size() << " " << _capacity << "\n";
+    manifest << agent->variables.size() << "\n";
+    for (const auto &v : agent->variables) {
+        manifest << v.first << " " << v.second.type_size << " " << v.second.elements << "\n";
+    }
+}
+void AgentVector::createMappedColumns(const std::string &directory, const bool open_existing) {
+    for (const auto& v : agent->variables) {
+        const std::string file_path = (path(directory) / (v.first + ".bin")).string();
+        (*_data)[v.first] = std::unique_ptr<detail::GenericMemoryVector>(new detail::MappedMemoryVector(file_path, *v.second.memory_vector, open_existing));
+    }
+    if (!open_existing) {
+        _capacity = 0;
+        _size = 0;
+    }
+}
+std::string AgentVector::mappedManifestPath(const std::string& directory) {
+    return (path(directory) / "manifest.txt").string();
+}
+
 AgentVector::Agent AgentVector::at(size_type pos) {
     if (pos >= _size) {
         _requireLength();
@@ -558,6 +681,7 @@ void AgentVector::internal_resize(size_type count, bool init) {
 }
 void AgentVector::swap(AgentVector& other) noexcept {
     std::swap(_data, other._data);
+    std::swap(mapped_directory, other.mapped_directory);
     std::swap(_capacity, other._capacity);
     std::swap(_size, other._size);
     std::swap(agent, other.agent);
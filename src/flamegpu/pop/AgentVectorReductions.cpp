@@ -0,0 +1,74 @@
+#include "flamegpu/pop/AgentVectorReductions.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace flamegpu {
+
+AgentVectorReductions::AgentVectorReductions(const AgentVector &_population, const unsigned int _threads)
+    : population(_population)
+    , threads(_threads ? _threads : std::max(1u, std::thread::hardware_concurrency())) { }
+
+unsigned int AgentVectorReductions::getChunkCount() const {
+    const AgentVector::size_type items = population.size();
+    const unsigned int useful_threads = static_cast<unsigned int>(items / MIN_ITEMS_PER_THREAD);
+    return std::max(1u, std::min(threads, useful_threads));
+}
+
+void AgentVectorReductions::runChunks(const unsigned int chunks, const std::function<void(unsigned int, AgentVector::size_type, AgentVector::size_type)> &fn) const {
+    const AgentVector::size_type items = population.size();
+    const AgentVector::size_type chunk_len = items / chunks;
+    const AgentVector::size_type remainder = items % chunks;
+    // The first 'remainder' chunks receive one extra item
+    auto chunk_begin = [chunk_len, remainder](unsigned int c) {
+        return c * chunk_len + std::min<AgentVector::size_type>(c, remainder);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (unsigned int c = 1; c < chunks; ++c) {
+        workers.emplace_back(fn, c, chunk_begin(c), chunk_begin(c + 1));
+    }
+    fn(0, chunk_begin(0), chunk_begin(1));
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+unsigned int AgentVectorReductions::countIDCollisions() const {
+    const id_t *const ids = getVariableData<id_t>(ID_VARIABLE_NAME, "countIDCollisions");
+    // Duplicate IDs always fall within the same shard, so shards can be checked independently
+    const unsigned int shards = getChunkCount();
+    // buckets[c * shards + s] holds the IDs from chunk c which belong to shard s
+    std::vector<std::vector<id_t>> buckets(static_cast<size_t>(shards) * shards);
+    forEachChunk(shards, [ids, shards, &buckets](unsigned int c, AgentVector::size_type first, AgentVector::size_type last) {
+        for (AgentVector::size_type i = first; i < last; ++i) {
+            if (ids[i] != ID_NOT_SET)
+                buckets[c * shards + ids[i] % shards].push_back(ids[i]);
+        }
+    });
+    std::vector<unsigned int> partial(shards, 0);
+    forEachChunk(shards, [shards, &buckets, &partial](unsigned int s, AgentVector::size_type, AgentVector::size_type) {
+        std::vector<id_t> shard;
+        size_t shard_len = 0;
+        for (unsigned int c = 0; c < shards; ++c)
+            shard_len += buckets[c * shards + s].size();
+        shard.reserve(shard_len);
+        for (unsigned int c = 0; c < shards; ++c) {
+            std::vector<id_t> &bucket = buckets[c * shards + s];
+            shard.insert(shard.end(), bucket.begin(), bucket.end());
+            std::vector<id_t>().swap(bucket);
+        }
+        std::sort(shard.begin(), shard.end());
+        unsigned int collisions = 0;
+        for (size_t i = 1; i < shard.size(); ++i)
+            collisions += shard[i] == shard[i - 1] ? 1 : 0;
+        partial[s] = collisions;
+    });
+    unsigned int rtn = 0;
+    for (const unsigned int &p : partial)
+        rtn += p;
+    return rtn;
+}
+
+}  // namespace flamegpu
@@ -4,7 +4,7 @@
 namespace flamegpu {
 
 DeviceAgentVector_impl::DeviceAgentVector_impl(CUDAAgent& _cuda_agent, const std::string &_cuda_agent_state,
-    const VarOffsetStruct& _agentOffsets, std::vector<NewAgentStorage>& _newAgentData,
+    const VarOffsetStruct& _agentOffsets, NewAgentArena& _newAgentData,
     CUDAScatter& _scatter, const unsigned int& _streamId, const cudaStream_t& _stream)
     : AgentVector(_cuda_agent.getAgentDescription(), 0)
     , unbound_buffers_has_changed(false)
@@ -395,11 +395,12 @@ void DeviceAgentVector_impl::_requireLength() const {
     }
     _requireAll();
     // Check if host new agent has any agents
-    for (auto &newAgent : newAgentData) {
+    for (NewAgentArena::size_type i = 0; i < newAgentData.size(); ++i) {
+        const char *const newAgent = newAgentData.getRecord(i);
         // Manually insert them to device agent vector
         for (auto &v : agentOffsets.vars) {
             char* dst = static_cast<char*>(_data->at(v.first)->getDataPtr()) + _size * v.second.len;
-            const char * src = newAgent.data + v.second.offset;
+            const char * src = newAgent + v.second.offset;
             memcpy(dst, src, v.second.len);
         }
         // Increase size
@@ -0,0 +1,141 @@
+#include "flamegpu/pop/detail/MappedMemoryVector.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace detail {
+
+MappedMemoryVector::MappedMemoryVector(const std::string &_file_path, const GenericMemoryVector &_prototype, const bool open_existing)
+    : GenericMemoryVector()
+    , file_path(_file_path)
+    , prototype(_prototype.clone())
+    , elements(_prototype.getElements())
+    , type(_prototype.getType())
+    , type_size(_prototype.getTypeSize()) {
+#ifdef _MSC_VER
+    HANDLE h = CreateFileA(file_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        open_existing ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        THROW exception::InvalidFilePath("Unable to %s file '%s', "
+            "in MappedMemoryVector::MappedMemoryVector()\n", open_existing ? "open" : "create", file_path.c_str());
+    }
+    file_handle = reinterpret_cast<intptr_t>(h);
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(h, &file_size);
+    mapped_bytes = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = ::open(file_path.c_str(), open_existing ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        THROW exception::InvalidFilePath("Unable to %s file '%s', "
+            "in MappedMemoryVector::MappedMemoryVector()\n", open_existing ? "open" : "create", file_path.c_str());
+    }
+    file_handle = fd;
+    struct stat st;
+    fstat(fd, &st);
+    mapped_bytes = static_cast<size_t>(st.st_size);
+#endif
+    if (mapped_bytes % getVariableSize()) {
+        const size_t len = mapped_bytes;
+        mapped_bytes = 0;
+        close();
+        THROW exception::InvalidInputFile("File '%s' has length %llu, which is not a multiple of the variable size %llu, "
+            "in MappedMemoryVector::MappedMemoryVector()\n",
+            file_path.c_str(), static_cast<unsigned long long>(len), static_cast<unsigned long long>(getVariableSize()));  // NOLINT(runtime/int)
+    }
+    map();
+}
+MappedMemoryVector::~MappedMemoryVector() {
+    close();
+}
+GenericMemoryVector* MappedMemoryVector::clone() const {
+    return prototype->clone();
+}
+void MappedMemoryVector::resize(const unsigned int t) {
+    const size_t new_bytes = static_cast<size_t>(t) * getVariableSize();
+    if (new_bytes == mapped_bytes)
+        return;
+    // The mapping must be released before the file can be resized on Windows
+    unmap();
+#ifdef _MSC_VER
+    LARGE_INTEGER len;
+    len.QuadPart = static_cast<LONGLONG>(new_bytes);
+    const bool ok = SetFilePointerEx(reinterpret_cast<HANDLE>(file_handle), len, nullptr, FILE_BEGIN) && SetEndOfFile(reinterpret_cast<HANDLE>(file_handle));
+#else
+    const bool ok = ftruncate(static_cast<int>(file_handle), static_cast<off_t>(new_bytes)) == 0;
+#endif
+    if (!ok) {
+        // Restore the previous mapping, so the vector remains usable
+        map();
+        THROW exception::OutOfMemory("Unable to resize file '%s' to %llu bytes, "
+            "in MappedMemoryVector::resize()\n", file_path.c_str(), static_cast<unsigned long long>(new_bytes));  // NOLINT(runtime/int)
+    }
+    mapped_bytes = new_bytes;
+    map();
+}
+void MappedMemoryVector::flush() {
+    if (!data)
+        return;
+#ifdef _MSC_VER
+    FlushViewOfFile(data, mapped_bytes);
+    FlushFileBuffers(reinterpret_cast<HANDLE>(file_handle));
+#else
+    msync(data, mapped_bytes, MS_SYNC);
+#endif
+}
+void MappedMemoryVector::map() {
+    if (!mapped_bytes)
+        return;
+#ifdef _MSC_VER
+    HANDLE m = CreateFileMappingA(reinterpret_cast<HANDLE>(file_handle), nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    void *ptr = m ? MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, mapped_bytes) : nullptr;
+    if (!ptr) {
+        if (m)
+            CloseHandle(m);
+        THROW exception::OutOfMemory("Unable to map %llu bytes of file '%s', "
+            "in MappedMemoryVector::map()\n", static_cast<unsigned long long>(mapped_bytes), file_path.c_str());  // NOLINT(runtime/int)
+    }
+    mapping_handle = reinterpret_cast<intptr_t>(m);
+#else
+    void *ptr = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(file_handle), 0);
+    if (ptr == MAP_FAILED) {
+        THROW exception::OutOfMemory("Unable to map %llu bytes of file '%s', "
+            "in MappedMemoryVector::map()\n", static_cast<unsigned long long>(mapped_bytes), file_path.c_str());  // NOLINT(runtime/int)
+    }
+#endif
+    data = ptr;
+}
+void MappedMemoryVector::close() {
+    unmap();
+    if (file_handle == -1)
+        return;
+#ifdef _MSC_VER
+    CloseHandle(reinterpret_cast<HANDLE>(file_handle));
+#else
+    ::close(static_cast<int>(file_handle));
+#endif
+    file_handle = -1;
+}
+void MappedMemoryVector::unmap() {
+    if (!data)
+        return;
+#ifdef _MSC_VER
+    UnmapViewOfFile(data);
+    CloseHandle(reinterpret_cast<HANDLE>(mapping_handle));
+    mapping_handle = 0;
+#else
+    munmap(data, mapped_bytes);
+#endif
+    data = nullptr;
+}
+
+}  // namespace detail
+}  // namespace flamegpu
@@ -0,0 +1,50 @@
+#include "flamegpu/runtime/HostAPI_macros.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace flamegpu {
+namespace detail {
+
+namespace {
+/**
+ * Registered names are accessed via function local statics, as registration occurs during static initialisation
+ */
+std::mutex &nameMutex() {
+    static std::mutex m;
+    return m;
+}
+std::map<FLAMEGPU_HOST_FUNCTION_POINTER, std::string> &functionNames() {
+    static std::map<FLAMEGPU_HOST_FUNCTION_POINTER, std::string> names;
+    return names;
+}
+std::map<FLAMEGPU_HOST_CONDITION_POINTER, std::string> &conditionNames() {
+    static std::map<FLAMEGPU_HOST_CONDITION_POINTER, std::string> names;
+    return names;
+}
+}  // anonymous namespace
+
+bool registerHostFunctionName(const FLAMEGPU_HOST_FUNCTION_POINTER func, const char *name) {
+    std::lock_guard<std::mutex> lock(nameMutex());
+    functionNames()[func] = name;
+    return true;
+}
+bool registerHostFunctionName(const FLAMEGPU_HOST_CONDITION_POINTER func, const char *name) {
+    std::lock_guard<std::mutex> lock(nameMutex());
+    conditionNames()[func] = name;
+    return true;
+}
+std::string getHostFunctionName(const FLAMEGPU_HOST_FUNCTION_POINTER func) {
+    std::lock_guard<std::mutex> lock(nameMutex());
+    const auto it = functionNames().find(func);
+    return it != functionNames().end() ? it->second : "";
+}
+std::string getHostFunctionName(const FLAMEGPU_HOST_CONDITION_POINTER func) {
+    std::lock_guard<std::mutex> lock(nameMutex());
+    const auto it = conditionNames().find(func);
+    return it != conditionNames().end() ? it->second : "";
+}
+
+}  // namespace detail
+}  // namespace flamegpu
@@ -12,9 +12,9 @@ HostAgentAPI::~HostAgentAPI() {
 
 HostNewAgentAPI HostAgentAPI::newAgent() {
     // Create the agent in our backing data structure
-    newAgentData.emplace_back(NewAgentStorage(agentOffsets, agent.nextID(1)));
+    const NewAgentArena::size_type index = newAgentData.append(agent.nextID(1));
     // Point the returned object to the created agent
-    return HostNewAgentAPI(newAgentData.back());
+    return HostNewAgentAPI(NewAgentStorage(newAgentData, index));
 }
 
 unsigned HostAgentAPI::count() {
@@ -2,8 +2,12 @@
 
 #include <cstdio>
 #include <cassert>
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "flamegpu/runtime/detail/curve/curve.cuh"
 
@@ -33,6 +37,11 @@ namespace detail {
      * Holds the length of the buffer (in terms of agents/items, rather than bytes)
      */
     __constant__ unsigned int d_lengths[Curve::MAX_VARIABLES];
+    /**
+     * Curve hashtable, displacement of each bucket
+     * Used to compute a variable's slot within the other arrays
+     */
+    __constant__ Curve::VariableHash d_displacements[Curve::DISPLACEMENT_BUCKETS];
 }  // namespace detail
 
 std::mutex Curve::instance_mutex;
@@ -53,23 +62,28 @@ __host__ void Curve::initialiseDevice() {
         char** _d_variables;
         unsigned int* _d_lengths;
         size_t* _d_sizes;
+        VariableHash* _d_displacements;
 
         // get a host pointer to d_hashes and d_variables
         gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_hashes), curve::detail::d_hashes));
         gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_variables), curve::detail::d_variables));
         gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_lengths), curve::detail::d_lengths));
         gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_sizes), curve::detail::d_sizes));
+        gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_displacements), curve::detail::d_displacements));
 
         // set values of hash table to 0 on host and device
         memset(h_hashes, 0, sizeof(unsigned int)*MAX_VARIABLES);
         memset(h_lengths, 0, sizeof(unsigned int)*MAX_VARIABLES);
         memset(h_sizes, 0, sizeof(size_t)*MAX_VARIABLES);
+        memset(h_displacements, 0, sizeof(VariableHash)*DISPLACEMENT_BUCKETS);
+        h_slots.clear();
 
         // initialise data to 0 on device
         gpuErrchk(cudaMemset(_d_hashes, 0, sizeof(unsigned int)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_variables, 0, sizeof(void*)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_lengths, 0, sizeof(unsigned int)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_sizes, 0, sizeof(size_t)*MAX_VARIABLES));
+        gpuErrchk(cudaMemset(_d_displacements, 0, sizeof(VariableHash)*DISPLACEMENT_BUCKETS));
     }
     deviceInitialised = true;
 }
@@ -90,24 +104,61 @@ __host__ Curve::VariableHash Curve::variableRuntimeHash(unsigned int num) {
     return variableRuntimeHash(std::to_string(num).c_str());
 }
 
-__host__ Curve::Variable Curve::getVariableHandle(VariableHash variable_hash) {
+__host__ bool Curve::findDisplacement(const std::vector<VariableHash> &bucket_hashes, const std::vector<bool> &occupied, VariableHash &displacement) {
     // Method is static, does not require mutex
-    unsigned int n = 0;
-    unsigned int i = (variable_hash) % MAX_VARIABLES;
-
-    while (h_hashes[i] != EMPTY_FLAG) {
-        if (h_hashes[i] == variable_hash) {
-            return i;
+    std::vector<Variable> slots;
+    slots.reserve(bucket_hashes.size());
+    for (VariableHash d = 0; d < MAX_DISPLACEMENT_ATTEMPTS; ++d) {
+        slots.clear();
+        for (const VariableHash &h : bucket_hashes) {
+            const Variable i = hashSlot(h, d);
+            if (occupied[i] || std::find(slots.begin(), slots.end(), i) != slots.end())
+                break;
+            slots.push_back(i);
         }
-        n += 1;
-        if (n >= MAX_VARIABLES) {
-            break;
+        if (slots.size() == bucket_hashes.size()) {
+            displacement = d;
+            return true;
         }
-        i += 1;
-        if (i >= MAX_VARIABLES) {
-            i = 0;
+    }
+    return false;
+}
+__host__ bool Curve::buildLayout(const std::vector<VariableHash> &variable_hashes, VariableHash *displacements) {
+    // Method is static, does not require mutex
+    if (variable_hashes.size() > static_cast<size_t>(MAX_VARIABLES))
+        return false;
+    std::vector<std::vector<VariableHash>> buckets(DISPLACEMENT_BUCKETS);
+    for (const VariableHash &h : variable_hashes) {
+        buckets[hashBucket(h)].push_back(h);
+    }
+    // Place the largest buckets first, whilst the table is emptiest
+    std::vector<unsigned int> order(DISPLACEMENT_BUCKETS);
+    for (unsigned int b = 0; b < DISPLACEMENT_BUCKETS; ++b) {
+        order[b] = b;
+        displacements[b] = 0;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](const unsigned int &a, const unsigned int &b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+    std::vector<bool> occupied(MAX_VARIABLES, false);
+    for (const unsigned int &b : order) {
+        if (buckets[b].empty())
+            break;
+        if (!findDisplacement(buckets[b], occupied, displacements[b]))
+            return false;
+        for (const VariableHash &h : buckets[b]) {
+            occupied[hashSlot(h, displacements[b])] = true;
         }
     }
+    return true;
+}
+
+__host__ Curve::Variable Curve::getVariableHandle(VariableHash variable_hash) {
+    // Do not lock mutex here, do it in the calling method
+    const auto f = h_slots.find(variable_hash);
+    if (f != h_slots.end() && h_hashes[f->second] == variable_hash) {
+        return f->second;
+    }
     return UNKNOWN_VARIABLE;
 }
 
@@ -117,19 +168,18 @@ __host__ Curve::Variable Curve::registerVariableByHash(VariableHash variable_has
 }
 __host__ Curve::Variable Curve::_registerVariableByHash(VariableHash variable_hash, void * d_ptr, size_t size, unsigned int length) {
     // Do not lock mutex here, do it in the calling method
-    unsigned int n = 0;
     assert(variable_hash != EMPTY_FLAG);
     assert(variable_hash != DELETED_FLAG);
-    unsigned int i = (variable_hash) % MAX_VARIABLES;
-    while (h_hashes[i] != EMPTY_FLAG && h_hashes[i] != DELETED_FLAG) {
-        n += 1;
-        if (n >= MAX_VARIABLES) {
+    Variable i = UNKNOWN_VARIABLE;
+    const auto f = h_slots.find(variable_hash);
+    if (f != h_slots.end()) {
+        // Registered before, so reuse it's slot, the layout is unchanged
+        i = f->second;
+    } else {
+        i = _addToLayout(variable_hash);
+        if (i == UNKNOWN_VARIABLE) {
             return UNKNOWN_VARIABLE;
         }
-        i += 1;
-        if (i >= MAX_VARIABLES) {
-            i = 0;
-        }
     }
 
     h_hashes[i] = variable_hash;
@@ -145,6 +195,81 @@ __host__ Curve::Variable Curve::_registerVariableByHash(VariableHash variable_ha
 
     return i;
 }
+__host__ Curve::Variable Curve::_addToLayout(VariableHash variable_hash) {
+    // Do not lock mutex here, do it in the calling method
+    const unsigned int bucket = hashBucket(variable_hash);
+    if (h_slots.size() < static_cast<size_t>(MAX_VARIABLES)) {
+        // Attempt to place the bucket again, leaving the slots of other buckets untouched
+        std::vector<VariableHash> bucket_hashes = { variable_hash };
+        std::vector<bool> occupied(MAX_VARIABLES, false);
+        for (const auto &s : h_slots) {
+            if (hashBucket(s.first) == bucket) {
+                bucket_hashes.push_back(s.first);
+            } else {
+                occupied[s.second] = true;
+            }
+        }
+        VariableHash displacement = 0;
+        if (findDisplacement(bucket_hashes, occupied, displacement)) {
+            std::unordered_map<VariableHash, unsigned int> slots = h_slots;
+            for (const VariableHash &h : bucket_hashes) {
+                slots[h] = hashSlot(h, displacement);
+            }
+            h_displacements[bucket] = displacement;
+            _relocate(slots);
+            return slots.at(variable_hash);
+        }
+    }
+    // Recompute the whole layout, discarding slots retained by unregistered variables
+    std::vector<VariableHash> hashes = { variable_hash };
+    for (const auto &s : h_slots) {
+        if (h_hashes[s.second] == s.first) {
+            hashes.push_back(s.first);
+        }
+    }
+    VariableHash displacements[DISPLACEMENT_BUCKETS];
+    if (!buildLayout(hashes, displacements)) {
+        return UNKNOWN_VARIABLE;
+    }
+    std::unordered_map<VariableHash, unsigned int> slots;
+    for (const VariableHash &h : hashes) {
+        slots.emplace(h, hashSlot(h, displacements[hashBucket(h)]));
+    }
+    memcpy(h_displacements, displacements, sizeof(VariableHash) * DISPLACEMENT_BUCKETS);
+    _relocate(slots);
+    return slots.at(variable_hash);
+}
+__host__ void Curve::_relocate(const std::unordered_map<VariableHash, unsigned int> &slots) {
+    // Do not lock mutex here, do it in the calling method
+    struct Entry {
+        VariableHash hash;
+        void *d_ptr;
+        size_t size;
+        unsigned int length;
+    };
+    // Copy out the moved variables, as their old and new slots may overlap
+    std::vector<std::pair<unsigned int, Entry>> moved;
+    for (const auto &s : h_slots) {
+        const auto f = slots.find(s.first);
+        if (f == slots.end() || f->second != s.second) {
+            if (f != slots.end()) {
+                moved.push_back({f->second, Entry{h_hashes[s.second], h_d_variables[s.second], h_sizes[s.second], h_lengths[s.second]}});
+            }
+            h_hashes[s.second] = EMPTY_FLAG;
+            h_d_variables[s.second] = nullptr;
+            h_sizes[s.second] = 0;
+            h_lengths[s.second] = 0;
+        }
+    }
+    for (const auto &m : moved) {
+        h_hashes[m.first] = m.second.hash;
+        h_d_variables[m.first] = m.second.d_ptr;
+        h_sizes[m.first] = m.second.size;
+        h_lengths[m.first] = m.second.length;
+    }
+    // New variables have no previous slot, so the caller will fill it
+    h_slots = slots;
+}
 __host__ int Curve::size() const {
     auto lock = std::shared_lock<std::shared_timed_mutex>(mutex);
     return _size();
@@ -157,9 +282,6 @@ __host__ int Curve::_size() const {
     }
     return rtn;
 }
-/**
- * TODO: Does un-registering imply that other variable with collisions will no longer be found. I.e. do you need to re-register all other variable when one is removed.
- */
 __host__ void Curve::unregisterVariableByHash(VariableHash variable_hash) {
     auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
     _unregisterVariableByHash(variable_hash);
@@ -174,7 +296,7 @@ __host__ void Curve::_unregisterVariableByHash(VariableHash variable_hash) {
         THROW exception::CurveException("Cannot unregister '%u', hash not found within curve table.", variable_hash);
     }
 
-    // clear hash location on host and copy hash to device
+    // clear hash location on host, the slot is retained within the layout in case it is registered again
     h_hashes[cv] = DELETED_FLAG;
 
     // set a host pointer to nullptr and copy to the device
@@ -192,6 +314,7 @@ __host__ void Curve::updateDevice() {
     // Initialise the device (if required)
     assert(deviceInitialised);  // No reason for this to ever fail. Purge calls init device
     // Copy
+    gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_displacements, h_displacements, sizeof(VariableHash) * DISPLACEMENT_BUCKETS));
     gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_hashes, h_hashes, sizeof(unsigned int) * MAX_VARIABLES));
     gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_variables, h_d_variables, sizeof(void*) * MAX_VARIABLES));
     gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_sizes, h_sizes, sizeof(size_t) * MAX_VARIABLES));
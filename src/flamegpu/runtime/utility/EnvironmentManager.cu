@@ -1,7 +1,11 @@
 #include "flamegpu/runtime/utility/EnvironmentManager.cuh"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
 #include "flamegpu/runtime/utility/DeviceEnvironment.cuh"
@@ -27,9 +31,7 @@ const char EnvironmentManager::CURVE_NAMESPACE_STRING[23] = "ENVIRONMENT_PROPERT
 
 EnvironmentManager::EnvironmentManager() :
     CURVE_NAMESPACE_HASH(detail::curve::Curve::variableRuntimeHash(CURVE_NAMESPACE_STRING)),
-    nextFree(0),
-    m_freeSpace(EnvironmentManager::MAX_BUFFER_SIZE),
-    freeFragments(),
+    c_segments(MAX_BUFFER_SIZE),
     deviceInitialised(false) { }
 
 void EnvironmentManager::purge() {
@@ -37,92 +39,59 @@ void EnvironmentManager::purge() {
     std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
     deviceInitialised = false;
     for (auto &a : deviceRequiresUpdate) {
-        a.second.c_update_required = true;
         a.second.rtc_update_required = true;
         a.second.curve_registration_required = true;
     }
     deviceRequiresUpdate_lock.unlock();
-    // We are now able to only purge the device stuff after device reset?
-    // freeFragments.clear();
-    // m_freeSpace = EnvironmentManager::MAX_BUFFER_SIZE;
-    // nextFree = 0;
-    // cuda_agent_models.clear();
-    // properties.clear();
-    // mapped_properties.clear();
-    // rtc_caches.clear();
     initialiseDevice();
-}
-
-void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Error if reinit
-    for (auto &&i : properties) {
-        if (i.first.first == instance_id) {
-            THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
-                "in EnvironmentManager::init().",
-                instance_id);
+    // Device allocations were lost by the reset, so reallocate the overflow buffers and reupload everything
+    for (auto &seg : segments) {
+        seg.second->d_overflow = nullptr;
+        seg.second->d_overflow_capacity = 0;
+        seg.second->c_dirty.mark(0, seg.second->hc_buffer.size());
+        seg.second->overflow_dirty.mark(0, seg.second->h_overflow.size());
+        if (allocateOverflow(*seg.second)) {
+            // Curve registration is already pending, so only the rtc cache requires the new pointers
+            for (auto &p : properties) {
+                if (p.first.first == seg.first && p.second.overflow) {
+                    writeRTCValue(*rtc_caches.at(seg.first), p.first);
+                }
+            }
         }
     }
+}
 
-    // Add to device requires update map
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    deviceRequiresUpdate.emplace(instance_id, EnvUpdateFlags());
-    deviceRequiresUpdate_lock.unlock();
-
-    // Build a DefragMap to send to defragger method
-    DefragMap orderedProperties;
-    size_t newSize = 0;
-    for (auto _i = desc.properties.begin(); _i != desc.properties.end(); ++_i) {
-        const auto &i = _i->second;
-        NamePair name = toName(instance_id, _i->first);
-        DefragProp prop = DefragProp(i.data.ptr, i.data.length, i.isConst, i.data.elements, i.data.type);
-        const size_t typeSize = i.data.length / i.data.elements;
-        orderedProperties.emplace(std::make_pair(typeSize, name), prop);
-        newSize += i.data.length;
-    }
-    if (newSize > m_freeSpace) {
-        // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-        // Arguably this check should be performed by init()
-        THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties,"
-            "in EnvironmentManager::init().");
-    }
-    // Defragment to rebuild it properly
-    defragment(detail::curve::Curve::getInstance(), &orderedProperties, {}, isPureRTC);
-    // Setup RTC version
-    buildRTCOffsets(instance_id, instance_id, orderedProperties);
+void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc) {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    initSegment(instance_id, instance_id, desc, nullptr);
 }
-void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int &master_instance_id, const SubEnvironmentData &mapping) {
+void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc, const unsigned int &master_instance_id, const SubEnvironmentData &mapping) {
     assert(deviceRequiresUpdate.size());  // submodel init should never be called first, requires parent init first for mapping
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-
-    // Add to device requires update map
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    deviceRequiresUpdate.emplace(instance_id, EnvUpdateFlags());
-    deviceRequiresUpdate_lock.unlock();
-
+    initSegment(instance_id, master_instance_id, desc, &mapping);
+}
+void EnvironmentManager::initSegment(const unsigned int &instance_id, const unsigned int &master_instance_id, const EnvironmentDescription &desc, const SubEnvironmentData *mapping) {
+    // Do not lock mutex here, do it in the calling method
     // Error if reinit
-    for (auto &&i : properties) {
-        if (i.first.first == instance_id) {
-            THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
-                "in EnvironmentManager::init().",
-                instance_id);
-        }
+    if (segments.find(instance_id) != segments.end()) {
+        THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
+            "in EnvironmentManager::init().",
+            instance_id);
     }
-
-    // Build a DefragMap of to send to defragger method
-    DefragMap orderedProperties;
-    size_t newSize = 0;
-    std::set<NamePair> new_mapped_props;
-    for (auto _i = desc.properties.begin(); _i != desc.properties.end(); ++_i) {
-        auto prop_mapping = mapping.properties.find(_i->first);
-        const auto &i = _i->second;
-        NamePair name = toName(instance_id, _i->first);
-        if (prop_mapping == mapping.properties.end()) {
-            // Property is not mapped, so add to defrag map
-            DefragProp prop = DefragProp(i.data.ptr, i.data.length, i.isConst, i.data.elements, i.data.type);
-            const size_t typeSize = i.data.length / i.data.elements;
-            orderedProperties.emplace(std::make_pair(typeSize, name), prop);
-            newSize += i.data.length;
+    // Add to device requires update map
+    {
+        std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
+        deviceRequiresUpdate.emplace(instance_id, EnvUpdateFlags());
+    }
+    // Sort the unmapped properties by decreasing type size (and name, for a deterministic layout)
+    // This creates natural alignment when they are packed
+    std::vector<std::pair<size_t, NamePair>> ordered;
+    std::vector<NamePair> new_mapped_props;
+    for (const auto &_i : desc.properties) {
+        const NamePair name = toName(instance_id, _i.first);
+        const auto prop_mapping = mapping ? mapping->properties.find(_i.first) : SubEnvironmentData::Mapping::const_iterator();
+        if (!mapping || prop_mapping == mapping->properties.end()) {
+            ordered.emplace_back(_i.second.data.length / _i.second.data.elements, name);
         } else {
             // Property is mapped, follow it's mapping upwards until we find the highest parent
             NamePair ultimateParent = toName(master_instance_id, prop_mapping->second);
@@ -132,21 +101,52 @@ void EnvironmentManager::init(const unsigned int &instance_id, const Environment
                 propFind = mapped_properties.find(ultimateParent);
             }
             // Add to mapping list
-            MappedProp mp = MappedProp(ultimateParent, i.isConst);
-            mapped_properties.emplace(name, mp);
-            new_mapped_props.emplace(name);
+            mapped_properties.emplace(name, MappedProp(ultimateParent, _i.second.isConst));
+            new_mapped_props.push_back(name);
         }
     }
-    if (newSize > m_freeSpace) {
-        // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-        // Arguably this check should be performed by init()
-        THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties,"
-            "in EnvironmentManager::init().");
+    std::sort(ordered.begin(), ordered.end(), [](const std::pair<size_t, NamePair> &a, const std::pair<size_t, NamePair> &b) {
+        return a.first != b.first ? a.first > b.first : a.second.second < b.second.second;
+    });
+    // Reserve a segment large enough for all properties small enough to be stored in the constant buffer
+    size_t constantSize = 0;
+    for (const auto &o : ordered) {
+        const size_t len = desc.properties.at(o.second.second).data.length;
+        if (len <= MAX_CONSTANT_PROPERTY_SIZE) {
+            constantSize += len;
+        }
+    }
+    constantSize = (constantSize + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+    const OffsetLen region = reserveSegment(constantSize);
+    std::unique_ptr<EnvSegment> segment = std::unique_ptr<EnvSegment>(new EnvSegment());
+    segment->c_offset = std::get<OFFSET>(region);
+    segment->hc_buffer.resize(std::get<LEN>(region));
+    segment->c_allocator = util::detail::FreeListAllocator(std::get<LEN>(region));
+    segment->master_instance_id = master_instance_id;
+    // Store the properties
+    std::vector<NamePair> orderedNames;
+    for (const auto &o : ordered) {
+        const auto &i = desc.properties.at(o.second.second);
+        bool overflow = false;
+        const ptrdiff_t offset = storeProperty(*segment, static_cast<const char*>(i.data.ptr), i.data.length, o.first, overflow);
+        properties.emplace(o.second, EnvProp(offset, i.data.length, i.isConst, i.data.elements, i.data.type, overflow));
+        orderedNames.push_back(o.second);
+    }
+    allocateOverflow(*segment);
+    segments.emplace(instance_id, std::move(segment));
+    // Register the properties with curve
+    {
+        auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
+        auto &curve = detail::curve::Curve::getInstance();
+        for (const auto &name : orderedNames) {
+            registerCurveVariable(curve, name, name);
+        }
+        for (const auto &name : new_mapped_props) {
+            registerCurveVariable(curve, name, mapped_properties.at(name).masterProp);
+        }
     }
-    // Defragment to rebuild it properly
-    defragment(detail::curve::Curve::getInstance(), &orderedProperties, new_mapped_props, isPureRTC);
     // Setup RTC version
-    buildRTCOffsets(instance_id, master_instance_id, orderedProperties);
+    buildRTCOffsets(instance_id, master_instance_id, orderedNames);
 }
 
 void EnvironmentManager::initRTC(const CUDASimulation& cudaSimulation) {
@@ -173,32 +173,44 @@ void EnvironmentManager::initialiseDevice() {
 }
 void EnvironmentManager::free(detail::curve::Curve &curve, const unsigned int &instance_id) {
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Release regular properties
-    for (auto &&i = properties.begin(); i != properties.end();) {
-        if (i->first.first == instance_id) {
-            // Release from CURVE
-            detail::curve::Curve::VariableHash cvh = toHash(i->first);
-            curve.unregisterVariableByHash(cvh);
-            // Drop from properties map
-            i = properties.erase(i);
-        } else {
-            ++i;
+    {
+        auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
+        // Release regular properties
+        for (auto &&i = properties.begin(); i != properties.end();) {
+            if (i->first.first == instance_id) {
+                // Release from CURVE
+                detail::curve::Curve::VariableHash cvh = toHash(i->first);
+                curve.unregisterVariableByHash(cvh);
+                // Drop from properties map
+                i = properties.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        // Release mapped properties
+        for (auto &&i = mapped_properties.begin(); i != mapped_properties.end();) {
+            if (i->first.first == instance_id) {
+                // Release from CURVE
+                detail::curve::Curve::VariableHash cvh = toHash(i->first);
+                curve.unregisterVariableByHash(cvh);
+                // Drop from properties map
+                i = mapped_properties.erase(i);
+            } else {
+                ++i;
+            }
         }
     }
-    // Release mapped properties
-    for (auto &&i = mapped_properties.begin(); i != mapped_properties.end();) {
-        if (i->first.first == instance_id) {
-            // Release from CURVE
-            detail::curve::Curve::VariableHash cvh = toHash(i->first);
-            curve.unregisterVariableByHash(cvh);
-            // Drop from properties map
-            i = mapped_properties.erase(i);
-        } else {
-            ++i;
+    // Release the instance's segment, other instances are unaffected
+    auto seg = segments.find(instance_id);
+    if (seg != segments.end()) {
+        if (seg->second->d_overflow) {
+            gpuErrchk(cudaFree(seg->second->d_overflow));
         }
+        if (!seg->second->hc_buffer.empty()) {
+            c_segments.deallocate(seg->second->c_offset, seg->second->hc_buffer.size());
+        }
+        segments.erase(seg);
     }
-    // Defragment to clear up all the buffer items we didn't handle here
-    defragment(curve);
     // Remove reference to cuda agent model used by RTC
     // This may not exist if the CUDAgent model has not been created (e.g. some tests which do not run the model)
     auto cam = cuda_agent_models.find(instance_id);
@@ -220,6 +232,42 @@ void EnvironmentManager::free(detail::curve::Curve &curve, const unsigned int &i
     }
 }
 
+EnvironmentManager::OffsetLen EnvironmentManager::reserveSegment(const size_t &len) {
+    // Do not lock mutex here, do it in the calling method
+    if (!len)
+        return OffsetLen(0, 0);
+    ptrdiff_t offset = c_segments.allocate(len, sizeof(void*));
+    if (offset != util::detail::FreeListAllocator::OUT_OF_SPACE)
+        return OffsetLen(offset, len);
+    // Otherwise reserve the largest region, properties which do not fit will overflow
+    const size_t largest = c_segments.getLargestFreeBlock() / sizeof(void*) * sizeof(void*);
+    if (largest) {
+        offset = c_segments.allocate(largest, sizeof(void*));
+        if (offset != util::detail::FreeListAllocator::OUT_OF_SPACE)
+            return OffsetLen(offset, largest);
+    }
+    // The constant buffer is full, all properties will overflow
+    return OffsetLen(0, 0);
+}
+ptrdiff_t EnvironmentManager::storeProperty(EnvSegment &segment, const char *ptr, const size_t &length, const size_t &typeSize, bool &overflow) {
+    // Do not lock mutex here, do it in the calling method
+    ptrdiff_t offset = util::detail::FreeListAllocator::OUT_OF_SPACE;
+    if (length <= MAX_CONSTANT_PROPERTY_SIZE) {
+        offset = segment.c_allocator.allocate(length, typeSize);
+    }
+    overflow = offset == util::detail::FreeListAllocator::OUT_OF_SPACE;
+    if (!overflow) {
+        memcpy(segment.hc_buffer.data() + offset, ptr, length);
+        segment.c_dirty.mark(offset, length);
+    } else {
+        // The overflow buffer has no fixed capacity, it grows as required
+        offset = segment.overflow_allocator.allocate(length, typeSize);
+        segment.h_overflow.resize(segment.overflow_allocator.getEnd());
+        memcpy(segment.h_overflow.data() + offset, ptr, length);
+        segment.overflow_dirty.mark(offset, length);
+    }
+    return offset;
+}
 EnvironmentManager::NamePair EnvironmentManager::toName(const unsigned int &instance_id, const std::string &var_name) {
     return std::make_pair(instance_id, var_name);
 }
@@ -236,266 +284,165 @@ void EnvironmentManager::newProperty(const NamePair &name, const char *ptr, cons
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
     assert(elements > 0);
     const size_t typeSize = (length / elements);
-    ptrdiff_t buffOffset = MAX_BUFFER_SIZE;
-    // Allocate buffer space, using a free fragment
-    for (auto it = freeFragments.begin(); it != freeFragments.end(); ++it) {
-        const ptrdiff_t alignmentOffset = std::get<OFFSET>(*it) % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (std::get<LEN>(*it) + alignmentFix <= length) {
-            // We can use this space!
-            buffOffset = std::get<OFFSET>(*it) + alignmentFix;
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(std::get<OFFSET>(*it), alignmentFix));
-            }
-            // Update nextFree
-            if (std::get<LEN>(*it) == length) {
-                // Remove
-                freeFragments.erase(it);
-            } else {
-                // Shrink
-                *it = { std::get<OFFSET>(*it) + length, std::get<LEN>(*it) - length };
-            }
-            break;
-        }
-    }
-    // Allocate buffer space, using nextFree
-    if (buffOffset == MAX_BUFFER_SIZE) {
-        const ptrdiff_t alignmentOffset = nextFree % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (nextFree + alignmentFix + length < MAX_BUFFER_SIZE) {
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(nextFree, alignmentFix));
-            }
-            // We can use this space!
-            nextFree += alignmentFix;
-            buffOffset = nextFree;
-            nextFree += length;
-        }
+    const auto seg = segments.find(name.first);
+    if (seg == segments.end()) {
+        THROW exception::UnknownInternalError("Instance with id '%u' has not been initialised, "
+            "in EnvironmentManager::add().", name.first);
+    }
+    EnvSegment &segment = *seg->second;
+    // Only this instance's segment is affected
+    std::unique_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+    bool overflow = false;
+    const ptrdiff_t offset = storeProperty(segment, ptr, length, typeSize, overflow);
+    // Add to properties
+    properties.emplace(name, EnvProp(offset, length, isConst, elements, type, overflow));
+    auto &curve = detail::curve::Curve::getInstance();
+    auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
+    const bool relocated = overflow && allocateOverflow(segment);
+    // Register in cuRVE, using the new overflow allocation if one was made
+    registerCurveVariable(curve, name, name);
+    addRTCOffset(name);
+    if (relocated) {
+        // Existing overflow properties have moved, the new property is now registered so can be treated the same
+        relocateOverflow(curve, name.first);
     }
-    if (buffOffset == MAX_BUFFER_SIZE) {  // buffOffset hasn't changed from init value
-        // defragment() and retry using nextFree
-        defragment(detail::curve::Curve::getInstance());
-        const ptrdiff_t alignmentOffset = nextFree % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (nextFree + alignmentFix + length < MAX_BUFFER_SIZE) {
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(nextFree, alignmentFix));
-            }
-            // We can use this space!
-            nextFree += alignmentFix;
-            buffOffset = nextFree;
-            nextFree += length;
-        } else {
-            // Ran out of constant cache space!
-            THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new property,"
-                "in EnvironmentManager::add().");
-        }
+}
+
+void *EnvironmentManager::getDeviceLocation(const NamePair &name) const {
+    // Do not lock mutex here, do it in the calling method
+    const EnvProp &prop = properties.at(name);
+    const EnvSegment &segment = *segments.at(name.first);
+    if (prop.overflow) {
+        return segment.d_overflow + prop.offset;
     }
-    // Update FreeSpace
-    m_freeSpace -= length;
-    // Add to properties
-    // printf("Constant '%s' created at offset: %llu, (%llu%%8), (%llu%%4)\n", name.c_str(), buffOffset, buffOffset % 8, buffOffset % 4);
-    properties.emplace(name, EnvProp(buffOffset, length, isConst, elements, type));
-    // Store data
-    memcpy(hc_buffer + buffOffset, ptr, length);
-    // Register in cuRVE
-    detail::curve::Curve::VariableHash cvh = toHash(name);
-    const auto CURVE_RESULT = detail::curve::Curve::getInstance().registerVariableByHash(cvh, reinterpret_cast<void*>(buffOffset), typeSize, elements);
+    return reinterpret_cast<void*>(segment.c_offset + prop.offset);
+}
+void EnvironmentManager::registerCurveVariable(detail::curve::Curve &curve, const NamePair &name, const NamePair &owner) {
+    // Do not lock mutex here, do it in the calling method
+    const EnvProp &prop = properties.at(owner);
+    const detail::curve::Curve::VariableHash cvh = toHash(name);
+    // Overflowed properties are flagged, so that the device knows the location is a pointer rather than an offset
+    const unsigned int length = prop.overflow ? prop.elements | OVERFLOW_LENGTH_FLAG : prop.elements;
+    const auto CURVE_RESULT = curve.registerVariableByHash(cvh, getDeviceLocation(owner), prop.length / prop.elements, length);
     if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-        THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE"
-            "in EnvironmentManager::add().");
+        THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
+            "in EnvironmentManager::registerCurveVariable().");
     }
-#ifdef _DEBUG
-    if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-        fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", name.second.c_str());
+}
+bool EnvironmentManager::allocateOverflow(EnvSegment &segment) {
+    // Do not lock mutex here, do it in the calling method
+    if (segment.h_overflow.size() <= segment.d_overflow_capacity)
+        return false;
+    if (segment.d_overflow) {
+        gpuErrchk(cudaFree(segment.d_overflow));
+    }
+    // Grow geometrically, so repeatedly adding properties does not repeatedly reallocate
+    segment.d_overflow_capacity = std::max(segment.h_overflow.size(), 2 * segment.d_overflow_capacity);
+    gpuErrchk(cudaMalloc(&segment.d_overflow, segment.d_overflow_capacity));
+    // The new allocation is uninitialised, so the whole buffer must be uploaded
+    segment.overflow_dirty.mark(0, segment.h_overflow.size());
+    return true;
+}
+void EnvironmentManager::relocateOverflow(detail::curve::Curve &curve, const unsigned int &instance_id) {
+    // Do not lock mutex here, do it in the calling method
+    for (const auto &p : properties) {
+        if (p.first.first == instance_id && p.second.overflow) {
+            curve.unregisterVariableByHash(toHash(p.first));
+            registerCurveVariable(curve, p.first, p.first);
+            writeRTCValue(*rtc_caches.at(instance_id), p.first);
+        }
+    }
+    for (const auto &mp : mapped_properties) {
+        if (mp.second.masterProp.first == instance_id && properties.at(mp.second.masterProp).overflow) {
+            curve.unregisterVariableByHash(toHash(mp.first));
+            registerCurveVariable(curve, mp.first, mp.second.masterProp);
+        }
     }
-#endif
-    addRTCOffset(name);
-    setDeviceRequiresUpdateFlag();
 }
 
-#ifdef _DEBUG
-void EnvironmentManager::defragment(detail::curve::Curve &curve, const DefragMap * mergeProperties, std::set<NamePair> newmaps, bool isPureRTC) {
-#else
-void EnvironmentManager::defragment(detail::curve::Curve & curve, const DefragMap * mergeProperties, std::set<NamePair> newmaps, bool) {
-#endif
+const EnvironmentManager::NamePair &EnvironmentManager::getOwner(const NamePair &name) const {
     // Do not lock mutex here, do it in the calling method
-    auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
-    // Build a multimap to sort the elements (to create natural alignment in compact form)
-    DefragMap orderedProperties;
-    for (auto &i : properties) {
-        size_t typeLen = i.second.length / i.second.elements;
-        orderedProperties.emplace(std::make_pair(typeLen, i.first), DefragProp(i.second));
-    }
-    // Include any merge elements
-    if (mergeProperties) {
-        orderedProperties.insert(mergeProperties->cbegin(), mergeProperties->cend());
-    }
-    // Lock device mutex here, as we begin to mess with curve
-    // Clear freefrags, so we can refill it with alignment junk
-    freeFragments.clear();
-    size_t spareFrags = 0;
-    // Rebuild properties map into temporary buffer
-    std::unordered_map<NamePair, EnvProp, NamePairHash> t_properties;
-    char t_buffer[MAX_BUFFER_SIZE];
-    ptrdiff_t buffOffset = 0;
-    // Iterate largest vars first
-    for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-        size_t typeSize = _i->first.first;
-        const NamePair &name = _i->first.second;
-        auto &i = _i->second;
+    const auto a = properties.find(name);
+    if (a != properties.end())
+        return a->first;
+    const auto b = mapped_properties.find(name);
+    if (b != mapped_properties.end())
+        return b->second.masterProp;
+    THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
+        "in EnvironmentManager::getOwner().",
+        name.first, name.second.c_str());
+}
+const char *EnvironmentManager::getHostPtr(const NamePair &name) const {
+    // Do not lock mutex here, do it in the calling method
+    const NamePair &owner = getOwner(name);
+    const EnvProp &prop = properties.at(owner);
+    const EnvSegment &segment = *segments.at(owner.first);
+    return (prop.overflow ? segment.h_overflow.data() : segment.hc_buffer.data()) + prop.offset;
+}
+void EnvironmentManager::writeProperty(const NamePair &name, const void *src, const size_t &offset, const size_t &len, void *old) {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    const NamePair &owner = getOwner(name);
+    const EnvProp &prop = properties.at(owner);
+    assert(offset + len <= prop.length);
+    // Only the segment which stores the property needs to be locked
+    EnvSegment &segment = *segments.at(owner.first);
+    std::unique_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+    char *ptr = (prop.overflow ? segment.h_overflow.data() : segment.hc_buffer.data()) + prop.offset + offset;
+    if (old)
+        memcpy(old, ptr, len);
+    memcpy(ptr, src, len);
+    // Only the modified bytes need to be uploaded
+    (prop.overflow ? segment.overflow_dirty : segment.c_dirty).mark(prop.offset + offset, len);
+    // Do rtc too
+    updateRTCValue(name);
+}
+void EnvironmentManager::readProperty(const NamePair &name, void *dst, const size_t &offset, const size_t &len) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    const NamePair &owner = getOwner(name);
+    assert(offset + len <= properties.at(owner).length);
+    const EnvSegment &segment = *segments.at(owner.first);
+    std::shared_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+    memcpy(dst, getHostPtr(owner) + offset, len);
+}
+
+void EnvironmentManager::buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const std::vector<NamePair> &orderedProperties) {
+    // Do not lock mutex here, do it in the calling method
+    // Submodels append their properties to the master's cache, masters create a new cache
+    std::shared_ptr<RTCEnvPropCache> cache = instance_id == master_instance_id ? std::make_shared<RTCEnvPropCache>() : rtc_caches.at(master_instance_id);
+    // Add the properties, they are already ordered so we can just enforce alignment
+    // As we add each property, set its rtc_offset value in main properties map
+    for (const auto &name : orderedProperties) {
+        auto &p = properties.at(name);
+        // Overflowed properties are represented by a pointer to their data
+        const size_t alignmentSize = p.overflow ? sizeof(void*) : p.length / p.elements;
+        const size_t length = p.overflow ? sizeof(void*) : p.length;
         // Handle alignment
-        const ptrdiff_t alignmentOffset = buffOffset % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (alignmentOffset != 0) {
-            freeFragments.push_back(OffsetLen(buffOffset, alignmentFix));
-            buffOffset += alignmentFix;
-            spareFrags += alignmentFix;
-        }
-        if (buffOffset + i.length <= MAX_BUFFER_SIZE) {
+        const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
+        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
+        cache->nextFree += alignmentFix;
+        if (cache->nextFree + length <= MAX_BUFFER_SIZE) {
             // Setup constant in new position
-            memcpy(t_buffer + buffOffset, i.data, i.length);
-            t_properties.emplace(name, EnvProp(buffOffset, i.length, i.isConst, i.elements, i.type, i.rtc_offset));
-            // Update cuRVE (There isn't an update, so unregister and reregister)  // TODO: curveGetVariableHandle()?
-            detail::curve::Curve::VariableHash cvh = toHash(name);
-            // Only unregister variable if it's already registered
-            if (!mergeProperties) {  // Merge properties are only provided on 1st init, when vars can't be unregistered
-                curve.unregisterVariableByHash(cvh);
-            } else {
-                // Can this var be found inside mergeProps
-                auto range = mergeProperties->equal_range(_i->first);
-                bool isFound = false;
-                for (auto w = range.first; w != range.second; ++w) {
-                    if (w->first.second == name) {
-                        isFound = true;
-                        break;
-                    }
-                }
-                if (!isFound) {
-                    curve.unregisterVariableByHash(cvh);
-                }
-            }
-            const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(buffOffset),
-                typeSize, i.elements);
-            if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                    "in EnvironmentManager::defragment().");
-            }
-#ifdef _DEBUG
-            if (!isPureRTC && CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", name.second.c_str());
-            }
-#endif
+            p.rtc_offset = cache->nextFree;
+            writeRTCValue(*cache, name);
             // Increase buffer offset length that has been added
-            buffOffset += i.length;
+            cache->nextFree += length;
         } else {
-            // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-            // Arguably this check should be performed by init()
+            // Ran out of constant cache space!
             THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                "in EnvironmentManager::defragment().");
-        }
-    }
-    // Replace stored properties with temp
-    std::swap(properties, t_properties);
-    // Replace buffer on host
-    memcpy(hc_buffer, t_buffer, buffOffset);
-    // Update m_freeSpace, nextFree
-    nextFree = buffOffset;
-    m_freeSpace = MAX_BUFFER_SIZE - buffOffset + spareFrags;
-    // Update cub for any mapped properties
-    for (auto &mp : mapped_properties) {
-        // Generate hash for the subproperty name
-        detail::curve::Curve::VariableHash cvh = toHash(mp.first);
-        // Unregister the property if it's already been registered
-        if (newmaps.find(mp.first) == newmaps.end()) {
-            curve.unregisterVariableByHash(cvh);
-        }
-        // Find the location of the mappedproperty
-        auto masterprop = properties.at(mp.second.masterProp);
-        // Create the mapping
-        const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(masterprop.offset),
-                masterprop.length / masterprop.elements, masterprop.elements);
-        if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-            THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                "in EnvironmentManager::defragment().");
-        }
-#ifdef _DEBUG
-        if (!isPureRTC && CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-            fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", mp.first.second.c_str());
+                "in EnvironmentManager::buildRTCOffsets().");
         }
-#endif
     }
-    setDeviceRequiresUpdateFlag();
+    // Cache is complete, add it to cache map
+    rtc_caches.emplace(instance_id, cache);
 }
-
-void EnvironmentManager::buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const DefragMap &orderedProperties) {
+void EnvironmentManager::writeRTCValue(RTCEnvPropCache &cache, const NamePair &name) {
     // Do not lock mutex here, do it in the calling method
-    // Actually begin
-    if (instance_id == master_instance_id) {
-        // Create a new cache
-        std::shared_ptr<RTCEnvPropCache> cache = std::make_shared<RTCEnvPropCache>();
-        // Add the properties, they are already ordered so we can just enforce alignment
-        // As we add each property, set its rtc_offset value in main properties map
-        for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-            auto &i = _i->second;
-            size_t alignmentSize = _i->first.first;
-            const NamePair &name = _i->first.second;
-            // Handle alignment
-            const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
-            const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
-            cache->nextFree += alignmentFix;
-            if (cache->nextFree + i.length <= MAX_BUFFER_SIZE) {
-                // Setup constant in new position
-                memcpy(cache->hc_buffer + cache->nextFree, i.data, i.length);
-                properties.at(name).rtc_offset = cache->nextFree;
-                // Increase buffer offset length that has been added
-                cache->nextFree += i.length;
-            } else {
-                // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-                // Arguably this check should be performed by init()
-                // This should never happen, it would be caught by defrag sooner
-                THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                    "in EnvironmentManager::buildRTCOffsets().");
-            }
-        }
-        // Cache is complete, add it to cache map
-        rtc_caches.emplace(instance_id, cache);
+    const EnvProp &p = properties.at(name);
+    if (p.overflow) {
+        const void *d_ptr = getDeviceLocation(name);
+        memcpy(cache.hc_buffer + p.rtc_offset, &d_ptr, sizeof(void*));
     } else {
-        // Find the master cache
-        std::shared_ptr<RTCEnvPropCache> &cache = rtc_caches.at(master_instance_id);
-        // Add the properties, they are already ordered so we can just enforce alignment
-        // As we add each property, set its rtc_offset value in main properties map
-        for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-            const NamePair &name = _i->first.second;
-            auto &i = _i->second;
-            auto mi_it = mapped_properties.find(name);
-            if (mi_it ==  mapped_properties.end()) {
-                // Property is not mapped, add it to cache
-                size_t alignmentSize = _i->first.first;
-                // Handle alignment
-                const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
-                const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
-                cache->nextFree += alignmentFix;
-                if (cache->nextFree + i.length <= MAX_BUFFER_SIZE) {
-                    // Setup constant in new position
-                    memcpy(cache->hc_buffer + cache->nextFree, i.data, i.length);
-                    properties.at(name).rtc_offset = cache->nextFree;
-                    // Increase buffer offset length that has been added
-                    cache->nextFree += i.length;
-                } else {
-                    // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-                    // Arguably this check should be performed by init()
-                    // This should never happen, it would be caught by defrag sooner
-                    THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                        "in EnvironmentManager::buildRTCOffsets().");
-                }
-            }
-        }
-        // Add a copy of cache for this instance_id to env manager
-        rtc_caches.emplace(instance_id, cache);
+        memcpy(cache.hc_buffer + p.rtc_offset, getHostPtr(name), p.length);
     }
 }
 char * EnvironmentManager::getRTCCache(const unsigned int& instance_id) {
@@ -511,17 +458,18 @@ void EnvironmentManager::addRTCOffset(const NamePair &name) {
     if (mi_it ==  mapped_properties.end()) {
         auto &cache = rtc_caches.at(name.first);
         auto &p = properties.at(name);
-        size_t alignmentSize = p.length > 64 ? 64 : p.length;  // This creates better alignment for small vectors
+        const size_t length = p.overflow ? sizeof(void*) : p.length;
+        size_t alignmentSize = length > 64 ? 64 : length;  // This creates better alignment for small vectors
         // Handle alignment
         const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
         const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
         cache->nextFree += alignmentFix;
-        if (cache->nextFree + p.length <= MAX_BUFFER_SIZE) {
+        if (cache->nextFree + length <= MAX_BUFFER_SIZE) {
             // Setup constant in new position
-            memcpy(cache->hc_buffer + cache->nextFree, hc_buffer + p.offset, p.length);
             p.rtc_offset = cache->nextFree;
+            writeRTCValue(*cache, name);
             // Increase buffer offset length that has been added
-            cache->nextFree += p.length;
+            cache->nextFree += length;
         } else {
             THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
                 "in EnvironmentManager::buildRTCOffsets().");
@@ -544,29 +492,25 @@ const CUDASimulation& EnvironmentManager::getCUDASimulation(const unsigned int &
 void EnvironmentManager::updateRTCValue(const NamePair &name) {
     // Don't lock mutex here, lock it in the calling function
     // Grab the updated prop
-    auto a = properties.find(name);
-    if (a == properties.end()) {
-        a = properties.find(mapped_properties.at(name).masterProp);
-    }
-    // Grab the main cache ptr for the prop
-    void *main_ptr = hc_buffer + a->second.offset;
-    // Grab the rtc cache ptr for the prop
-    void *rtc_ptr = rtc_caches.at(name.first)->hc_buffer + a->second.rtc_offset;
-    // Copy
-    memcpy(rtc_ptr, main_ptr, a->second.length);
+    const NamePair &owner = getOwner(name);
+    const EnvProp &p = properties.at(owner);
+    // Properties stored in global memory, are represented in the rtc cache by a pointer which doesn't change
+    if (!p.overflow) {
+        // Grab the rtc cache ptr for the prop
+        void *rtc_ptr = rtc_caches.at(name.first)->hc_buffer + p.rtc_offset;
+        // Copy
+        memcpy(rtc_ptr, getHostPtr(owner), p.length);
+    }
 
     // Now we must detect if the variable is mapped in any form
     // If this is the case, any rtc models which share the property must be flagged for update too
     {
         std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-        // First check if it's the subvar
-        auto mp_it = mapped_properties.find(name);
-        const NamePair check = mp_it == mapped_properties.end() ? name : mp_it->second.masterProp;
         // Now check for any properties mapped to this variable
         for (auto mp : mapped_properties) {
-            if (mp.second.masterProp == check) {
+            if (mp.second.masterProp == owner) {
                 // It's a hit, set flag to true
-                deviceRequiresUpdate.at(check.first).rtc_update_required = true;
+                deviceRequiresUpdate.at(owner.first).rtc_update_required = true;
             }
         }
         deviceRequiresUpdate_lock.unlock();
@@ -575,87 +519,92 @@ void EnvironmentManager::updateRTCValue(const NamePair &name) {
 
 void EnvironmentManager::removeProperty(const NamePair &name) {
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Unregister in cuRVE
-    detail::curve::Curve::VariableHash cvh = toHash(name);
-    detail::curve::Curve::getInstance().unregisterVariableByHash(cvh);
-    // Update free space
+    {
+        // Unregister in cuRVE
+        auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
+        detail::curve::Curve::VariableHash cvh = toHash(name);
+        detail::curve::Curve::getInstance().unregisterVariableByHash(cvh);
+    }
     // Remove from properties map
     auto realprop = properties.find(name);
     if (realprop!= properties.end()) {
-        auto i = realprop->second;
-        // Cast is safe, length would need to be gigabytes, we only have 64KB constant cache
-        if (i.offset + static_cast<uint32_t>(i.length) == nextFree) {
-            // Rollback nextFree
-            nextFree = i.offset;
+        // Return the property's storage to it's segment
+        const auto &i = realprop->second;
+        EnvSegment &segment = *segments.at(name.first);
+        std::unique_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+        if (i.overflow) {
+            segment.overflow_allocator.deallocate(i.offset, i.length);
+            segment.h_overflow.resize(segment.overflow_allocator.getEnd());
         } else {
-            // Notify free fragments
-            freeFragments.push_back(OffsetLen(i.offset, i.length));
+            segment.c_allocator.deallocate(i.offset, i.length);
         }
-        m_freeSpace += i.length;
         // Purge properties
-        properties.erase(name);
+        properties.erase(realprop);
     } else {
         mapped_properties.erase(name);
     }
-    setDeviceRequiresUpdateFlag(name.first);
 }
 void EnvironmentManager::removeProperty(const unsigned int &instance_id, const std::string &var_name) {
     removeProperty({instance_id, var_name});
 }
 
 void EnvironmentManager::resetModel(const unsigned int &instance_id, const EnvironmentDescription &desc) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    EnvSegment &segment = *segments.at(instance_id);
+    std::unique_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
     // Todo: Might want to change this, so EnvManager holds a copy of the default at init time
     // For every property, in the named model, which is not a mapped property
     for (auto &d : desc.getPropertiesMap()) {
         if (mapped_properties.find({instance_id, d.first}) == mapped_properties.end()) {
             // Find the local property data
-            auto &p = properties.at({instance_id, d.first});
-            // Set back to default value
-            memcpy(hc_buffer + p.offset, d.second.data.ptr, d.second.data.length);
-            // Do rtc too
-            void *rtc_ptr = rtc_caches.at(instance_id)->hc_buffer + p.rtc_offset;
-            memcpy(rtc_ptr, d.second.data.ptr, d.second.data.length);
+            const NamePair name = toName(instance_id, d.first);
+            auto &p = properties.at(name);
             assert(d.second.data.length == p.length);
+            // Set back to default value
+            memcpy(const_cast<char*>(getHostPtr(name)), d.second.data.ptr, d.second.data.length);
+            if (p.overflow) {
+                segment.overflow_dirty.mark(p.offset, p.length);
+            } else {
+                segment.c_dirty.mark(p.offset, p.length);
+                // Do rtc too
+                void *rtc_ptr = rtc_caches.at(instance_id)->hc_buffer + p.rtc_offset;
+                memcpy(rtc_ptr, d.second.data.ptr, d.second.data.length);
+            }
         }
     }
-    setDeviceRequiresUpdateFlag(instance_id);
 }
-void EnvironmentManager::setDeviceRequiresUpdateFlag(const unsigned int &instance_id) {
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    // Don't lock mutex here, lock it in the calling function
-    // Increment host version
-    if (instance_id == UINT_MAX) {
-        // Set required version for all, we have defragged
-        for (auto &a : deviceRequiresUpdate) {
-            a.second.c_update_required = true;
-            a.second.rtc_update_required = true;
-        }
-    } else {
-        // Set individual
-        auto &flags = deviceRequiresUpdate.at(instance_id);
-        flags.c_update_required = true;
-        flags.rtc_update_required = true;
+size_t EnvironmentManager::getPropertiesSize(const unsigned int &instance_id) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    size_t rtn = 0;
+    for (const auto &p : properties) {
+        if (p.first.first == instance_id)
+            rtn += p.second.length;
     }
+    return rtn;
 }
 void EnvironmentManager::updateDevice(const unsigned int &instance_id) {
     // Lock shared mutex of mutex in calling method first!!!
     // Device must be init first
     assert(deviceInitialised);
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
     NVTX_RANGE("EnvironmentManager::updateDevice()");
+    // Update the instance's segment, and those of it's parents which store it's mapped properties
+    UploadCounters uploaded;
+    unsigned int segment_id = instance_id;
+    while (true) {
+        EnvSegment &segment = *segments.at(segment_id);
+        std::unique_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+        uploadRanges(segment.c_dirty, reinterpret_cast<char*>(const_cast<char*>(c_buffer + segment.c_offset)), segment.hc_buffer, uploaded);
+        uploadRanges(segment.overflow_dirty, segment.d_overflow, segment.h_overflow, uploaded);
+        if (segment.master_instance_id == segment_id)
+            break;
+        segment_id = segment.master_instance_id;
+    }
+    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
     auto &flags = deviceRequiresUpdate.at(instance_id);
-    auto &c_update_required = flags.c_update_required;
+    flags.uploads.bytes += uploaded.bytes;
+    flags.uploads.uploads += uploaded.uploads;
     auto &rtc_update_required = flags.rtc_update_required;
     auto &curve_registration_required = flags.curve_registration_required;
-    if (c_update_required) {
-        // Store data
-        gpuErrchk(cudaMemcpy(reinterpret_cast<void*>(const_cast<char*>(c_buffer)), reinterpret_cast<void*>(const_cast<char*>(hc_buffer)), MAX_BUFFER_SIZE, cudaMemcpyHostToDevice));
-        // Update C update flag for all instances
-        for (auto &a : deviceRequiresUpdate) {
-            a.second.c_update_required = false;
-        }
-    }
     if (rtc_update_required) {
         // RTC is nolonger updated here, it's always updated before the CurveRTCHost is pushed to device.
         // Update instance's rtc update flag
@@ -666,47 +615,36 @@ void EnvironmentManager::updateDevice(const unsigned int &instance_id) {
         // Update cub for any not mapped properties
         for (auto &p : properties) {
             if (p.first.first == instance_id) {
-                // Generate hash for the subproperty name
-                detail::curve::Curve::VariableHash cvh = toHash(p.first);
-                const auto &prop = p.second;
-                // Create the mapping
-                const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(prop.offset),
-                        prop.length / prop.elements, prop.elements);
-                if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                    THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                        "in EnvironmentManager::updateDevice().");
-                }
-#ifdef _DEBUG
-                if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", p.first.second.c_str());
-                }
-#endif
+                registerCurveVariable(curve, p.first, p.first);
             }
         }
         // Update cub for any mapped properties
         for (auto &mp : mapped_properties) {
             if (mp.first.first == instance_id) {
-                // Generate hash for the subproperty name
-                detail::curve::Curve::VariableHash cvh = toHash(mp.first);
-                const auto &masterprop = properties.at(mp.second.masterProp);
-                // Create the mapping
-                const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(masterprop.offset),
-                        masterprop.length / masterprop.elements, masterprop.elements);
-                if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                    THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                        "in EnvironmentManager::updateDevice().");
-                }
-#ifdef _DEBUG
-                if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", mp.first.second.c_str());
-                }
-#endif
+                registerCurveVariable(curve, mp.first, mp.second.masterProp);
             }
         }
         curve_registration_required = false;
     }
 }
-
+void EnvironmentManager::uploadRanges(util::detail::DirtyRanges &dirty, char *d_ptr, const std::vector<char> &h_buffer, UploadCounters &counters) {
+    // Do not lock mutex here, do it in the calling method
+    for (const auto &r : dirty.getRanges()) {
+        // The buffer may have shrunk since the range was marked, if properties were removed
+        const size_t end = std::min(r.second, h_buffer.size());
+        if (r.first >= end)
+            continue;
+        gpuErrchk(cudaMemcpy(d_ptr + r.first, h_buffer.data() + r.first, end - r.first, cudaMemcpyHostToDevice));
+        counters.bytes += end - r.first;
+        ++counters.uploads;
+    }
+    dirty.clear();
+}
+EnvironmentManager::UploadCounters EnvironmentManager::getUploadCounters(const unsigned int &instance_id) const {
+    std::shared_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
+    const auto f = deviceRequiresUpdate.find(instance_id);
+    return f != deviceRequiresUpdate.end() ? f->second.uploads : UploadCounters();
+}
 
 EnvironmentManager& EnvironmentManager::getInstance() {
     auto lock = std::unique_lock<std::mutex>(instance_mutex);  // Mutex to protect from two threads triggering the static instantiation concurrently
@@ -724,21 +662,16 @@ EnvironmentManager& EnvironmentManager::getInstance() {
 util::Any EnvironmentManager::getPropertyAny(const unsigned int &instance_id, const std::string &var_name) const {
     std::shared_lock<std::shared_timed_mutex> lock(mutex);
     const NamePair name = toName(instance_id, var_name);
-    auto a = properties.find(name);
-    if (a != properties.end())
-        return util::Any(hc_buffer + a->second.offset, a->second.length, a->second.type, a->second.elements);
-    const auto b = mapped_properties.find(name);
-    if (b != mapped_properties.end()) {
-        a = properties.find(b->second.masterProp);
-        if (a != properties.end())
-            return util::Any(hc_buffer + a->second.offset, a->second.length, a->second.type, a->second.elements);
-        THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
-            "in EnvironmentManager::getPropertyAny().",
-            name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str());
-    }
-    THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
+    const NamePair &owner = getOwner(name);
+    const auto a = properties.find(owner);
+    if (a != properties.end()) {
+        const EnvSegment &segment = *segments.at(owner.first);
+        std::shared_lock<std::shared_timed_mutex> segment_lock(segment.mutex);
+        return util::Any(getHostPtr(owner), a->second.length, a->second.type, a->second.elements);
+    }
+    THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
         "in EnvironmentManager::getPropertyAny().",
-        name.first, name.second.c_str());
+        name.first, name.second.c_str(), owner.first, owner.second.c_str());
 }
 
 }  // namespace flamegpu
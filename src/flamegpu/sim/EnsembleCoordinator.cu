@@ -0,0 +1,222 @@
+#include "flamegpu/sim/EnsembleCoordinator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/sim/LogFrame.h"
+
+namespace flamegpu {
+
+const unsigned int EnsembleCoordinator::SHUTDOWN_TIMEOUT;
+
+EnsembleCoordinator::EnsembleCoordinator(const std::string &address,
+    const std::string &_model_name,
+    const bool _verbose,
+    std::vector<RunLog> &_run_logs,
+    std::vector<unsigned char> &_run_failed,
+    std::queue<unsigned int> &_log_export_queue,
+    std::mutex &_log_export_queue_mutex,
+    std::condition_variable &_log_export_queue_cdn)
+    : model_name(_model_name)
+    , verbose(_verbose)
+    , run_logs(_run_logs)
+    , run_failed(_run_failed)
+    , log_export_queue(_log_export_queue)
+    , log_export_queue_mutex(_log_export_queue_mutex)
+    , log_export_queue_cdn(_log_export_queue_cdn) {
+    std::string host;
+    uint16_t port;
+    util::detail::Socket::parseAddress(address, host, port);
+    listener = util::detail::Socket::listen(host, port);
+    for (unsigned int i = 0; i < run_logs.size(); ++i) {
+        unassigned.push_back(i);
+    }
+}
+
+unsigned int EnsembleCoordinator::run() {
+    std::vector<const util::detail::Socket*> sockets;
+    while (completed < run_logs.size()) {
+        sockets.clear();
+        sockets.push_back(&listener);
+        for (const auto &w : workers) {
+            sockets.push_back(&w.socket);
+        }
+        const std::vector<size_t> ready = util::detail::Socket::poll(sockets, 1000);
+        // Handle messages from workers, in the same order as sockets
+        size_t i = 1;
+        for (auto w = workers.begin(); w != workers.end(); ++i) {
+            if (std::find(ready.begin(), ready.end(), i) != ready.end() && !receive(*w)) {
+                reassign(*w);
+                w = workers.erase(w);
+            } else {
+                ++w;
+            }
+        }
+        if (!ready.empty() && ready[0] == 0) {
+            try {
+                workers.emplace_back(listener.accept());
+                workers.back().id = worker_count++;
+            } catch (exception::EnsembleNetworkError &e) {
+                fprintf(stderr, "\nFailed to accept worker: %s\n", e.what());
+            }
+        }
+        // Assign runs to requesting workers
+        for (auto w = workers.begin(); w != workers.end();) {
+            bool connected = true;
+            while (connected && w->requests && !unassigned.empty()) {
+                std::string payload;
+                EnsembleProtocol::write(payload, static_cast<uint32_t>(unassigned.front()));
+                try {
+                    EnsembleProtocol::send(w->socket, EnsembleProtocol::Assign, payload);
+                    w->assigned.insert(unassigned.front());
+                    unassigned.pop_front();
+                    --w->requests;
+                } catch (exception::EnsembleNetworkError &) {
+                    connected = false;
+                }
+            }
+            if (connected) {
+                ++w;
+            } else {
+                reassign(*w);
+                w = workers.erase(w);
+            }
+        }
+    }
+    // Every run has completed, release the workers and wait for them to disconnect
+    for (auto &w : workers) {
+        try {
+            EnsembleProtocol::send(w.socket, EnsembleProtocol::Finished);
+        } catch (exception::EnsembleNetworkError &) {
+            w.socket.close();
+        }
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(SHUTDOWN_TIMEOUT);
+    while (!workers.empty() && std::chrono::steady_clock::now() < deadline) {
+        sockets.clear();
+        for (auto w = workers.begin(); w != workers.end();) {
+            if (w->socket.isOpen()) {
+                sockets.push_back(&w->socket);
+                ++w;
+            } else {
+                w = workers.erase(w);
+            }
+        }
+        const std::vector<size_t> ready = util::detail::Socket::poll(sockets, 100);
+        size_t i = 0;
+        for (auto w = workers.begin(); w != workers.end(); ++i, ++w) {
+            if (std::find(ready.begin(), ready.end(), i) != ready.end()) {
+                // Discard any outstanding requests, until the worker disconnects
+                try {
+                    if (!w->receiver.receiveSome(w->socket)) {
+                        w->socket.close();
+                    } else if (w->receiver.isComplete()) {
+                        EnsembleProtocol::Message type;
+                        std::string payload;
+                        w->receiver.take(type, payload);
+                    }
+                } catch (exception::EnsembleNetworkError &) {
+                    w->socket.close();
+                }
+            }
+        }
+    }
+    workers.clear();
+    return failed;
+}
+bool EnsembleCoordinator::receive(Worker &worker) {
+    try {
+        if (!worker.receiver.receiveSome(worker.socket))
+            return false;
+        if (!worker.receiver.isComplete())
+            return true;
+        EnsembleProtocol::Message type;
+        std::string payload;
+        worker.receiver.take(type, payload);
+        return handleMessage(worker, type, payload);
+    } catch (exception::EnsembleNetworkError &e) {
+        fprintf(stderr, "\nWorker %u connection failed: %s\n", worker.id, e.what());
+        return false;
+    }
+}
+bool EnsembleCoordinator::handleMessage(Worker &worker, const EnsembleProtocol::Message type, const std::string &payload) {
+    size_t offset = 0;
+    if (!worker.welcomed) {
+        // The first message must be the handshake
+        std::string reason;
+        if (type != EnsembleProtocol::Hello) {
+            return false;
+        } else if (EnsembleProtocol::readUInt32(payload, offset) != EnsembleProtocol::VERSION) {
+            reason = "protocol version does not match";
+        } else if (EnsembleProtocol::readUInt64(payload, offset) != run_logs.size()) {
+            reason = "number of plans does not match";
+        } else if (EnsembleProtocol::readString(payload, offset) != model_name) {
+            reason = "model name does not match";
+        }
+        if (!reason.empty()) {
+            std::string reject;
+            EnsembleProtocol::write(reject, reason);
+            EnsembleProtocol::send(worker.socket, EnsembleProtocol::Reject, reject);
+            fprintf(stderr, "\nRejected worker %u: %s\n", worker.id, reason.c_str());
+            return false;
+        }
+        EnsembleProtocol::send(worker.socket, EnsembleProtocol::Welcome);
+        worker.welcomed = true;
+        return true;
+    }
+    switch (type) {
+    case EnsembleProtocol::Request:
+        ++worker.requests;
+        return true;
+    case EnsembleProtocol::Result: {
+        const unsigned int run_id = EnsembleProtocol::readUInt32(payload, offset);
+        RunLog log = EnsembleProtocol::readRunLog(payload, offset);
+        if (!worker.assigned.erase(run_id))
+            return false;
+        run_logs[run_id] = std::move(log);
+        complete(run_id, false);
+        return true;
+    }
+    case EnsembleProtocol::Failure: {
+        const unsigned int run_id = EnsembleProtocol::readUInt32(payload, offset);
+        const std::string message = EnsembleProtocol::readString(payload, offset);
+        if (!worker.assigned.erase(run_id))
+            return false;
+        fprintf(stderr, "\nRun %u failed on worker %u with exception: \n%s\n", run_id, worker.id, message.c_str());
+        complete(run_id, true);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+void EnsembleCoordinator::complete(const unsigned int run_id, const bool _failed) {
+    ++completed;
+    if (_failed) {
+        run_failed[run_id] = 1;
+        ++failed;
+        return;
+    }
+    // Notify logger
+    {
+        std::lock_guard<std::mutex> lck(log_export_queue_mutex);
+        log_export_queue.push(run_id);
+    }
+    log_export_queue_cdn.notify_one();
+    // Print progress to console
+    if (verbose)
+        printf("\rCUDAEnsemble progress: %u/%u", completed, static_cast<unsigned int>(run_logs.size()));
+}
+void EnsembleCoordinator::reassign(Worker &worker) {
+    if (!worker.assigned.empty()) {
+        fprintf(stderr, "\nWorker %u disconnected, %u incomplete runs will be reassigned.\n", worker.id, static_cast<unsigned int>(worker.assigned.size()));
+        // Reassigned runs are executed before those which were never assigned
+        unassigned.insert(unassigned.begin(), worker.assigned.begin(), worker.assigned.end());
+        worker.assigned.clear();
+    }
+}
+
+}  // namespace flamegpu
@@ -0,0 +1,252 @@
+#include "flamegpu/sim/EnsembleProtocol.h"
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <new>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/util/detail/Socket.h"
+
+namespace flamegpu {
+
+const uint32_t EnsembleProtocol::VERSION;
+const uint64_t EnsembleProtocol::MAX_PAYLOAD;
+
+namespace {
+/**
+ * Types which may be held by the util::Any values of a LogFrame
+ */
+const std::vector<std::type_index> &supportedTypes() {
+    static const std::vector<std::type_index> types = {
+        typeid(float), typeid(double), typeid(bool), typeid(char), typeid(signed char), typeid(unsigned char),
+        typeid(int16_t), typeid(uint16_t), typeid(int32_t), typeid(uint32_t), typeid(int64_t), typeid(uint64_t),
+        typeid(long), typeid(unsigned long), typeid(long long), typeid(unsigned long long)};  // NOLINT(runtime/int)
+    return types;
+}
+void writeAny(std::string &payload, const util::Any &value) {
+    const auto &types = supportedTypes();
+    uint32_t type = 0;
+    while (type < types.size() && types[type] != value.type)
+        ++type;
+    if (type == types.size()) {
+        THROW exception::EnsembleNetworkError("Logged value of type '%s' can not be sent to the coordinator, in EnsembleProtocol::write()", value.type.name());
+    }
+    EnsembleProtocol::write(payload, type);
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(value.elements));
+    EnsembleProtocol::write(payload, std::string(static_cast<const char*>(value.ptr), value.length));
+}
+util::Any readAny(const std::string &payload, size_t &offset) {
+    const auto &types = supportedTypes();
+    const uint32_t type = EnsembleProtocol::readUInt32(payload, offset);
+    const uint32_t elements = EnsembleProtocol::readUInt32(payload, offset);
+    const std::string data = EnsembleProtocol::readString(payload, offset);
+    if (type >= types.size()) {
+        THROW exception::EnsembleNetworkError("Received logged value of unknown type, in EnsembleProtocol::readRunLog()");
+    }
+    return util::Any(data.data(), data.size(), types[type], elements);
+}
+void writeFrame(std::string &payload, const LogFrame &frame) {
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(frame.getStepCount()));
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(frame.getEnvironment().size()));
+    for (const auto &property : frame.getEnvironment()) {
+        EnsembleProtocol::write(payload, property.first);
+        writeAny(payload, property.second);
+    }
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(frame.getAgents().size()));
+    for (const auto &agent : frame.getAgents()) {
+        EnsembleProtocol::write(payload, agent.first.first);
+        EnsembleProtocol::write(payload, agent.first.second);
+        EnsembleProtocol::write(payload, static_cast<uint32_t>(agent.second.second));
+        EnsembleProtocol::write(payload, static_cast<uint32_t>(agent.second.first.size()));
+        for (const auto &reduction : agent.second.first) {
+            EnsembleProtocol::write(payload, reduction.first.name);
+            EnsembleProtocol::write(payload, static_cast<uint32_t>(reduction.first.reduction));
+            writeAny(payload, reduction.second);
+        }
+    }
+}
+LogFrame readFrame(const std::string &payload, size_t &offset) {
+    const unsigned int step_count = EnsembleProtocol::readUInt32(payload, offset);
+    std::map<std::string, util::Any> environment;
+    for (uint32_t i = EnsembleProtocol::readUInt32(payload, offset); i > 0; --i) {
+        std::string name = EnsembleProtocol::readString(payload, offset);
+        environment.emplace(std::move(name), readAny(payload, offset));
+    }
+    std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents;
+    for (uint32_t i = EnsembleProtocol::readUInt32(payload, offset); i > 0; --i) {
+        std::string agent_name = EnsembleProtocol::readString(payload, offset);
+        std::string state_name = EnsembleProtocol::readString(payload, offset);
+        const unsigned int count = EnsembleProtocol::readUInt32(payload, offset);
+        std::map<LoggingConfig::NameReductionFn, util::Any> reductions;
+        for (uint32_t j = EnsembleProtocol::readUInt32(payload, offset); j > 0; --j) {
+            // The reduction functions are not required to access the logged value
+            LoggingConfig::NameReductionFn key = {EnsembleProtocol::readString(payload, offset), static_cast<LoggingConfig::Reduction>(EnsembleProtocol::readUInt32(payload, offset)), nullptr, nullptr};
+            reductions.emplace(std::move(key), readAny(payload, offset));
+        }
+        agents.emplace(util::StringPair(std::move(agent_name), std::move(state_name)), std::make_pair(std::move(reductions), count));
+    }
+    return LogFrame(std::move(environment), std::move(agents), step_count);
+}
+}  // namespace
+
+void EnsembleProtocol::send(util::detail::Socket &socket, const Message type, const std::string &payload) {
+    if (payload.size() > MAX_PAYLOAD) {
+        THROW exception::EnsembleNetworkError("Message payload of %llu bytes exceeds the limit of %llu bytes, in EnsembleProtocol::send()",
+            static_cast<unsigned long long>(payload.size()), static_cast<unsigned long long>(MAX_PAYLOAD));  // NOLINT(runtime/int)
+    }
+    std::string message;
+    message.reserve(sizeof(uint32_t) + sizeof(uint64_t) + payload.size());
+    write(message, static_cast<uint32_t>(type));
+    write(message, payload);
+    socket.sendAll(message.data(), message.size());
+}
+bool EnsembleProtocol::Receiver::receiveSome(util::detail::Socket &socket) {
+    if (header_received < sizeof(header)) {
+        const size_t received = socket.receiveSome(header + header_received, sizeof(header) - header_received);
+        if (!received) {
+            if (header_received) {
+                THROW exception::EnsembleNetworkError("Received malformed message, in EnsembleProtocol::Receiver::receiveSome()");
+            }
+            return false;
+        }
+        header_received += received;
+        if (header_received < sizeof(header))
+            return true;
+        // The header is complete, validate it and allocate the payload
+        uint32_t t;
+        uint64_t length;
+        memcpy(&t, header, sizeof(uint32_t));
+        memcpy(&length, header + sizeof(uint32_t), sizeof(uint64_t));
+        if (t < Hello || t > Failure) {
+            THROW exception::EnsembleNetworkError("Received malformed message, in EnsembleProtocol::Receiver::receiveSome()");
+        }
+        if (length > MAX_PAYLOAD) {
+            THROW exception::EnsembleNetworkError("Received message with a payload of %llu bytes, which exceeds the limit of %llu bytes, in EnsembleProtocol::Receiver::receiveSome()",
+                static_cast<unsigned long long>(length), static_cast<unsigned long long>(MAX_PAYLOAD));  // NOLINT(runtime/int)
+        }
+        try {
+            payload.resize(length);
+        } catch (std::bad_alloc &) {
+            THROW exception::EnsembleNetworkError("Unable to allocate %llu bytes for received message, in EnsembleProtocol::Receiver::receiveSome()",
+                static_cast<unsigned long long>(length));  // NOLINT(runtime/int)
+        }
+        payload_received = 0;
+        return true;
+    }
+    if (payload_received < payload.size()) {
+        const size_t received = socket.receiveSome(&payload[payload_received], payload.size() - payload_received);
+        if (!received) {
+            THROW exception::EnsembleNetworkError("Received malformed message, in EnsembleProtocol::Receiver::receiveSome()");
+        }
+        payload_received += received;
+    }
+    return true;
+}
+bool EnsembleProtocol::Receiver::isComplete() const {
+    return header_received == sizeof(header) && payload_received == payload.size();
+}
+void EnsembleProtocol::Receiver::take(Message &type, std::string &_payload) {
+    if (!isComplete()) {
+        THROW exception::InvalidOperation("The message has not been completely received, in EnsembleProtocol::Receiver::take()");
+    }
+    uint32_t t;
+    memcpy(&t, header, sizeof(uint32_t));
+    type = static_cast<Message>(t);
+    _payload = std::move(payload);
+    payload.clear();
+    header_received = 0;
+    payload_received = 0;
+}
+bool EnsembleProtocol::receive(util::detail::Socket &socket, Message &type, std::string &payload) {
+    Receiver receiver;
+    do {
+        if (!receiver.receiveSome(socket))
+            return false;
+    } while (!receiver.isComplete());
+    receiver.take(type, payload);
+    return true;
+}
+void EnsembleProtocol::write(std::string &payload, const uint32_t value) {
+    payload.append(reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+}
+void EnsembleProtocol::write(std::string &payload, const uint64_t value) {
+    payload.append(reinterpret_cast<const char*>(&value), sizeof(uint64_t));
+}
+void EnsembleProtocol::write(std::string &payload, const std::string &value) {
+    write(payload, static_cast<uint64_t>(value.size()));
+    payload.append(value);
+}
+uint32_t EnsembleProtocol::readUInt32(const std::string &payload, size_t &offset) {
+    if (payload.size() < offset + sizeof(uint32_t)) {
+        THROW exception::EnsembleNetworkError("Received message is too short, in EnsembleProtocol::readUInt32()");
+    }
+    uint32_t rtn;
+    memcpy(&rtn, payload.data() + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    return rtn;
+}
+uint64_t EnsembleProtocol::readUInt64(const std::string &payload, size_t &offset) {
+    if (payload.size() < offset + sizeof(uint64_t)) {
+        THROW exception::EnsembleNetworkError("Received message is too short, in EnsembleProtocol::readUInt64()");
+    }
+    uint64_t rtn;
+    memcpy(&rtn, payload.data() + offset, sizeof(uint64_t));
+    offset += sizeof(uint64_t);
+    return rtn;
+}
+std::string EnsembleProtocol::readString(const std::string &payload, size_t &offset) {
+    const uint64_t length = readUInt64(payload, offset);
+    if (payload.size() - offset < length) {
+        THROW exception::EnsembleNetworkError("Received message is too short, in EnsembleProtocol::readString()");
+    }
+    std::string rtn = payload.substr(offset, length);
+    offset += length;
+    return rtn;
+}
+void EnsembleProtocol::write(std::string &payload, const RunLog &log) {
+    write(payload, log.random_seed);
+    write(payload, static_cast<uint32_t>(log.step_log_frequency));
+    writeFrame(payload, log.exit);
+    write(payload, static_cast<uint32_t>(log.step.size()));
+    for (const auto &frame : log.step) {
+        writeFrame(payload, frame);
+    }
+    write(payload, static_cast<uint32_t>(log.step_timing.size()));
+    for (const auto &step : log.step_timing) {
+        write(payload, static_cast<uint32_t>(step.size()));
+        for (const auto &component : step) {
+            write(payload, component.first);
+            uint64_t duration;
+            memcpy(&duration, &component.second, sizeof(double));
+            write(payload, duration);
+        }
+    }
+}
+RunLog EnsembleProtocol::readRunLog(const std::string &payload, size_t &offset) {
+    RunLog rtn;
+    rtn.random_seed = readUInt64(payload, offset);
+    rtn.step_log_frequency = readUInt32(payload, offset);
+    rtn.exit = readFrame(payload, offset);
+    for (uint32_t i = readUInt32(payload, offset); i > 0; --i) {
+        rtn.step.push_back(readFrame(payload, offset));
+    }
+    for (uint32_t i = readUInt32(payload, offset); i > 0; --i) {
+        std::map<std::string, double> step;
+        for (uint32_t j = readUInt32(payload, offset); j > 0; --j) {
+            std::string component = readString(payload, offset);
+            const uint64_t duration = readUInt64(payload, offset);
+            double d;
+            memcpy(&d, &duration, sizeof(double));
+            step.emplace(std::move(component), d);
+        }
+        rtn.step_timing.push_back(std::move(step));
+    }
+    return rtn;
+}
+
+}  // namespace flamegpu
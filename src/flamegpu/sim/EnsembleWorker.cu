@@ -0,0 +1,97 @@
+#include "flamegpu/sim/EnsembleWorker.h"
+
+#include <chrono>
+#include <thread>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/sim/EnsembleProtocol.h"
+#include "flamegpu/sim/LogFrame.h"
+
+namespace flamegpu {
+
+const unsigned int EnsembleWorker::CONNECT_TIMEOUT;
+
+EnsembleWorker::EnsembleWorker(const std::string &address, const unsigned int _plan_count, const std::string &model_name)
+    : plan_count(_plan_count) {
+    std::string host;
+    uint16_t port;
+    util::detail::Socket::parseAddress(address, host, port);
+    // The coordinator may not be listening yet, if the processes were launched together
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(CONNECT_TIMEOUT);
+    while (!socket.isOpen()) {
+        try {
+            socket = util::detail::Socket::connect(host, port);
+        } catch (exception::EnsembleNetworkError &) {
+            if (std::chrono::steady_clock::now() > deadline)
+                throw;
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+    }
+    std::string payload;
+    EnsembleProtocol::write(payload, EnsembleProtocol::VERSION);
+    EnsembleProtocol::write(payload, static_cast<uint64_t>(plan_count));
+    EnsembleProtocol::write(payload, model_name);
+    EnsembleProtocol::send(socket, EnsembleProtocol::Hello, payload);
+    EnsembleProtocol::Message type;
+    if (!EnsembleProtocol::receive(socket, type, payload)) {
+        THROW exception::EnsembleNetworkError("Coordinator %s closed the connection, in EnsembleWorker::EnsembleWorker()", address.c_str());
+    } else if (type == EnsembleProtocol::Reject) {
+        size_t offset = 0;
+        THROW exception::EnsembleNetworkError("Coordinator %s rejected the worker: %s, in EnsembleWorker::EnsembleWorker()",
+            address.c_str(), EnsembleProtocol::readString(payload, offset).c_str());
+    } else if (type != EnsembleProtocol::Welcome) {
+        THROW exception::EnsembleNetworkError("Coordinator %s sent an unexpected message, in EnsembleWorker::EnsembleWorker()", address.c_str());
+    }
+}
+bool EnsembleWorker::nextRun(unsigned int &run_id) {
+    send(EnsembleProtocol::Request, "");
+    std::lock_guard<std::mutex> lock(receive_mutex);
+    // Finished is only sent once, so runners waiting behind the runner which received it must not wait for a reply
+    if (finished || connection_lost)
+        return false;
+    try {
+        EnsembleProtocol::Message type;
+        std::string payload;
+        if (EnsembleProtocol::receive(socket, type, payload)) {
+            if (type == EnsembleProtocol::Assign) {
+                size_t offset = 0;
+                run_id = EnsembleProtocol::readUInt32(payload, offset);
+                if (run_id < plan_count)
+                    return true;
+            } else if (type == EnsembleProtocol::Finished) {
+                // The connection is closed when the worker is destroyed, after every runner has exited
+                finished = true;
+                return false;
+            }
+        }
+    } catch (exception::EnsembleNetworkError &) {
+        // Handled below
+    }
+    connection_lost = true;
+    return false;
+}
+void EnsembleWorker::sendResult(const unsigned int run_id, const RunLog &log) {
+    std::string payload;
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(run_id));
+    EnsembleProtocol::write(payload, log);
+    send(EnsembleProtocol::Result, payload);
+    ++completed_runs;
+}
+void EnsembleWorker::sendFailure(const unsigned int run_id, const std::string &message) {
+    std::string payload;
+    EnsembleProtocol::write(payload, static_cast<uint32_t>(run_id));
+    EnsembleProtocol::write(payload, message);
+    send(EnsembleProtocol::Failure, payload);
+}
+void EnsembleWorker::send(const int type, const std::string &payload) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    if (finished || connection_lost)
+        return;
+    try {
+        EnsembleProtocol::send(socket, static_cast<EnsembleProtocol::Message>(type), payload);
+    } catch (exception::EnsembleNetworkError &) {
+        connection_lost = true;
+    }
+}
+
+}  // namespace flamegpu
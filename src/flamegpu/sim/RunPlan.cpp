@@ -21,6 +21,9 @@ RunPlan& RunPlan::operator=(const RunPlan& other) {
     this->allow_0_steps = other.allow_0_steps;
     this->output_subdirectory = other.output_subdirectory;
     this->allow_0_steps = other.allow_0_steps;
+    if (this != &other) {
+        this->property_overrides.clear();
+    }
     for (auto &i : other.property_overrides)
         this->property_overrides.emplace(i.first, util::Any(i.second));
     return *this;
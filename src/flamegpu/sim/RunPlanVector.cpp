@@ -1,12 +1,102 @@
 #include "flamegpu/sim/RunPlanVector.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <thread>
+#include <type_traits>
+
 #include "flamegpu/model/ModelDescription.h"
 
 namespace flamegpu {
 
+namespace {
+/**
+ * Parameters of the primitive polynomial and initial direction numbers of a Sobol dimension
+ */
+struct SobolParameters {
+    /**
+     * Degree of the primitive polynomial
+     */
+    unsigned int s;
+    /**
+     * Coefficients of the primitive polynomial's inner terms
+     */
+    unsigned int a;
+    /**
+     * Initial direction numbers
+     */
+    unsigned int m[7];
+};
+/**
+ * Dimensions 2 onwards of Joe and Kuo's new-joe-kuo-6.21201 direction numbers
+ * The first dimension is the van der Corput sequence, so requires no parameters
+ */
+const SobolParameters SOBOL_PARAMETERS[RunPlanVector::SOBOL_MAX_DIMENSIONS - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+/**
+ * Returns the 32 direction numbers of a Sobol dimension
+ */
+std::array<uint32_t, 32> sobolDirections(const unsigned int dimension) {
+    std::array<uint32_t, 32> v;
+    if (dimension == 0) {
+        for (unsigned int k = 0; k < 32; ++k) {
+            v[k] = 1u << (31 - k);
+        }
+        return v;
+    }
+    const SobolParameters &p = SOBOL_PARAMETERS[dimension - 1];
+    for (unsigned int k = 0; k < p.s; ++k) {
+        v[k] = p.m[k] << (31 - k);
+    }
+    for (unsigned int k = p.s; k < 32; ++k) {
+        v[k] = v[k - p.s] ^ (v[k - p.s] >> p.s);
+        for (unsigned int j = 1; j < p.s; ++j) {
+            v[k] ^= ((p.a >> (p.s - 1 - j)) & 1u) * v[k - j];
+        }
+    }
+    return v;
+}
+/**
+ * Scales a value in the range [0, 1) to the range of an integer property, [min, max]
+ */
+template<typename T>
+T scaleUnit(const double u, const double min, const double max, std::false_type) {
+    return static_cast<T>(std::min(std::floor(min + (max - min + 1) * u), max));
+}
+/**
+ * Scales a value in the range [0, 1) to the range of a floating point property, [min, max)
+ */
+template<typename T>
+T scaleUnit(const double u, const double min, const double max, std::true_type) {
+    return static_cast<T>(min + (max - min) * u);
+}
+}  // namespace
+
 RunPlanVector::RunPlanVector(const ModelDescription &model, unsigned int initial_length)
     : std::vector<RunPlan>(initial_length, RunPlan(model))
     , randomPropertySeed(std::random_device()())
-    , rand(randomPropertySeed)
+    , materialised(initial_length, false)
     , environment(std::make_shared<std::unordered_map<std::string, EnvironmentDescription::PropData> const>(model.model->environment->getPropertiesMap()))
     , allow_0_steps(model.model->exitConditions.size() + model.model->exitConditionCallbacks.size() > 0) {
     this->resize(initial_length, RunPlan(environment, allow_0_steps));
@@ -15,12 +105,12 @@ RunPlanVector::RunPlanVector(const ModelDescription &model, unsigned int initial
 RunPlanVector::RunPlanVector(const std::shared_ptr<const std::unordered_map<std::string, EnvironmentDescription::PropData>> &_environment, const bool &_allow_0_steps)
     : std::vector<RunPlan>()
     , randomPropertySeed(std::random_device()())
-    , rand(randomPropertySeed)
     , environment(_environment)
     , allow_0_steps(_allow_0_steps) { }
 void RunPlanVector::setRandomSimulationSeed(const uint64_t &initial_seed, const unsigned int &step) {
+    // These members are not stored in property columns, so the plans are accessed directly
     uint64_t current_seed = initial_seed;
-    for (auto &i : *this) {
+    for (auto &i : static_cast<std::vector<RunPlan>&>(*this)) {
         i.setRandomSimulationSeed(current_seed);
         current_seed += step;
     }
@@ -30,18 +120,17 @@ void RunPlanVector::setSteps(const unsigned int &steps) {
         throw std::out_of_range("Model description requires atleast 1 exit condition to have unlimited steps, "
             "in RunPlanVector::setSteps()");
     }
-    for (auto &i : *this) {
+    for (auto &i : static_cast<std::vector<RunPlan>&>(*this)) {
         i.setSteps(steps);
     }
 }
 void RunPlanVector::setOutputSubdirectory(const std::string &subdir) {
-    for (auto &i : *this) {
+    for (auto &i : static_cast<std::vector<RunPlan>&>(*this)) {
         i.setOutputSubdirectory(subdir);
     }
 }
 void RunPlanVector::setRandomPropertySeed(const uint64_t &seed) {
     randomPropertySeed = seed;
-    rand.seed(randomPropertySeed);
 }
 
 uint64_t RunPlanVector::getRandomPropertySeed() {
@@ -77,11 +166,8 @@ RunPlanVector& RunPlanVector::operator+=(const RunPlan& rhs) {
         THROW exception::InvalidArgument("RunPlan is for a different ModelDescription, "
             "in ::operator+=(RunPlanVector, RunPlan)");
     }
-    // Update shared_ptr to env
-    RunPlan rhs_copy = rhs;
-    rhs_copy.environment = environment;
     // Operation
-    this->push_back(rhs_copy);
+    pushPlan(rhs);
     return *this;
 }
 RunPlanVector& RunPlanVector::operator+=(const RunPlanVector& rhs) {
@@ -95,37 +181,333 @@ RunPlanVector& RunPlanVector::operator+=(const RunPlanVector& rhs) {
     }
     // Operation
     this->reserve(size() + rhs.size());
-    // Iterate, because insert would require RunPlan::operator==
-    for (const auto &i : rhs) {
-        // Update shared_ptr to env
-        RunPlan i_copy = i;
-        i_copy.environment = environment;
-        this->push_back(i);
+    for (size_type i = 0; i < rhs.size(); ++i) {
+        // rhs's property column values are copied into the plan, and then moved into this vector's columns where available
+        pushPlan(rhs[i]);
     }
     return *this;
 }
 RunPlanVector& RunPlanVector::operator*=(const unsigned int& rhs) {
-    RunPlanVector copy(*this);
+    // Repeat the plans, flags and property columns
+    const std::vector<RunPlan> plans_copy(static_cast<std::vector<RunPlan>&>(*this));
+    const std::vector<bool> materialised_copy(materialised);
     this->clear();
-    this->reserve(copy.size() * rhs);
+    materialised.clear();
+    this->reserve(plans_copy.size() * rhs);
     for (unsigned int i = 0; i < rhs; ++i) {
         // Iterate, because insert would require RunPlan::operator==
-        for (const auto &j : copy) {
+        for (const auto &j : plans_copy) {
             this->push_back(j);
         }
+        materialised.insert(materialised.end(), materialised_copy.begin(), materialised_copy.end());
+    }
+    for (auto &column : property_columns) {
+        const std::vector<char> column_copy(column.second);
+        column.second.clear();
+        column.second.reserve(column_copy.size() * rhs);
+        for (unsigned int i = 0; i < rhs; ++i) {
+            column.second.insert(column.second.end(), column_copy.begin(), column_copy.end());
+        }
     }
     return *this;
 }
 RunPlanVector RunPlanVector::operator*(const unsigned int& rhs) const {
-    RunPlanVector rtn(this->environment, this->allow_0_steps);
-    rtn.reserve(size() * rhs);
-    for (unsigned int i = 0; i < rhs; ++i) {
-        // Iterate, because insert would require RunPlan::operator==
-        for (const auto &j : *this) {
-            rtn.push_back(j);
+    RunPlanVector rtn(*this);
+    rtn *= rhs;
+    return rtn;
+}
+
+RunPlanVector::iterator RunPlanVector::begin() {
+    for (size_type i = 0; i < size(); ++i) {
+        materialise(i);
+    }
+    // All values are now held by the plans
+    property_columns.clear();
+    return std::vector<RunPlan>::begin();
+}
+RunPlanVector::iterator RunPlanVector::end() {
+    return std::vector<RunPlan>::end();
+}
+RunPlan& RunPlanVector::operator[](const size_type pos) {
+    materialise(pos);
+    return std::vector<RunPlan>::operator[](pos);
+}
+RunPlan RunPlanVector::operator[](const size_type pos) const {
+    RunPlan rtn(std::vector<RunPlan>::operator[](pos));
+    if (!materialised[pos]) {
+        applyColumns(pos, rtn);
+    }
+    return rtn;
+}
+RunPlanVector::iterator RunPlanVector::insert(const const_iterator pos, const RunPlan& value) {
+    return insert(pos, 1, value);
+}
+RunPlanVector::iterator RunPlanVector::insert(const iterator pos, const RunPlan& value) {
+    return insert(pos, 1, value);
+}
+RunPlanVector::iterator RunPlanVector::insert(const iterator pos, const size_type count, const RunPlan& value) {
+    return insert(cbegin() + (pos - std::vector<RunPlan>::begin()), count, value);
+}
+RunPlanVector::iterator RunPlanVector::insert(const const_iterator pos, const size_type count, const RunPlan& value) {
+    if (*value.environment != *this->environment) {
+        THROW exception::InvalidArgument("RunPlan is for a different ModelDescription, "
+            "in RunPlanVector::insert()");
+    }
+    if (pos.vec != this) {
+        THROW exception::InvalidArgument("Iterator does not belong to this RunPlanVector, "
+            "in RunPlanVector::insert()");
+    }
+    const size_type index = pos.pos;
+    // Inserted plans hold their own values, the column rows are padding
+    materialised.insert(materialised.begin() + index, count, true);
+    for (auto &column : property_columns) {
+        const size_type length = environment->at(column.first).data.length;
+        column.second.insert(column.second.begin() + index * length, count * length, 0);
+    }
+    RunPlan value_copy(value);
+    value_copy.environment = environment;
+    return std::vector<RunPlan>::insert(std::vector<RunPlan>::begin() + index, count, value_copy);
+}
+
+void RunPlanVector::setPropertyLatinHypercube(const std::vector<PropertyRange> &properties) {
+    const std::vector<const EnvironmentDescription::PropData*> props = validateRanges(properties, "setPropertyLatinHypercube");
+    const size_type count = size();
+    std::vector<size_type> strata(count);
+    for (size_t d = 0; d < properties.size(); ++d) {
+        const unsigned int stream = propertyStream(properties[d].name, properties[d].index);
+        // Fisher-Yates shuffle of the strata, the engine is keyed by an index which no plan can hold
+        for (size_type i = 0; i < count; ++i) {
+            strata[i] = i;
+        }
+        PlanRandomEngine shuffle_engine(randomPropertySeed, UINT64_MAX, stream);
+        for (size_type i = count - 1; i > 0; --i) {
+            std::swap(strata[i], strata[shuffle_engine.uniformInt<uint64_t>(0, i)]);
+        }
+        const uint64_t seed = randomPropertySeed;
+        fillPropertyRange(properties[d], *props[d], [&strata, count, seed, stream](const size_type i) {
+            PlanRandomEngine engine(seed, i, stream);
+            const double offset = static_cast<double>(engine() >> 11) * 1.1102230246251565e-16;  // 2^-53
+            return std::min((strata[i] + offset) / count, 1.0 - 1.1102230246251565e-16);
+        });
+    }
+}
+void RunPlanVector::setPropertySobol(const std::vector<PropertyRange> &properties) {
+    if (properties.size() > SOBOL_MAX_DIMENSIONS) {
+        THROW exception::InvalidArgument("%u properties were provided, however a maximum of %u are supported, "
+            "in RunPlanVector::setPropertySobol()\n",
+            static_cast<unsigned int>(properties.size()), SOBOL_MAX_DIMENSIONS);
+    }
+    const std::vector<const EnvironmentDescription::PropData*> props = validateRanges(properties, "setPropertySobol");
+    for (unsigned int d = 0; d < properties.size(); ++d) {
+        const std::array<uint32_t, 32> v = sobolDirections(d);
+        fillPropertyRange(properties[d], *props[d], [&v](const size_type i) {
+            // Points are generated directly from the index, rather than in Gray code order, so that plans are independent
+            uint32_t x = 0;
+            for (unsigned int k = 0; k < 32; ++k) {
+                if ((i >> k) & 1) {
+                    x ^= v[k];
+                }
+            }
+            return static_cast<double>(x) * 2.3283064365386963e-10;  // 2^-32
+        });
+    }
+}
+void RunPlanVector::setPropertyHalton(const std::vector<PropertyRange> &properties) {
+    const std::vector<const EnvironmentDescription::PropData*> props = validateRanges(properties, "setPropertyHalton");
+    uint64_t base = 1;
+    for (size_t d = 0; d < properties.size(); ++d) {
+        // Find the next prime
+        bool prime = false;
+        while (!prime) {
+            ++base;
+            prime = true;
+            for (uint64_t f = 2; f * f <= base; ++f) {
+                if (base % f == 0) {
+                    prime = false;
+                    break;
+                }
+            }
+        }
+        fillPropertyRange(properties[d], *props[d], [base](const size_type i) {
+            // Radical inverse of i + 1, so that the first plan does not sample the lower bound of every range
+            double f = 1.0, r = 0.0;
+            for (uint64_t n = static_cast<uint64_t>(i) + 1; n > 0; n /= base) {
+                f /= base;
+                r += f * (n % base);
+            }
+            return r;
+        });
+    }
+}
+std::vector<const EnvironmentDescription::PropData*> RunPlanVector::validateRanges(const std::vector<PropertyRange> &properties, const char *caller) const {
+    if (this->size() < 2) {
+        THROW std::out_of_range(std::string("Unable to apply a property distribution a vector with less than 2 elements, "
+            "in RunPlanVector::") + caller + "()\n");
+    }
+    std::vector<const EnvironmentDescription::PropData*> rtn;
+    for (const auto &range : properties) {
+        const auto it = environment->find(range.name);
+        if (it == environment->end()) {
+            THROW exception::InvalidEnvProperty("Environment description does not contain property '%s', "
+                "in RunPlanVector::%s()\n",
+                range.name.c_str(), caller);
+        }
+        if (!range.is_element && it->second.data.elements != 1) {
+            THROW exception::InvalidEnvPropertyType("Environment property '%s' is an array with %u elements, an index must be provided, "
+                "in RunPlanVector::%s()\n",
+                range.name.c_str(), it->second.data.elements, caller);
+        }
+        if (range.index >= it->second.data.elements) {
+            THROW std::out_of_range(std::string("Environment property array index out of bounds "
+                "in RunPlanVector::") + caller + "()\n");
         }
+        rtn.push_back(&it->second);
     }
     return rtn;
 }
+void RunPlanVector::fillPropertyRange(const PropertyRange &range, const EnvironmentDescription::PropData &prop, const std::function<double(size_type)> &unit) {
+    const std::type_index &type = prop.data.type;
+    if (type == std::type_index(typeid(float))) {
+        fillPropertyRange<float>(range, prop, unit);
+    } else if (type == std::type_index(typeid(double))) {
+        fillPropertyRange<double>(range, prop, unit);
+    } else if (type == std::type_index(typeid(char))) {
+        fillPropertyRange<char>(range, prop, unit);
+    } else if (type == std::type_index(typeid(int8_t))) {
+        fillPropertyRange<int8_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(uint8_t))) {
+        fillPropertyRange<uint8_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(int16_t))) {
+        fillPropertyRange<int16_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(uint16_t))) {
+        fillPropertyRange<uint16_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(int32_t))) {
+        fillPropertyRange<int32_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(uint32_t))) {
+        fillPropertyRange<uint32_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(int64_t))) {
+        fillPropertyRange<int64_t>(range, prop, unit);
+    } else if (type == std::type_index(typeid(uint64_t))) {
+        fillPropertyRange<uint64_t>(range, prop, unit);
+    } else {
+        THROW exception::InvalidEnvPropertyType("Environment property '%s' has unsupported type '%s', "
+            "in RunPlanVector::fillPropertyRange()\n",
+            range.name.c_str(), type.name());
+    }
+}
+template<typename T>
+void RunPlanVector::fillPropertyRange(const PropertyRange &range, const EnvironmentDescription::PropData &prop, const std::function<double(size_type)> &unit) {
+    const double min = range.min;
+    const double max = range.max;
+    fillProperty<T>(range.name, prop, range.index, [&unit, min, max](const size_type i, PlanRandomEngine &) {
+        return scaleUnit<T>(unit(i), min, max, std::is_floating_point<T>());
+    });
+}
+
+unsigned int RunPlanVector::propertyStream(const std::string &name, const EnvironmentManager::size_type index) {
+    // FNV-1a, so that the value of a plan is independent of the order that properties were set
+    unsigned int hash = 2166136261u;
+    for (const char &c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    for (unsigned int i = 0; i < sizeof(EnvironmentManager::size_type); ++i) {
+        hash ^= static_cast<unsigned char>(index >> (8 * i));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+void RunPlanVector::forEachPlan(const std::function<void(size_type, size_type)> &fn) {
+    // Below this size, the cost of launching threads outweighs the benefit
+    const size_type MIN_PLANS_PER_THREAD = 16384;
+    const size_type thread_count = std::min<size_type>(std::max(1u, std::thread::hardware_concurrency()), size() / MIN_PLANS_PER_THREAD);
+    if (thread_count <= 1) {
+        fn(0, size());
+        return;
+    }
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> exceptions(thread_count);
+    const size_type chunk = (size() + thread_count - 1) / thread_count;
+    for (size_type t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&fn, &exceptions, t, chunk, this]() {
+            try {
+                fn(t * chunk, std::min(size(), (t + 1) * chunk));
+            } catch (...) {
+                exceptions[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (const auto &e : exceptions) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+std::vector<char> *RunPlanVector::getColumn(const std::string &name, const EnvironmentDescription::PropData &prop) {
+    auto it = property_columns.find(name);
+    if (it != property_columns.end()) {
+        return &it->second;
+    }
+    if (std::find(materialised.begin(), materialised.end(), false) == materialised.end()) {
+        // No plan would use the column
+        return nullptr;
+    }
+    // Initialise each row from the plan's own override if present, otherwise the property's default
+    std::vector<char> &column = property_columns.emplace(name, std::vector<char>(size() * prop.data.length)).first->second;
+    for (size_type i = 0; i < size(); ++i) {
+        char *row = column.data() + i * prop.data.length;
+        auto &overrides = std::vector<RunPlan>::operator[](i).property_overrides;
+        const auto ovrd = overrides.find(name);
+        if (materialised[i] || ovrd == overrides.end()) {
+            memcpy(row, prop.data.ptr, prop.data.length);
+        } else {
+            memcpy(row, ovrd->second.ptr, prop.data.length);
+            overrides.erase(ovrd);
+        }
+    }
+    return &column;
+}
+char *RunPlanVector::propertyStorage(const size_type plan, const std::string &name, const EnvironmentDescription::PropData &prop, std::vector<char> *column) {
+    if (!materialised[plan]) {
+        return column->data() + plan * prop.data.length;
+    }
+    auto &overrides = std::vector<RunPlan>::operator[](plan).property_overrides;
+    auto it = overrides.find(name);
+    if (it == overrides.end()) {
+        it = overrides.emplace(name, prop.data).first;
+    }
+    return static_cast<char*>(it->second.ptr);
+}
+void RunPlanVector::applyColumns(const size_type pos, RunPlan &plan) const {
+    for (const auto &column : property_columns) {
+        const EnvironmentDescription::PropData &prop = environment->at(column.first);
+        plan.property_overrides.erase(column.first);
+        plan.property_overrides.emplace(column.first, util::Any(column.second.data() + pos * prop.data.length, prop.data.length, prop.data.type, prop.data.elements));
+    }
+}
+void RunPlanVector::materialise(const size_type pos) {
+    if (!materialised[pos]) {
+        applyColumns(pos, std::vector<RunPlan>::operator[](pos));
+        materialised[pos] = true;
+    }
+}
+void RunPlanVector::pushPlan(const RunPlan &plan) {
+    RunPlan plan_copy(plan);
+    plan_copy.environment = environment;
+    for (auto &column : property_columns) {
+        const EnvironmentDescription::PropData &prop = environment->at(column.first);
+        const auto ovrd = plan_copy.property_overrides.find(column.first);
+        const char *row = static_cast<const char*>(ovrd == plan_copy.property_overrides.end() ? prop.data.ptr : ovrd->second.ptr);
+        column.second.insert(column.second.end(), row, row + prop.data.length);
+        if (ovrd != plan_copy.property_overrides.end()) {
+            plan_copy.property_overrides.erase(ovrd);
+        }
+    }
+    this->push_back(plan_copy);
+    materialised.push_back(false);
+}
 
 }  // namespace flamegpu
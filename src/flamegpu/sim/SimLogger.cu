@@ -28,6 +28,7 @@ namespace flamegpu {
 
 SimLogger::SimLogger(const std::vector<RunLog> &_run_logs,
         const RunPlanVector &_run_plans,
+        const unsigned int _first_log_index,
         const std::string &_out_directory,
         const std::string &_out_format,
         std::queue<unsigned int> &_log_export_queue,
@@ -35,6 +36,7 @@ SimLogger::SimLogger(const std::vector<RunLog> &_run_logs,
         std::condition_variable &_log_export_queue_cdn)
     : run_logs(_run_logs)
     , run_plans(_run_plans)
+    , first_log_index(_first_log_index)
     , out_directory(_out_directory)
     , out_format(_out_format)
     , log_export_queue(_log_export_queue)
@@ -81,7 +83,7 @@ void SimLogger::start() {
             const path exit_path = p_out_directory/path(run_plans[target_log].getOutputSubdirectory())/path("exit." + out_format);
             const auto exit_logger = io::LoggerFactory::createLogger(exit_path.generic_string(), false, false);
             exit_logger->log(run_logs[target_log], true, false, true);
-            const path step_path = p_out_directory/path(run_plans[target_log].getOutputSubdirectory())/path(std::to_string(target_log)+"."+out_format);
+            const path step_path = p_out_directory/path(run_plans[target_log].getOutputSubdirectory())/path(std::to_string(first_log_index + target_log)+"."+out_format);
             const auto step_logger = io::LoggerFactory::createLogger(step_path.generic_string(), false, false);
             step_logger->log(run_logs[target_log], true, true, false);
 
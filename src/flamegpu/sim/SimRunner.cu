@@ -5,6 +5,8 @@
 #include "flamegpu/model/ModelData.h"
 #include "flamegpu/gpu/CUDASimulation.h"
 #include "flamegpu/sim/RunPlanVector.h"
+#include "flamegpu/sim/EnsembleWorker.h"
+#include "flamegpu/pop/AgentVector.h"
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -24,9 +26,12 @@ SimRunner::SimRunner(const std::shared_ptr<const ModelData> _model,
     unsigned int _runner_id,
     bool _verbose,
     std::vector<RunLog> &_run_logs,
+    std::vector<unsigned char> &_run_failed,
     std::queue<unsigned int> &_log_export_queue,
     std::mutex &_log_export_queue_mutex,
-    std::condition_variable &_log_export_queue_cdn)
+    std::condition_variable &_log_export_queue_cdn,
+    const std::vector<util::StringPairUnorderedMap<std::shared_ptr<const AgentVector>>> &_run_populations,
+    EnsembleWorker *_worker)
       : model(_model->clone())
       , run_id(0)
       , device_id(_device_id)
@@ -38,9 +43,12 @@ SimRunner::SimRunner(const std::shared_ptr<const ModelData> _model,
       , step_log_config(std::move(_step_log_config))
       , exit_log_config(std::move(_exit_log_config))
       , run_logs(_run_logs)
+      , run_failed(_run_failed)
       , log_export_queue(_log_export_queue)
       , log_export_queue_mutex(_log_export_queue_mutex)
-      ,  log_export_queue_cdn(_log_export_queue_cdn) {
+      ,  log_export_queue_cdn(_log_export_queue_cdn)
+      , run_populations(_run_populations)
+      , worker(_worker) {
     this->thread = std::thread(&SimRunner::start, this);
     // Attempt to name the thread
 #ifdef _MSC_VER
@@ -65,19 +73,21 @@ SimRunner::SimRunner(const std::shared_ptr<const ModelData> _model,
 
 void SimRunner::start() {
     // While there are still plans to process
-    while ((this->run_id = next_run++) < plans.size()) {
+    while (nextRun()) {
         try {
+            // Copy of the plan, including the values held in the vector's property columns
+            const RunPlan plan = plans[run_id];
             // Update environment (this might be worth moving into CUDASimulation)
             auto &prop_map = model->environment->properties;
-            for (auto &ovrd : plans[run_id].property_overrides) {
+            for (auto &ovrd : plan.property_overrides) {
                 auto &prop = prop_map.at(ovrd.first);
                 memcpy(prop.data.ptr, ovrd.second.ptr, prop.data.length);
             }
             // Set simulation device
             std::unique_ptr<CUDASimulation> simulation = std::unique_ptr<CUDASimulation>(new CUDASimulation(model));
             // Copy steps and seed from runplan
-            simulation->SimulationConfig().steps = plans[run_id].getSteps();
-            simulation->SimulationConfig().random_seed = plans[run_id].getRandomSimulationSeed();
+            simulation->SimulationConfig().steps = plan.getSteps();
+            simulation->SimulationConfig().random_seed = plan.getRandomSimulationSeed();
             simulation->SimulationConfig().verbose = false;
             simulation->SimulationConfig().timing = false;
             simulation->CUDAConfig().device_id = this->device_id;
@@ -85,9 +95,19 @@ void SimRunner::start() {
             // Set the step config directly, to bypass validation
             simulation->step_log_config = step_log_config;
             simulation->exit_log_config = exit_log_config;
-            // TODO Set population?
+            // Set the initial population, directly from the ensemble's shared copy
+            if (!run_populations.empty()) {
+                for (const auto &pop : run_populations[this->run_id]) {
+                    simulation->setPopulationData(*pop.second, pop.first.second);
+                }
+            }
             // Execute simulation
             simulation->simulate();
+            if (worker) {
+                // Return the log to the coordinator, which writes it to disk
+                worker->sendResult(this->run_id, simulation->getRunLog());
+                continue;
+            }
             // Store results in run_log (use placement new because const members)
             run_logs[this->run_id] = simulation->getRunLog();
             // Notify logger
@@ -100,9 +120,18 @@ void SimRunner::start() {
             if (verbose)
                 printf("\rCUDAEnsemble progress: %u/%u", run_id + 1, static_cast<unsigned int>(plans.size()));
         } catch(std::exception &e) {
+            run_failed[this->run_id] = 1;
+            ++err_ct;
             fprintf(stderr, "\nRun %u failed on device %d, thread %u with exception: \n%s\n", run_id, device_id, runner_id, e.what());
+            if (worker)
+                worker->sendFailure(this->run_id, e.what());
         }
     }
 }
+bool SimRunner::nextRun() {
+    if (worker)
+        return worker->nextRun(this->run_id);
+    return (this->run_id = next_run++) < plans.size();
+}
 
 }  // namespace flamegpu
@@ -0,0 +1,306 @@
+#include "flamegpu/util/TraceRecorder.h"
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+
+namespace {
+/**
+ * A single range, open ranges have end set to 0
+ */
+struct TraceEvent {
+    char label[TraceRecorder::MAX_LABEL_LENGTH + 1];
+    uint64_t begin;
+    uint64_t end;
+};
+/**
+ * A slot of a thread's ring buffer, the range is stored as words so that it can be read whilst being overwritten
+ * sequence is odd whilst the slot is being written, and 2 * (index + 1) once range index has been written
+ */
+struct TraceSlot {
+    static const size_t WORDS = sizeof(TraceEvent) / sizeof(uint64_t);
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> data[WORDS];
+};
+static_assert(sizeof(TraceEvent) % sizeof(uint64_t) == 0, "TraceEvent must be a whole number of words");
+/**
+ * Storage owned by a single recording thread
+ * Only the owning thread writes to the ring buffer, publishing each completed range by incrementing written
+ * The ring buffer is not locked, instead readers discard slots whose sequence changes whilst they are copied
+ */
+struct ThreadBuffer {
+    ThreadBuffer(unsigned int capacity, unsigned int _thread_id, uint64_t _generation)
+        : ring(capacity)
+        , thread_id(_thread_id)
+        , generation(_generation) { }
+    /**
+     * Completed ranges, index i is stored at ring[i % ring.size()]
+     */
+    std::vector<TraceSlot> ring;
+    /**
+     * Total number of completed ranges written to the ring buffer
+     */
+    std::atomic<uint64_t> written = {0};
+    /**
+     * Currently open ranges
+     */
+    TraceEvent stack[TraceRecorder::MAX_DEPTH];
+    /**
+     * Number of currently open ranges, this may exceed MAX_DEPTH
+     */
+    unsigned int depth = 0;
+    /**
+     * Sequential id used in the exported trace
+     */
+    const unsigned int thread_id;
+    /**
+     * Value of the recorder's generation when the buffer was created
+     */
+    const uint64_t generation;
+};
+std::atomic<bool> recording = {false};
+/**
+ * Incremented by start() and clear(), so that threads replace their (now unregistered) buffer on their next range
+ */
+std::atomic<uint64_t> generation = {0};
+/**
+ * Protects registry and events_per_thread, this is only locked when a thread first records within a generation
+ */
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+unsigned int events_per_thread = TraceRecorder::DEFAULT_EVENTS_PER_THREAD;
+/**
+ * The registry shares ownership, so that ranges outlive the thread which recorded them
+ */
+thread_local std::shared_ptr<ThreadBuffer> local_buffer;
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+ThreadBuffer *getThreadBuffer() {
+    if (!local_buffer || local_buffer->generation != generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        local_buffer = std::make_shared<ThreadBuffer>(events_per_thread, static_cast<unsigned int>(registry.size() + 1), generation.load());
+        registry.push_back(local_buffer);
+    }
+    return local_buffer.get();
+}
+/**
+ * Writes range index to it's slot of the buffer, this must only be called by the owning thread
+ */
+void writeEvent(ThreadBuffer &buffer, const uint64_t index, const TraceEvent &event) {
+    TraceSlot &slot = buffer.ring[index % buffer.ring.size()];
+    uint64_t words[TraceSlot::WORDS];
+    memcpy(words, &event, sizeof(TraceEvent));
+    // Mark the slot as being written before any of it's data changes
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < TraceSlot::WORDS; ++i) {
+        slot.data[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+/**
+ * Copies range index from it's slot of the buffer
+ * @return false if the slot did not hold the range for the whole copy, as the owning thread has overwritten it
+ */
+bool readEvent(const ThreadBuffer &buffer, const uint64_t index, TraceEvent &event) {
+    const TraceSlot &slot = buffer.ring[index % buffer.ring.size()];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2)
+        return false;
+    uint64_t words[TraceSlot::WORDS];
+    for (size_t i = 0; i < TraceSlot::WORDS; ++i) {
+        words[i] = slot.data[i].load(std::memory_order_relaxed);
+    }
+    // Order the data loads before re-checking the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        return false;
+    memcpy(&event, words, sizeof(TraceEvent));
+    return true;
+}
+/**
+ * Copies the completed ranges of a buffer, without blocking the owning thread
+ */
+std::vector<TraceEvent> copyEvents(const ThreadBuffer &buffer) {
+    const uint64_t capacity = buffer.ring.size();
+    const uint64_t written = buffer.written.load(std::memory_order_acquire);
+    const uint64_t first = written > capacity ? written - capacity : 0;
+    std::vector<TraceEvent> rtn;
+    rtn.reserve(static_cast<size_t>(written - first));
+    TraceEvent event;
+    for (uint64_t i = first; i < written; ++i) {
+        // Ranges overwritten during the copy are discarded
+        if (readEvent(buffer, i, event))
+            rtn.push_back(event);
+    }
+    return rtn;
+}
+}  // anonymous namespace
+
+void TraceRecorder::start(const unsigned int eventsPerThread) {
+    if (eventsPerThread == 0) {
+        THROW exception::InvalidArgument("eventsPerThread must be greater than 0, "
+            "in TraceRecorder::start()\n");
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (recording.load()) {
+        THROW exception::InvalidOperation("The trace recorder is already recording, "
+            "in TraceRecorder::start()\n");
+    }
+    registry.clear();
+    events_per_thread = eventsPerThread;
+    ++generation;
+    recording.store(true, std::memory_order_release);
+}
+void TraceRecorder::stop() {
+    recording.store(false, std::memory_order_release);
+}
+bool TraceRecorder::isRecording() {
+    return recording.load(std::memory_order_acquire);
+}
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (recording.load()) {
+        THROW exception::InvalidOperation("The trace recorder cannot be cleared whilst recording, "
+            "in TraceRecorder::clear()\n");
+    }
+    registry.clear();
+    ++generation;
+}
+uint64_t TraceRecorder::getEventCount() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    uint64_t rtn = 0;
+    for (const auto &buffer : registry) {
+        rtn += std::min<uint64_t>(buffer->written.load(std::memory_order_acquire), buffer->ring.size());
+    }
+    return rtn;
+}
+uint64_t TraceRecorder::getDroppedEventCount() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    uint64_t rtn = 0;
+    for (const auto &buffer : registry) {
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        if (written > buffer->ring.size())
+            rtn += written - buffer->ring.size();
+    }
+    return rtn;
+}
+void TraceRecorder::exportChromeTrace(const std::string &path) {
+    // Copy the ranges out of each buffer, so the registry isn't locked during output
+    std::vector<std::pair<unsigned int, std::vector<TraceEvent>>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto &buffer : registry) {
+            threads.emplace_back(buffer->thread_id, copyEvents(*buffer));
+        }
+    }
+    uint64_t epoch = std::numeric_limits<uint64_t>::max();
+    for (const auto &thread : threads) {
+        for (const auto &event : thread.second) {
+            epoch = std::min(epoch, event.begin);
+        }
+    }
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+    for (const auto &thread : threads) {
+        // Name each thread, so they are labelled consistently by the viewer
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("thread_name");
+        writer.Key("ph");
+        writer.String("M");
+        writer.Key("pid");
+        writer.Uint(1);
+        writer.Key("tid");
+        writer.Uint(thread.first);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(("thread " + std::to_string(thread.first)).c_str());
+        writer.EndObject();
+        writer.EndObject();
+        for (const auto &event : thread.second) {
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(event.label);
+            writer.Key("cat");
+            writer.String("flamegpu");
+            writer.Key("ph");
+            writer.String("X");
+            writer.Key("ts");
+            writer.Double(static_cast<double>(event.begin - epoch) / 1000.0);
+            writer.Key("dur");
+            writer.Double(static_cast<double>(event.end - event.begin) / 1000.0);
+            writer.Key("pid");
+            writer.Uint(1);
+            writer.Key("tid");
+            writer.Uint(thread.first);
+            writer.EndObject();
+        }
+    }
+    writer.EndArray();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.EndObject();
+    // Perform output
+    std::ofstream out(path, std::ofstream::trunc);
+    if (!out.is_open()) {
+        THROW exception::InvalidFilePath("Unable to open file '%s' for writing, "
+            "in TraceRecorder::exportChromeTrace()\n", path.c_str());
+    }
+    out << s.GetString();
+    out << "\n";
+    out.close();
+}
+void TraceRecorder::push(const char *label) {
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+    ThreadBuffer *buffer = getThreadBuffer();
+    if (buffer->depth < MAX_DEPTH) {
+        TraceEvent &event = buffer->stack[buffer->depth];
+        strncpy(event.label, label, MAX_LABEL_LENGTH);
+        event.label[MAX_LABEL_LENGTH] = '\0';
+        event.begin = now();
+        event.end = 0;
+    }
+    ++buffer->depth;
+}
+void TraceRecorder::pop() {
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+    ThreadBuffer *buffer = getThreadBuffer();
+    // The range may have been opened before recording began
+    if (!buffer->depth)
+        return;
+    --buffer->depth;
+    if (buffer->depth < MAX_DEPTH) {
+        TraceEvent &event = buffer->stack[buffer->depth];
+        event.end = now();
+        writeEvent(*buffer, buffer->written.load(std::memory_order_relaxed), event);
+    }
+}
+
+}  // namespace util
+}  // namespace flamegpu
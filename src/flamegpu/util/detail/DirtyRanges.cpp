@@ -0,0 +1,47 @@
+#include "flamegpu/util/detail/DirtyRanges.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+DirtyRanges::DirtyRanges(size_t _mergeGap)
+    : mergeGap(_mergeGap) { }
+
+void DirtyRanges::mark(size_t offset, size_t length) {
+    if (!length)
+        return;
+    size_t begin = offset;
+    size_t end = offset + length;
+    // The preceding range may reach (or be within merge gap of) the new range
+    auto it = ranges.upper_bound(begin);
+    if (it != ranges.begin()) {
+        const auto prev = std::prev(it);
+        if (prev->second + mergeGap >= begin) {
+            it = prev;
+        }
+    }
+    // Absorb every range which begins before (or within merge gap of) the end of the new range
+    while (it != ranges.end() && it->first <= end + mergeGap) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = ranges.erase(it);
+    }
+    ranges.emplace(begin, end);
+}
+void DirtyRanges::clear() {
+    ranges.clear();
+}
+size_t DirtyRanges::getBytes() const {
+    size_t rtn = 0;
+    for (const auto &r : ranges) {
+        rtn += r.second - r.first;
+    }
+    return rtn;
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
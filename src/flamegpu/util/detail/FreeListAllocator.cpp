@@ -0,0 +1,108 @@
+#include "flamegpu/util/detail/FreeListAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+const ptrdiff_t FreeListAllocator::OUT_OF_SPACE;
+
+FreeListAllocator::FreeListAllocator(size_t _capacity)
+    : capacity(_capacity) { }
+
+ptrdiff_t FreeListAllocator::allocate(size_t length, size_t alignment) {
+    assert(length > 0);
+    assert(alignment > 0);
+    // Search the size class of the region, and then the first block of each larger class
+    for (unsigned int c = sizeClass(length); c < SIZE_CLASSES; ++c) {
+        for (const size_t &block_offset : size_classes[c]) {
+            const auto block = free_blocks.find(block_offset);
+            const size_t block_end = block->first + block->second;
+            const size_t rtn = (block->first + alignment - 1) / alignment * alignment;
+            if (rtn < block_end && length <= block_end - rtn) {
+                const size_t offset = block->first;
+                eraseFree(block);
+                // Return the padding and remainder, neither can be adjacent to another free block
+                if (rtn != offset)
+                    insertFree(offset, rtn - offset);
+                if (rtn + length != block_end)
+                    insertFree(rtn + length, block_end - rtn - length);
+                allocated += length;
+                return static_cast<ptrdiff_t>(rtn);
+            }
+        }
+    }
+    // Allocate from the end of the used space
+    const size_t rtn = (end + alignment - 1) / alignment * alignment;
+    if (rtn < end || rtn > capacity || length > capacity - rtn)
+        return OUT_OF_SPACE;
+    const size_t padding_offset = end;
+    end = rtn + length;
+    if (rtn != padding_offset)
+        insertFree(padding_offset, rtn - padding_offset);
+    allocated += length;
+    return static_cast<ptrdiff_t>(rtn);
+}
+void FreeListAllocator::deallocate(ptrdiff_t offset, size_t length) {
+    assert(offset >= 0 && static_cast<size_t>(offset) + length <= end);
+    assert(length <= allocated);
+    allocated -= length;
+    insertFree(static_cast<size_t>(offset), length);
+}
+size_t FreeListAllocator::getLargestFreeBlock() const {
+    size_t rtn = capacity - end;
+    // Only the highest occupied size class can contain the largest block
+    for (unsigned int c = SIZE_CLASSES; c > 0; --c) {
+        if (!size_classes[c - 1].empty()) {
+            for (const size_t &block_offset : size_classes[c - 1]) {
+                rtn = std::max(rtn, free_blocks.at(block_offset));
+            }
+            break;
+        }
+    }
+    return rtn;
+}
+unsigned int FreeListAllocator::sizeClass(size_t length) {
+    unsigned int rtn = 0;
+    while (length >>= 1)
+        ++rtn;
+    return rtn;
+}
+void FreeListAllocator::insertFree(size_t offset, size_t length) {
+    if (!length)
+        return;
+    // Merge with the following block
+    auto next = free_blocks.find(offset + length);
+    if (next != free_blocks.end()) {
+        length += next->second;
+        eraseFree(next);
+    }
+    // Merge with the preceding block
+    next = free_blocks.lower_bound(offset);
+    if (next != free_blocks.begin()) {
+        const auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            length += prev->second;
+            eraseFree(prev);
+        }
+    }
+    if (offset + length == end) {
+        // Rollback end
+        end = offset;
+    } else {
+        free_blocks.emplace(offset, length);
+        size_classes[sizeClass(length)].insert(offset);
+    }
+}
+void FreeListAllocator::eraseFree(std::map<size_t, size_t>::iterator it) {
+    size_classes[sizeClass(it->second)].erase(it->first);
+    free_blocks.erase(it);
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
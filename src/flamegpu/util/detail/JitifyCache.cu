@@ -348,24 +348,9 @@ std::unique_ptr<KernelInstantiation> JitifyCache::compileKernel(const std::strin
 std::unique_ptr<KernelInstantiation> JitifyCache::loadKernel(const std::string &func_name, const std::vector<std::string> &template_args, const std::string &kernel_src, const std::string &dynamic_header) {
     NVTX_RANGE("JitifyCache::loadKernel");
     std::lock_guard<std::mutex> lock(cache_mutex);
-    // Detect current compute capability=
-    int currentDeviceIdx = 0;
-    cudaError_t status = cudaGetDevice(&currentDeviceIdx);
-    const std::string arch = std::to_string((status == cudaSuccess) ? compute_capability::getComputeCapability(currentDeviceIdx) : 0);
-    status = cudaRuntimeGetVersion(&currentDeviceIdx);
-    const std::string cuda_version = std::to_string((status == cudaSuccess) ? currentDeviceIdx : 0);
-    const std::string seatbelts = std::to_string(SEATBELTS);
     // Cat kernel, dynamic header, header version
     const std::string long_reference = kernel_src + dynamic_header;  // Don't need to include rest, they are explicit in short reference/filename
-    // Generate short reference string
-    // Would prefer to use a proper hash, e.g. md5(reference_string), but that requires extra dependencies
-    const std::string short_reference =
-        cuda_version + "_" +
-        arch + "_" +
-        seatbelts + "_" +
-        std::string(flamegpu::VERSION_FULL) + "_" +
-        // Use jitify hash methods for consistent hashing between OSs
-        std::to_string(hash_combine(hash_larson64(kernel_src.c_str()), hash_larson64(dynamic_header.c_str())));
+    const std::string short_reference = getCacheKey(kernel_src, dynamic_header);
     // Does a copy with the right reference exist in memory?
     if (use_memory_cache) {
         const auto it = cache.find(short_reference);
@@ -418,6 +403,40 @@ std::unique_ptr<KernelInstantiation> JitifyCache::loadKernel(const std::string &
         return kernelinst;
     }
 }
+bool JitifyCache::isCached(const std::string &kernel_src, const std::string &dynamic_header) const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    const std::string long_reference = kernel_src + dynamic_header;
+    const std::string short_reference = getCacheKey(kernel_src, dynamic_header);
+    if (use_memory_cache) {
+        const auto it = cache.find(short_reference);
+        if (it != cache.end() && it->second.long_reference == long_reference) {
+            return true;
+        }
+    }
+    if (use_disk_cache) {
+        const path cache_file = getTMP() / short_reference;
+        const path reference_file = cache_file.parent_path() / path(cache_file.filename().string() + ".ref");
+        return exists(cache_file) && loadFile(reference_file) == long_reference;
+    }
+    return false;
+}
+std::string JitifyCache::getCacheKey(const std::string &kernel_src, const std::string &dynamic_header) {
+    // Detect current compute capability=
+    int currentDeviceIdx = 0;
+    cudaError_t status = cudaGetDevice(&currentDeviceIdx);
+    const std::string arch = std::to_string((status == cudaSuccess) ? compute_capability::getComputeCapability(currentDeviceIdx) : 0);
+    status = cudaRuntimeGetVersion(&currentDeviceIdx);
+    const std::string cuda_version = std::to_string((status == cudaSuccess) ? currentDeviceIdx : 0);
+    const std::string seatbelts = std::to_string(SEATBELTS);
+    // Generate short reference string
+    // Would prefer to use a proper hash, e.g. md5(reference_string), but that requires extra dependencies
+    return cuda_version + "_" +
+        arch + "_" +
+        seatbelts + "_" +
+        std::string(flamegpu::VERSION_FULL) + "_" +
+        // Use jitify hash methods for consistent hashing between OSs
+        std::to_string(hash_combine(hash_larson64(kernel_src.c_str()), hash_larson64(dynamic_header.c_str())));
+}
 void JitifyCache::useMemoryCache(bool yesno) {
     std::lock_guard<std::mutex> lock(cache_mutex);
     use_memory_cache = yesno;
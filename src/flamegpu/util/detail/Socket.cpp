@@ -0,0 +1,228 @@
+#include "flamegpu/util/detail/Socket.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+namespace {
+#ifdef _WIN32
+const Socket::Handle INVALID_HANDLE = INVALID_SOCKET;
+int lastError() { return WSAGetLastError(); }
+void closeHandle(Socket::Handle h) { closesocket(h); }
+int pollHandles(WSAPOLLFD *fds, size_t count, int timeout_ms) { return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms); }
+typedef WSAPOLLFD PollFD;
+typedef int SendLength;
+#else
+const Socket::Handle INVALID_HANDLE = -1;
+int lastError() { return errno; }
+void closeHandle(Socket::Handle h) { ::close(h); }
+int pollHandles(pollfd *fds, size_t count, int timeout_ms) { return ::poll(fds, static_cast<nfds_t>(count), timeout_ms); }
+typedef pollfd PollFD;
+typedef size_t SendLength;
+#endif
+// Prevent writes to a closed connection raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+/**
+ * Resolves a host and port to an IPv4 address
+ */
+sockaddr_in resolve(const std::string &host, const uint16_t port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(addrinfo));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        THROW exception::EnsembleNetworkError("Unable to resolve host '%s', in Socket::resolve()", host.c_str());
+    }
+    sockaddr_in addr;
+    memcpy(&addr, result->ai_addr, sizeof(sockaddr_in));
+    addr.sin_port = htons(port);
+    freeaddrinfo(result);
+    return addr;
+}
+}  // namespace
+
+Socket::Socket()
+    : handle(INVALID_HANDLE) { }
+Socket::Socket(const Handle _handle)
+    : handle(_handle) { }
+Socket::~Socket() {
+    close();
+}
+Socket::Socket(Socket &&other) noexcept
+    : handle(other.handle) {
+    other.handle = INVALID_HANDLE;
+}
+Socket &Socket::operator=(Socket &&other) noexcept {
+    if (this != &other) {
+        close();
+        handle = other.handle;
+        other.handle = INVALID_HANDLE;
+    }
+    return *this;
+}
+void Socket::initialise() {
+#ifdef _WIN32
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            THROW exception::EnsembleNetworkError("WSAStartup() failed, in Socket::initialise()");
+        }
+    });
+#endif
+}
+Socket Socket::listen(const std::string &host, const uint16_t port) {
+    initialise();
+    const sockaddr_in addr = resolve(host, port);
+    Socket rtn(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (!rtn.isOpen()) {
+        THROW exception::EnsembleNetworkError("Unable to create socket (error %d), in Socket::listen()", lastError());
+    }
+    // Allow the port to be reused immediately after a previous coordinator exits
+    const int reuse = 1;
+    setsockopt(rtn.handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(int));
+    if (::bind(rtn.handle, reinterpret_cast<const sockaddr*>(&addr), sizeof(sockaddr_in)) != 0) {
+        THROW exception::EnsembleNetworkError("Unable to bind to %s:%u (error %d), in Socket::listen()", host.c_str(), port, lastError());
+    }
+    if (::listen(rtn.handle, SOMAXCONN) != 0) {
+        THROW exception::EnsembleNetworkError("Unable to listen on %s:%u (error %d), in Socket::listen()", host.c_str(), port, lastError());
+    }
+    return rtn;
+}
+Socket Socket::connect(const std::string &host, const uint16_t port) {
+    initialise();
+    const sockaddr_in addr = resolve(host, port);
+    Socket rtn(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (!rtn.isOpen()) {
+        THROW exception::EnsembleNetworkError("Unable to create socket (error %d), in Socket::connect()", lastError());
+    }
+    if (::connect(rtn.handle, reinterpret_cast<const sockaddr*>(&addr), sizeof(sockaddr_in)) != 0) {
+        THROW exception::EnsembleNetworkError("Unable to connect to %s:%u (error %d), in Socket::connect()", host.c_str(), port, lastError());
+    }
+    // Messages are small and latency sensitive
+    const int no_delay = 1;
+    setsockopt(rtn.handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(int));
+    return rtn;
+}
+void Socket::parseAddress(const std::string &address, std::string &host, uint16_t &port) {
+    const size_t pos = address.rfind(':');
+    if (pos == std::string::npos || pos == 0 || pos + 1 == address.size()) {
+        THROW exception::InvalidArgument("Address '%s' is not of the form 'host:port', in Socket::parseAddress()", address.c_str());
+    }
+    char *end = nullptr;
+    const unsigned long p = strtoul(address.c_str() + pos + 1, &end, 10);  // NOLINT(runtime/int)
+    if (*end != '\0' || p > UINT16_MAX) {
+        THROW exception::InvalidArgument("Address '%s' does not contain a valid port, in Socket::parseAddress()", address.c_str());
+    }
+    host = address.substr(0, pos);
+    port = static_cast<uint16_t>(p);
+}
+Socket Socket::accept() {
+    Socket rtn(::accept(handle, nullptr, nullptr));
+    if (!rtn.isOpen()) {
+        THROW exception::EnsembleNetworkError("Unable to accept connection (error %d), in Socket::accept()", lastError());
+    }
+    const int no_delay = 1;
+    setsockopt(rtn.handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(int));
+    return rtn;
+}
+uint16_t Socket::getPort() const {
+    sockaddr_in addr;
+    socklen_t length = sizeof(sockaddr_in);
+    if (getsockname(handle, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        THROW exception::EnsembleNetworkError("Unable to query socket (error %d), in Socket::getPort()", lastError());
+    }
+    return ntohs(addr.sin_port);
+}
+bool Socket::isOpen() const {
+    return handle != INVALID_HANDLE;
+}
+void Socket::close() {
+    if (handle != INVALID_HANDLE) {
+        closeHandle(handle);
+        handle = INVALID_HANDLE;
+    }
+}
+void Socket::sendAll(const void *data, size_t length) {
+    const char *ptr = static_cast<const char*>(data);
+    while (length) {
+        const auto sent = ::send(handle, ptr, static_cast<SendLength>(length), SEND_FLAGS);
+        if (sent <= 0) {
+            THROW exception::EnsembleNetworkError("Connection failed (error %d), in Socket::sendAll()", lastError());
+        }
+        ptr += sent;
+        length -= static_cast<size_t>(sent);
+    }
+}
+bool Socket::receiveAll(void *data, size_t length) {
+    char *ptr = static_cast<char*>(data);
+    bool partial = false;
+    while (length) {
+        const auto received = ::recv(handle, ptr, static_cast<SendLength>(length), 0);
+        if (received == 0 && !partial) {
+            return false;
+        } else if (received <= 0) {
+            THROW exception::EnsembleNetworkError("Connection failed (error %d), in Socket::receiveAll()", received ? lastError() : 0);
+        }
+        partial = true;
+        ptr += received;
+        length -= static_cast<size_t>(received);
+    }
+    return true;
+}
+size_t Socket::receiveSome(void *data, const size_t length) {
+    const auto received = ::recv(handle, static_cast<char*>(data), static_cast<SendLength>(length), 0);
+    if (received < 0) {
+        THROW exception::EnsembleNetworkError("Connection failed (error %d), in Socket::receiveSome()", lastError());
+    }
+    return static_cast<size_t>(received);
+}
+std::vector<size_t> Socket::poll(const std::vector<const Socket*> &sockets, const int timeout_ms) {
+    std::vector<PollFD> fds(sockets.size());
+    for (size_t i = 0; i < sockets.size(); ++i) {
+        fds[i].fd = sockets[i]->handle;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    std::vector<size_t> rtn;
+    if (pollHandles(fds.data(), fds.size(), timeout_ms) > 0) {
+        for (size_t i = 0; i < fds.size(); ++i) {
+            // Errors and hang ups are reported as readable, so that the following receive observes them
+            if (fds[i].revents & (POLLIN | POLLERR | POLLHUP))
+                rtn.push_back(i);
+        }
+    }
+    return rtn;
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
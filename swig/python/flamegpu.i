@@ -52,8 +52,10 @@ using namespace flamegpu; // @todo - is this required? Ideally it shouldn't be,
 %include <std_string.i>
 %include <std_vector.i>
 %include <std_unordered_map.i>
+%include <std_map.i>
 %include <std_array.i>
 %include <std_list.i>
+%include <std_set.i>
 %include <stdint.i>
 
 // argc/argv support
@@ -79,6 +81,9 @@ using namespace flamegpu; // @todo - is this required? Ideally it shouldn't be,
 %template(UInt64Vector) std::vector<uint64_t>;
 %template(FloatVector) std::vector<float>;
 %template(DoubleVector) std::vector<double>;
+%template(StringDoubleMap) std::map<std::string, double>;
+%template(StringDoubleMapVector) std::vector<std::map<std::string, double>>;
+%template(StringDoubleMapList) std::list<std::map<std::string, double>>;
 //%template(BoolVector) std::vector<bool>;
 //%template(DoubleVector) std::vector<double>;
 
@@ -308,7 +313,12 @@ class FLAMEGPURuntimeException : public std::exception {
 %ignore flamegpu::ModelDescription::addStepFunction;
 %ignore flamegpu::ModelDescription::addExitFunction;
 %ignore flamegpu::ModelDescription::addExitCondition;
+%ignore flamegpu::ModelDescription::addConcurrentStepFunction;
+%ignore flamegpu::ModelDescription::addConcurrentExitCondition;
 %ignore flamegpu::LayerDescription::addHostFunction;
+%ignore flamegpu::LayerDescription::addConcurrentHostFunction;
+%ignore flamegpu::detail::registerHostFunctionName;
+%ignore flamegpu::detail::getHostFunctionName;
 
 // Disable functions which use C++ iterators/type_index
 %ignore flamegpu::AgentVector::const_iterator;
@@ -332,6 +342,7 @@ class FLAMEGPURuntimeException : public std::exception {
 %ignore flamegpu::AgentVector::data;
 
 %ignore flamegpu::VarOffsetStruct; // not required but defined in HostNewAgentAPI
+%ignore flamegpu::NewAgentArena; // not required but defined in HostNewAgentAPI
 
 // Disable functions which use C++ iterators/type_index
 %ignore flamegpu::DeviceAgentVector_impl::const_iterator;
@@ -359,6 +370,17 @@ class FLAMEGPURuntimeException : public std::exception {
 // RunPlanVector::SetPropertyRandom takes a c++ std::distribution as an argument, so not appropriate for wrapping.
 %ignore flamegpu::RunPlanVector::setPropertyRandom;
 
+// Adaptive sampling takes std::function callbacks, which are not wrapped.
+%ignore flamegpu::CUDAEnsemble::simulate(const RunPlanVector &, const AdaptiveSampling &);
+%ignore flamegpu::CUDAEnsemble::AdaptiveSampling;
+%ignore flamegpu::CUDAEnsemble::AdaptiveResult;
+%ignore flamegpu::CUDAEnsemble::getAdaptiveResults;
+%ignore flamegpu::CUDAEnsemble::seedStep;
+%ignore flamegpu::CUDAEnsemble::confidenceInterval;
+
+// StringPairUnorderedMap is not wrapped, so initial populations can only be loaded from file in python.
+%ignore flamegpu::CUDAEnsemble::setInitialPopulation;
+
 // Ignore const'd accessors for configuration structs, which were mutable in python.
 %ignore flamegpu::CUDASimulation::getCUDAConfig;
 %ignore flamegpu::CUDAEnsemble::getConfig;
@@ -392,6 +414,8 @@ class FLAMEGPURuntimeException : public std::exception {
 // Renames which require flatnested, as swig/python does not support nested classes.
 %feature("flatnested");     // flat nested on to ensure Config is included
     %rename (CUDASimulation_Config) flamegpu::CUDASimulation::Config;
+    %rename (CUDASimulation_MemoryUsage) flamegpu::CUDASimulation::MemoryUsage;
+    %rename (CUDASimulation_EnvironmentUploads) flamegpu::CUDASimulation::EnvironmentUploads;
     %rename (Simulation_Config) flamegpu::Simulation::Config;
 
     %rename (MessageBruteForce_Description) flamegpu::MessageBruteForce::Description;
@@ -404,6 +428,7 @@ class FLAMEGPURuntimeException : public std::exception {
     %rename (MessageBucket_Description) flamegpu::MessageBucket::Description;
 
     %rename (CUDAEnsembleConfig) flamegpu::CUDAEnsemble::EnsembleConfig;
+    %rename (RunPlanVector_PropertyRange) flamegpu::RunPlanVector::PropertyRange;
 %feature("flatnested", ""); // flat nested off
 
 // Director features. These go before the %includes.
@@ -469,6 +494,13 @@ class ModelVis;
 
 %include "flamegpu/sim/AgentInterface.h"
 
+// Callbacks are named by their Python class, which labels them in timing reports
+%pythonappend flamegpu::HostFunctionCallback::HostFunctionCallback %{
+    self.setName(type(self).__name__)
+%}
+%pythonappend flamegpu::HostFunctionConditionCallback::HostFunctionConditionCallback %{
+    self.setName(type(self).__name__)
+%}
 %include "flamegpu/runtime/HostFunctionCallback.h"
 
 %feature("flatnested");     // flat nested on
@@ -495,6 +527,7 @@ class ModelVis;
 
 %include "flamegpu/model/EnvironmentDescription.h"
 %include "flamegpu/model/ModelDescription.h"
+%template(LayerMergeVector) std::vector<flamegpu::LayerMerge>;
 %include "flamegpu/model/HostFunctionDescription.h"
 %include "flamegpu/model/AgentDescription.h"
 %include "flamegpu/model/AgentFunctionDescription.h"
@@ -503,6 +536,14 @@ class ModelVis;
 %include "flamegpu/model/SubAgentDescription.h"
 %include "flamegpu/model/SubEnvironmentDescription.h"
 
+%feature("flatnested");     // flat nested on to ensure AgentUsage is included
+%include "flamegpu/model/VariableUsageAnalysis.h"
+%feature("flatnested", ""); // flat nested off
+%template(StringSet) std::set<std::string>;
+%template(StringVector) std::vector<std::string>;
+%template(StringAgentUsageMap) std::map<std::string, flamegpu::VariableUsageAnalysis::AgentUsage>;
+%template(StringStringSetMap) std::map<std::string, std::set<std::string>>;
+
 %include "flamegpu/runtime/utility/RandomManager.cuh"
 
 // Include Simulation and CUDASimulation
@@ -510,6 +551,8 @@ class ModelVis;
 %include "flamegpu/sim/Simulation.h"
 %include "flamegpu/gpu/CUDASimulation.h"
 %feature("flatnested", ""); // flat nested off
+%template(StringMemoryUsageMap) std::map<std::string, flamegpu::CUDASimulation::MemoryUsage>;
+%template(EnvironmentUploadsVector) std::vector<flamegpu::CUDASimulation::EnvironmentUploads>;
 
 %feature("flatnested");     // flat nested on to ensure Config is included
 %include "flamegpu/gpu/CUDAEnsemble.h"
@@ -543,7 +586,10 @@ class ModelVis;
 
 // Include ensemble implementations
 %include "flamegpu/sim/RunPlan.h"
+%feature("flatnested");     // flat nested on, for RunPlanVector::PropertyRange
 %include "flamegpu/sim/RunPlanVector.h"
+%feature("flatnested", ""); // flat nested off
+%template(RunPlanVector_PropertyRangeVector) std::vector<flamegpu::RunPlanVector::PropertyRange>;
 
 // %extend classes go after %includes, but before tempalates (that use them)
 // -----------------
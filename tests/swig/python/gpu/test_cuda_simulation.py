@@ -255,6 +255,23 @@ class TestSimulation(TestCase):
         assert externalCounter == 3
         assert c.getStepCounter() == 3
 
+    def test_host_function_callback_names(self):
+        # Python callbacks are labelled by their class in host function timings
+        m = pyflamegpu.ModelDescription("test_host_function_callback_names")
+        m.newAgent("Agent")
+        inc = IncrementCounter()
+        assert inc.getName() == "IncrementCounter"
+        m.addStepFunctionCallback(inc)
+        c = pyflamegpu.CUDASimulation(m)
+        c.SimulationConfig().steps = 2
+        c.SimulationConfig().timing = True
+        c.simulate()
+        assert "step function IncrementCounter" in c.getElapsedTimeHostFunctions()
+        steps = c.getElapsedTimeHostFunctionSteps()
+        assert len(steps) == 2
+        for step in steps:
+            assert "step function IncrementCounter" in step
+
     DeathFunc = """
         FLAMEGPU_AGENT_FUNCTION(DeathFunc, flamegpu::MessageNone, flamegpu::MessageNone) {
             unsigned int x = FLAMEGPU->getVariable<unsigned int>("x");
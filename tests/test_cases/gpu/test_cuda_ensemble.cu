@@ -1,7 +1,12 @@
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "flamegpu/flamegpu.h"
+#include "flamegpu/sim/EnsembleProtocol.h"
+#include "flamegpu/util/detail/Socket.h"
 
 #include "gtest/gtest.h"
 
@@ -349,6 +354,425 @@ TEST(TestCUDAEnsemble, getEnsembleElapsedTime) {
     double threshold = sleepDurationSeconds * 0.8;
     EXPECT_GE(elapsedSeconds, threshold);
 }
+FLAMEGPU_EXIT_FUNCTION(adaptiveExit) {
+    // The metric's variance is controlled by the configuration
+    const float spread = FLAMEGPU->environment.getProperty<float>("spread");
+    FLAMEGPU->environment.setProperty<float>("metric", 10.0f + spread * FLAMEGPU->random.uniform<float>());
+}
+TEST(TestCUDAEnsemble, confidenceInterval) {
+    std::vector<RunLog> logs(4);
+    std::vector<double> values = {1.0, 1.0, 1.0, 1.0};
+    auto metric = [&logs, &values](const RunLog &log) { return values[&log - logs.data()]; };
+    auto criterion = CUDAEnsemble::confidenceInterval(metric, 0.1);
+    std::vector<const RunLog*> ptrs;
+    // At least 2 samples are required
+    EXPECT_EQ(criterion(ptrs), 2u);
+    ptrs.push_back(&logs[0]);
+    EXPECT_EQ(criterion(ptrs), 1u);
+    // No variance
+    ptrs.push_back(&logs[1]);
+    EXPECT_EQ(criterion(ptrs), 0u);
+    // mean 1.5, s = sqrt(1/3), half width = 1.96 * s / 2 = 0.566
+    values = {1.0, 2.0, 1.0, 2.0};
+    ptrs.push_back(&logs[2]);
+    ptrs.push_back(&logs[3]);
+    // Requires (1.96 * s / 0.1)^2 = 128.05 samples in total
+    EXPECT_EQ(criterion(ptrs), 129u - 4u);
+    EXPECT_EQ(CUDAEnsemble::confidenceInterval(metric, 0.6)(ptrs), 0u);
+    // Relative threshold of 0.4 * 1.5 = 0.6
+    EXPECT_EQ(CUDAEnsemble::confidenceInterval(metric, 0.4, true)(ptrs), 0u);
+    EXPECT_GT(CUDAEnsemble::confidenceInterval(metric, 0.3, true)(ptrs), 0u);
+}
+TEST(TestCUDAEnsemble, simulateAdaptive) {
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<float>("spread", 0.0f);
+    model.Environment().newProperty<float>("metric", 0.0f);
+    model.newAgent("Agent");
+    model.addExitFunction(adaptiveExit);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    // Configuration 0 has no variance, configuration 1 requires further replicates
+    flamegpu::RunPlanVector plans(model, 2);
+    plans.setSteps(1);
+    plans.setRandomSimulationSeed(1000, 1000);
+    plans[1].setProperty<float>("spread", 4.0f);
+    flamegpu::CUDAEnsemble ensemble(model);
+    ensemble.Config().quiet = true;
+    ensemble.Config().out_format = "";  // Suppress warning
+    ensemble.setExitLog(lcfg);
+    CUDAEnsemble::AdaptiveSampling sampling;
+    sampling.min_replicates = 3;
+    sampling.max_replicates = 20;
+    sampling.max_batch = 4;
+    // Invalid configs
+    EXPECT_THROW(ensemble.simulate(plans, sampling), exception::InvalidArgument);
+    sampling.replicate = CUDAEnsemble::seedStep(1);
+    sampling.criterion = CUDAEnsemble::confidenceInterval([](const RunLog &log) {
+        return log.getExitLog().getEnvironmentProperty<float>("metric");
+    }, 0.25);
+    sampling.min_replicates = 0;
+    EXPECT_THROW(ensemble.simulate(plans, sampling), exception::InvalidArgument);
+    sampling.min_replicates = 3;
+    ensemble.simulate(plans, sampling);
+    const auto &results = ensemble.getAdaptiveResults();
+    ASSERT_EQ(results.size(), 2u);
+    // Configuration 0 converges after the minimum replicates
+    EXPECT_TRUE(results[0].converged);
+    EXPECT_EQ(results[0].replicates, 3u);
+    // Configuration 1 requires approximately (1.96 * 4 / sqrt(12) / 0.25)^2 = 85 replicates, so is stopped at the maximum
+    EXPECT_FALSE(results[1].converged);
+    EXPECT_EQ(results[1].replicates, 20u);
+    // Replicates use stepped seeds
+    for (unsigned int c = 0; c < results.size(); ++c) {
+        ASSERT_EQ(results[c].logs.size(), results[c].replicates);
+        for (unsigned int r = 0; r < results[c].replicates; ++r) {
+            EXPECT_EQ(results[c].logs[r].getRandomSeed(), 1000u * (c + 1) + r);
+        }
+    }
+    // getLogs() returns every run
+    EXPECT_EQ(ensemble.getLogs().size(), 23u);
+    // A standard simulate() clears the results
+    ensemble.simulate(plans);
+    EXPECT_TRUE(ensemble.getAdaptiveResults().empty());
+    EXPECT_EQ(ensemble.getLogs().size(), 2u);
+}
+TEST(TestCUDAEnsemble, simulateDistributed) {
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<float>("spread", 1.0f);
+    model.Environment().newProperty<float>("metric", 0.0f);
+    model.newAgent("Agent");
+    model.addExitFunction(adaptiveExit);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    flamegpu::RunPlanVector plans(model, 8);
+    plans.setSteps(1);
+    plans.setRandomSimulationSeed(1000, 1);
+    // Reference results, from a local ensemble
+    flamegpu::CUDAEnsemble local(model);
+    local.Config().quiet = true;
+    local.Config().out_format = "";  // Suppress warning
+    local.setExitLog(lcfg);
+    local.simulate(plans);
+    // Find a free port
+    const uint16_t port = util::detail::Socket::listen("127.0.0.1", 0).getPort();
+    const std::string address = "127.0.0.1:" + std::to_string(port);
+    // Coordinator
+    flamegpu::CUDAEnsemble coordinator(model);
+    coordinator.Config().quiet = true;
+    coordinator.Config().out_format = "";  // Suppress warning
+    coordinator.Config().listen_address = address;
+    coordinator.setExitLog(lcfg);
+    // Both roles can't be set at once
+    coordinator.Config().coordinator_address = address;
+    EXPECT_THROW(coordinator.simulate(plans), exception::InvalidArgument);
+    coordinator.Config().coordinator_address = "";
+    std::thread coordinator_thread([&coordinator, &plans]() { coordinator.simulate(plans); });
+    // A worker with a different number of plans is rejected
+    flamegpu::RunPlanVector wrong_plans(model, 3);
+    wrong_plans.setSteps(1);
+    flamegpu::CUDAEnsemble rejected(model);
+    rejected.Config().quiet = true;
+    rejected.Config().coordinator_address = address;
+    EXPECT_THROW(rejected.simulate(wrong_plans), exception::EnsembleNetworkError);
+    // A worker which disconnects after being assigned a run, the run is reassigned
+    {
+        util::detail::Socket fake = util::detail::Socket::connect("127.0.0.1", port);
+        std::string payload;
+        EnsembleProtocol::write(payload, EnsembleProtocol::VERSION);
+        EnsembleProtocol::write(payload, static_cast<uint64_t>(plans.size()));
+        EnsembleProtocol::write(payload, model.getName());
+        EnsembleProtocol::send(fake, EnsembleProtocol::Hello, payload);
+        EnsembleProtocol::Message type;
+        ASSERT_TRUE(EnsembleProtocol::receive(fake, type, payload));
+        ASSERT_EQ(type, EnsembleProtocol::Welcome);
+        EnsembleProtocol::send(fake, EnsembleProtocol::Request);
+        ASSERT_TRUE(EnsembleProtocol::receive(fake, type, payload));
+        ASSERT_EQ(type, EnsembleProtocol::Assign);
+    }
+    // A worker which executes every run
+    flamegpu::CUDAEnsemble worker(model);
+    worker.Config().quiet = true;
+    worker.Config().out_format = "";  // Suppress warning
+    worker.Config().coordinator_address = address;
+    worker.setExitLog(lcfg);
+    EXPECT_NO_THROW(worker.simulate(plans));
+    coordinator_thread.join();
+    // The coordinator holds every log, matching the local ensemble
+    const std::vector<RunLog> &expected = local.getLogs();
+    const std::vector<RunLog> &logs = coordinator.getLogs();
+    ASSERT_EQ(logs.size(), expected.size());
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        EXPECT_EQ(logs[i].getRandomSeed(), expected[i].getRandomSeed());
+        EXPECT_EQ(logs[i].getExitLog().getStepCount(), expected[i].getExitLog().getStepCount());
+        EXPECT_EQ(logs[i].getExitLog().getEnvironmentProperty<float>("metric"), expected[i].getExitLog().getEnvironmentProperty<float>("metric"));
+    }
+    // Adaptive sampling is not supported
+    CUDAEnsemble::AdaptiveSampling sampling;
+    sampling.replicate = CUDAEnsemble::seedStep(1);
+    sampling.criterion = [](const std::vector<const RunLog*> &) { return 0u; };
+    EXPECT_THROW(worker.simulate(plans, sampling), exception::InvalidArgument);
+}
+TEST(TestCUDAEnsemble, simulateDistributedConcurrentRuns) {
+    // Each worker has fewer runners than plans, so runners wait for their next run while others return results
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<float>("spread", 1.0f);
+    model.Environment().newProperty<float>("metric", 0.0f);
+    model.newAgent("Agent");
+    model.addExitFunction(adaptiveExit);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    flamegpu::RunPlanVector plans(model, 12);
+    plans.setSteps(1);
+    plans.setRandomSimulationSeed(2000, 1);
+    const uint16_t port = util::detail::Socket::listen("127.0.0.1", 0).getPort();
+    const std::string address = "127.0.0.1:" + std::to_string(port);
+    flamegpu::CUDAEnsemble coordinator(model);
+    coordinator.Config().quiet = true;
+    coordinator.Config().out_format = "";  // Suppress warning
+    coordinator.Config().listen_address = address;
+    coordinator.setExitLog(lcfg);
+    std::thread coordinator_thread([&coordinator, &plans]() { coordinator.simulate(plans); });
+    std::vector<std::thread> worker_threads;
+    std::atomic<unsigned int> worker_errors = {0};
+    for (unsigned int w = 0; w < 2; ++w) {
+        worker_threads.emplace_back([&model, &plans, &lcfg, &address, &worker_errors]() {
+            flamegpu::CUDAEnsemble worker(model);
+            worker.Config().quiet = true;
+            worker.Config().out_format = "";  // Suppress warning
+            worker.Config().concurrent_runs = 2;
+            worker.Config().devices = {0};
+            worker.Config().coordinator_address = address;
+            worker.setExitLog(lcfg);
+            try {
+                worker.simulate(plans);
+            } catch (std::exception &) {
+                ++worker_errors;
+            }
+        });
+    }
+    for (auto &t : worker_threads) {
+        t.join();
+    }
+    coordinator_thread.join();
+    EXPECT_EQ(worker_errors.load(), 0u);
+    const std::vector<RunLog> &logs = coordinator.getLogs();
+    ASSERT_EQ(logs.size(), plans.size());
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        EXPECT_EQ(logs[i].getRandomSeed(), 2000u + i);
+        EXPECT_EQ(logs[i].getExitLog().getStepCount(), 1u);
+    }
+}
+TEST(TestCUDAEnsemble, distributedMessageLimit) {
+    util::detail::Socket listener = util::detail::Socket::listen("127.0.0.1", 0);
+    util::detail::Socket sender = util::detail::Socket::connect("127.0.0.1", listener.getPort());
+    util::detail::Socket receiver = listener.accept();
+    // Header claiming a payload larger than the limit
+    const uint32_t type = EnsembleProtocol::Result;
+    const uint64_t length = EnsembleProtocol::MAX_PAYLOAD + 1;
+    sender.sendAll(&type, sizeof(uint32_t));
+    sender.sendAll(&length, sizeof(uint64_t));
+    EnsembleProtocol::Message received_type;
+    std::string payload;
+    EXPECT_THROW(EnsembleProtocol::receive(receiver, received_type, payload), exception::EnsembleNetworkError);
+    EXPECT_TRUE(payload.empty());
+}
+TEST(TestCUDAEnsemble, simulateDistributedStalledWorker) {
+    // A worker which stalls midway through a message must not block the coordinator from serving other workers
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<float>("spread", 1.0f);
+    model.Environment().newProperty<float>("metric", 0.0f);
+    model.newAgent("Agent");
+    model.addExitFunction(adaptiveExit);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    flamegpu::RunPlanVector plans(model, 4);
+    plans.setSteps(1);
+    const uint16_t port = util::detail::Socket::listen("127.0.0.1", 0).getPort();
+    const std::string address = "127.0.0.1:" + std::to_string(port);
+    flamegpu::CUDAEnsemble coordinator(model);
+    coordinator.Config().quiet = true;
+    coordinator.Config().out_format = "";  // Suppress warning
+    coordinator.Config().listen_address = address;
+    coordinator.setExitLog(lcfg);
+    std::thread coordinator_thread([&coordinator, &plans]() { coordinator.simulate(plans); });
+    util::detail::Socket stalled = util::detail::Socket::connect("127.0.0.1", port);
+    {
+        std::string payload;
+        EnsembleProtocol::write(payload, EnsembleProtocol::VERSION);
+        EnsembleProtocol::write(payload, static_cast<uint64_t>(plans.size()));
+        EnsembleProtocol::write(payload, model.getName());
+        EnsembleProtocol::send(stalled, EnsembleProtocol::Hello, payload);
+        EnsembleProtocol::Message type;
+        ASSERT_TRUE(EnsembleProtocol::receive(stalled, type, payload));
+        ASSERT_EQ(type, EnsembleProtocol::Welcome);
+        // Send the header and part of the payload of a message
+        const uint32_t result_type = EnsembleProtocol::Result;
+        const uint64_t length = 1024;
+        const char partial[16] = {};
+        stalled.sendAll(&result_type, sizeof(uint32_t));
+        stalled.sendAll(&length, sizeof(uint64_t));
+        stalled.sendAll(partial, sizeof(partial));
+    }
+    flamegpu::CUDAEnsemble worker(model);
+    worker.Config().quiet = true;
+    worker.Config().out_format = "";  // Suppress warning
+    worker.Config().coordinator_address = address;
+    worker.setExitLog(lcfg);
+    EXPECT_NO_THROW(worker.simulate(plans));
+    // The coordinator discards the partial message when the connection closes
+    stalled.close();
+    coordinator_thread.join();
+    const std::vector<RunLog> &logs = coordinator.getLogs();
+    ASSERT_EQ(logs.size(), plans.size());
+    for (const auto &log : logs) {
+        EXPECT_EQ(log.getExitLog().getStepCount(), 1u);
+    }
+}
+/**
+ * Environment variable holding the coordinator's address, which is passed to the worker processes launched by simulateDistributedProcesses
+ */
+const char *COORDINATOR_ADDRESS_ENV = "FLAMEGPU_TEST_ENSEMBLE_COORDINATOR";
+FLAMEGPU_EXIT_FUNCTION(slowExit) {
+    // Runs are slow enough that every worker process connects before the runs are exhausted
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+}
+void defineDistributedProcessModel(ModelDescription &model) {
+    model.Environment().newProperty<float>("metric", 0.0f);
+    model.newAgent("Agent");
+    model.addExitFunction(slowExit);
+}
+const unsigned int PROCESS_PLAN_COUNT = 16;
+// Disabled, as this is only executed in the worker processes launched by simulateDistributedProcesses
+TEST(TestCUDAEnsemble, DISABLED_distributedWorkerProcess) {
+    const char *address = std::getenv(COORDINATOR_ADDRESS_ENV);
+    ASSERT_NE(address, nullptr);
+    flamegpu::ModelDescription model("test");
+    defineDistributedProcessModel(model);
+    flamegpu::RunPlanVector plans(model, PROCESS_PLAN_COUNT);
+    plans.setSteps(1);
+    plans.setRandomSimulationSeed(3000, 1);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    flamegpu::CUDAEnsemble worker(model);
+    worker.Config().quiet = true;
+    worker.Config().out_format = "";  // Suppress warning
+    worker.Config().concurrent_runs = 2;
+    worker.Config().devices = {0};
+    worker.Config().coordinator_address = address;
+    worker.setExitLog(lcfg);
+    EXPECT_NO_THROW(worker.simulate(plans));
+}
+TEST(TestCUDAEnsemble, simulateDistributedProcesses) {
+    // Workers are separate processes, executing DISABLED_distributedWorkerProcess from this test executable
+    flamegpu::ModelDescription model("test");
+    defineDistributedProcessModel(model);
+    flamegpu::RunPlanVector plans(model, PROCESS_PLAN_COUNT);
+    plans.setSteps(1);
+    plans.setRandomSimulationSeed(3000, 1);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("metric");
+    const uint16_t port = util::detail::Socket::listen("127.0.0.1", 0).getPort();
+    const std::string address = "127.0.0.1:" + std::to_string(port);
+    flamegpu::CUDAEnsemble coordinator(model);
+    coordinator.Config().quiet = true;
+    coordinator.Config().out_format = "";  // Suppress warning
+    coordinator.Config().listen_address = address;
+    coordinator.setExitLog(lcfg);
+    std::thread coordinator_thread([&coordinator, &plans]() { coordinator.simulate(plans); });
+#ifdef _WIN32
+    _putenv_s(COORDINATOR_ADDRESS_ENV, address.c_str());
+#else
+    setenv(COORDINATOR_ADDRESS_ENV, address.c_str(), 1);
+#endif
+    const std::string command = "\"" + ::testing::internal::GetArgvs()[0] + "\" --gtest_also_run_disabled_tests --gtest_filter=TestCUDAEnsemble.DISABLED_distributedWorkerProcess";
+    int exit_codes[2] = {-1, -1};
+    std::vector<std::thread> worker_threads;
+    for (int &exit_code : exit_codes) {
+        worker_threads.emplace_back([&command, &exit_code]() { exit_code = std::system(command.c_str()); });
+    }
+    for (auto &t : worker_threads) {
+        t.join();
+    }
+    coordinator_thread.join();
+    for (const int &exit_code : exit_codes) {
+        EXPECT_EQ(exit_code, 0);
+    }
+    const std::vector<RunLog> &logs = coordinator.getLogs();
+    ASSERT_EQ(logs.size(), plans.size());
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        EXPECT_EQ(logs[i].getRandomSeed(), 3000u + i);
+        EXPECT_EQ(logs[i].getExitLog().getStepCount(), 1u);
+    }
+}
+TEST(TestCUDAEnsemble, setInitialPopulation) {
+    flamegpu::ModelDescription model("test");
+    flamegpu::AgentDescription &agent = model.newAgent("Agent");
+    agent.newVariable<uint32_t>("counter", 0);
+    agent.newFunction("simulateAgentFn", simulateAgentFn);
+    model.newLayer().addAgentFunction(simulateAgentFn);
+    LoggingConfig lcfg(model);
+    lcfg.agent("Agent").logCount();
+    lcfg.agent("Agent").logSum<uint32_t>("counter");
+    flamegpu::RunPlanVector plans(model, 3);
+    plans.setSteps(2);
+    flamegpu::CUDAEnsemble ensemble(model);
+    ensemble.Config().quiet = true;
+    ensemble.Config().out_format = "";  // Suppress warning
+    ensemble.setExitLog(lcfg);
+    // Every run shares 10 agents, plan 1 has 20 agents which start counting from 5
+    AgentVector shared(agent, 10);
+    AgentVector override_pop(agent, 20);
+    for (auto a : override_pop) {
+        a.setVariable<uint32_t>("counter", 5);
+    }
+    util::StringPairUnorderedMap<AgentVector> pops;
+    pops.emplace(util::StringPair{"Agent", ModelData::DEFAULT_STATE}, shared);
+    ensemble.setInitialPopulation(pops);
+    pops.clear();
+    pops.emplace(util::StringPair{"Agent", ModelData::DEFAULT_STATE}, override_pop);
+    ensemble.setInitialPopulation(1, pops);
+    ensemble.simulate(plans);
+    const std::vector<RunLog> &logs = ensemble.getLogs();
+    ASSERT_EQ(logs.size(), 3u);
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        const unsigned int count = i == 1 ? 20 : 10;
+        const unsigned int initial = i == 1 ? 5 : 0;
+        EXPECT_EQ(logs[i].getExitLog().getAgent("Agent").getCount(), count);
+        EXPECT_EQ(logs[i].getExitLog().getAgent("Agent").getSum<uint32_t>("counter"), count * (initial + 2));
+    }
+    // Populations loaded from file are equivalent
+    const std::string input_file = "test_cuda_ensemble_setInitialPopulation.json";
+    {
+        flamegpu::CUDASimulation sim(model);
+        sim.setPopulationData(override_pop);
+        sim.exportData(input_file);
+    }
+    ensemble.clearInitialPopulation();
+    ensemble.loadInitialPopulation(input_file);
+    ensemble.simulate(plans);
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        EXPECT_EQ(logs[i].getExitLog().getAgent("Agent").getCount(), 20u);
+        EXPECT_EQ(logs[i].getExitLog().getAgent("Agent").getSum<uint32_t>("counter"), 20u * 7u);
+    }
+    ASSERT_EQ(::remove(input_file.c_str()), 0);
+    // Without an initial population, runs begin with no agents
+    ensemble.clearInitialPopulation();
+    ensemble.simulate(plans);
+    for (unsigned int i = 0; i < logs.size(); ++i) {
+        EXPECT_EQ(logs[i].getExitLog().getAgent("Agent").getCount(), 0u);
+    }
+    // Invalid populations
+    pops.clear();
+    pops.emplace(util::StringPair{"Agent", "missing"}, shared);
+    EXPECT_THROW(ensemble.setInitialPopulation(pops), exception::InvalidAgentState);
+    pops.clear();
+    pops.emplace(util::StringPair{"Missing", ModelData::DEFAULT_STATE}, shared);
+    EXPECT_THROW(ensemble.setInitialPopulation(pops), exception::InvalidAgent);
+    // Plan overrides must be within the RunPlanVector
+    pops.clear();
+    ensemble.setInitialPopulation(3, pops);
+    EXPECT_THROW(ensemble.simulate(plans), exception::OutOfBoundsException);
+}
 
 }  // namespace test_cuda_ensemble
 }  // namespace tests
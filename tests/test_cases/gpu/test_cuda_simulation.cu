@@ -1,6 +1,13 @@
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
 #include <thread>
 #include <set>
+#include <vector>
 
 #include "flamegpu/flamegpu.h"
 #include "flamegpu/util/detail/compute_capability.cuh"
@@ -505,6 +512,416 @@ TEST(TestCUDASimulation, stepElapsedTime) {
     }
 }
 
+FLAMEGPU_AGENT_FUNCTION_CONDITION(BreakdownCondition) {
+    return FLAMEGPU->getVariable<int>("x") > 0;
+}
+FLAMEGPU_AGENT_FUNCTION(BreakdownOutput, MessageNone, MessageBruteForce) {
+    FLAMEGPU->message_out.setVariable<int>("x", FLAMEGPU->getVariable<int>("x"));
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(BreakdownInput, MessageBruteForce, MessageNone) {
+    int sum = 0;
+    for (auto &message : FLAMEGPU->message_in) {
+        sum += message.getVariable<int>("x");
+    }
+    FLAMEGPU->setVariable<int>("x", sum);
+    return ALIVE;
+}
+FLAMEGPU_HOST_FUNCTION(BreakdownHostSlow) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+// test the per step breakdown of simulation time
+TEST(TestCUDASimulation, stepElapsedTimeBreakdown) {
+    ModelDescription m(MODEL_NAME);
+    MessageBruteForce::Description &message = m.newMessage("message");
+    message.newVariable<int>("x");
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 1);
+    AgentFunctionDescription &out_fn = a.newFunction("out", BreakdownOutput);
+    out_fn.setMessageOutput(message);
+    out_fn.setFunctionCondition(BreakdownCondition);
+    AgentFunctionDescription &in_fn = a.newFunction("in", BreakdownInput);
+    in_fn.setMessageInput(message);
+    m.newLayer().addAgentFunction(out_fn);
+    m.newLayer().addAgentFunction(in_fn);
+    m.newLayer().addHostFunction(BreakdownHostSlow);
+    m.addStepFunction(IncrementCounter);
+    AgentVector pop(a, static_cast<unsigned int>(AGENT_COUNT));
+
+    const unsigned int STEPS = 3u;
+    {
+        // Disabled by default
+        CUDASimulation c(m);
+        c.SimulationConfig().steps = STEPS;
+        c.setPopulationData(pop);
+        c.simulate();
+        EXPECT_EQ(c.getElapsedTimeStepBreakdowns().size(), 0u);
+        EXPECT_EQ(c.getRunLog().getStepTimingLog().size(), 0u);
+        EXPECT_THROW(c.getElapsedTimeStepBreakdown(0), exception::OutOfBoundsException);
+    }
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = STEPS;
+    c.CUDAConfig().timingBreakdown = true;
+    c.applyConfig();
+    c.setPopulationData(pop);
+    c.simulate();
+    const std::vector<std::map<std::string, double>> breakdowns = c.getElapsedTimeStepBreakdowns();
+    ASSERT_EQ(breakdowns.size(), STEPS);
+    EXPECT_EQ(c.getRunLog().getStepTimingLog().size(), STEPS);
+    for (unsigned int step = 0; step < STEPS; ++step) {
+        const std::map<std::string, double> breakdown = c.getElapsedTimeStepBreakdown(step);
+        EXPECT_EQ(breakdown, breakdowns[step]);
+        for (const char *label : {"layer 0", "layer 0: condition Agent::out", "layer 0: condition scatter Agent::out", "layer 0: Agent::out",
+            "layer 0: scatter Agent::out", "layer 1", "layer 1: buildIndex message", "layer 1: Agent::in", "layer 1: scatter Agent::in",
+            "layer 2", "layer 2: host function BreakdownHostSlow", "step functions", "exit conditions", "log reduction"}) {
+            ASSERT_EQ(breakdown.count(label), 1u) << label;
+            EXPECT_GE(breakdown.at(label), 0.) << label;
+        }
+        // The host function dominates the layer, and components are contained within their layer and step
+        EXPECT_GE(breakdown.at("layer 2: host function BreakdownHostSlow"), 0.045);
+        EXPECT_GE(breakdown.at("layer 2"), breakdown.at("layer 2: host function BreakdownHostSlow"));
+        EXPECT_GE(breakdown.at("layer 0"), breakdown.at("layer 0: Agent::out"));
+        EXPECT_GE(c.getElapsedTimeStep(step), breakdown.at("layer 2"));
+    }
+    EXPECT_THROW(c.getElapsedTimeStepBreakdown(STEPS), exception::OutOfBoundsException);
+    // The breakdown is exported with the run log
+    const std::string JSON_PATH = "test_step_timing_breakdown.json";
+    c.exportLog(JSON_PATH, true, false, false);
+    {
+        std::ifstream f(JSON_PATH);
+        const std::string json((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        EXPECT_NE(json.find("\"timing\":[{"), std::string::npos);
+        EXPECT_NE(json.find("\"layer 1: buildIndex message\":"), std::string::npos);
+    }
+    std::remove(JSON_PATH.c_str());
+    // reset() clears the breakdown
+    c.reset();
+    EXPECT_EQ(c.getElapsedTimeStepBreakdowns().size(), 0u);
+}
+FLAMEGPU_EXIT_CONDITION(HostTimingExitCondition) {
+    return CONTINUE;
+}
+// test the cumulative and per step timing of host functions
+TEST(TestCUDASimulation, hostFunctionTiming) {
+    ModelDescription m(MODEL_NAME);
+    m.newAgent(AGENT_NAME);
+    m.addInitFunction(InitIncrementCounterSlow);
+    m.addStepFunction(IncrementCounter);
+    m.newLayer().addHostFunction(BreakdownHostSlow);
+    m.addExitCondition(HostTimingExitCondition);
+    m.addExitFunction(ExitIncrementCounterSlow);
+    const unsigned int STEPS = 3u;
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = STEPS;
+    c.CUDAConfig().slowHostFunctionFraction = 0.5;
+    c.applyConfig();
+    testing::internal::CaptureStderr();
+    c.simulate();
+    const std::string errors = testing::internal::GetCapturedStderr();
+    // The slow host function dominates each step, so is warned about once, fast host functions are not
+    const std::string slowWarning = "Warning: Host function 'layer 0: host function BreakdownHostSlow' took";
+    const size_t slowWarningPos = errors.find(slowWarning);
+    EXPECT_NE(slowWarningPos, std::string::npos);
+    EXPECT_EQ(errors.find(slowWarning, slowWarningPos + 1), std::string::npos);
+    EXPECT_EQ(errors.find("Warning: Host function 'step function IncrementCounter'"), std::string::npos);
+    EXPECT_EQ(errors.find("Warning: Host function 'exit condition HostTimingExitCondition'"), std::string::npos);
+    // Host functions are labelled by name
+    const std::map<std::string, double> total = c.getElapsedTimeHostFunctions();
+    for (const char *label : {"init function InitIncrementCounterSlow", "step function IncrementCounter",
+        "layer 0: host function BreakdownHostSlow", "exit condition HostTimingExitCondition", "exit function ExitIncrementCounterSlow"}) {
+        ASSERT_EQ(total.count(label), 1u) << label;
+        EXPECT_GE(total.at(label), 0.) << label;
+    }
+    EXPECT_GE(total.at("init function InitIncrementCounterSlow"), 0.095);
+    EXPECT_GE(total.at("exit function ExitIncrementCounterSlow"), 0.095);
+    EXPECT_GE(total.at("layer 0: host function BreakdownHostSlow"), STEPS * 0.045);
+    // Init and exit functions are not part of a step
+    const std::vector<std::map<std::string, double>> steps = c.getElapsedTimeHostFunctionSteps();
+    ASSERT_EQ(steps.size(), STEPS);
+    double layerSum = 0;
+    for (unsigned int step = 0; step < STEPS; ++step) {
+        EXPECT_EQ(steps[step].size(), 3u);
+        EXPECT_EQ(steps[step].count("init function InitIncrementCounterSlow"), 0u);
+        EXPECT_EQ(steps[step].count("exit function ExitIncrementCounterSlow"), 0u);
+        ASSERT_EQ(steps[step].count("layer 0: host function BreakdownHostSlow"), 1u);
+        layerSum += steps[step].at("layer 0: host function BreakdownHostSlow");
+        EXPECT_GE(c.getElapsedTimeStep(step), steps[step].at("layer 0: host function BreakdownHostSlow"));
+    }
+    EXPECT_DOUBLE_EQ(total.at("layer 0: host function BreakdownHostSlow"), layerSum);
+    // reset() clears the timing
+    c.reset();
+    EXPECT_EQ(c.getElapsedTimeHostFunctions().size(), 0u);
+    EXPECT_EQ(c.getElapsedTimeHostFunctionSteps().size(), 0u);
+    // Per step times are not retained if neither timing nor the slow host function warning are enabled
+    c.CUDAConfig().slowHostFunctionFraction = 0;
+    c.applyConfig();
+    c.simulate();
+    EXPECT_EQ(c.getElapsedTimeHostFunctions().count("layer 0: host function BreakdownHostSlow"), 1u);
+    EXPECT_EQ(c.getElapsedTimeHostFunctionSteps().size(), 0u);
+}
+FLAMEGPU_STEP_FUNCTION(MemoryReportCreate) {
+    for (unsigned int i = 0; i < 100; ++i) {
+        FLAMEGPU->agent(AGENT_NAME).newAgent().setVariable<int>("x", 2);
+    }
+}
+TEST(TestCUDASimulation, memoryReport) {
+    ModelDescription m(MODEL_NAME);
+    MessageBruteForce::Description &message = m.newMessage("message");
+    message.newVariable<int>("x");
+    m.Environment().newMacroProperty<int, 10>("macro");
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 1);
+    AgentFunctionDescription &out_fn = a.newFunction("out", BreakdownOutput);
+    out_fn.setMessageOutput(message);
+    AgentFunctionDescription &in_fn = a.newFunction("in", BreakdownInput);
+    in_fn.setMessageInput(message);
+    m.newLayer().addAgentFunction(out_fn);
+    m.newLayer().addAgentFunction(in_fn);
+    m.addStepFunction(MemoryReportCreate);
+    AgentVector pop(a, static_cast<unsigned int>(AGENT_COUNT));
+
+    CUDASimulation c(m);
+    c.setPopulationData(pop);
+    // State lists are allocated with a minimum length of 1024 agents, each variable is double buffered
+    const size_t STATE_BYTES = 2 * 1024 * (sizeof(int) + sizeof(id_t));
+    {
+        const std::map<std::string, CUDASimulation::MemoryUsage> report = c.getMemoryReport();
+        ASSERT_EQ(report.count("agent Agent state default"), 1u);
+        EXPECT_EQ(report.at("agent Agent state default").device, STATE_BYTES);
+        EXPECT_EQ(report.at("agent Agent state default").host, 0u);
+    }
+    c.step();
+    c.step();
+    const std::map<std::string, CUDASimulation::MemoryUsage> report = c.getMemoryReport();
+    for (const char *label : {"agent Agent state default", "agent Agent new buffers", "message message", "message message index",
+        "random", "scan compaction", "scatter", "macro environment", "environment", "host api", "host agent creation", "total"}) {
+        ASSERT_EQ(report.count(label), 1u) << label;
+        EXPECT_GE(report.at(label).peak_device, report.at(label).device) << label;
+        EXPECT_GE(report.at(label).peak_host, report.at(label).host) << label;
+    }
+    for (const char *label : {"agent Agent state default", "message message", "message message index",
+        "random", "scan compaction", "macro environment", "host agent creation", "total"}) {
+        EXPECT_GT(report.at(label).device, 0u) << label;
+    }
+    // 10 + 200 agents still fit within the initial state list allocation
+    EXPECT_EQ(report.at("agent Agent state default").device, STATE_BYTES);
+    // During the second step, 10 + 100 agents each output a message, into a read and write list
+    EXPECT_GE(report.at("message message").device, 2 * (AGENT_COUNT + 100) * sizeof(int));
+    size_t macro_bytes = 10 * sizeof(int);
+#if !defined(SEATBELTS) || SEATBELTS
+    macro_bytes += sizeof(unsigned int);
+#endif
+    EXPECT_EQ(report.at("macro environment").device, macro_bytes);
+    EXPECT_GE(report.at("random").device, (AGENT_COUNT + 100) * sizeof(curandState));
+    EXPECT_GE(report.at("host agent creation").host, 100 * (sizeof(int) + sizeof(id_t)));
+    // Total sums the components
+    size_t host = 0, device = 0;
+    for (const auto &r : report) {
+        if (r.first != "total") {
+            host += r.second.host;
+            device += r.second.device;
+        }
+    }
+    EXPECT_EQ(report.at("total").host, host);
+    EXPECT_EQ(report.at("total").device, device);
+}
+std::atomic<unsigned int> concurrent_arrivals = {0};
+// Returns true once the number of arrivals reaches target, false if this does not happen within 5 seconds
+bool waitForConcurrentArrivals(const unsigned int target) {
+    for (int i = 0; i < 5000 && concurrent_arrivals.load() < target; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return concurrent_arrivals.load() >= target;
+}
+FLAMEGPU_HOST_FUNCTION(ConcurrentRendezvous1) {
+    // Neither function can return until both have started
+    ++concurrent_arrivals;
+    EXPECT_TRUE(waitForConcurrentArrivals(2 * (FLAMEGPU->getStepCounter() + 1)));
+}
+FLAMEGPU_HOST_FUNCTION(ConcurrentRendezvous2) {
+    ++concurrent_arrivals;
+    EXPECT_TRUE(waitForConcurrentArrivals(2 * (FLAMEGPU->getStepCounter() + 1)));
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentStepA) {
+    FLAMEGPU->environment.setProperty<int>("sum_a", FLAMEGPU->agent(AGENT_NAME).sum<int>("x"));
+    FLAMEGPU->agent(AGENT_NAME).newAgent().setVariable<int>("x", 1);
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentStepB) {
+    FLAMEGPU->environment.setProperty<int>("sum_b", FLAMEGPU->agent(AGENT_NAME2).sum<int>("x"));
+    FLAMEGPU->agent(AGENT_NAME2).newAgent().setVariable<int>("x", 2);
+}
+FLAMEGPU_EXIT_CONDITION(ConcurrentExitCount) {
+    FLAMEGPU->environment.setProperty<unsigned int>("exit_count", FLAMEGPU->environment.getProperty<unsigned int>("exit_count") + 1);
+    return CONTINUE;
+}
+FLAMEGPU_EXIT_CONDITION(ConcurrentExitAfter3) {
+    return FLAMEGPU->getStepCounter() + 1 >= 3 ? EXIT : CONTINUE;
+}
+TEST(TestCUDASimulation, concurrentHostFunctions) {
+    concurrent_arrivals = 0;
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x");
+    AgentDescription &b = m.newAgent(AGENT_NAME2);
+    b.newVariable<int>("x");
+    m.Environment().newProperty<int>("sum_a", 0);
+    m.Environment().newProperty<int>("sum_b", 0);
+    m.Environment().newProperty<unsigned int>("exit_count", 0);
+    LayerDescription &l = m.newLayer();
+    l.addConcurrentHostFunction(ConcurrentRendezvous1);
+    l.addConcurrentHostFunction(ConcurrentRendezvous2);
+    m.addConcurrentStepFunction(ConcurrentStepA);
+    m.addConcurrentStepFunction(ConcurrentStepB);
+    // The exit conditions are executed together, so the count is updated in the step which exits
+    m.addConcurrentExitCondition(ConcurrentExitAfter3);
+    m.addConcurrentExitCondition(ConcurrentExitCount);
+    EXPECT_THROW(m.addConcurrentStepFunction(ConcurrentStepA), exception::InvalidHostFunc);
+    EXPECT_THROW(m.addStepFunction(ConcurrentStepB), exception::InvalidHostFunc);
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 10;
+    c.simulate();
+    EXPECT_EQ(c.getStepCounter(), 3u);
+    EXPECT_EQ(concurrent_arrivals.load(), 6u);
+    // Agents created by each concurrent step function are added to the population
+    AgentVector pop_a(a);
+    AgentVector pop_b(b);
+    c.getPopulationData(pop_a);
+    c.getPopulationData(pop_b);
+    EXPECT_EQ(pop_a.size(), 3u);
+    EXPECT_EQ(pop_b.size(), 3u);
+    // Each concurrent function is timed individually
+    const std::map<std::string, double> total = c.getElapsedTimeHostFunctions();
+    for (const char *label : {"layer 0: host function ConcurrentRendezvous1", "layer 0: host function ConcurrentRendezvous2",
+        "step function ConcurrentStepA", "step function ConcurrentStepB", "exit condition ConcurrentExitAfter3", "exit condition ConcurrentExitCount"}) {
+        EXPECT_EQ(total.count(label), 1u) << label;
+    }
+}
+FLAMEGPU_EXIT_FUNCTION(ConcurrentExitCheck) {
+    // Step function reductions observed the agents born in previous steps
+    EXPECT_EQ(FLAMEGPU->environment.getProperty<int>("sum_a"), 2);
+    EXPECT_EQ(FLAMEGPU->environment.getProperty<int>("sum_b"), 4);
+    EXPECT_EQ(FLAMEGPU->environment.getProperty<unsigned int>("exit_count"), 3u);
+}
+TEST(TestCUDASimulation, concurrentHostFunctionsEnvironment) {
+    concurrent_arrivals = 0;
+    ModelDescription m(MODEL_NAME);
+    m.newAgent(AGENT_NAME).newVariable<int>("x");
+    m.newAgent(AGENT_NAME2).newVariable<int>("x");
+    m.Environment().newProperty<int>("sum_a", 0);
+    m.Environment().newProperty<int>("sum_b", 0);
+    m.Environment().newProperty<unsigned int>("exit_count", 0);
+    m.addConcurrentStepFunction(ConcurrentStepA);
+    m.addConcurrentStepFunction(ConcurrentStepB);
+    m.addConcurrentExitCondition(ConcurrentExitAfter3);
+    m.addConcurrentExitCondition(ConcurrentExitCount);
+    m.addExitFunction(ConcurrentExitCheck);
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 10;
+    c.simulate();
+    EXPECT_EQ(c.getStepCounter(), 3u);
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentBirthA) {
+    for (int i = 0; i < 10; ++i) {
+        FLAMEGPU->agent(AGENT_NAME).newAgent().setVariable<int>("x", 1);
+    }
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentBirthB) {
+    for (int i = 0; i < 10; ++i) {
+        FLAMEGPU->agent(AGENT_NAME).newAgent().setVariable<int>("x", 2);
+    }
+}
+TEST(TestCUDASimulation, concurrentHostFunctionsReproducible) {
+    // Each concurrent function always uses the same HostAPI, so host created agents are added in the same order every run
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x");
+    m.addConcurrentStepFunction(ConcurrentBirthA);
+    m.addConcurrentStepFunction(ConcurrentBirthB);
+    std::vector<int> first;
+    for (int run = 0; run < 3; ++run) {
+        CUDASimulation c(m);
+        c.SimulationConfig().steps = 2;
+        c.SimulationConfig().random_seed = 12;
+        c.simulate();
+        AgentVector pop(a);
+        c.getPopulationData(pop);
+        ASSERT_EQ(pop.size(), 40u);
+        std::vector<int> values;
+        for (const auto &agent : pop) {
+            values.push_back(agent.getVariable<int>("x"));
+        }
+        if (run == 0) {
+            first = values;
+        } else {
+            EXPECT_EQ(values, first);
+        }
+    }
+}
+std::atomic<int> concurrent_sort_sum_a = {0};
+std::atomic<int> concurrent_sort_sum_b = {0};
+FLAMEGPU_STEP_FUNCTION(ConcurrentSortA) {
+    FLAMEGPU->agent(AGENT_NAME).sort<int>("x", HostAgentAPI::Asc);
+    concurrent_sort_sum_a = FLAMEGPU->agent(AGENT_NAME).sum<int>("x");
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentSortB) {
+    FLAMEGPU->agent(AGENT_NAME2).sort<int, int>("x", HostAgentAPI::Desc, "y", HostAgentAPI::Asc);
+    concurrent_sort_sum_b = FLAMEGPU->agent(AGENT_NAME2).sum<int>("x");
+}
+TEST(TestCUDASimulation, concurrentHostFunctionsSort) {
+    // Concurrent sorts of different agents use separate streams and scan buffers
+    const unsigned int POP_SIZE = 10000;
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x");
+    AgentDescription &b = m.newAgent(AGENT_NAME2);
+    b.newVariable<int>("x");
+    b.newVariable<int>("y");
+    m.addConcurrentStepFunction(ConcurrentSortA);
+    m.addConcurrentStepFunction(ConcurrentSortB);
+    AgentVector pop_a(a, POP_SIZE);
+    AgentVector pop_b(b, POP_SIZE);
+    int sum_a = 0, sum_b = 0;
+    for (unsigned int i = 0; i < POP_SIZE; ++i) {
+        const int x = static_cast<int>((i * 7919) % POP_SIZE);
+        pop_a[i].setVariable<int>("x", x);
+        pop_b[i].setVariable<int>("x", x % 100);
+        pop_b[i].setVariable<int>("y", x);
+        sum_a += x;
+        sum_b += x % 100;
+    }
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 1;
+    c.setPopulationData(pop_a);
+    c.setPopulationData(pop_b);
+    c.simulate();
+    c.getPopulationData(pop_a);
+    c.getPopulationData(pop_b);
+    EXPECT_EQ(concurrent_sort_sum_a.load(), sum_a);
+    EXPECT_EQ(concurrent_sort_sum_b.load(), sum_b);
+    for (unsigned int i = 1; i < POP_SIZE; ++i) {
+        EXPECT_LE(pop_a[i - 1].getVariable<int>("x"), pop_a[i].getVariable<int>("x"));
+        const int x0 = pop_b[i - 1].getVariable<int>("x"), x1 = pop_b[i].getVariable<int>("x");
+        EXPECT_GE(x0, x1);
+        if (x0 == x1) {
+            EXPECT_LE(pop_b[i - 1].getVariable<int>("y"), pop_b[i].getVariable<int>("y"));
+        }
+    }
+}
+FLAMEGPU_STEP_FUNCTION(ConcurrentStepThrow) {
+    THROW exception::InvalidArgument("Thrown from a concurrent step function\n");
+}
+TEST(TestCUDASimulation, concurrentHostFunctionException) {
+    ModelDescription m(MODEL_NAME);
+    m.newAgent(AGENT_NAME).newVariable<int>("x");
+    m.Environment().newProperty<int>("sum_a", 0);
+    m.addConcurrentStepFunction(ConcurrentStepA);
+    m.addConcurrentStepFunction(ConcurrentStepThrow);
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 1;
+    // Exceptions are rethrown on the simulation's thread
+    EXPECT_THROW(c.simulate(), exception::InvalidArgument);
+}
+
 /* const char* rtc_empty_agent_func = R"###(
 FLAMEGPU_AGENT_FUNCTION(rtc_test_func, MessageNone, MessageNone) {
     return ALIVE;
@@ -635,6 +1052,36 @@ TEST(TestCUDASimulation, AgentID_MultipleStatesUniqueIDs) {
     ASSERT_EQ(ids_copy.size(), pop_out_a.size() + pop_out_b.size());
 }
 
+TEST(TestCUDASimulation, AgentID_ValidateAgentIDs) {
+    // Agents exported from a simulation retain their IDs
+    // Adding them to two states of a second simulation creates collisions
+    ModelDescription model("test_agentid");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newState("a");
+    agent.newState("b");
+    AgentVector pop(agent, 100);
+    {
+        CUDASimulation sim(model);
+        sim.setPopulationData(pop, "a");
+        sim.step();
+        sim.getPopulationData(pop, "a");
+    }
+    EXPECT_EQ(AgentVectorReductions(pop).countIDCollisions(), 0u);
+    {
+        CUDASimulation sim(model);
+        EXPECT_TRUE(sim.getCUDAConfig().validateAgentIDs);
+        EXPECT_NO_THROW(sim.setPopulationData(pop, "a"));
+        EXPECT_THROW(sim.setPopulationData(pop, "b"), exception::AgentIDCollision);
+    }
+    {
+        // Validation can be disabled for trusted inputs
+        CUDASimulation sim(model);
+        sim.CUDAConfig().validateAgentIDs = false;
+        EXPECT_NO_THROW(sim.setPopulationData(pop, "a"));
+        EXPECT_NO_THROW(sim.setPopulationData(pop, "b"));
+    }
+}
+
 }  // namespace test_cuda_simulation
 }  // namespace tests
 }  // namespace flamegpu
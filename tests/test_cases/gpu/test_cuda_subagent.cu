@@ -2255,6 +2255,207 @@ TEST(TestCUDASubAgent, UnmappedVariablesResetToDefaultBetweenSubmodelRuns) {
     }
 }
 
+TEST(TestCUDASubAgent, UnmappedVariablesPersistBetweenPersistentSubmodelRuns) {
+    // Agents that rely on unmapped subagent variables will retain their value between calls to a persistent submodel
+    ModelDescription sm(SUB_MODEL_NAME);
+    {
+        // Define SubModel
+        auto &a = sm.newAgent(AGENT_NAME);
+        a.newVariable<unsigned int>(SUB_VAR1_NAME, 1);
+        a.newVariable<unsigned int>(AGENT_VAR1_NAME);
+        a.newFunction("", AddSubVar);
+        sm.newLayer().addAgentFunction(AddSubVar);
+        sm.addExitCondition(ExitAlways);
+    }
+    ModelDescription m(MODEL_NAME);
+    auto &ma = m.newAgent(AGENT_NAME);
+    {
+        // Define Model
+        ma.newVariable<unsigned int>(AGENT_VAR1_NAME);
+        ma.newVariable<unsigned int>("id");
+        auto &smd = m.newSubModel("sub", sm);
+        smd.bindAgent(AGENT_NAME, AGENT_NAME, true, true);  // auto map vars and states
+        EXPECT_FALSE(smd.getPersistent());
+        smd.setPersistent(true);
+        EXPECT_TRUE(smd.getPersistent());
+        m.newLayer().addSubModel("sub");
+    }
+    // Init Agents
+    AgentVector pop(ma, static_cast<unsigned int>(AGENT_COUNT));
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        AgentVector::Agent ai = pop[i];
+        ai.setVariable<unsigned int>("id", i);
+        ai.setVariable<unsigned int>(AGENT_VAR1_NAME, i);
+    }
+    // Init Model
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 1;
+    c.applyConfig();
+    c.setPopulationData(pop);
+    // Run Model
+    c.step();
+    c.step();
+    // Check result
+    c.getPopulationData(pop);
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (AgentVector::Agent ai : pop) {
+        // Unmapped subvar persists between calls
+        EXPECT_EQ(ai.getVariable<unsigned int>(AGENT_VAR1_NAME), ai.getVariable<unsigned int>("id") + 1 + 2);
+    }
+    // Resetting the parent model, resets the persistent submodel
+    c.reset();
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        AgentVector::Agent ai = pop[i];
+        ai.setVariable<unsigned int>(AGENT_VAR1_NAME, i);
+    }
+    c.setPopulationData(pop);
+    c.step();
+    c.getPopulationData(pop);
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (AgentVector::Agent ai : pop) {
+        EXPECT_EQ(ai.getVariable<unsigned int>(AGENT_VAR1_NAME), ai.getVariable<unsigned int>("id") + 1);
+    }
+}
+FLAMEGPU_STEP_FUNCTION(BirthBetweenPersistentSubmodelRuns) {
+    // Only birth agents between the first and second execution of the submodel
+    if (FLAMEGPU->getStepCounter() == 0) {
+        for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+            auto a = FLAMEGPU->agent(AGENT_NAME).newAgent();
+            a.setVariable<unsigned int>("id", AGENT_COUNT + i);
+            a.setVariable<unsigned int>(AGENT_VAR1_NAME, 0);
+        }
+    }
+}
+TEST(TestCUDASubAgent, UnmappedVariablesDefaultForAgentsBornBetweenPersistentSubmodelRuns) {
+    // Agents born in the parent model between calls to a persistent submodel receive the default value of unmapped subagent variables
+    ModelDescription sm(SUB_MODEL_NAME);
+    {
+        // Define SubModel
+        auto &a = sm.newAgent(AGENT_NAME);
+        a.newVariable<unsigned int>(SUB_VAR1_NAME, 1);
+        a.newVariable<unsigned int>(AGENT_VAR1_NAME);
+        a.newFunction("", AddSubVar);
+        sm.newLayer().addAgentFunction(AddSubVar);
+        sm.addExitCondition(ExitAlways);
+    }
+    ModelDescription m(MODEL_NAME);
+    auto &ma = m.newAgent(AGENT_NAME);
+    {
+        // Define Model
+        ma.newVariable<unsigned int>(AGENT_VAR1_NAME);
+        ma.newVariable<unsigned int>("id");
+        auto &smd = m.newSubModel("sub", sm);
+        smd.bindAgent(AGENT_NAME, AGENT_NAME, true, true);  // auto map vars and states
+        smd.setPersistent(true);
+        m.newLayer().addSubModel("sub");
+        m.addStepFunction(BirthBetweenPersistentSubmodelRuns);
+    }
+    // Init Agents
+    AgentVector pop(ma, static_cast<unsigned int>(AGENT_COUNT));
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        AgentVector::Agent ai = pop[i];
+        ai.setVariable<unsigned int>("id", i);
+        ai.setVariable<unsigned int>(AGENT_VAR1_NAME, i);
+    }
+    // Init Model
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 2;
+    c.applyConfig();
+    c.setPopulationData(pop);
+    // Run Model
+    c.simulate();
+    // Check result
+    c.getPopulationData(pop);
+    ASSERT_EQ(pop.size(), 2 * AGENT_COUNT);
+    unsigned int born = 0;
+    for (AgentVector::Agent ai : pop) {
+        const unsigned int id = ai.getVariable<unsigned int>("id");
+        if (id < AGENT_COUNT) {
+            // Unmapped subvar persists between calls
+            EXPECT_EQ(ai.getVariable<unsigned int>(AGENT_VAR1_NAME), id + 1 + 2);
+        } else {
+            // Unmapped subvar of agents born by the parent starts from it's default value
+            EXPECT_EQ(ai.getVariable<unsigned int>(AGENT_VAR1_NAME), 1u);
+            ++born;
+        }
+    }
+    EXPECT_EQ(born, AGENT_COUNT);
+}
+FLAMEGPU_INIT_FUNCTION(PersistentInit) {
+    FLAMEGPU->environment.setProperty<unsigned int>("init_count", FLAMEGPU->environment.getProperty<unsigned int>("init_count") + 1);
+}
+FLAMEGPU_STEP_FUNCTION(PersistentStep) {
+    const unsigned int step_count = FLAMEGPU->environment.getProperty<unsigned int>("step_count") + 1;
+    FLAMEGPU->environment.setProperty<unsigned int>("step_count", step_count);
+    FLAMEGPU->environment.setProperty<unsigned int>("out_step_count", step_count);
+    FLAMEGPU->environment.setProperty<unsigned int>("out_agent_count", FLAMEGPU->agent("unmapped").count());
+    FLAMEGPU->agent("unmapped").newAgent();
+}
+unsigned int persistent_init_count = 0;
+unsigned int persistent_step_count = 0;
+unsigned int persistent_agent_count = 0;
+FLAMEGPU_EXIT_FUNCTION(PersistentExit) {
+    persistent_init_count = FLAMEGPU->environment.getProperty<unsigned int>("init_count");
+    persistent_step_count = FLAMEGPU->environment.getProperty<unsigned int>("out_step_count");
+    persistent_agent_count = FLAMEGPU->environment.getProperty<unsigned int>("out_agent_count");
+}
+void definePersistentSubmodel(ModelDescription &sm, ModelDescription &m, bool persistent) {
+    {
+        // Define SubModel
+        sm.Environment().newProperty<unsigned int>("init_count", 0);
+        sm.Environment().newProperty<unsigned int>("step_count", 0);
+        sm.Environment().newProperty<unsigned int>("out_step_count", 0);
+        sm.Environment().newProperty<unsigned int>("out_agent_count", 0);
+        sm.newAgent("unmapped");
+        sm.addInitFunction(PersistentInit);
+        sm.addStepFunction(PersistentStep);
+        sm.addExitCondition(ExitAlways);
+    }
+    {
+        // Define Model
+        m.Environment().newProperty<unsigned int>("init_count", 0);
+        m.Environment().newProperty<unsigned int>("out_step_count", 0);
+        m.Environment().newProperty<unsigned int>("out_agent_count", 0);
+        auto &smd = m.newSubModel("sub", sm);
+        smd.SubEnvironment().mapProperty("init_count", "init_count");
+        smd.SubEnvironment().mapProperty("out_step_count", "out_step_count");
+        smd.SubEnvironment().mapProperty("out_agent_count", "out_agent_count");
+        smd.setPersistent(persistent);
+        m.newLayer().addSubModel("sub");
+        m.addExitFunction(PersistentExit);
+    }
+}
+TEST(TestCUDASubAgent, UnmappedStateResetBetweenSubmodelRuns) {
+    ModelDescription sm(SUB_MODEL_NAME);
+    ModelDescription m(MODEL_NAME);
+    definePersistentSubmodel(sm, m, false);
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 3;
+    c.simulate();
+    // Init functions run each call, unmapped agents and environment properties are reset each call
+    EXPECT_EQ(persistent_init_count, 3u);
+    EXPECT_EQ(persistent_step_count, 1u);
+    EXPECT_EQ(persistent_agent_count, 0u);
+}
+TEST(TestCUDASubAgent, UnmappedStatePersistsBetweenPersistentSubmodelRuns) {
+    ModelDescription sm(SUB_MODEL_NAME);
+    ModelDescription m(MODEL_NAME);
+    definePersistentSubmodel(sm, m, true);
+    CUDASimulation c(m);
+    c.SimulationConfig().steps = 3;
+    c.simulate();
+    // Init functions run only on the first call, unmapped agents and environment properties persist
+    EXPECT_EQ(persistent_init_count, 1u);
+    EXPECT_EQ(persistent_step_count, 3u);
+    EXPECT_EQ(persistent_agent_count, 2u);
+    // Resetting the parent model, resets the persistent submodel
+    c.reset();
+    c.simulate();
+    EXPECT_EQ(persistent_init_count, 1u);
+    EXPECT_EQ(persistent_step_count, 3u);
+    EXPECT_EQ(persistent_agent_count, 2u);
+}
+
 FLAMEGPU_AGENT_FUNCTION(CopyID, MessageNone, MessageNone) {
     FLAMEGPU->setVariable<id_t>("id_copy", FLAMEGPU->getID());
     return ALIVE;
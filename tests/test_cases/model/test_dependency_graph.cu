@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <limits>
 
 #include "flamegpu/flamegpu.h"
 
@@ -439,32 +440,32 @@ TEST(DependencyGraphTest, CorrectLayersAllDependencies) {
     std::string expectedLayers = R"###(--------------------
 Layer 0
 --------------------
-Function1
+HostFn1
 
 --------------------
 Layer 1
 --------------------
-HostFn1
+Function1
 
 --------------------
 Layer 2
 --------------------
-Function2
+Function3
 
 --------------------
 Layer 3
 --------------------
-Function3
+Function2
 
 --------------------
 Layer 4
 --------------------
-Function4
+HostFn2
 
 --------------------
 Layer 5
 --------------------
-HostFn2
+Function4
 
 --------------------
 Layer 6
@@ -495,26 +496,149 @@ TEST(DependencyGraphTest, CorrectLayersConcurrent) {
     std::string expectedLayers = R"###(--------------------
 Layer 0
 --------------------
-Function3
+HostFn1
 
 --------------------
 Layer 1
 --------------------
-HostFn1
+Function3
+Function1
+Function2
 
 --------------------
 Layer 2
 --------------------
+HostFn2
+
+)###";
+    EXPECT_EQ(expectedLayers, graph.getConstructedLayersString());
+}
+TEST(DependencyGraphTest, CorrectLayersCostBalanced) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    AgentDescription &a3 = _m.newAgent(AGENT_NAME3);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn2);
+    AgentFunctionDescription &f3 = a2.newFunction(FUNCTION_NAME3, agent_fn3);
+    AgentFunctionDescription &f4 = a3.newFunction(FUNCTION_NAME4, agent_fn4);
+    AgentFunctionDescription &f5 = a3.newFunction("Function5", agent_fn4);
+    f2.dependsOn(f);
+    f5.dependsOn(f4);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(f);
+    graph.addRoot(f3);
+    graph.addRoot(f4);
+    graph.setNodeCost(f, 2.0);
+    graph.setNodeCost(f2, 20.0);
+    graph.setNodeCost(f3, 8.0);
+    EXPECT_EQ(graph.getNodeCost(f3), 8.0);
+    EXPECT_EQ(graph.getNodeCost(f4), 1.0);
+    _m.generateLayers();
+    // Function3 has enough slack to be deferred to run alongside the longer Function2
+    std::string expectedLayers = R"###(--------------------
+Layer 0
+--------------------
 Function1
+Function4
+
+--------------------
+Layer 1
+--------------------
 Function2
+Function3
+Function5
+
+)###";
+    EXPECT_EQ(expectedLayers, graph.getConstructedLayersString());
+    EXPECT_EQ(_m.getLayersCount(), 2u);
+}
+TEST(DependencyGraphTest, CorrectLayersCostCriticalPath) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn2);
+    AgentFunctionDescription &f3 = a.newFunction(FUNCTION_NAME3, agent_fn3);
+    AgentFunctionDescription &f4 = a.newFunction(FUNCTION_NAME4, agent_fn4);
+    f2.dependsOn(f);
+    f4.dependsOn(f3);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(f);
+    graph.addRoot(f3);
+    // All functions conflict, the most expensive chain is scheduled first
+    graph.setNodeCost(f4, 5.0);
+    _m.generateLayers();
+    std::string expectedLayers = R"###(--------------------
+Layer 0
+--------------------
+Function3
+
+--------------------
+Layer 1
+--------------------
+Function4
+
+--------------------
+Layer 2
+--------------------
+Function1
 
 --------------------
 Layer 3
 --------------------
+Function2
+
+)###";
+    EXPECT_EQ(expectedLayers, graph.getConstructedLayersString());
+}
+TEST(DependencyGraphTest, CorrectLayersConcurrentHostFunctions) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    HostFunctionDescription hf(HOST_FN_NAME1, host_fn1);
+    HostFunctionDescription hf2(HOST_FN_NAME2, host_fn2);
+    HostFunctionDescription hf3(HOST_FN_NAME3, host_fn3);
+    EXPECT_FALSE(hf.isConcurrent());
+    hf.setConcurrent(true);
+    hf2.setConcurrent(true);
+    EXPECT_TRUE(hf.isConcurrent());
+    hf.dependsOn(f);
+    hf2.dependsOn(f);
+    hf3.dependsOn(f);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(f);
+    _m.generateLayers();
+    // Concurrent host functions share a layer, other host functions remain alone
+    std::string expectedLayers = R"###(--------------------
+Layer 0
+--------------------
+Function1
+
+--------------------
+Layer 1
+--------------------
+HostFn1
 HostFn2
 
+--------------------
+Layer 2
+--------------------
+HostFn3
+
 )###";
     EXPECT_EQ(expectedLayers, graph.getConstructedLayersString());
+    EXPECT_EQ(_m.Layer(1).getHostFunctionsCount(), 2u);
+}
+TEST(DependencyGraphTest, NodeCostExceptions) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    EXPECT_THROW(graph.setNodeCost(f, -1.0), exception::InvalidArgument);
+    EXPECT_THROW(graph.setNodeCost(f, std::numeric_limits<double>::infinity()), exception::InvalidArgument);
+    EXPECT_THROW(graph.setNodeCost(f, std::numeric_limits<double>::quiet_NaN()), exception::InvalidArgument);
+    EXPECT_NO_THROW(graph.setNodeCost(f, 0.0));
+    EXPECT_EQ(graph.getNodeCost(f), 0.0);
 }
 TEST(DependencyGraphTest, InterModelDependency) {
     ModelDescription _m(MODEL_NAME);
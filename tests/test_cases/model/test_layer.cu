@@ -130,6 +130,28 @@ TEST(LayerDescriptionTest, HostFunction) {
     EXPECT_THROW(l.addHostFunction(host_fn), exception::InvalidLayerMember);
 }
 
+TEST(LayerDescriptionTest, ConcurrentHostFunction) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription& a1 = _m.newAgent(AGENT_NAME);
+    auto &f1 = a1.newFunction(FUNCTION_NAME1, agent_fn1);
+    LayerDescription &l = _m.newLayer(LAYER_NAME);
+    l.addConcurrentHostFunction(host_fn);
+    // Layer may contain multiple concurrent host functions
+    EXPECT_NO_THROW(l.addConcurrentHostFunction(host_fn2));
+    EXPECT_EQ(l.getHostFunctionsCount(), 2u);
+    EXPECT_THROW(l.addConcurrentHostFunction(host_fn), exception::InvalidHostFunc);
+    // But nothing else
+    EXPECT_THROW(l.addHostFunction(host_fn), exception::InvalidLayerMember);
+    EXPECT_THROW(l.addAgentFunction(f1), exception::InvalidLayerMember);
+    // Concurrent host functions cannot be added alongside regular host functions or agent functions
+    LayerDescription &l2 = _m.newLayer();
+    l2.addHostFunction(host_fn);
+    EXPECT_THROW(l2.addConcurrentHostFunction(host_fn2), exception::InvalidLayerMember);
+    LayerDescription &l3 = _m.newLayer();
+    l3.addAgentFunction(f1);
+    EXPECT_THROW(l3.addConcurrentHostFunction(host_fn2), exception::InvalidLayerMember);
+}
+
 TEST(LayerDescriptionTest, AgentFunction_WrongModel) {
     ModelDescription _m(MODEL_NAME);
     ModelDescription _m2(WRONG_MODEL_NAME);
@@ -413,5 +435,137 @@ TEST(LayerDescriptionTest, SubModelAndHostOrAgentFunction) {
     EXPECT_THROW(layer4.addAgentFunction(agent_fn1), exception::InvalidLayerMember);
     EXPECT_THROW(layer4.addHostFunction(host_fn), exception::InvalidLayerMember);
 }
+TEST(LayerDescriptionTest, CompactLayersIndependent) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    a.newState(STATE_NAME);
+    a.newState(NEW_STATE_NAME);
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    f1.setInitialState(STATE_NAME);
+    f1.setEndState(STATE_NAME);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn2);
+    f2.setInitialState(NEW_STATE_NAME);
+    f2.setEndState(NEW_STATE_NAME);
+    AgentFunctionDescription &f3 = a2.newFunction(FUNCTION_NAME3, agent_fn3);
+    _m.newLayer(LAYER_NAME).addAgentFunction(f1);
+    _m.newLayer().addAgentFunction(f2);
+    _m.newLayer().addAgentFunction(f3);
+    const std::vector<LayerMerge> merges = _m.compactLayers();
+    ASSERT_EQ(merges.size(), 1u);
+    EXPECT_EQ(merges[0].first_layer, 0u);
+    EXPECT_EQ(merges[0].last_layer, 2u);
+    EXPECT_EQ(merges[0].agent_functions, (std::vector<std::string>{FUNCTION_NAME1, FUNCTION_NAME2, FUNCTION_NAME3}));
+    EXPECT_EQ(_m.getLayersCount(), 1u);
+    EXPECT_EQ(_m.getLayer(LAYER_NAME).getAgentFunctionsCount(), 3u);
+    // Already compact
+    EXPECT_TRUE(_m.compactLayers().empty());
+}
+TEST(LayerDescriptionTest, CompactLayersDependent) {
+    ModelDescription _m(MODEL_NAME);
+    MessageSpatial3D::Description& message = _m.newMessage<MessageSpatial3D>(MESSAGE_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn2);
+    AgentFunctionDescription &f3 = a2.newFunction(FUNCTION_NAME3, agent_fn_messageout1);
+    f3.setMessageOutput(message);
+    AgentFunctionDescription &f4 = a.newFunction(FUNCTION_NAME4, agent_fn_messagein1);
+    f4.setMessageInput(message);
+    AgentFunctionDescription &f5 = a2.newFunction("Function5", agent_fn5);
+    // Same agent state
+    _m.newLayer().addAgentFunction(f1);
+    _m.newLayer().addAgentFunction(f2);
+    // Can merge with f2
+    _m.newLayer().addAgentFunction(f3);
+    // Reads the message list output by f3
+    _m.newLayer().addAgentFunction(f4);
+    // Host functions act as a barrier
+    _m.newLayer().addHostFunction(host_fn);
+    _m.newLayer().addAgentFunction(f5);
+    const std::vector<LayerMerge> merges = _m.compactLayers();
+    ASSERT_EQ(merges.size(), 1u);
+    EXPECT_EQ(merges[0].first_layer, 1u);
+    EXPECT_EQ(merges[0].last_layer, 2u);
+    EXPECT_EQ(merges[0].agent_functions, (std::vector<std::string>{FUNCTION_NAME2, FUNCTION_NAME3}));
+    EXPECT_EQ(_m.getLayersCount(), 5u);
+    EXPECT_EQ(_m.getLayer(1).getAgentFunctionsCount(), 2u);
+    EXPECT_EQ(_m.getLayer(3).getHostFunctionsCount(), 1u);
+}
+TEST(LayerDescriptionTest, CompactLayersMacroProperty) {
+    ModelDescription _m(MODEL_NAME);
+    _m.Environment().newMacroProperty<int>("macro");
+    _m.Environment().newMacroProperty<int>("macro2");
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    AgentFunctionDescription &f2 = a2.newFunction(FUNCTION_NAME2, agent_fn2);
+    // Non-RTC functions are assumed to access all macro properties
+    _m.newLayer().addAgentFunction(f1);
+    _m.newLayer().addAgentFunction(f2);
+    EXPECT_TRUE(_m.compactLayers().empty());
+    // RTC functions are also assumed to access all macro properties, their source may not name the macro property literally
+    ModelDescription _m2(MODEL_NAME);
+    _m2.Environment().newMacroProperty<int>("macro");
+    _m2.Environment().newMacroProperty<int>("macro2");
+    const char *rtc_macro = R"###(
+FLAMEGPU_AGENT_FUNCTION(rtc_macro, flamegpu::MessageNone, flamegpu::MessageNone) {
+    FLAMEGPU->environment.getMacroProperty<int>("macro") += 1;
+    return flamegpu::ALIVE;
+}
+)###";
+    const char *rtc_macro2 = R"###(
+FLAMEGPU_AGENT_FUNCTION(rtc_macro2, flamegpu::MessageNone, flamegpu::MessageNone) {
+    FLAMEGPU->environment.getMacroProperty<int>("macro2") += 1;
+    return flamegpu::ALIVE;
+}
+)###";
+    AgentDescription &b = _m2.newAgent(AGENT_NAME);
+    AgentDescription &b2 = _m2.newAgent(AGENT_NAME2);
+    AgentDescription &b3 = _m2.newAgent("Agent3");
+    _m2.newLayer().addAgentFunction(b.newRTCFunction(FUNCTION_NAME1, rtc_macro));
+    _m2.newLayer().addAgentFunction(b2.newRTCFunction(FUNCTION_NAME2, rtc_macro2));
+    _m2.newLayer().addAgentFunction(b3.newRTCFunction(FUNCTION_NAME3, rtc_macro));
+    EXPECT_TRUE(_m2.compactLayers().empty());
+    EXPECT_EQ(_m2.getLayersCount(), 3u);
+}
+FLAMEGPU_AGENT_FUNCTION(agent_fn_increment, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") + 1);
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(agent_fn_double, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") * 2);
+    return ALIVE;
+}
+TEST(LayerDescriptionTest, CompactLayersSimulation) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    a.newVariable<int>("x", 1);
+    a2.newVariable<int>("x", 1);
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME1, agent_fn_increment);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn_double);
+    AgentFunctionDescription &f3 = a2.newFunction(FUNCTION_NAME3, agent_fn_double);
+    _m.newLayer().addAgentFunction(f1);
+    _m.newLayer().addAgentFunction(f3);
+    _m.newLayer().addAgentFunction(f2);
+    ASSERT_EQ(_m.compactLayers().size(), 1u);
+    ASSERT_EQ(_m.getLayersCount(), 2u);
+    CUDASimulation sim(_m);
+    AgentVector pop(a, 10);
+    AgentVector pop2(a2, 10);
+    sim.setPopulationData(pop);
+    sim.setPopulationData(pop2);
+    sim.step();
+    sim.getPopulationData(pop);
+    sim.getPopulationData(pop2);
+    ASSERT_EQ(pop.size(), 10u);
+    ASSERT_EQ(pop2.size(), 10u);
+    for (unsigned int i = 0; i < 10; ++i) {
+        // (1 + 1) * 2, the order of dependent functions is retained
+        EXPECT_EQ(pop[i].getVariable<int>("x"), 4);
+        EXPECT_EQ(pop2[i].getVariable<int>("x"), 2);
+    }
+}
 }  // namespace test_layer
 }  // namespace flamegpu
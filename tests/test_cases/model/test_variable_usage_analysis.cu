@@ -0,0 +1,223 @@
+/**
+* Tests of VariableUsageAnalysis and CUDAConfig().eliminateUnusedAgentVariables
+*
+* Tests cover:
+* > string literal extraction from RTC source
+* > variables used by RTC functions, conditions and agent output are retained
+* > compiled agent functions and submodel mappings prevent elimination
+* > logging configs retain logged variables
+* > host functions are reported as warnings
+* > CUDASimulation does not store eliminated variables, and they retain their default value
+*/
+#include <array>
+#include <set>
+#include <string>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_variable_usage_analysis {
+const char *MODEL_NAME = "model";
+const char *AGENT_NAME = "agent";
+const char *AGENT_NAME2 = "agent2";
+const unsigned int AGENT_COUNT = 128;
+const char *rtc_increment_x = R"###(
+FLAMEGPU_AGENT_FUNCTION(increment_x, flamegpu::MessageNone, flamegpu::MessageNone) {
+    // FLAMEGPU->getVariable<int>("commented");
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") + 1);
+    return flamegpu::ALIVE;
+}
+)###";
+const char *rtc_condition_y = R"###(
+FLAMEGPU_AGENT_FUNCTION_CONDITION(condition_y) {
+    return FLAMEGPU->getVariable<int>("y") >= 0;
+}
+)###";
+const char *rtc_output_agent2 = R"###(
+FLAMEGPU_AGENT_FUNCTION(output_agent2, flamegpu::MessageNone, flamegpu::MessageNone) {
+    FLAMEGPU->agent_out.setVariable<float>("b", 1.0f);
+    return flamegpu::ALIVE;
+}
+)###";
+FLAMEGPU_AGENT_FUNCTION(compiled_fn, MessageNone, MessageNone) {
+    return ALIVE;
+}
+FLAMEGPU_STEP_FUNCTION(usage_step) {
+    // do nothing
+}
+FLAMEGPU_EXIT_CONDITION(usage_exit) {
+    return EXIT;
+}
+void defineAgent(ModelDescription &model) {
+    AgentDescription &a = model.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newVariable<int>("y", 0);
+    a.newVariable<float>("unused", 12.0f);
+    a.newVariable<int, 3>("unused_array", {1, 2, 3});
+}
+TEST(VariableUsageAnalysisTest, ExtractStringLiterals) {
+    const std::set<std::string> literals = VariableUsageAnalysis::extractStringLiterals(
+        "f(\"a\"); // \"comment\"\n/* \"block\" */ g('\"', \"b\" \"c\", \"esc\\\"aped\");");
+    EXPECT_EQ(literals, std::set<std::string>({"a", "bc", "esc\\\"aped"}));
+}
+TEST(VariableUsageAnalysisTest, RTCUsage) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    AgentDescription &a2 = model.newAgent(AGENT_NAME2);
+    a2.newVariable<float>("a");
+    a2.newVariable<float>("b");
+    AgentDescription &a = model.Agent(AGENT_NAME);
+    AgentFunctionDescription &f1 = a.newRTCFunction("increment_x", rtc_increment_x);
+    f1.setRTCFunctionCondition(rtc_condition_y);
+    AgentFunctionDescription &f2 = a.newRTCFunction("output_agent2", rtc_output_agent2);
+    f2.setAgentOutput(a2);
+    const VariableUsageAnalysis analysis(model);
+    const VariableUsageAnalysis::AgentUsage &usage = analysis.getAgentUsage(AGENT_NAME);
+    EXPECT_TRUE(usage.eliminable);
+    EXPECT_EQ(usage.used, std::set<std::string>({ID_VARIABLE_NAME, "x", "y"}));
+    EXPECT_EQ(usage.unused, std::set<std::string>({"unused", "unused_array"}));
+    EXPECT_EQ(analysis.getEliminableVariables(AGENT_NAME), usage.unused);
+    // Variables of output agents are used by the outputting function
+    EXPECT_EQ(analysis.getEliminableVariables(AGENT_NAME2), std::set<std::string>({"a"}));
+    EXPECT_TRUE(analysis.getWarnings().empty());
+    EXPECT_NE(analysis.getReport().find("unused: unused_array"), std::string::npos);
+    EXPECT_THROW(analysis.getAgentUsage("missing"), exception::InvalidAgentName);
+}
+TEST(VariableUsageAnalysisTest, CompiledFunction) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    model.Agent(AGENT_NAME).newFunction("compiled_fn", compiled_fn);
+    const VariableUsageAnalysis analysis(model);
+    const VariableUsageAnalysis::AgentUsage &usage = analysis.getAgentUsage(AGENT_NAME);
+    EXPECT_FALSE(usage.eliminable);
+    ASSERT_EQ(usage.reasons.size(), 1u);
+    EXPECT_NE(usage.reasons[0].find("compiled_fn"), std::string::npos);
+    EXPECT_TRUE(analysis.getEliminableVariables(AGENT_NAME).empty());
+    EXPECT_NE(analysis.getReport().find("not eligible for elimination"), std::string::npos);
+}
+TEST(VariableUsageAnalysisTest, SubModel) {
+    ModelDescription sub(MODEL_NAME);
+    defineAgent(sub);
+    sub.addExitCondition(usage_exit);
+    ModelDescription model("master");
+    defineAgent(model);
+    SubModelDescription &smd = model.newSubModel("sub", sub);
+    smd.bindAgent(AGENT_NAME, AGENT_NAME, true);
+    const VariableUsageAnalysis analysis(model);
+    EXPECT_FALSE(analysis.getAgentUsage(AGENT_NAME).eliminable);
+    EXPECT_TRUE(analysis.getEliminableVariables(AGENT_NAME).empty());
+}
+TEST(VariableUsageAnalysisTest, LoggingConfig) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    VariableUsageAnalysis analysis(model);
+    EXPECT_EQ(analysis.getEliminableVariables(AGENT_NAME).count("x"), 1u);
+    LoggingConfig log(model);
+    log.agent(AGENT_NAME).logMean<int>("x");
+    analysis.addLoggingConfig(log);
+    EXPECT_EQ(analysis.getEliminableVariables(AGENT_NAME).count("x"), 0u);
+    EXPECT_EQ(analysis.getAgentUsage(AGENT_NAME).used.count("x"), 1u);
+    ModelDescription other("other");
+    defineAgent(other);
+    EXPECT_THROW(analysis.addLoggingConfig(LoggingConfig(other)), exception::InvalidArgument);
+}
+TEST(VariableUsageAnalysisTest, HostFunctionWarnings) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    model.addStepFunction(usage_step);
+    const VariableUsageAnalysis analysis(model);
+    // Host functions do not prevent elimination
+    EXPECT_TRUE(analysis.getAgentUsage(AGENT_NAME).eliminable);
+    ASSERT_EQ(analysis.getWarnings().size(), 1u);
+    EXPECT_NE(analysis.getWarnings()[0].find("step function 'usage_step'"), std::string::npos);
+}
+TEST(VariableUsageAnalysisTest, CUDASimulationElimination) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    model.Agent(AGENT_NAME).newRTCFunction("increment_x", rtc_increment_x);
+    model.newLayer().addAgentFunction(AGENT_NAME, "increment_x");
+    AgentVector pop(model.Agent(AGENT_NAME), AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+        pop[i].setVariable<float>("unused", 1.0f);
+    }
+    {
+        // Disabled by default
+        CUDASimulation sim(model);
+        sim.applyConfig();
+        EXPECT_TRUE(sim.getEliminatedAgentVariables().empty());
+    }
+    CUDASimulation sim(model);
+    sim.SimulationConfig().steps = 2;
+    sim.CUDAConfig().eliminateUnusedAgentVariables = true;
+    StepLoggingConfig log(model);
+    log.agent(AGENT_NAME).logSum<int>("y");
+    sim.setStepLog(log);
+    sim.applyConfig();
+    const auto &eliminated = sim.getEliminatedAgentVariables();
+    ASSERT_EQ(eliminated.size(), 1u);
+    EXPECT_EQ(eliminated.at(AGENT_NAME), std::set<std::string>({"unused", "unused_array"}));
+    // Eliminated variables cannot be logged
+    StepLoggingConfig log2(model);
+    log2.agent(AGENT_NAME).logSum<float>("unused");
+    EXPECT_THROW(sim.setStepLog(log2), exception::InvalidArgument);
+    sim.setPopulationData(pop);
+    sim.simulate();
+    AgentVector out(model.Agent(AGENT_NAME));
+    sim.getPopulationData(out);
+    ASSERT_EQ(out.size(), AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        EXPECT_EQ(out[i].getVariable<int>("x"), static_cast<int>(i) + 2);
+        // Eliminated variables take their default value
+        EXPECT_EQ(out[i].getVariable<float>("unused"), 12.0f);
+        EXPECT_EQ((out[i].getVariable<int, 3>("unused_array")), (std::array<int, 3>{1, 2, 3}));
+    }
+    // The simulation does not store eliminated variables
+    EXPECT_EQ(sim.getCUDAAgent(AGENT_NAME).getAgentDescription().variables.count("unused"), 0u);
+    // Can't eliminate after population data has been set
+    CUDASimulation sim2(model);
+    sim2.setPopulationData(pop);
+    sim2.CUDAConfig().eliminateUnusedAgentVariables = true;
+    EXPECT_THROW(sim2.applyConfig(), exception::InvalidOperation);
+}
+TEST(VariableUsageAnalysisTest, CUDASimulationEliminationWithoutApplyConfig) {
+    ModelDescription model(MODEL_NAME);
+    defineAgent(model);
+    model.Agent(AGENT_NAME).newRTCFunction("increment_x", rtc_increment_x);
+    model.newLayer().addAgentFunction(AGENT_NAME, "increment_x");
+    AgentVector pop(model.Agent(AGENT_NAME), AGENT_COUNT);
+    {
+        // Elimination is applied when the simulation is first initialised, without an explicit applyConfig()
+        CUDASimulation sim(model);
+        sim.CUDAConfig().eliminateUnusedAgentVariables = true;
+        EXPECT_TRUE(sim.getEliminatedAgentVariables().empty());
+        sim.setPopulationData(pop);
+        ASSERT_EQ(sim.getEliminatedAgentVariables().size(), 1u);
+        EXPECT_EQ(sim.getCUDAAgent(AGENT_NAME).getAgentDescription().variables.count("unused"), 0u);
+        EXPECT_NO_THROW(sim.simulate());
+    }
+    {
+        // Enabling after the argument parsing constructor has initialised the simulation
+        const char *argv[3] = { "prog.exe", "--steps", "1" };
+        CUDASimulation sim(model, sizeof(argv) / sizeof(char*), argv);
+        sim.CUDAConfig().eliminateUnusedAgentVariables = true;
+        EXPECT_NO_THROW(sim.applyConfig());
+        EXPECT_EQ(sim.getEliminatedAgentVariables().size(), 1u);
+        sim.setPopulationData(pop);
+        EXPECT_NO_THROW(sim.simulate());
+    }
+    {
+        // Can't eliminate after the simulation has been stepped
+        CUDASimulation sim(model);
+        sim.setPopulationData(pop);
+        sim.step();
+        sim.CUDAConfig().eliminateUnusedAgentVariables = true;
+        EXPECT_THROW(sim.step(), exception::InvalidOperation);
+    }
+}
+}  // namespace test_variable_usage_analysis
+}  // namespace flamegpu
@@ -0,0 +1,166 @@
+/**
+* Tests of memory-mapped AgentVector storage
+*
+* Tests cover:
+* > createMapped() produces a default initialised population
+* > push_back/resize/erase/iteration behave as with host memory
+* > syncMapped() + openMapped() round trip, including after the original has been destroyed
+* > copies are held in host memory, moves retain the mapping
+* > population can be passed to/from CUDASimulation
+* > exceptions for missing and mismatched manifests
+*/
+#include <array>
+#include <fstream>
+#include <string>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/util/detail/filesystem.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_agent_vector_mapped {
+const unsigned int AGENT_COUNT = 1024;
+const char *MAPPED_DIR = "test_agent_vector_mapped";
+class AgentVectorMappedTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        model = new ModelDescription("model");
+        AgentDescription &agent = model->newAgent("agent");
+        agent.newVariable<int>("int", 12);
+        agent.newVariable<float, 3>("float_array", {1.0f, 2.0f, 3.0f});
+    }
+    void TearDown() override {
+        delete model;
+        std::experimental::filesystem::remove_all(MAPPED_DIR);
+    }
+    ModelDescription *model = nullptr;
+};
+
+TEST_F(AgentVectorMappedTest, Create) {
+    AgentVector pop = AgentVector::createMapped(model->Agent("agent"), MAPPED_DIR, AGENT_COUNT);
+    EXPECT_TRUE(pop.isMapped());
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (const auto &ai : pop) {
+        EXPECT_EQ(ai.getVariable<int>("int"), 12);
+        EXPECT_EQ((ai.getVariable<float, 3>("float_array")), (std::array<float, 3>{1.0f, 2.0f, 3.0f}));
+    }
+    EXPECT_TRUE(::exists(path(MAPPED_DIR) / "int.bin"));
+    EXPECT_TRUE(::exists(path(MAPPED_DIR) / "float_array.bin"));
+    EXPECT_FALSE(AgentVector(model->Agent("agent")).isMapped());
+}
+TEST_F(AgentVectorMappedTest, Modify) {
+    AgentVector pop = AgentVector::createMapped(model->Agent("agent"), MAPPED_DIR);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        pop.push_back();
+        pop.back().setVariable<int>("int", static_cast<int>(i));
+    }
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    pop.erase(0, 10);
+    ASSERT_EQ(pop.size(), AGENT_COUNT - 10);
+    const int *data = pop.data<int>("int");
+    for (unsigned int i = 0; i < pop.size(); ++i) {
+        EXPECT_EQ(data[i], static_cast<int>(i + 10));
+    }
+    pop.resize(AGENT_COUNT * 2);
+    EXPECT_EQ(pop[AGENT_COUNT * 2 - 1].getVariable<int>("int"), 12);
+    EXPECT_EQ(pop[0].getVariable<int>("int"), 10);
+}
+TEST_F(AgentVectorMappedTest, Reopen) {
+    {
+        AgentVector pop = AgentVector::createMapped(model->Agent("agent"), MAPPED_DIR, AGENT_COUNT);
+        for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+            pop[i].setVariable<int>("int", static_cast<int>(i) * 3);
+            pop[i].setVariable<float>("float_array", 1, static_cast<float>(i));
+        }
+        pop.pop_back();
+        pop.syncMapped();
+        AgentVector reopened = AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR);
+        EXPECT_EQ(reopened.size(), AGENT_COUNT - 1);
+        EXPECT_EQ(reopened[AGENT_COUNT - 2].getVariable<int>("int"), static_cast<int>(AGENT_COUNT - 2) * 3);
+        // Destruction of either vector updates the manifest
+        pop.pop_back();
+    }
+    AgentVector pop = AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR);
+    ASSERT_EQ(pop.size(), AGENT_COUNT - 2);
+    for (unsigned int i = 0; i < pop.size(); ++i) {
+        EXPECT_EQ(pop[i].getVariable<int>("int"), static_cast<int>(i) * 3);
+        EXPECT_EQ(pop[i].getVariable<float>("float_array", 1), static_cast<float>(i));
+        EXPECT_EQ(pop[i].getVariable<float>("float_array", 2), 3.0f);
+    }
+}
+TEST_F(AgentVectorMappedTest, CopyMove) {
+    AgentVector pop = AgentVector::createMapped(model->Agent("agent"), MAPPED_DIR, AGENT_COUNT);
+    pop[5].setVariable<int>("int", 5);
+    AgentVector copy(pop);
+    EXPECT_FALSE(copy.isMapped());
+    EXPECT_EQ(copy.size(), AGENT_COUNT);
+    EXPECT_EQ(copy[5].getVariable<int>("int"), 5);
+    AgentVector moved(std::move(pop));
+    EXPECT_TRUE(moved.isMapped());
+    EXPECT_FALSE(pop.isMapped());
+    EXPECT_EQ(moved[5].getVariable<int>("int"), 5);
+    // Copy assignment retains the storage of the destination
+    const AgentVector heap(model->Agent("agent"), 10);
+    moved = heap;
+    EXPECT_TRUE(moved.isMapped());
+    EXPECT_EQ(moved.size(), 10u);
+    moved.syncMapped();
+    EXPECT_EQ(AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR).size(), 10u);
+    EXPECT_THROW(copy.syncMapped(), exception::InvalidOperation);
+}
+FLAMEGPU_AGENT_FUNCTION(increment, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("int", FLAMEGPU->getVariable<int>("int") + 1);
+    return ALIVE;
+}
+TEST_F(AgentVectorMappedTest, Simulation) {
+    AgentDescription &agent = model->Agent("agent");
+    agent.newFunction("increment", increment);
+    model->newLayer().addAgentFunction(increment);
+    AgentVector pop = AgentVector::createMapped(agent, MAPPED_DIR, AGENT_COUNT);
+    CUDASimulation sim(*model);
+    sim.setPopulationData(pop);
+    sim.step();
+    sim.getPopulationData(pop);
+    EXPECT_TRUE(pop.isMapped());
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (const auto &ai : pop) {
+        EXPECT_EQ(ai.getVariable<int>("int"), 13);
+    }
+}
+TEST_F(AgentVectorMappedTest, Exceptions) {
+    EXPECT_THROW(AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR), exception::InvalidFilePath);
+    EXPECT_THROW(AgentVector::createMapped(model->Agent("agent"), ""), exception::InvalidFilePath);
+    {
+        AgentVector pop = AgentVector::createMapped(model->Agent("agent"), MAPPED_DIR, AGENT_COUNT);
+    }
+    // Different agent
+    ModelDescription other("other");
+    AgentDescription &other_agent = other.newAgent("agent");
+    other_agent.newVariable<int>("int");
+    other_agent.newVariable<double, 3>("float_array");
+    EXPECT_THROW(AgentVector::openMapped(other_agent, MAPPED_DIR), exception::InvalidInputFile);
+    // Truncated data file
+    {
+        std::ofstream f((path(MAPPED_DIR) / "int.bin").string(), std::ios::trunc | std::ios::binary);
+        f << "abc";
+    }
+    EXPECT_THROW(AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR), exception::InvalidInputFile);
+    // Data file holds a different number of agents
+    {
+        std::ofstream f((path(MAPPED_DIR) / "int.bin").string(), std::ios::trunc | std::ios::binary);
+        f << "abcd";
+    }
+    EXPECT_THROW(AgentVector::openMapped(model->Agent("agent"), MAPPED_DIR), exception::InvalidInputFile);
+    // Failed opens don't rewrite the manifest
+    std::ifstream manifest((path(MAPPED_DIR) / "manifest.txt").string());
+    std::string header;
+    unsigned int version, size;
+    std::string name;
+    manifest >> header >> version >> name >> size;
+    EXPECT_EQ(size, AGENT_COUNT);
+}
+}  // namespace test_agent_vector_mapped
+}  // namespace flamegpu
@@ -0,0 +1,193 @@
+/**
+* Tests of AgentVectorReductions
+*
+* Tests cover:
+* > sum/min/max/count/histogramEven/reduce/transformReduce match reference values
+* > sum OutT prevents overflow, as with HostAgentAPI
+* > results are independent of the number of host threads
+* > results match HostAgentAPI reductions of the same population
+* > empty populations
+* > exceptions for bad variable name/type and array variables
+* > ID collision detection
+*/
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_agent_vector_reductions {
+// Large enough that multiple threads are used
+const unsigned int AGENT_COUNT = 300000;
+FLAMEGPU_CUSTOM_REDUCTION(customMax, a, b) {
+    return a > b ? a : b;
+}
+FLAMEGPU_CUSTOM_REDUCTION(customSum, a, b) {
+    return a + b;
+}
+FLAMEGPU_CUSTOM_TRANSFORM(customTransform, a) {
+    return a <= 0 ? 1 : 0;
+}
+class AgentVectorReductionsTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        model = new ModelDescription("model");
+        AgentDescription &agent = model->newAgent("agent");
+        agent.newVariable<int>("int");
+        agent.newVariable<unsigned char>("uchar");
+        agent.newVariable<float>("float");
+        agent.newVariable<int, 3>("int_array");
+        population = new AgentVector(agent, AGENT_COUNT);
+        std::mt19937_64 rd(0);
+        std::uniform_int_distribution<int> dist(-1000, 1000);
+        std::uniform_real_distribution<float> fdist(-1.0f, 1.0f);
+        int_in.resize(AGENT_COUNT);
+        float_in.resize(AGENT_COUNT);
+        for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+            int_in[i] = dist(rd);
+            float_in[i] = fdist(rd);
+            AgentVector::Agent ai = population->at(i);
+            ai.setVariable<int>("int", int_in[i]);
+            ai.setVariable<unsigned char>("uchar", 255);
+            ai.setVariable<float>("float", float_in[i]);
+        }
+    }
+    void TearDown() override {
+        delete population;
+        delete model;
+    }
+    ModelDescription *model = nullptr;
+    AgentVector *population = nullptr;
+    std::vector<int> int_in;
+    std::vector<float> float_in;
+};
+
+TEST_F(AgentVectorReductionsTest, Sum) {
+    AgentVectorReductions r(*population);
+    EXPECT_EQ(r.sum<int>("int"), std::accumulate(int_in.begin(), int_in.end(), 0));
+    EXPECT_NEAR(r.sum<float>("float"), std::accumulate(float_in.begin(), float_in.end(), 0.0f), 1.0f);
+}
+TEST_F(AgentVectorReductionsTest, SumOutT) {
+    AgentVectorReductions r(*population);
+    // 300000 * 255 overflows unsigned char, but not int64_t
+    EXPECT_EQ(r.sum<unsigned char>("uchar"), static_cast<unsigned char>(AGENT_COUNT * 255));
+    EXPECT_EQ((r.sum<unsigned char, int64_t>("uchar")), static_cast<int64_t>(AGENT_COUNT) * 255);
+}
+TEST_F(AgentVectorReductionsTest, MinMax) {
+    AgentVectorReductions r(*population);
+    EXPECT_EQ(r.min<int>("int"), *std::min_element(int_in.begin(), int_in.end()));
+    EXPECT_EQ(r.max<int>("int"), *std::max_element(int_in.begin(), int_in.end()));
+    EXPECT_EQ(r.min<float>("float"), *std::min_element(float_in.begin(), float_in.end()));
+    EXPECT_EQ(r.max<float>("float"), *std::max_element(float_in.begin(), float_in.end()));
+}
+TEST_F(AgentVectorReductionsTest, Count) {
+    AgentVectorReductions r(*population);
+    EXPECT_EQ(r.count<int>("int", 7), static_cast<unsigned int>(std::count(int_in.begin(), int_in.end(), 7)));
+    EXPECT_EQ(r.count<unsigned char>("uchar", 255), AGENT_COUNT);
+}
+TEST_F(AgentVectorReductionsTest, HistogramEven) {
+    AgentVectorReductions r(*population);
+    const std::vector<unsigned int> hist = r.histogramEven<int>("int", 10, -500, 500);
+    std::vector<unsigned int> expect(10, 0);
+    for (const int &v : int_in) {
+        if (v >= -500 && v < 500)
+            ++expect[(v + 500) / 100];
+    }
+    EXPECT_EQ(hist, expect);
+    EXPECT_THROW(r.histogramEven<int>("int", 10, 500, -500), exception::InvalidArgument);
+}
+TEST_F(AgentVectorReductionsTest, Reduce) {
+    AgentVectorReductions r(*population);
+    EXPECT_EQ(r.reduce<int>("int", customMax, std::numeric_limits<int>::lowest()), *std::max_element(int_in.begin(), int_in.end()));
+    // Init is only applied once
+    EXPECT_EQ(r.reduce<int>("int", customSum, 10), std::accumulate(int_in.begin(), int_in.end(), 10));
+}
+TEST_F(AgentVectorReductionsTest, TransformReduce) {
+    AgentVectorReductions r(*population);
+    const unsigned int expect = static_cast<unsigned int>(std::count_if(int_in.begin(), int_in.end(), [](int v) { return v <= 0; }));
+    EXPECT_EQ((r.transformReduce<int, unsigned int>("int", customTransform, customSum, 0u)), expect);
+}
+TEST_F(AgentVectorReductionsTest, ThreadCountIndependent) {
+    AgentVectorReductions r1(*population, 1);
+    AgentVectorReductions r7(*population, 7);
+    EXPECT_EQ(r1.getThreadCount(), 1u);
+    EXPECT_EQ(r7.getThreadCount(), 7u);
+    EXPECT_EQ(r1.sum<int>("int"), r7.sum<int>("int"));
+    EXPECT_EQ(r1.min<float>("float"), r7.min<float>("float"));
+    EXPECT_EQ(r1.max<float>("float"), r7.max<float>("float"));
+    EXPECT_EQ(r1.count<int>("int", 0), r7.count<int>("int", 0));
+    EXPECT_EQ(r1.histogramEven<float>("float", 16, -1.0f, 1.0f), r7.histogramEven<float>("float", 16, -1.0f, 1.0f));
+    EXPECT_EQ(r1.reduce<int>("int", customSum, 0), r7.reduce<int>("int", customSum, 0));
+}
+TEST_F(AgentVectorReductionsTest, EmptyPopulation) {
+    AgentVector empty(model->Agent("agent"));
+    AgentVectorReductions r(empty);
+    EXPECT_EQ(r.sum<int>("int"), 0);
+    EXPECT_EQ(r.min<int>("int"), std::numeric_limits<int>::max());
+    EXPECT_EQ(r.max<int>("int"), std::numeric_limits<int>::lowest());
+    EXPECT_EQ(r.count<int>("int", 0), 0u);
+    EXPECT_EQ(r.histogramEven<int>("int", 4, 0, 4), std::vector<unsigned int>(4, 0));
+    EXPECT_EQ(r.reduce<int>("int", customSum, 12), 12);
+}
+TEST_F(AgentVectorReductionsTest, Exceptions) {
+    AgentVectorReductions r(*population);
+    EXPECT_THROW(r.sum<int>("nope"), exception::InvalidAgentVar);
+    EXPECT_THROW(r.sum<float>("int"), exception::InvalidVarType);
+    EXPECT_THROW(r.sum<int>("int_array"), exception::UnsupportedVarType);
+    EXPECT_THROW(r.min<int>("int_array"), exception::UnsupportedVarType);
+    EXPECT_THROW(r.max<int>("int_array"), exception::UnsupportedVarType);
+    EXPECT_THROW(r.count<int>("int_array", 0), exception::UnsupportedVarType);
+    EXPECT_THROW(r.histogramEven<int>("int_array", 10, 0, 9), exception::UnsupportedVarType);
+    EXPECT_THROW(r.reduce<int>("int_array", customSum, 0), exception::UnsupportedVarType);
+    EXPECT_THROW((r.transformReduce<int, int>("int_array", customTransform, customSum, 0)), exception::UnsupportedVarType);
+}
+TEST_F(AgentVectorReductionsTest, CountIDCollisions) {
+    // Newly created agents have ID_NOT_SET, which never collides
+    EXPECT_EQ(AgentVectorReductions(*population).countIDCollisions(), 0u);
+    // Internal variables can't be set via the public interface
+    id_t *ids = const_cast<id_t*>(static_cast<const AgentVector*>(population)->data<id_t>(ID_VARIABLE_NAME));
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        ids[i] = i + 1;
+    }
+    AgentVectorReductions r1(*population, 1);
+    AgentVectorReductions r7(*population, 7);
+    EXPECT_EQ(r1.countIDCollisions(), 0u);
+    EXPECT_EQ(r7.countIDCollisions(), 0u);
+    // 3 agents share ID 12, 2 agents share ID AGENT_COUNT / 2
+    ids[AGENT_COUNT / 2] = 12;
+    ids[AGENT_COUNT - 1] = 12;
+    ids[7] = AGENT_COUNT / 2;
+    EXPECT_EQ(r1.countIDCollisions(), 3u);
+    EXPECT_EQ(r7.countIDCollisions(), 3u);
+}
+int device_sum, device_min, device_max;
+unsigned int device_count;
+std::vector<unsigned int> device_hist;
+FLAMEGPU_STEP_FUNCTION(DeviceReductions) {
+    auto agent = FLAMEGPU->agent("agent");
+    device_sum = agent.sum<int>("int");
+    device_min = agent.min<int>("int");
+    device_max = agent.max<int>("int");
+    device_count = agent.count<int>("int", 0);
+    device_hist = agent.histogramEven<int>("int", 20, -1000, 1000);
+}
+TEST_F(AgentVectorReductionsTest, MatchesHostAgentAPI) {
+    model->addStepFunction(DeviceReductions);
+    CUDASimulation sim(*model);
+    sim.setPopulationData(*population);
+    sim.step();
+    AgentVectorReductions r(*population);
+    EXPECT_EQ(r.sum<int>("int"), device_sum);
+    EXPECT_EQ(r.min<int>("int"), device_min);
+    EXPECT_EQ(r.max<int>("int"), device_max);
+    EXPECT_EQ(r.count<int>("int", 0), device_count);
+    EXPECT_EQ(r.histogramEven<int>("int", 20, -1000, 1000), device_hist);
+}
+}  // namespace test_agent_vector_reductions
+}  // namespace flamegpu
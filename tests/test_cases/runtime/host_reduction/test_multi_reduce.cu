@@ -0,0 +1,185 @@
+/**
+* Tests of HostAgentAPI::multiReduce()
+*
+* Tests cover:
+* > results match the individual sum/min/max reductions
+* > results match the host reference implementation, AgentVectorReductions::multiReduce()
+* > repeated variables and operations
+* > OutT prevents overflow of sums
+* > batches larger than a single kernel launch
+* > empty populations and empty requests
+* > exceptions for bad variable name/type and array variables
+*/
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_host_multi_reduce {
+// Large enough that the first stage kernel requires a grid-stride loop
+const unsigned int AGENT_COUNT = 100000;
+// More than can be reduced by a single kernel launch
+const unsigned int WIDE_VARIABLES = 40;
+std::vector<float> float_out;
+std::vector<int64_t> int_out;
+std::vector<int> wide_out;
+float x_sum, y_min, z_max;
+class HostMultiReduceTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        model = new ModelDescription("model");
+        AgentDescription &agent = model->newAgent("agent");
+        agent.newVariable<float>("x");
+        agent.newVariable<float>("y");
+        agent.newVariable<float>("z");
+        agent.newVariable<int>("int");
+        agent.newVariable<int, 2>("int_array");
+        for (unsigned int v = 0; v < WIDE_VARIABLES; ++v) {
+            agent.newVariable<int>("wide" + std::to_string(v));
+        }
+        population = new AgentVector(agent, AGENT_COUNT);
+        std::mt19937_64 rd(0);
+        std::uniform_real_distribution<float> fdist(-100.0f, 100.0f);
+        std::uniform_int_distribution<int> dist(-1000, 1000);
+        for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+            AgentVector::Agent ai = population->at(i);
+            ai.setVariable<float>("x", fdist(rd));
+            ai.setVariable<float>("y", fdist(rd));
+            ai.setVariable<float>("z", fdist(rd));
+            // Large enough that the sum overflows int
+            ai.setVariable<int>("int", std::numeric_limits<int>::max() - dist(rd) - 1000);
+            for (unsigned int v = 0; v < WIDE_VARIABLES; ++v) {
+                ai.setVariable<int>("wide" + std::to_string(v), dist(rd) * static_cast<int>(v));
+            }
+        }
+        float_out.clear();
+        int_out.clear();
+        wide_out.clear();
+    }
+    void TearDown() override {
+        delete population;
+        delete model;
+    }
+    void run() {
+        CUDASimulation sim(*model);
+        sim.setPopulationData(*population);
+        sim.step();
+    }
+    ModelDescription *model = nullptr;
+    AgentVector *population = nullptr;
+};
+const std::vector<ReductionRequest> XYZ_REQUESTS = {
+    {"x", ReductionRequest::Sum}, {"x", ReductionRequest::Min}, {"x", ReductionRequest::Max},
+    {"y", ReductionRequest::Sum}, {"y", ReductionRequest::Min}, {"y", ReductionRequest::Max},
+    {"z", ReductionRequest::Sum}, {"z", ReductionRequest::Min}, {"z", ReductionRequest::Max},
+};
+FLAMEGPU_STEP_FUNCTION(step_xyz) {
+    auto agent = FLAMEGPU->agent("agent");
+    float_out = agent.multiReduce<float>(XYZ_REQUESTS);
+    x_sum = agent.sum<float>("x");
+    y_min = agent.min<float>("y");
+    z_max = agent.max<float>("z");
+}
+TEST_F(HostMultiReduceTest, MatchesIndividualReductions) {
+    model->addStepFunction(step_xyz);
+    run();
+    ASSERT_EQ(float_out.size(), XYZ_REQUESTS.size());
+    // Summation order differs from cub::DeviceReduce::Sum()
+    EXPECT_NEAR(float_out[0], x_sum, 16.0f);
+    EXPECT_EQ(float_out[4], y_min);
+    EXPECT_EQ(float_out[8], z_max);
+}
+TEST_F(HostMultiReduceTest, MatchesHostReference) {
+    model->addStepFunction(step_xyz);
+    run();
+    const std::vector<float> host = AgentVectorReductions(*population).multiReduce<float>(XYZ_REQUESTS);
+    ASSERT_EQ(float_out.size(), host.size());
+    for (size_t i = 0; i < host.size(); ++i) {
+        if (XYZ_REQUESTS[i].op == ReductionRequest::Sum) {
+            EXPECT_NEAR(float_out[i], host[i], 16.0f);
+        } else {
+            EXPECT_EQ(float_out[i], host[i]);
+        }
+    }
+}
+FLAMEGPU_STEP_FUNCTION(step_int_out) {
+    int_out = FLAMEGPU->agent("agent").multiReduce<int, int64_t>({
+        {"int", ReductionRequest::Max}, {"int", ReductionRequest::Sum}, {"int", ReductionRequest::Min}, {"int", ReductionRequest::Sum}});
+}
+TEST_F(HostMultiReduceTest, RepeatedRequestsOutT) {
+    model->addStepFunction(step_int_out);
+    run();
+    const int *data = population->data<int>("int");
+    const int64_t sum = std::accumulate(data, data + AGENT_COUNT, static_cast<int64_t>(0));
+    ASSERT_EQ(int_out.size(), 4u);
+    EXPECT_EQ(int_out[0], *std::max_element(data, data + AGENT_COUNT));
+    EXPECT_EQ(int_out[1], sum);
+    EXPECT_EQ(int_out[2], *std::min_element(data, data + AGENT_COUNT));
+    EXPECT_EQ(int_out[3], sum);
+    EXPECT_EQ(int_out, (AgentVectorReductions(*population).multiReduce<int, int64_t>({
+        {"int", ReductionRequest::Max}, {"int", ReductionRequest::Sum}, {"int", ReductionRequest::Min}, {"int", ReductionRequest::Sum}})));
+}
+std::vector<ReductionRequest> wideRequests() {
+    std::vector<ReductionRequest> rtn;
+    for (unsigned int v = 0; v < WIDE_VARIABLES; ++v) {
+        rtn.push_back({"wide" + std::to_string(v), ReductionRequest::Sum});
+        rtn.push_back({"wide" + std::to_string(v), ReductionRequest::Max});
+    }
+    return rtn;
+}
+FLAMEGPU_STEP_FUNCTION(step_wide) {
+    wide_out = FLAMEGPU->agent("agent").multiReduce<int>(wideRequests());
+}
+TEST_F(HostMultiReduceTest, MultipleLaunches) {
+    model->addStepFunction(step_wide);
+    run();
+    ASSERT_EQ(wide_out.size(), 2 * WIDE_VARIABLES);
+    EXPECT_EQ(wide_out, AgentVectorReductions(*population).multiReduce<int>(wideRequests()));
+    for (unsigned int v = 0; v < WIDE_VARIABLES; ++v) {
+        const int *data = population->data<int>("wide" + std::to_string(v));
+        EXPECT_EQ(wide_out[2 * v], std::accumulate(data, data + AGENT_COUNT, 0));
+        EXPECT_EQ(wide_out[2 * v + 1], *std::max_element(data, data + AGENT_COUNT));
+    }
+}
+FLAMEGPU_STEP_FUNCTION(step_empty) {
+    EXPECT_TRUE(FLAMEGPU->agent("agent").multiReduce<float>({}).empty());
+    float_out = FLAMEGPU->agent("agent").multiReduce<float>(XYZ_REQUESTS);
+}
+TEST_F(HostMultiReduceTest, EmptyPopulation) {
+    model->addStepFunction(step_empty);
+    CUDASimulation sim(*model);
+    sim.step();
+    // Identity values match those of the individual reductions
+    const std::vector<float> host = AgentVectorReductions(AgentVector(model->Agent("agent"))).multiReduce<float>(XYZ_REQUESTS);
+    EXPECT_EQ(float_out, host);
+    EXPECT_EQ(float_out[0], 0.0f);
+    EXPECT_EQ(float_out[1], std::numeric_limits<float>::max());
+    EXPECT_EQ(float_out[2], std::numeric_limits<float>::lowest());
+}
+FLAMEGPU_STEP_FUNCTION(step_exceptions) {
+    auto agent = FLAMEGPU->agent("agent");
+    EXPECT_THROW(agent.multiReduce<float>({{"x", ReductionRequest::Sum}, {"nope", ReductionRequest::Sum}}), exception::InvalidAgentVar);
+    EXPECT_THROW(agent.multiReduce<float>({{"x", ReductionRequest::Sum}, {"int", ReductionRequest::Sum}}), exception::InvalidVarType);
+    EXPECT_THROW(agent.multiReduce<int>({{"int_array", ReductionRequest::Min}}), exception::UnsupportedVarType);
+    EXPECT_THROW(agent.multiReduce<int>({{"int", static_cast<ReductionRequest::Op>(99)}}), exception::InvalidArgument);
+}
+TEST_F(HostMultiReduceTest, Exceptions) {
+    model->addStepFunction(step_exceptions);
+    run();
+    AgentVectorReductions r(*population);
+    EXPECT_THROW(r.multiReduce<float>({{"x", ReductionRequest::Sum}, {"nope", ReductionRequest::Sum}}), exception::InvalidAgentVar);
+    EXPECT_THROW(r.multiReduce<float>({{"x", ReductionRequest::Sum}, {"int", ReductionRequest::Sum}}), exception::InvalidVarType);
+    EXPECT_THROW(r.multiReduce<int>({{"int_array", ReductionRequest::Min}}), exception::UnsupportedVarType);
+    EXPECT_THROW(r.multiReduce<int>({{"int", static_cast<ReductionRequest::Op>(99)}}), exception::InvalidArgument);
+}
+}  // namespace test_host_multi_reduce
+}  // namespace flamegpu
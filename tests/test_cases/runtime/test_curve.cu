@@ -0,0 +1,97 @@
+/**
+* Tests of the Curve variable table's perfect hash layout
+*
+* Tests cover:
+* > buildLayout() assigns each hash a unique slot
+* > buildLayout() fails if there are more hashes than slots
+* > slots are retained when a variable is unregistered and registered again
+* > registered variables always occupy unique slots
+*/
+#include <random>
+#include <set>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/runtime/detail/curve/curve.cuh"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_curve {
+using detail::curve::Curve;
+// Local copies, as gtest's assertions take their arguments by reference
+const Curve::Variable UNKNOWN_VARIABLE = Curve::UNKNOWN_VARIABLE;
+const int MAX_VARIABLES = Curve::MAX_VARIABLES;
+std::vector<Curve::VariableHash> randomHashes(const unsigned int count, const unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::set<Curve::VariableHash> hashes;
+    while (hashes.size() < count) {
+        hashes.insert(rng());
+    }
+    return std::vector<Curve::VariableHash>(hashes.begin(), hashes.end());
+}
+void checkLayout(const unsigned int count) {
+    for (unsigned int seed = 0; seed < 8; ++seed) {
+        const std::vector<Curve::VariableHash> hashes = randomHashes(count, seed);
+        std::vector<Curve::VariableHash> displacements(Curve::DISPLACEMENT_BUCKETS);
+        ASSERT_TRUE(Curve::buildLayout(hashes, displacements.data()));
+        std::set<Curve::Variable> slots;
+        for (const auto &h : hashes) {
+            const Curve::Variable slot = Curve::hashSlot(h, displacements[Curve::hashBucket(h)]);
+            EXPECT_GE(slot, 0);
+            EXPECT_LT(slot, MAX_VARIABLES);
+            slots.insert(slot);
+        }
+        EXPECT_EQ(slots.size(), hashes.size());
+    }
+}
+TEST(CurveTest, BuildLayout) {
+    checkLayout(1);
+    checkLayout(100);
+    checkLayout(512);
+    checkLayout(Curve::MAX_VARIABLES);
+}
+TEST(CurveTest, BuildLayoutFull) {
+    const std::vector<Curve::VariableHash> hashes = randomHashes(Curve::MAX_VARIABLES + 1, 12);
+    std::vector<Curve::VariableHash> displacements(Curve::DISPLACEMENT_BUCKETS);
+    EXPECT_FALSE(Curve::buildLayout(hashes, displacements.data()));
+}
+TEST(CurveTest, SlotRetained) {
+    // Ensure Curve has been initialised on the active device
+    ModelDescription model("model");
+    model.newAgent("agent");
+    CUDASimulation sim(model);
+    sim.applyConfig();
+    Curve &curve = Curve::getInstance();
+    // Hashes are unlikely to collide with any variables left registered by other tests
+    const std::vector<Curve::VariableHash> hashes = randomHashes(64, 1234);
+    const int size_before = curve.size();
+    int d = 0;
+    for (const auto &h : hashes) {
+        ASSERT_NE(curve.registerVariableByHash(h, &d, sizeof(int), 1), UNKNOWN_VARIABLE);
+    }
+    EXPECT_EQ(curve.size(), size_before + static_cast<int>(hashes.size()));
+    // Later registrations may move variables which share a bucket, but each remains in a unique slot
+    std::set<Curve::Variable> slots;
+    for (const auto &h : hashes) {
+        const Curve::Variable slot = curve.getVariableHandle(h);
+        EXPECT_NE(slot, UNKNOWN_VARIABLE);
+        slots.insert(slot);
+    }
+    EXPECT_EQ(slots.size(), hashes.size());
+    // Unregistered variables are not found, but retain their slot when registered again
+    const Curve::Variable slot = curve.getVariableHandle(hashes[0]);
+    curve.unregisterVariableByHash(hashes[0]);
+    EXPECT_EQ(curve.getVariableHandle(hashes[0]), UNKNOWN_VARIABLE);
+    EXPECT_EQ(curve.size(), size_before + static_cast<int>(hashes.size()) - 1);
+    EXPECT_EQ(curve.registerVariableByHash(hashes[0], &d, sizeof(int), 1), slot);
+    for (const auto &h : hashes) {
+        curve.unregisterVariableByHash(h);
+    }
+    EXPECT_EQ(curve.size(), size_before);
+    EXPECT_THROW(curve.unregisterVariableByHash(hashes[0]), exception::CurveException);
+}
+}  // namespace test_curve
+}  // namespace flamegpu
@@ -5,10 +5,16 @@
  * Tests cover:
  * > init() [does it work, can we host multiple models]
  * > free() [does it work, can we re-host a model]
- * > Out of space exception
- * Implied tests: (Covered as a result of other tests)
- * > defrag() [init uses this]
+ * > Overflow of large properties to global memory
+ * > Overflow of instances which do not fit within the constant buffer
+ * > Overflow of properties added to an initialised instance
+ * > Only modified ranges are uploaded
+ * > Uploads by submodels are attributed to the parent's step
  */
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "flamegpu/flamegpu.h"
 
@@ -44,6 +50,68 @@ FLAMEGPU_STEP_FUNCTION(Multi_ms2) {
     ASSERT_EQ(FLAMEGPU->environment.getProperty<double>("ms1_float2"), MS2_VAL);
 }
 
+const unsigned int OVERFLOW_LEN = 100;
+const unsigned int INSTANCE_PROPS = 64;
+const unsigned int INSTANCE_COUNT = 24;
+FLAMEGPU_STEP_FUNCTION(OverflowTest) {
+    const std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> a = FLAMEGPU->environment.getProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_a");
+    ASSERT_EQ(a[0], 1);
+    ASSERT_EQ(a[EnvironmentManager::MAX_BUFFER_SIZE / 2 - 1], 2);
+    ASSERT_EQ(FLAMEGPU->environment.getProperty<char>("char_5kb_c", 7), 3);
+    ASSERT_EQ(FLAMEGPU->environment.getProperty<float>("small"), 14.0f);
+    // Update an overflowed element, this is checked by the following step
+    if (FLAMEGPU->getStepCounter() == 0) {
+        FLAMEGPU->environment.setProperty<char>("char_5kb_b", 12, 4);
+    } else {
+        ASSERT_EQ(FLAMEGPU->environment.getProperty<char>("char_5kb_b", 12), 4);
+    }
+}
+FLAMEGPU_AGENT_FUNCTION(ReadOverflow, MessageNone, MessageNone) {
+    const unsigned int i = FLAMEGPU->getID() % OVERFLOW_LEN;
+    FLAMEGPU->setVariable<int>("a", FLAMEGPU->environment.getProperty<int>("overflow", i));
+    FLAMEGPU->setVariable<int>("b", FLAMEGPU->environment.getProperty<int>("constant"));
+    return ALIVE;
+}
+const char *rtc_ReadOverflow = R"###(
+FLAMEGPU_AGENT_FUNCTION(ReadOverflow, flamegpu::MessageNone, flamegpu::MessageNone) {
+    const unsigned int i = FLAMEGPU->getID() % 100;
+    FLAMEGPU->setVariable<int>("a", FLAMEGPU->environment.getProperty<int>("overflow", i));
+    FLAMEGPU->setVariable<int>("b", FLAMEGPU->environment.getProperty<int>("constant"));
+    return flamegpu::ALIVE;
+}
+)###";
+FLAMEGPU_STEP_FUNCTION(IncrementOverflow) {
+    for (unsigned int i = 0; i < OVERFLOW_LEN; ++i) {
+        FLAMEGPU->environment.setProperty<int>("overflow", i, FLAMEGPU->environment.getProperty<int>("overflow", i) + 1);
+    }
+}
+FLAMEGPU_AGENT_FUNCTION(ReadRuntimeOverflow, MessageNone, MessageNone) {
+    const unsigned int i = FLAMEGPU->getID() % OVERFLOW_LEN;
+    FLAMEGPU->setVariable<int>("a", FLAMEGPU->environment.getProperty<int>("overflow", i));
+    FLAMEGPU->setVariable<int>("b", FLAMEGPU->environment.getProperty<int>("runtime_a", i) + FLAMEGPU->environment.getProperty<int>("runtime_b", i));
+    return ALIVE;
+}
+FLAMEGPU_STEP_FUNCTION(SetSingle) {
+    FLAMEGPU->environment.setProperty<double>("p5", FLAMEGPU->environment.getProperty<double>("p5") + 1);
+    FLAMEGPU->environment.setProperty<double>("p5", FLAMEGPU->environment.getProperty<double>("p5") + 1);
+}
+FLAMEGPU_AGENT_FUNCTION(ReadInstance, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<double>("first", FLAMEGPU->environment.getProperty<double>("p0"));
+    FLAMEGPU->setVariable<double>("last", FLAMEGPU->environment.getProperty<double>("p63"));
+    return ALIVE;
+}
+FLAMEGPU_EXIT_CONDITION(ExitAlways) {
+    return EXIT;
+}
+
+/**
+ * Provides the tests with access to the EnvironmentManager singleton, this is never constructed
+ */
+class EnvironmentManagerAccess : public EnvironmentManager {
+ public:
+    static EnvironmentManager &get() { return getInstance(); }
+};
+
 class MiniSim {
  public:
     explicit MiniSim(const char *model_name = "model")
@@ -106,17 +174,194 @@ TEST_F(EnvironmentManagerTest, Alignment) {
     ms->run();
 }
 
-// Test bounds limit
-TEST_F(EnvironmentManagerTest, OutOfMemory1) {
+// Properties larger than the constant buffer overflow to global memory
+TEST_F(EnvironmentManagerTest, Overflow) {
     std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_a = {};
-    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_b;
-    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_c;
+    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_b = {};
+    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_c = {};
+    char_5kb_a[0] = 1;
+    char_5kb_a[EnvironmentManager::MAX_BUFFER_SIZE / 2 - 1] = 2;
+    char_5kb_c[7] = 3;
     ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_a", char_5kb_a);
     ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_b", char_5kb_b);
     ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_c", char_5kb_c);
-    EXPECT_THROW(ms->run(), exception::OutOfMemory);
+    ms->env.newProperty<float>("small", 14.0f);
+    ms->model.addStepFunction(OverflowTest);
+    CUDASimulation cudaSimulation(ms->model);
+    cudaSimulation.SimulationConfig().steps = 2;
+    cudaSimulation.setPopulationData(*ms->population);
+    EXPECT_NO_THROW(cudaSimulation.simulate());
+}
+void defineOverflowModel(ModelDescription &model, bool rtc) {
+    std::array<int, OVERFLOW_LEN> overflow;
+    for (unsigned int i = 0; i < OVERFLOW_LEN; ++i) {
+        overflow[i] = static_cast<int>(i);
+    }
+    model.Environment().newProperty<int, OVERFLOW_LEN>("overflow", overflow);
+    model.Environment().newProperty<int>("constant", 12);
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<int>("a", -1);
+    agent.newVariable<int>("b", -1);
+    if (rtc) {
+        agent.newRTCFunction("ReadOverflow", rtc_ReadOverflow);
+    } else {
+        agent.newFunction("ReadOverflow", ReadOverflow);
+    }
+    model.newLayer().addAgentFunction(agent.Function("ReadOverflow"));
+    model.addStepFunction(IncrementOverflow);
+}
+void runOverflowModel(ModelDescription &model) {
+    AgentVector population(model.Agent("agent"), TEST_LEN);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 2;
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.simulate();
+    cudaSimulation.getPopulationData(population);
+    // Each element was updated individually, but the modified ranges are coalesced into a single upload
+    const auto uploads = cudaSimulation.getEnvironmentUploadSteps();
+    ASSERT_EQ(uploads.size(), 2u);
+    EXPECT_EQ(uploads[1].uploads, 1u);
+    EXPECT_EQ(uploads[1].bytes, OVERFLOW_LEN * sizeof(int));
+    for (const auto &agent : population) {
+        // The device reads the value after the first step's increment
+        EXPECT_EQ(agent.getVariable<int>("a"), static_cast<int>(agent.getID() % OVERFLOW_LEN) + 1);
+        EXPECT_EQ(agent.getVariable<int>("b"), 12);
+    }
+}
+// Overflowed properties can be read on the device, and updates from host functions are visible
+TEST(EnvironmentManagerTest2, DeviceOverflow) {
+    ModelDescription model("model");
+    defineOverflowModel(model, false);
+    runOverflowModel(model);
+}
+TEST(EnvironmentManagerTest2, DeviceOverflowRTC) {
+    ModelDescription model("model");
+    defineOverflowModel(model, true);
+    runOverflowModel(model);
+}
+// Properties added to an initialised instance may overflow, relocating the instance's existing overflowed properties
+TEST(EnvironmentManagerTest2, RuntimeOverflow) {
+    ModelDescription model("model");
+    std::array<int, OVERFLOW_LEN> overflow;
+    for (unsigned int i = 0; i < OVERFLOW_LEN; ++i) {
+        overflow[i] = static_cast<int>(i);
+    }
+    model.Environment().newProperty<int, OVERFLOW_LEN>("overflow", overflow);
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<int>("a", 0);
+    agent.newVariable<int>("b", 0);
+    agent.newFunction("ReadRuntimeOverflow", ReadRuntimeOverflow);
+    model.newLayer().addAgentFunction(agent.Function("ReadRuntimeOverflow"));
+    AgentVector population(agent, TEST_LEN);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 1;
+    cudaSimulation.setPopulationData(population);
+    // Both properties are larger than MAX_CONSTANT_PROPERTY_SIZE, so overflow, the second grows the overflow buffer
+    ASSERT_GT(sizeof(overflow), EnvironmentManager::MAX_CONSTANT_PROPERTY_SIZE);
+    std::array<int, OVERFLOW_LEN> runtime_a, runtime_b;
+    for (unsigned int i = 0; i < OVERFLOW_LEN; ++i) {
+        runtime_a[i] = static_cast<int>(i * 2);
+        runtime_b[i] = static_cast<int>(i * 3);
+    }
+    auto &env = EnvironmentManagerAccess::get();
+    EXPECT_NO_THROW((env.newProperty<int, OVERFLOW_LEN>(cudaSimulation.getInstanceID(), "runtime_a", runtime_a)));
+    EXPECT_NO_THROW((env.newProperty<int, OVERFLOW_LEN>(cudaSimulation.getInstanceID(), "runtime_b", runtime_b)));
+    EXPECT_EQ((env.getProperty<int, OVERFLOW_LEN>(cudaSimulation.getInstanceID(), "runtime_a")), runtime_a);
+    EXPECT_EQ((env.getProperty<int, OVERFLOW_LEN>(cudaSimulation.getInstanceID(), "overflow")), overflow);
+    cudaSimulation.simulate();
+    cudaSimulation.getPopulationData(population);
+    for (const auto &a : population) {
+        const unsigned int i = a.getID() % OVERFLOW_LEN;
+        ASSERT_EQ(a.getVariable<int>("a"), static_cast<int>(i));
+        ASSERT_EQ(a.getVariable<int>("b"), static_cast<int>(i * 5));
+    }
+}
+// Concurrent instances whose properties exceed the constant buffer, each have their own segment or overflow
+/**
+ * Defines an agent which reads properties p0 and p63 of the model's INSTANCE_PROPS double properties, in the model's first layer
+ */
+AgentDescription &defineInstanceModel(ModelDescription &model) {
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<double>("first", 0);
+    agent.newVariable<double>("last", 0);
+    agent.newFunction("ReadInstance", ReadInstance);
+    model.newLayer().addAgentFunction(agent.Function("ReadInstance"));
+    for (unsigned int i = 0; i < INSTANCE_PROPS; ++i) {
+        model.Environment().newProperty<double>("p" + std::to_string(i), 0);
+    }
+    return agent;
+}
+TEST(EnvironmentManagerTest2, ManyInstances) {
+    ModelDescription model("model");
+    AgentDescription &agent = defineInstanceModel(model);
+    // Combined, the instances require more space than the constant buffer
+    ASSERT_GT(INSTANCE_COUNT * INSTANCE_PROPS * sizeof(double), EnvironmentManager::MAX_BUFFER_SIZE);
+    AgentVector population(agent, TEST_LEN);
+    std::vector<std::unique_ptr<CUDASimulation>> sims;
+    for (unsigned int i = 0; i < INSTANCE_COUNT; ++i) {
+        // Each instance takes a copy of the model, so has unique values
+        model.Environment().setProperty<double>("p0", i);
+        model.Environment().setProperty<double>("p63", i * 2.0);
+        sims.emplace_back(new CUDASimulation(model));
+        sims.back()->setPopulationData(population);
+    }
+    for (unsigned int i = 0; i < INSTANCE_COUNT; ++i) {
+        sims[i]->step();
+    }
+    for (unsigned int i = 0; i < INSTANCE_COUNT; ++i) {
+        sims[i]->getPopulationData(population);
+        for (const auto &a : population) {
+            ASSERT_EQ(a.getVariable<double>("first"), i);
+            ASSERT_EQ(a.getVariable<double>("last"), i * 2.0);
+        }
+    }
 }
 
+// Only the modified property is uploaded
+TEST(EnvironmentManagerTest2, UploadModifiedRanges) {
+    ModelDescription model("model");
+    AgentDescription &agent = defineInstanceModel(model);
+    model.newLayer().addAgentFunction(agent.Function("ReadInstance"));
+    model.addStepFunction(SetSingle);
+    AgentVector population(agent, TEST_LEN);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 3;
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.simulate();
+    const auto uploads = cudaSimulation.getEnvironmentUploadSteps();
+    ASSERT_EQ(uploads.size(), 3u);
+    for (unsigned int i = 1; i < uploads.size(); ++i) {
+        // Set twice by the previous step, uploaded once by the first layer, not uploaded by the second layer
+        EXPECT_EQ(uploads[i].uploads, 1u);
+        EXPECT_EQ(uploads[i].bytes, sizeof(double));
+    }
+}
+// Copies performed by a submodel are attributed to the parent's step
+TEST(EnvironmentManagerTest2, UploadSubModel) {
+    ModelDescription sub_model("sub");
+    defineInstanceModel(sub_model);
+    sub_model.addStepFunction(SetSingle);
+    sub_model.addExitCondition(ExitAlways);
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<double>("first", 0);
+    agent.newVariable<double>("last", 0);
+    SubModelDescription &sub_desc = model.newSubModel("sub", sub_model);
+    sub_desc.bindAgent("agent", "agent", true, true);
+    model.newLayer().addSubModel("sub");
+    AgentVector population(agent, TEST_LEN);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 3;
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.simulate();
+    // The parent model has no environment properties, so every copy was performed by the submodel
+    const auto uploads = cudaSimulation.getEnvironmentUploadSteps();
+    ASSERT_EQ(uploads.size(), 3u);
+    for (const auto &step : uploads) {
+        EXPECT_GE(step.uploads, 1u);
+        EXPECT_GE(step.bytes, sizeof(double));
+    }
+}
 // Multiple models
 TEST(EnvironmentManagerTest2, MultipleModels) {
     MiniSim *ms1 = new MiniSim("ms1");
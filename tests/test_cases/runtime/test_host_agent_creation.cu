@@ -788,5 +788,39 @@ TEST(HostAgentCreationTest, AgentID_MultipleAgents) {
     }
     ASSERT_EQ(ids_b.size(), 2 * POP_SIZE);  // No collisions
 }
+FLAMEGPU_STEP_FUNCTION(HandleOutlivesGrowth) {
+    auto t = FLAMEGPU->agent("agent");
+    // Hold the first agent whilst the backing arena grows several times
+    HostNewAgentAPI first = t.newAgent();
+    first.setVariable<float>("x", 1.0f);
+    for (unsigned int i = 1; i < NEW_AGENT_COUNT; ++i)
+        t.newAgent().setVariable<float>("x", 2.0f);
+    // Writes through the original handle should still reach the first agent
+    first.setVariable<float>("x", 3.0f);
+}
+TEST(HostAgentCreationTest, HandleOutlivesArenaGrowth) {
+    ModelDescription model("TestModel");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<float>("x");
+    model.addStepFunction(HandleOutlivesGrowth);
+    CUDASimulation cudaSimulation(model);
+    // Repeat, so that the second step reuses the arena and device staging buffer
+    cudaSimulation.SimulationConfig().steps = 2;
+    cudaSimulation.simulate();
+    AgentVector population(model.Agent("agent"));
+    cudaSimulation.getPopulationData(population);
+    EXPECT_EQ(population.size(), 2 * NEW_AGENT_COUNT);
+    unsigned int is_2 = 0;
+    unsigned int is_3 = 0;
+    for (AgentVector::Agent ai : population) {
+        const float val = ai.getVariable<float>("x");
+        if (val == 2.0f)
+            is_2++;
+        else if (val == 3.0f)
+            is_3++;
+    }
+    EXPECT_EQ(is_3, 2u);
+    EXPECT_EQ(is_2, 2 * (NEW_AGENT_COUNT - 1));
+}
 }  // namespace test_host_agent_creation
 }  // namespace flamegpu
@@ -0,0 +1,254 @@
+/**
+* Tests of PhiloxRandom and CUDASimulation::Config::counterBasedRandom
+*
+* Tests cover:
+* > Philox4x32-10 known answer tests
+* > host distributions are in range and reproducible
+* > device agent functions (compiled and RTC) and conditions generate the same values as the host
+* > values do not depend on the composition of the layer
+* > no curand state is allocated
+* > submodels generate different values each time they are run
+*/
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_philox_random {
+const char *MODEL_NAME = "model";
+const char *AGENT_NAME = "agent";
+const char *FUNC_NAME = "random_fn";
+const unsigned int AGENT_COUNT = 1024;
+const uint64_t SEED = 0x123456789ABCull;
+FLAMEGPU_AGENT_FUNCTION(random_fn, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<float>("uniform_f", FLAMEGPU->random.uniform<float>());
+    FLAMEGPU->setVariable<double>("uniform_d", FLAMEGPU->random.uniform<double>());
+    FLAMEGPU->setVariable<int>("uniform_i", FLAMEGPU->random.uniform<int>(-100, 100));
+    FLAMEGPU->setVariable<float>("normal_f", FLAMEGPU->random.normal<float>());
+    return ALIVE;
+}
+const char *rtc_random_fn = R"###(
+FLAMEGPU_AGENT_FUNCTION(random_fn, flamegpu::MessageNone, flamegpu::MessageNone) {
+    FLAMEGPU->setVariable<float>("uniform_f", FLAMEGPU->random.uniform<float>());
+    FLAMEGPU->setVariable<double>("uniform_d", FLAMEGPU->random.uniform<double>());
+    FLAMEGPU->setVariable<int>("uniform_i", FLAMEGPU->random.uniform<int>(-100, 100));
+    FLAMEGPU->setVariable<float>("normal_f", FLAMEGPU->random.normal<float>());
+    return flamegpu::ALIVE;
+}
+)###";
+FLAMEGPU_AGENT_FUNCTION_CONDITION(random_condition) {
+    return FLAMEGPU->random.uniform<float>() < 0.5f;
+}
+FLAMEGPU_AGENT_FUNCTION(mark_fn, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("uniform_i", 1);
+    return ALIVE;
+}
+FLAMEGPU_EXIT_CONDITION(exit_always) {
+    return EXIT;
+}
+void defineModel(ModelDescription &model) {
+    AgentDescription &agent = model.newAgent(AGENT_NAME);
+    agent.newVariable<float>("uniform_f", 0);
+    agent.newVariable<double>("uniform_d", 0);
+    agent.newVariable<int>("uniform_i", 0);
+    agent.newVariable<float>("normal_f", 0);
+}
+/**
+ * Checks that each agent holds the values produced by the host implementation during the given step
+ */
+void checkPopulation(const AgentVector &population, const unsigned int step) {
+    ASSERT_EQ(population.size(), AGENT_COUNT);
+    const PhiloxRandom::Key key = {SEED, step, PhiloxRandom::agentFunctionStream(AGENT_NAME, FUNC_NAME)};
+    for (const auto &agent : population) {
+        PhiloxRandom host(key, agent.getID());
+        EXPECT_EQ(agent.getVariable<float>("uniform_f"), host.uniform<float>());
+        EXPECT_EQ(agent.getVariable<double>("uniform_d"), host.uniform<double>());
+        EXPECT_EQ(agent.getVariable<int>("uniform_i"), host.uniform<int>(-100, 100));
+        // Transcendental functions may differ in their least significant bits
+        const float normal = host.normal<float>();
+        EXPECT_NEAR(agent.getVariable<float>("normal_f"), normal, 1e-5f * std::max(1.0f, std::abs(normal)));
+    }
+}
+void runDeviceMatchesHost(ModelDescription &model) {
+    model.newLayer().addAgentFunction(AGENT_NAME, FUNC_NAME);
+    CUDASimulation sim(model);
+    sim.SimulationConfig().random_seed = SEED;
+    sim.SimulationConfig().steps = 2;
+    sim.CUDAConfig().counterBasedRandom = true;
+    sim.applyConfig();
+    AgentVector init_population(model.Agent(AGENT_NAME), AGENT_COUNT);
+    sim.setPopulationData(init_population);
+    sim.simulate();
+    AgentVector population(model.Agent(AGENT_NAME));
+    sim.getPopulationData(population);
+    // Values were set during the second step
+    checkPopulation(population, 1);
+    // The curand state array is not allocated
+    EXPECT_EQ(sim.getMemoryReport().at("random").device, 0u);
+}
+TEST(PhiloxRandomTest, KnownAnswer) {
+    // Known answer tests from the Random123 library
+    const unsigned int key0[2] = {0, 0};
+    const PhiloxRandom::Block r0 = PhiloxRandom::philox4x32_10(PhiloxRandom::Block{{0, 0, 0, 0}}, key0);
+    EXPECT_EQ(r0.v[0], 0x6627e8d5u);
+    EXPECT_EQ(r0.v[1], 0xe169c58du);
+    EXPECT_EQ(r0.v[2], 0xbc57ac4cu);
+    EXPECT_EQ(r0.v[3], 0x9b00dbd8u);
+    const unsigned int key1[2] = {0xffffffffu, 0xffffffffu};
+    const PhiloxRandom::Block r1 = PhiloxRandom::philox4x32_10(PhiloxRandom::Block{{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}}, key1);
+    EXPECT_EQ(r1.v[0], 0x408f276du);
+    EXPECT_EQ(r1.v[1], 0x41c83b0eu);
+    EXPECT_EQ(r1.v[2], 0xa20bc7c6u);
+    EXPECT_EQ(r1.v[3], 0x6d5451fdu);
+    const unsigned int key2[2] = {0xa4093822u, 0x299f31d0u};
+    const PhiloxRandom::Block r2 = PhiloxRandom::philox4x32_10(PhiloxRandom::Block{{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}}, key2);
+    EXPECT_EQ(r2.v[0], 0xd16cfe09u);
+    EXPECT_EQ(r2.v[1], 0x94fdccebu);
+    EXPECT_EQ(r2.v[2], 0x5001e420u);
+    EXPECT_EQ(r2.v[3], 0x24126ea1u);
+}
+TEST(PhiloxRandomTest, HostDistributions) {
+    PhiloxRandom a(SEED, 12, 3, 4);
+    PhiloxRandom b(SEED, 12, 3, 4);
+    PhiloxRandom c(SEED, 13, 3, 4);
+    double sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+        const float f = a.uniform<float>();
+        EXPECT_GT(f, 0.0f);
+        EXPECT_LE(f, 1.0f);
+        // Streams with the same key and counter are identical
+        EXPECT_EQ(b.uniform<float>(), f);
+        // Streams of different agents differ
+        EXPECT_NE(c.uniform<float>(), f);
+        const int x = a.uniform<int>(-3, 3);
+        b.uniform<int>(-3, 3);
+        c.uniform<int>(-3, 3);
+        EXPECT_GE(x, -3);
+        EXPECT_LE(x, 3);
+        sum += a.normal<double>();
+        b.normal<double>();
+        c.normal<double>();
+    }
+    EXPECT_NEAR(sum / 10000, 0.0, 0.05);
+    EXPECT_EQ(a.getCallIndex(), 30000u);
+    EXPECT_NE(PhiloxRandom::agentFunctionStream(AGENT_NAME, FUNC_NAME), PhiloxRandom::agentFunctionStream(AGENT_NAME, FUNC_NAME, true));
+}
+TEST(PhiloxRandomTest, DeviceMatchesHost) {
+    ModelDescription model(MODEL_NAME);
+    defineModel(model);
+    model.Agent(AGENT_NAME).newFunction(FUNC_NAME, random_fn);
+    runDeviceMatchesHost(model);
+}
+TEST(PhiloxRandomTest, RTCDeviceMatchesHost) {
+    ModelDescription model(MODEL_NAME);
+    defineModel(model);
+    model.Agent(AGENT_NAME).newRTCFunction(FUNC_NAME, rtc_random_fn);
+    runDeviceMatchesHost(model);
+}
+TEST(PhiloxRandomTest, ConditionMatchesHost) {
+    ModelDescription model(MODEL_NAME);
+    defineModel(model);
+    AgentFunctionDescription &fn = model.Agent(AGENT_NAME).newFunction("mark_fn", mark_fn);
+    fn.setFunctionCondition(random_condition);
+    model.newLayer().addAgentFunction(fn);
+    CUDASimulation sim(model);
+    sim.SimulationConfig().random_seed = SEED;
+    sim.CUDAConfig().counterBasedRandom = true;
+    sim.applyConfig();
+    AgentVector init_population(model.Agent(AGENT_NAME), AGENT_COUNT);
+    sim.setPopulationData(init_population);
+    sim.step();
+    AgentVector population(model.Agent(AGENT_NAME));
+    sim.getPopulationData(population);
+    ASSERT_EQ(population.size(), AGENT_COUNT);
+    const PhiloxRandom::Key key = {SEED, 0, PhiloxRandom::agentFunctionStream(AGENT_NAME, "mark_fn", true)};
+    unsigned int passed = 0;
+    for (const auto &agent : population) {
+        const bool expected = PhiloxRandom(key, agent.getID()).uniform<float>() < 0.5f;
+        EXPECT_EQ(agent.getVariable<int>("uniform_i"), expected ? 1 : 0);
+        passed += expected ? 1 : 0;
+    }
+    EXPECT_GT(passed, 0u);
+    EXPECT_LT(passed, AGENT_COUNT);
+}
+TEST(PhiloxRandomTest, LayerComposition) {
+    std::map<id_t, float> results[2];
+    for (int composition = 0; composition < 2; ++composition) {
+        ModelDescription model(MODEL_NAME);
+        defineModel(model);
+        model.Agent(AGENT_NAME).newFunction(FUNC_NAME, random_fn);
+        LayerDescription &layer = model.newLayer();
+        if (composition) {
+            // Another agent function executes within the layer first, so the agents are executed by different threads
+            AgentDescription &other = model.newAgent("other");
+            other.newVariable<float>("uniform_f", 0);
+            other.newVariable<double>("uniform_d", 0);
+            other.newVariable<int>("uniform_i", 0);
+            other.newVariable<float>("normal_f", 0);
+            other.newFunction(FUNC_NAME, random_fn);
+            layer.addAgentFunction("other", FUNC_NAME);
+        }
+        layer.addAgentFunction(AGENT_NAME, FUNC_NAME);
+        CUDASimulation sim(model);
+        sim.SimulationConfig().random_seed = SEED;
+        sim.CUDAConfig().counterBasedRandom = true;
+        sim.applyConfig();
+        if (composition) {
+            AgentVector other_population(model.Agent("other"), 100);
+            sim.setPopulationData(other_population);
+        }
+        AgentVector init_population(model.Agent(AGENT_NAME), AGENT_COUNT);
+        sim.setPopulationData(init_population);
+        sim.step();
+        AgentVector population(model.Agent(AGENT_NAME));
+        sim.getPopulationData(population);
+        ASSERT_EQ(population.size(), AGENT_COUNT);
+        for (const auto &agent : population) {
+            results[composition].emplace(agent.getID(), agent.getVariable<float>("uniform_f"));
+        }
+    }
+    EXPECT_EQ(results[0], results[1]);
+}
+TEST(PhiloxRandomTest, SubModelSteps) {
+    ModelDescription sub_model("sub");
+    defineModel(sub_model);
+    sub_model.Agent(AGENT_NAME).newFunction(FUNC_NAME, random_fn);
+    sub_model.newLayer().addAgentFunction(AGENT_NAME, FUNC_NAME);
+    sub_model.addExitCondition(exit_always);
+    ModelDescription model(MODEL_NAME);
+    defineModel(model);
+    SubModelDescription &sub_desc = model.newSubModel("sub", sub_model);
+    sub_desc.bindAgent(AGENT_NAME, AGENT_NAME, true, true);
+    model.newLayer().addSubModel("sub");
+    CUDASimulation sim(model);
+    sim.SimulationConfig().random_seed = SEED;
+    sim.CUDAConfig().counterBasedRandom = true;
+    sim.applyConfig();
+    AgentVector init_population(model.Agent(AGENT_NAME), AGENT_COUNT);
+    sim.setPopulationData(init_population);
+    // The submodel's step counter restarts each parent step, the values must still differ
+    std::map<id_t, float> results[2];
+    for (auto &result : results) {
+        sim.step();
+        AgentVector population(model.Agent(AGENT_NAME));
+        sim.getPopulationData(population);
+        ASSERT_EQ(population.size(), AGENT_COUNT);
+        for (const auto &agent : population) {
+            result.emplace(agent.getID(), agent.getVariable<float>("uniform_f"));
+        }
+    }
+    unsigned int repeated = 0;
+    for (const auto &r : results[0]) {
+        repeated += results[1].at(r.first) == r.second ? 1 : 0;
+    }
+    EXPECT_LT(repeated, AGENT_COUNT / 100);
+}
+}  // namespace test_philox_random
+}  // namespace flamegpu
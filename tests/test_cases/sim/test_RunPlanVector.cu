@@ -1,3 +1,5 @@
+#include <set>
+
 #include "flamegpu/flamegpu.h"
 
 #include "gtest/gtest.h"
@@ -449,6 +451,236 @@ TEST(TestRunPlanVector, setPropertyRandom) {
     EXPECT_THROW((plans.setPropertyRandom<double>("d3", static_cast<EnvironmentManager::size_type>(-1), d3dist0)), std::out_of_range);
     EXPECT_THROW((plans.setPropertyRandom<double>("d3", 4u, d3dist0)), std::out_of_range);
 }
+// Random property values depend only on the seed, the plan's index and the property
+TEST(TestRunPlanVector, setPropertyRandomDeterministic) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 0.f);
+    environment.newProperty<int32_t>("i", 0);
+    environment.newProperty<double, 3>("d3", {{0., 0., 0.}});
+    // A large vector is generated in parallel
+    constexpr uint32_t largePlans = 100000u;
+    constexpr uint32_t smallPlans = 8u;
+    flamegpu::RunPlanVector large(model, largePlans);
+    flamegpu::RunPlanVector small(model, smallPlans);
+    flamegpu::RunPlanVector small2(model, smallPlans);
+    large.setRandomPropertySeed(12u);
+    small.setRandomPropertySeed(12u);
+    small2.setRandomPropertySeed(13u);
+    // Properties are set in a different order
+    large.setPropertyUniformRandom<float>("f", 0.f, 1.f);
+    large.setPropertyUniformRandom<int32_t>("i", -1000, 1000);
+    large.setPropertyNormalRandom<double>("d3", 1, 0., 1.);
+    small.setPropertyNormalRandom<double>("d3", 1, 0., 1.);
+    small.setPropertyUniformRandom<int32_t>("i", -1000, 1000);
+    small.setPropertyUniformRandom<float>("f", 0.f, 1.f);
+    small2.setPropertyUniformRandom<float>("f", 0.f, 1.f);
+    // The first plans of the large vector match the small vector
+    const flamegpu::RunPlanVector &const_large = large;
+    bool atleastOneDifferent = false;
+    for (uint32_t i = 0; i < smallPlans; ++i) {
+        const flamegpu::RunPlan plan = const_large[i];
+        EXPECT_EQ(plan.getProperty<float>("f"), small[i].getProperty<float>("f"));
+        EXPECT_EQ(plan.getProperty<int32_t>("i"), small[i].getProperty<int32_t>("i"));
+        EXPECT_EQ(plan.getProperty<double>("d3", 1), small[i].getProperty<double>("d3", 1));
+        EXPECT_EQ(plan.getProperty<double>("d3", 0), 0.);
+        if (small[i].getProperty<float>("f") != small2[i].getProperty<float>("f")) {
+            atleastOneDifferent = true;
+        }
+    }
+    EXPECT_TRUE(atleastOneDifferent);
+    // Regenerating the values gives the same result
+    const float f_last = const_large[largePlans - 1].getProperty<float>("f");
+    large.setPropertyUniformRandom<float>("f", 0.f, 1.f);
+    EXPECT_EQ(const_large[largePlans - 1].getProperty<float>("f"), f_last);
+    // Values are within range, and not all the same
+    std::set<int32_t> i_values;
+    for (uint32_t i = 0; i < largePlans; i += 97) {
+        const flamegpu::RunPlan plan = const_large[i];
+        EXPECT_GE(plan.getProperty<float>("f"), 0.f);
+        EXPECT_LT(plan.getProperty<float>("f"), 1.f);
+        EXPECT_GE(plan.getProperty<int32_t>("i"), -1000);
+        EXPECT_LE(plan.getProperty<int32_t>("i"), 1000);
+        i_values.insert(plan.getProperty<int32_t>("i"));
+    }
+    EXPECT_GT(i_values.size(), 100u);
+}
+// Properties set for the whole vector interact correctly with plans modified via reference
+TEST(TestRunPlanVector, propertyColumns) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 1.f);
+    environment.newProperty<int32_t, 3>("i3", {{1, 2, 3}});
+    constexpr uint32_t totalPlans = 4u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    const flamegpu::RunPlanVector &const_plans = plans;
+    plans.setProperty<float>("f", 2.f);
+    plans.setProperty<int32_t>("i3", 1, 12);
+    // Const access does not copy the values into the plan
+    EXPECT_EQ(const_plans[0].getProperty<float>("f"), 2.f);
+    EXPECT_EQ((const_plans[0].getProperty<int32_t, 3>("i3")), (std::array<int32_t, 3>{{1, 12, 3}}));
+    // Modify a plan via reference, the reference remains valid for subsequent vector operations
+    flamegpu::RunPlan &plan1 = plans[1];
+    EXPECT_EQ(plan1.getProperty<float>("f"), 2.f);
+    plan1.setProperty<float>("f", 3.f);
+    plans.setProperty<int32_t>("i3", 2, 13);
+    EXPECT_EQ((plan1.getProperty<int32_t, 3>("i3")), (std::array<int32_t, 3>{{1, 12, 13}}));
+    EXPECT_EQ((const_plans[2].getProperty<int32_t, 3>("i3")), (std::array<int32_t, 3>{{1, 12, 13}}));
+    EXPECT_EQ(const_plans[1].getProperty<float>("f"), 3.f);
+    EXPECT_EQ(const_plans[2].getProperty<float>("f"), 2.f);
+    // Overrides of an individual plan are moved into the vector's columns
+    flamegpu::RunPlan single(model);
+    single.setProperty<float>("f", 4.f);
+    plans += single;
+    plans *= 2;
+    ASSERT_EQ(plans.size(), (totalPlans + 1) * 2);
+    for (uint32_t i = 0; i < plans.size(); ++i) {
+        const uint32_t j = i % (totalPlans + 1);
+        EXPECT_EQ(const_plans[i].getProperty<float>("f"), j == 1 ? 3.f : j == totalPlans ? 4.f : 2.f);
+        EXPECT_EQ(const_plans[i].getProperty<int32_t>("i3", 1), j == totalPlans ? 2 : 12);
+    }
+    // Inserted plans keep their values
+    plans.insert(plans.begin() + 1, single);
+    plans.setProperty<int32_t>("i3", 0, 11);
+    EXPECT_EQ(const_plans[1].getProperty<float>("f"), 4.f);
+    EXPECT_EQ(const_plans[2].getProperty<float>("f"), 3.f);
+    for (uint32_t i = 0; i < plans.size(); ++i) {
+        EXPECT_EQ(const_plans[i].getProperty<int32_t>("i3", 0), 11);
+    }
+    // Assigning a plan replaces it's overrides
+    plans[0] = single;
+    EXPECT_EQ(const_plans[0].getProperty<float>("f"), 4.f);
+    EXPECT_EQ(const_plans[0].getProperty<int32_t>("i3", 0), 1);
+}
+// Const iteration returns copies of the plans, including their column values
+TEST(TestRunPlanVector, constIteration) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 1.f);
+    constexpr uint32_t totalPlans = 4u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    const flamegpu::RunPlanVector &const_plans = plans;
+    plans.setProperty<float>("f", 2.f);
+    plans[1].setProperty<float>("f", 3.f);
+    EXPECT_EQ(static_cast<uint32_t>(const_plans.cend() - const_plans.cbegin()), totalPlans);
+    uint32_t i = 0;
+    for (const flamegpu::RunPlan &plan : const_plans) {
+        EXPECT_EQ(plan.getProperty<float>("f"), i == 1 ? 3.f : 2.f);
+        ++i;
+    }
+    EXPECT_EQ(i, totalPlans);
+    // Properties set after const iteration still apply to all plans
+    plans.setProperty<float>("f", 4.f);
+    for (auto it = const_plans.begin(); it != const_plans.end(); ++it) {
+        EXPECT_EQ((*it).getProperty<float>("f"), 4.f);
+    }
+    // Plans can be inserted at a read only position
+    flamegpu::RunPlan single(model);
+    single.setProperty<float>("f", 5.f);
+    plans.insert(const_plans.cbegin() + 1, single);
+    ASSERT_EQ(plans.size(), totalPlans + 1);
+    EXPECT_EQ(const_plans[1].getProperty<float>("f"), 5.f);
+    EXPECT_EQ(const_plans[2].getProperty<float>("f"), 4.f);
+    // Iterators of a different vector are rejected
+    flamegpu::RunPlanVector other(model, 1);
+    const flamegpu::RunPlanVector &const_other = other;
+    EXPECT_THROW(plans.insert(const_other.cbegin(), single), flamegpu::exception::InvalidArgument);
+}
+TEST(TestRunPlanVector, setPropertyLatinHypercube) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 0.f);
+    environment.newProperty<int32_t>("i", 0);
+    environment.newProperty<double, 3>("d3", {{0., 0., 0.}});
+    constexpr uint32_t totalPlans = 16u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    plans.setRandomPropertySeed(1u);
+    const std::vector<flamegpu::RunPlanVector::PropertyRange> properties = {
+        {"f", 0., 1.},
+        {"i", 0., 15.},
+        {"d3", 1u, -1., 1.}};
+    plans.setPropertyLatinHypercube(properties);
+    // Each stratum of each property is sampled by exactly one plan
+    const flamegpu::RunPlanVector &const_plans = plans;
+    std::set<int> fStrata, iStrata, d3Strata;
+    for (uint32_t i = 0; i < totalPlans; ++i) {
+        const flamegpu::RunPlan plan = const_plans[i];
+        fStrata.insert(static_cast<int>(plan.getProperty<float>("f") * totalPlans));
+        iStrata.insert(plan.getProperty<int32_t>("i"));
+        d3Strata.insert(static_cast<int>((plan.getProperty<double>("d3", 1) + 1.) / 2. * totalPlans));
+        // Other elements are unaffected
+        EXPECT_EQ(plan.getProperty<double>("d3", 0), 0.);
+    }
+    EXPECT_EQ(fStrata.size(), totalPlans);
+    EXPECT_EQ(*fStrata.begin(), 0);
+    EXPECT_EQ(*fStrata.rbegin(), static_cast<int>(totalPlans) - 1);
+    EXPECT_EQ(iStrata.size(), totalPlans);
+    EXPECT_EQ(*iStrata.begin(), 0);
+    EXPECT_EQ(*iStrata.rbegin(), 15);
+    EXPECT_EQ(d3Strata.size(), totalPlans);
+    // The design is reproducible
+    flamegpu::RunPlanVector plans2(model, totalPlans);
+    plans2.setRandomPropertySeed(1u);
+    plans2.setPropertyLatinHypercube(properties);
+    for (uint32_t i = 0; i < totalPlans; ++i) {
+        EXPECT_EQ(plans[i].getProperty<float>("f"), plans2[i].getProperty<float>("f"));
+        EXPECT_EQ(plans[i].getProperty<int32_t>("i"), plans2[i].getProperty<int32_t>("i"));
+    }
+    // Tests for exceptions
+    // --------------------
+    flamegpu::RunPlanVector singlePlanVector(model, 1);
+    EXPECT_THROW(singlePlanVector.setPropertyLatinHypercube(properties), std::out_of_range);
+    EXPECT_THROW(plans.setPropertyLatinHypercube({{"does_not_exist", 0., 1.}}), flamegpu::exception::InvalidEnvProperty);
+    EXPECT_THROW(plans.setPropertyLatinHypercube({{"d3", 0., 1.}}), flamegpu::exception::InvalidEnvPropertyType);
+    EXPECT_THROW(plans.setPropertyLatinHypercube({{"d3", 3u, 0., 1.}}), std::out_of_range);
+}
+TEST(TestRunPlanVector, setPropertySobol) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 0.f);
+    environment.newProperty<double, 2>("d2", {{0., 0.}});
+    constexpr uint32_t totalPlans = 8u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    plans.setPropertySobol({{"f", 0., 8.}, {"d2", 1u, 0., 1.}});
+    // The first dimension is the van der Corput sequence, the second is from the primitive polynomial x + 1
+    const std::array<float, totalPlans> fExpected = {{0.f, 4.f, 2.f, 6.f, 1.f, 5.f, 3.f, 7.f}};
+    const std::array<double, totalPlans> d2Expected = {{0., 0.5, 0.75, 0.25, 0.625, 0.125, 0.375, 0.875}};
+    for (uint32_t i = 0; i < totalPlans; ++i) {
+        EXPECT_EQ(plans[i].getProperty<float>("f"), fExpected[i]);
+        EXPECT_EQ(plans[i].getProperty<double>("d2", 1), d2Expected[i]);
+        EXPECT_EQ(plans[i].getProperty<double>("d2", 0), 0.);
+    }
+    // Tests for exceptions
+    // --------------------
+    const std::vector<flamegpu::RunPlanVector::PropertyRange> tooMany(flamegpu::RunPlanVector::SOBOL_MAX_DIMENSIONS + 1, {"f", 0., 1.});
+    EXPECT_THROW(plans.setPropertySobol(tooMany), flamegpu::exception::InvalidArgument);
+    EXPECT_THROW(plans.setPropertySobol({{"does_not_exist", 0., 1.}}), flamegpu::exception::InvalidEnvProperty);
+}
+TEST(TestRunPlanVector, setPropertyHalton) {
+    // Define the simple model to use
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<double>("a", 0.);
+    environment.newProperty<double>("b", 0.);
+    environment.newProperty<uint32_t>("u", 0u);
+    constexpr uint32_t totalPlans = 4u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    plans.setPropertyHalton({{"a", 0., 1.}, {"b", 0., 9.}, {"u", 0., 24.}});
+    // Radical inverses of 1 to 4, in bases 2, 3 and 5
+    const std::array<double, totalPlans> aExpected = {{0.5, 0.25, 0.75, 0.125}};
+    const std::array<double, totalPlans> bExpected = {{3., 6., 1., 4.}};
+    const std::array<uint32_t, totalPlans> uExpected = {{5u, 10u, 15u, 20u}};
+    for (uint32_t i = 0; i < totalPlans; ++i) {
+        EXPECT_DOUBLE_EQ(plans[i].getProperty<double>("a"), aExpected[i]);
+        EXPECT_DOUBLE_EQ(plans[i].getProperty<double>("b"), bExpected[i]);
+        EXPECT_EQ(plans[i].getProperty<uint32_t>("u"), uExpected[i]);
+    }
+}
 // Test getting the random property seed
 TEST(TestRunPlanVector, getRandomPropertySeed) {
     // Define the simple model to use
@@ -0,0 +1,78 @@
+#include <map>
+
+#include "flamegpu/util/detail/DirtyRanges.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+
+using util::detail::DirtyRanges;
+
+TEST(TestDirtyRanges, Empty) {
+    DirtyRanges d;
+    EXPECT_TRUE(d.empty());
+    EXPECT_EQ(d.getBytes(), 0u);
+    // Zero length ranges are ignored
+    d.mark(12, 0);
+    EXPECT_TRUE(d.empty());
+}
+TEST(TestDirtyRanges, Disjoint) {
+    DirtyRanges d;
+    d.mark(16, 4);
+    d.mark(0, 4);
+    d.mark(32, 8);
+    EXPECT_FALSE(d.empty());
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{0, 4}, {16, 20}, {32, 40}}));
+    EXPECT_EQ(d.getBytes(), 16u);
+}
+TEST(TestDirtyRanges, Coalesce) {
+    DirtyRanges d;
+    // Repeated
+    d.mark(8, 4);
+    d.mark(8, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{8, 12}}));
+    // Adjacent, before and after
+    d.mark(4, 4);
+    d.mark(12, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{4, 16}}));
+    // Contained
+    d.mark(6, 2);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{4, 16}}));
+    // Overlapping
+    d.mark(14, 6);
+    d.mark(2, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{2, 20}}));
+    // Spanning multiple ranges
+    d.mark(40, 4);
+    d.mark(60, 4);
+    EXPECT_EQ(d.getRanges().size(), 3u);
+    d.mark(10, 52);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{2, 64}}));
+    EXPECT_EQ(d.getBytes(), 62u);
+}
+TEST(TestDirtyRanges, MergeGap) {
+    DirtyRanges d(8);
+    EXPECT_EQ(d.getMergeGap(), 8u);
+    d.mark(0, 4);
+    // Gap of 8 is merged
+    d.mark(12, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{0, 16}}));
+    // Gap of 9 is not
+    d.mark(25, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{0, 16}, {25, 29}}));
+    // Gap before an existing range
+    d.mark(40, 4);
+    d.mark(33, 2);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{0, 16}, {25, 44}}));
+}
+TEST(TestDirtyRanges, Clear) {
+    DirtyRanges d;
+    d.mark(0, 4);
+    d.mark(8, 4);
+    d.clear();
+    EXPECT_TRUE(d.empty());
+    EXPECT_EQ(d.getBytes(), 0u);
+    d.mark(4, 4);
+    EXPECT_EQ(d.getRanges(), (std::map<size_t, size_t>{{4, 8}}));
+}
+
+}  // namespace flamegpu
@@ -0,0 +1,112 @@
+#include "flamegpu/util/detail/FreeListAllocator.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+
+using util::detail::FreeListAllocator;
+
+TEST(TestFreeListAllocator, Bump) {
+    FreeListAllocator a(64);
+    EXPECT_EQ(a.getCapacity(), 64u);
+    EXPECT_EQ(a.getFreeSpace(), 64u);
+    EXPECT_EQ(a.allocate(8, 8), 0);
+    EXPECT_EQ(a.allocate(4, 4), 8);
+    EXPECT_EQ(a.allocate(16, 8), 16);
+    EXPECT_EQ(a.getEnd(), 32u);
+    EXPECT_EQ(a.getFreeSpace(), 36u);
+    // The alignment padding is free
+    EXPECT_EQ(a.getFreeBlockCount(), 1u);
+    EXPECT_EQ(a.allocate(4, 4), 12);
+    EXPECT_EQ(a.getFreeBlockCount(), 0u);
+}
+TEST(TestFreeListAllocator, OutOfSpace) {
+    FreeListAllocator a(32);
+    EXPECT_EQ(a.allocate(24), 0);
+    EXPECT_EQ(a.allocate(16), FreeListAllocator::OUT_OF_SPACE);
+    // Alignment padding can prevent allocation
+    EXPECT_EQ(a.allocate(8, 16), FreeListAllocator::OUT_OF_SPACE);
+    EXPECT_EQ(a.allocate(8, 8), 24);
+    EXPECT_EQ(a.getFreeSpace(), 0u);
+    EXPECT_EQ(a.getLargestFreeBlock(), 0u);
+    EXPECT_EQ(a.allocate(1), FreeListAllocator::OUT_OF_SPACE);
+}
+TEST(TestFreeListAllocator, ReuseFreed) {
+    FreeListAllocator a(1024);
+    const ptrdiff_t x = a.allocate(32, 8);
+    a.allocate(8, 8);
+    const ptrdiff_t z = a.allocate(64, 8);
+    a.deallocate(x, 32);
+    EXPECT_EQ(a.getFreeBlockCount(), 1u);
+    // Smaller regions are placed within the free block
+    EXPECT_EQ(a.allocate(8, 8), x);
+    EXPECT_EQ(a.allocate(16, 8), x + 8);
+    // The remainder is too small
+    EXPECT_EQ(a.allocate(16, 8), z + 64);
+    EXPECT_EQ(a.getFreeBlockCount(), 1u);
+    EXPECT_EQ(a.allocate(8, 8), x + 24);
+    EXPECT_EQ(a.getFreeBlockCount(), 0u);
+}
+TEST(TestFreeListAllocator, SizeClass) {
+    FreeListAllocator a(1024);
+    const ptrdiff_t big = a.allocate(256);
+    a.allocate(8);
+    const ptrdiff_t small = a.allocate(16);
+    a.allocate(8);
+    a.deallocate(big, 256);
+    a.deallocate(small, 16);
+    // The small block is preferred, despite the big block having a lower offset
+    EXPECT_EQ(a.allocate(12), small);
+    EXPECT_EQ(a.allocate(12), big);
+}
+TEST(TestFreeListAllocator, Alignment) {
+    FreeListAllocator a(1024);
+    a.allocate(4);
+    const ptrdiff_t x = a.allocate(60);
+    a.allocate(8);
+    a.deallocate(x, 60);
+    // The free block begins at 4, so the aligned region begins at 16 and the padding remains free
+    EXPECT_EQ(a.allocate(32, 16), 16);
+    EXPECT_EQ(a.getFreeBlockCount(), 2u);
+    EXPECT_EQ(a.allocate(12, 4), 4);
+    EXPECT_EQ(a.allocate(16, 16), 48);
+    EXPECT_EQ(a.getFreeBlockCount(), 0u);
+}
+TEST(TestFreeListAllocator, Coalesce) {
+    FreeListAllocator a(1024);
+    const ptrdiff_t x = a.allocate(16);
+    const ptrdiff_t y = a.allocate(16);
+    const ptrdiff_t z = a.allocate(16);
+    a.allocate(16);
+    a.deallocate(x, 16);
+    a.deallocate(z, 16);
+    EXPECT_EQ(a.getFreeBlockCount(), 2u);
+    // Joins the blocks either side
+    a.deallocate(y, 16);
+    EXPECT_EQ(a.getFreeBlockCount(), 1u);
+    EXPECT_EQ(a.getLargestFreeBlock(), 1024u - 64u);
+    EXPECT_EQ(a.allocate(48), x);
+}
+TEST(TestFreeListAllocator, RollbackEnd) {
+    FreeListAllocator a(1024);
+    const ptrdiff_t x = a.allocate(16);
+    const ptrdiff_t y = a.allocate(16);
+    const ptrdiff_t z = a.allocate(16);
+    a.deallocate(y, 16);
+    EXPECT_EQ(a.getEnd(), 48u);
+    // Freeing the final region also returns the free block before it
+    a.deallocate(z, 16);
+    EXPECT_EQ(a.getEnd(), 16u);
+    EXPECT_EQ(a.getFreeBlockCount(), 0u);
+    a.deallocate(x, 16);
+    EXPECT_EQ(a.getEnd(), 0u);
+    EXPECT_EQ(a.getFreeSpace(), 1024u);
+    EXPECT_EQ(a.getLargestFreeBlock(), 1024u);
+}
+TEST(TestFreeListAllocator, Unbounded) {
+    FreeListAllocator a;
+    EXPECT_EQ(a.allocate(1 << 20, 8), 0);
+    EXPECT_EQ(a.allocate(4, 8), 1 << 20);
+    EXPECT_EQ(a.getEnd(), (1u << 20) + 4u);
+}
+
+}  // namespace flamegpu
@@ -0,0 +1,222 @@
+/**
+* Tests of util::TraceRecorder
+*
+* Tests cover:
+* > ranges are only recorded whilst recording
+* > nested ranges, and ranges which were opened before recording began
+* > ring buffer overflow retains the most recent ranges
+* > ranges from multiple threads are recorded independently
+* > export whilst other threads are recording
+* > Chrome trace-event export
+* > NVTX macros forward ranges from CUDASimulation, if USE_NVTX_TRACE is defined
+* > exceptions
+*/
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/util/TraceRecorder.h"
+#include "flamegpu/util/nvtx.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_trace_recorder {
+const char *TRACE_PATH = "test_trace_recorder.json";
+const unsigned int THREADS = 8;
+const unsigned int RANGES = 1000;
+class TraceRecorderTest : public testing::Test {
+ protected:
+    void TearDown() override {
+        util::TraceRecorder::stop();
+        util::TraceRecorder::clear();
+        std::remove(TRACE_PATH);
+    }
+    std::string exportTrace() {
+        util::TraceRecorder::exportChromeTrace(TRACE_PATH);
+        std::ifstream f(TRACE_PATH);
+        return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_F(TraceRecorderTest, Recording) {
+    EXPECT_FALSE(util::TraceRecorder::isRecording());
+    util::TraceRecorder::push("before");
+    util::TraceRecorder::pop();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 0u);
+    util::TraceRecorder::start();
+    EXPECT_TRUE(util::TraceRecorder::isRecording());
+    util::TraceRecorder::push("a");
+    util::TraceRecorder::pop();
+    util::TraceRecorder::push("b");
+    util::TraceRecorder::pop();
+    util::TraceRecorder::stop();
+    util::TraceRecorder::push("after");
+    util::TraceRecorder::pop();
+    EXPECT_FALSE(util::TraceRecorder::isRecording());
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 2u);
+    EXPECT_EQ(util::TraceRecorder::getDroppedEventCount(), 0u);
+    // Restarting discards previous ranges
+    util::TraceRecorder::start();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 0u);
+    util::TraceRecorder::push("c");
+    util::TraceRecorder::pop();
+    util::TraceRecorder::stop();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 1u);
+    util::TraceRecorder::clear();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 0u);
+}
+TEST_F(TraceRecorderTest, Nesting) {
+    // Opened before recording, so the pop is ignored
+    util::TraceRecorder::push("outer");
+    util::TraceRecorder::start();
+    util::TraceRecorder::push("middle");
+    util::TraceRecorder::push("inner");
+    util::TraceRecorder::pop();
+    util::TraceRecorder::pop();
+    util::TraceRecorder::pop();
+    util::TraceRecorder::stop();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 2u);
+    const std::string trace = exportTrace();
+    EXPECT_EQ(trace.find("\"outer\""), std::string::npos);
+    // Inner completes first
+    const size_t inner = trace.find("\"name\":\"inner\"");
+    const size_t middle = trace.find("\"name\":\"middle\"");
+    ASSERT_NE(inner, std::string::npos);
+    ASSERT_NE(middle, std::string::npos);
+    EXPECT_LT(inner, middle);
+}
+TEST_F(TraceRecorderTest, DepthAndLabelLimits) {
+    util::TraceRecorder::start();
+    const unsigned int DEPTH = util::TraceRecorder::MAX_DEPTH + 10;
+    for (unsigned int i = 0; i < DEPTH; ++i) {
+        util::TraceRecorder::push("deep");
+    }
+    for (unsigned int i = 0; i < DEPTH; ++i) {
+        util::TraceRecorder::pop();
+    }
+    const std::string long_label(util::TraceRecorder::MAX_LABEL_LENGTH + 20, 'x');
+    util::TraceRecorder::push(long_label.c_str());
+    util::TraceRecorder::pop();
+    util::TraceRecorder::stop();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), util::TraceRecorder::MAX_DEPTH + 1);
+    const std::string trace = exportTrace();
+    EXPECT_NE(trace.find("\"" + std::string(util::TraceRecorder::MAX_LABEL_LENGTH, 'x') + "\""), std::string::npos);
+    EXPECT_EQ(trace.find(std::string(util::TraceRecorder::MAX_LABEL_LENGTH + 1, 'x')), std::string::npos);
+}
+TEST_F(TraceRecorderTest, Overflow) {
+    util::TraceRecorder::start(4);
+    for (int i = 0; i < 10; ++i) {
+        util::TraceRecorder::push(("range" + std::to_string(i)).c_str());
+        util::TraceRecorder::pop();
+    }
+    util::TraceRecorder::stop();
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), 4u);
+    EXPECT_EQ(util::TraceRecorder::getDroppedEventCount(), 6u);
+    const std::string trace = exportTrace();
+    EXPECT_EQ(trace.find("\"range5\""), std::string::npos);
+    for (int i = 6; i < 10; ++i) {
+        EXPECT_NE(trace.find("\"range" + std::to_string(i) + "\""), std::string::npos);
+    }
+}
+TEST_F(TraceRecorderTest, MultipleThreads) {
+    util::TraceRecorder::start();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([]() {
+            for (unsigned int i = 0; i < RANGES; ++i) {
+                util::TraceRecorder::push("thread range");
+                util::TraceRecorder::pop();
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    util::TraceRecorder::stop();
+    // Ranges outlive the threads which recorded them
+    EXPECT_EQ(util::TraceRecorder::getEventCount(), THREADS * RANGES);
+    const std::string trace = exportTrace();
+    for (unsigned int t = 1; t <= THREADS; ++t) {
+        EXPECT_NE(trace.find("\"thread " + std::to_string(t) + "\""), std::string::npos);
+    }
+}
+TEST_F(TraceRecorderTest, ExportWhileRecording) {
+    const unsigned int CAPACITY = 16;
+    util::TraceRecorder::start(CAPACITY);
+    std::atomic<bool> finished = {false};
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&finished]() {
+            while (!finished.load()) {
+                util::TraceRecorder::push("thread range");
+                util::TraceRecorder::pop();
+            }
+        });
+    }
+    // Each export holds complete ranges, which are not torn by the recording threads
+    for (unsigned int i = 0; i < 10; ++i) {
+        const std::string trace = exportTrace();
+        unsigned int ranges = 0;
+        for (size_t pos = trace.find("\"ph\":\"X\""); pos != std::string::npos; pos = trace.find("\"ph\":\"X\"", pos + 1)) {
+            ++ranges;
+        }
+        unsigned int labels = 0;
+        for (size_t pos = trace.find("\"name\":\"thread range\""); pos != std::string::npos; pos = trace.find("\"name\":\"thread range\"", pos + 1)) {
+            ++labels;
+        }
+        EXPECT_LE(ranges, THREADS * CAPACITY);
+        EXPECT_EQ(ranges, labels);
+    }
+    finished = true;
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+TEST_F(TraceRecorderTest, ExportFormat) {
+    util::TraceRecorder::start();
+    util::TraceRecorder::push("quote\"d");
+    util::TraceRecorder::pop();
+    util::TraceRecorder::stop();
+    const std::string trace = exportTrace();
+    EXPECT_EQ(trace.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(trace.find("\"name\":\"quote\\\"d\",\"cat\":\"flamegpu\",\"ph\":\"X\",\"ts\":0.0,\"dur\":"), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"M\""), std::string::npos);
+    EXPECT_NE(trace.find("\"displayTimeUnit\":\"ms\"}"), std::string::npos);
+}
+TEST_F(TraceRecorderTest, Exceptions) {
+    EXPECT_THROW(util::TraceRecorder::start(0), exception::InvalidArgument);
+    util::TraceRecorder::start();
+    EXPECT_THROW(util::TraceRecorder::start(), exception::InvalidOperation);
+    EXPECT_THROW(util::TraceRecorder::clear(), exception::InvalidOperation);
+    util::TraceRecorder::stop();
+    EXPECT_THROW(util::TraceRecorder::exportChromeTrace(""), exception::InvalidFilePath);
+}
+#if defined(USE_NVTX_TRACE)
+FLAMEGPU_STEP_FUNCTION(trace_step) {
+    NVTX_RANGE("trace_step");
+}
+TEST_F(TraceRecorderTest, NVTXMacros) {
+    ModelDescription model("model");
+    model.newAgent("agent");
+    model.addStepFunction(trace_step);
+    CUDASimulation sim(model);
+    sim.SimulationConfig().steps = 2;
+    util::TraceRecorder::start();
+    sim.simulate();
+    util::TraceRecorder::stop();
+    const std::string trace = exportTrace();
+    EXPECT_NE(trace.find("\"CUDASimulation::step 0\""), std::string::npos);
+    EXPECT_NE(trace.find("\"CUDASimulation::step 1\""), std::string::npos);
+    EXPECT_NE(trace.find("\"trace_step\""), std::string::npos);
+}
+#endif
+}  // namespace test_trace_recorder
+}  // namespace flamegpu